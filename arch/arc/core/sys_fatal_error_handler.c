@@ -26,6 +26,7 @@
 #include <sections.h>
 #include <kernel_structs.h>
 #include <misc/printk.h>
+#include <console/uart_console.h>
 
 /**
  *
@@ -56,10 +57,13 @@ FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
 	if (k_is_in_isr() || _is_thread_essential()) {
 		printk("Fatal fault in %s! Spinning...\n",
 		       k_is_in_isr() ? "ISR" : "essential thread");
+		/* output left to the UART interrupt would never be sent */
+		uart_console_flush();
 		for (;;)
 			; /* spin forever */
 	}
 	printk("Fatal fault in thread! Aborting.\n");
+	uart_console_flush();
 	k_thread_abort(_current);
 
 	CODE_UNREACHABLE;
@@ -165,4 +165,6 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 	/* initial values in all other regs/k_thread entries are irrelevant */
 
 	thread_monitor_init(thread);
+
+	_thread_stats_init(thread);
 }
@@ -145,4 +145,6 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 	/* initial values in all other registers/TCS entries are irrelevant */
 
 	thread_monitor_init(tcs);
+
+	_thread_stats_init(tcs);
 }
@@ -18,6 +18,7 @@
 #include <arch/cpu.h>
 #include <kernel_structs.h>
 #include <misc/printk.h>
+#include <console/uart_console.h>
 #include <inttypes.h>
 
 const NANO_ESF _default_esf = {
@@ -230,6 +231,8 @@ FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
 	if (k_is_in_isr() || _is_thread_essential()) {
 		printk("Fatal fault in %s! Spinning...\n",
 		       k_is_in_isr() ? "ISR" : "essential thread");
+		/* output left to the UART interrupt would never be sent */
+		uart_console_flush();
 #ifdef ALT_CPU_HAS_DEBUG_STUB
 		_nios2_break();
 #endif
@@ -237,6 +240,7 @@ FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
 			; /* spin forever */
 	}
 	printk("Fatal fault in thread! Aborting.\n");
+	uart_console_flush();
 	k_thread_abort(_current);
 
 	CODE_UNREACHABLE;
@@ -140,6 +140,8 @@ static void _new_thread_internal(char *pStackMem, unsigned stackSize,
 
 	thread_monitor_init(thread);
 
+	_thread_stats_init(thread);
+
 	_nano_timeout_thread_init(thread);
 }
 
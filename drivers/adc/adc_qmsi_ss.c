@@ -29,6 +29,7 @@
 #include "qm_ss_isr.h"
 #include "qm_ss_adc.h"
 #include "ss_clk.h"
+#include "clk.h"
 
 enum {
 	ADC_STATE_IDLE,
@@ -40,6 +41,19 @@ struct adc_info  {
 	atomic_t  state;
 	device_sync_call_t sync;
 	struct k_sem sem;
+#if (CONFIG_ADC_QMSI_INTERRUPT)
+	struct adc_stream *stream;
+	qm_ss_adc_xfer_t stream_xfer;
+	qm_ss_adc_channel_t stream_channel;
+	/* Index of the stream buffer being filled */
+	int stream_buffer;
+	volatile int stream_stopping;
+	/* Set by the QMSI callback, the next block is started once the
+	 * QMSI interrupt handler returns
+	 */
+	int block_done;
+	int block_error;
+#endif
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	uint32_t device_power_state;
 #ifdef CONFIG_SYS_POWER_DEEP_SLEEP
@@ -71,6 +85,58 @@ static void complete_callback(void *data, int error, qm_ss_adc_status_t status,
 	}
 }
 
+static void stream_callback(void *data, int error, qm_ss_adc_status_t status,
+			    qm_ss_adc_cb_source_t source)
+{
+	ARG_UNUSED(status);
+	ARG_UNUSED(source);
+
+	struct device *dev = data;
+	struct adc_info *info = dev->driver_data;
+
+	info->block_done = 1;
+	if (error) {
+		info->block_error = 1;
+	}
+}
+
+/* Called once the QMSI interrupt handler has stopped the sequencer */
+static void stream_next(struct device *dev)
+{
+	struct adc_info *info = dev->driver_data;
+	struct adc_stream *stream = info->stream;
+	uint8_t *full = NULL;
+
+	if (!stream || !info->block_done) {
+		return;
+	}
+
+	info->block_done = 0;
+
+	if (info->stream_stopping) {
+		info->stream = NULL;
+		device_sync_call_complete(&info->sync);
+		return;
+	}
+
+	if (info->block_error) {
+		/* samples were lost, fill the same buffer again */
+		info->block_error = 0;
+		stream->overruns++;
+	} else {
+		full = stream->buffer[info->stream_buffer];
+		info->stream_buffer ^= 1;
+	}
+
+	info->stream_xfer.samples =
+		(qm_ss_adc_sample_t *)stream->buffer[info->stream_buffer];
+	qm_ss_adc_irq_convert(QM_SS_ADC_0, &info->stream_xfer);
+
+	if (full) {
+		stream->callback(dev, stream, full);
+	}
+}
+
 #endif
 
 static void adc_lock(struct adc_info *data)
@@ -229,24 +295,116 @@ static int adc_qmsi_ss_read(struct device *dev, struct adc_seq_table *seq_tbl)
 
 	return ret;
 }
+
+/*
+ * The sequencer stops after each block: the next one is started from the
+ * interrupt ending the previous one, at the cost of a short gap between
+ * blocks. The sampling window is at most 255 ADC clock cycles, so the ADC
+ * clock is divided for the stream rate, down to about 600 Hz at 32 MHz.
+ */
+static int adc_qmsi_ss_stream_start(struct device *dev,
+				    struct adc_stream *stream)
+{
+	struct adc_info *info = dev->driver_data;
+	uint32_t ticks_per_us = clk_sys_get_ticks_per_us();
+	uint32_t clk = ticks_per_us * 1000000;
+	uint32_t div, window;
+
+	if (!stream->sampling_rate || !stream->callback ||
+	    stream->buffer_length < sizeof(qm_ss_adc_sample_t)) {
+		return -EINVAL;
+	}
+
+	div = (clk + stream->sampling_rate * 255 - 1) /
+		(stream->sampling_rate * 255);
+	window = clk / div / stream->sampling_rate;
+	if (div > QM_SS_ADC_DIV_MAX * ticks_per_us ||
+	    window < CONFIG_ADC_QMSI_SAMPLE_WIDTH + 3) {
+		return -EINVAL;
+	}
+
+	adc_lock(info);
+
+	ss_clk_adc_set_div(div);
+	cfg.window = window;
+	if (qm_ss_adc_set_config(QM_SS_ADC_0, &cfg) != 0) {
+		ss_clk_adc_set_div(CONFIG_ADC_QMSI_CLOCK_RATIO);
+		adc_unlock(info);
+		return -EINVAL;
+	}
+
+	info->stream_channel = stream->channel_id;
+	info->stream_xfer.ch = &info->stream_channel;
+	info->stream_xfer.ch_len = 1;
+	info->stream_xfer.samples = (qm_ss_adc_sample_t *)stream->buffer[0];
+	info->stream_xfer.samples_len =
+		stream->buffer_length / sizeof(qm_ss_adc_sample_t);
+	info->stream_xfer.callback = stream_callback;
+	info->stream_xfer.callback_data = dev;
+
+	info->stream_buffer = 0;
+	info->stream_stopping = 0;
+	info->block_done = 0;
+	info->block_error = 0;
+	info->stream = stream;
+
+	if (qm_ss_adc_irq_convert(QM_SS_ADC_0, &info->stream_xfer) != 0) {
+		info->stream = NULL;
+		ss_clk_adc_set_div(CONFIG_ADC_QMSI_CLOCK_RATIO);
+		adc_unlock(info);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static void adc_qmsi_ss_stream_stop(struct device *dev)
+{
+	struct adc_info *info = dev->driver_data;
+
+	if (!info->stream) {
+		return;
+	}
+
+	/* The sequencer cannot be stopped through QMSI, wait for the end
+	 * of the block in progress
+	 */
+	info->stream_stopping = 1;
+	device_sync_call_wait(&info->sync);
+
+	ss_clk_adc_set_div(CONFIG_ADC_QMSI_CLOCK_RATIO);
+	adc_unlock(info);
+}
 #endif /* CONFIG_ADC_QMSI_POLL */
 
 void adc_qmsi_ss_rx_isr(void *arg)
 {
-	ARG_UNUSED(arg);
 	qm_ss_adc_0_isr(NULL);
+#if (CONFIG_ADC_QMSI_INTERRUPT)
+	stream_next(arg);
+#else
+	ARG_UNUSED(arg);
+#endif
 }
 
 void adc_qmsi_ss_err_isr(void *arg)
 {
-	ARG_UNUSED(arg);
 	qm_ss_adc_0_error_isr(NULL);
+#if (CONFIG_ADC_QMSI_INTERRUPT)
+	stream_next(arg);
+#else
+	ARG_UNUSED(arg);
+#endif
 }
 
 static const struct adc_driver_api api_funcs = {
 	.enable  = adc_qmsi_ss_enable,
 	.disable = adc_qmsi_ss_disable,
 	.read    = adc_qmsi_ss_read,
+#if (CONFIG_ADC_QMSI_INTERRUPT)
+	.stream_start = adc_qmsi_ss_stream_start,
+	.stream_stop = adc_qmsi_ss_stream_stop,
+#endif
 };
 
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
@@ -0,0 +1,206 @@
+/* adc_sim.c - Simulated ADC driver */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Every channel samples the same synthetic pulse wave, in 12 bits samples
+ * of 16 bits. A stream is timed by a kernel timer, each expiry producing
+ * the samples due since the previous one, as an ADC FIFO threshold
+ * interrupt would.
+ */
+
+#include <errno.h>
+
+#include <init.h>
+#include <kernel.h>
+#include <adc.h>
+#include <misc/util.h>
+
+/* Samples per timer expiry */
+#define FIFO_THRESHOLD 16
+
+#define BASELINE 2048
+#define PEAK 800
+#define TROUGH 200
+
+struct adc_sim_data {
+	struct device *dev;
+	struct k_sem sem;
+	struct k_timer timer;
+	struct adc_stream *stream;
+	/* Index of the stream buffer being filled, and of the next sample
+	 * in it
+	 */
+	int buffer;
+	uint32_t offset;
+	/* Samples produced, and cycles elapsed, since the stream start */
+	uint32_t produced;
+	uint64_t elapsed;
+	uint32_t last;
+};
+
+/* Fast rise to the systolic peak, fall below the baseline and slow
+ * recovery, t in microseconds
+ */
+static uint16_t pulse_wave(uint64_t t)
+{
+	uint32_t period = USEC_PER_SEC * 60 / CONFIG_ADC_SIM_PULSE_RATE;
+	uint32_t phase = t % period;
+	uint32_t rise = period / 10;
+	uint32_t fall = period * 3 / 10;
+
+	if (phase < rise) {
+		return BASELINE + PEAK * phase / rise;
+	}
+
+	if (phase < fall) {
+		return BASELINE + PEAK -
+			(PEAK + TROUGH) * (phase - rise) / (fall - rise);
+	}
+
+	return BASELINE - TROUGH + TROUGH * (phase - fall) / (period - fall);
+}
+
+static void adc_sim_enable(struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static void adc_sim_disable(struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static int adc_sim_read(struct device *dev, struct adc_seq_table *seq_tbl)
+{
+	struct adc_sim_data *data = dev->driver_data;
+	struct adc_seq_entry *entry;
+	uint16_t *samples;
+	uint64_t t;
+	int i, j;
+
+	k_sem_take(&data->sem, K_FOREVER);
+
+	for (i = 0; i < seq_tbl->num_entries; i++) {
+		entry = &seq_tbl->entries[i];
+		samples = (uint16_t *)entry->buffer;
+		t = k_uptime_get() * USEC_PER_MSEC;
+
+		for (j = 0; j < entry->buffer_length / sizeof(uint16_t); j++) {
+			samples[j] = pulse_wave(t);
+		}
+	}
+
+	k_sem_give(&data->sem);
+
+	return 0;
+}
+
+static void adc_sim_expiry(struct k_timer *timer)
+{
+	struct adc_sim_data *data =
+		CONTAINER_OF(timer, struct adc_sim_data, timer);
+	struct adc_stream *stream = data->stream;
+	uint32_t now = k_cycle_get_32();
+	uint16_t *samples;
+	uint32_t due;
+
+	data->elapsed += now - data->last;
+	data->last = now;
+
+	due = data->elapsed * stream->sampling_rate /
+		sys_clock_hw_cycles_per_sec;
+
+	while (data->produced < due) {
+		samples = (uint16_t *)stream->buffer[data->buffer];
+		samples[data->offset++] =
+			pulse_wave((uint64_t)data->produced * USEC_PER_SEC /
+				   stream->sampling_rate);
+		data->produced++;
+
+		if (data->offset == stream->buffer_length / sizeof(uint16_t)) {
+			data->offset = 0;
+			data->buffer ^= 1;
+			stream->callback(data->dev, stream, (uint8_t *)samples);
+		}
+	}
+}
+
+static int adc_sim_stream_start(struct device *dev, struct adc_stream *stream)
+{
+	struct adc_sim_data *data = dev->driver_data;
+	int32_t period;
+
+	if (!stream->sampling_rate || !stream->callback ||
+	    stream->buffer_length < sizeof(uint16_t)) {
+		return -EINVAL;
+	}
+
+	k_sem_take(&data->sem, K_FOREVER);
+
+	data->stream = stream;
+	data->buffer = 0;
+	data->offset = 0;
+	data->produced = 0;
+	data->elapsed = 0;
+	data->last = k_cycle_get_32();
+
+	period = max(FIFO_THRESHOLD * MSEC_PER_SEC / stream->sampling_rate, 1);
+	k_timer_start(&data->timer, period, period);
+
+	return 0;
+}
+
+static void adc_sim_stream_stop(struct device *dev)
+{
+	struct adc_sim_data *data = dev->driver_data;
+
+	if (!data->stream) {
+		return;
+	}
+
+	k_timer_stop(&data->timer);
+	data->stream = NULL;
+
+	k_sem_give(&data->sem);
+}
+
+static const struct adc_driver_api api_funcs = {
+	.enable = adc_sim_enable,
+	.disable = adc_sim_disable,
+	.read = adc_sim_read,
+	.stream_start = adc_sim_stream_start,
+	.stream_stop = adc_sim_stream_stop,
+};
+
+static int adc_sim_init(struct device *dev)
+{
+	struct adc_sim_data *data = dev->driver_data;
+
+	data->dev = dev;
+	k_sem_init(&data->sem, 1, 1);
+	k_timer_init(&data->timer, adc_sim_expiry, NULL);
+
+	return 0;
+}
+
+static struct adc_sim_data adc_sim_data_dev;
+
+DEVICE_AND_API_INIT(adc_sim, CONFIG_ADC_0_NAME, &adc_sim_init,
+		    &adc_sim_data_dev, NULL,
+		    POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		    &api_funcs);
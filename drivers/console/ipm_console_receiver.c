@@ -26,54 +26,83 @@
 #include <console/ipm_console.h>
 #include <misc/__assert.h>
 
+/* Size of a ring buffer item holding a batch of characters */
+#define BATCH_SIZE32 (IPM_CONSOLE_BATCH_SIZE / sizeof(uint32_t))
+#define ITEM_SIZE32 (1 + BATCH_SIZE32)
+
+static void ipm_console_putc(struct device *d, char c, int *pos)
+{
+	const struct ipm_console_receiver_config_info *config_info;
+	char *line_buf;
+	int lb_size;
+
+	config_info = d->config->config_info;
+	line_buf = config_info->line_buf;
+	lb_size = config_info->lb_size;
+
+	line_buf[*pos] = c;
+
+	if (c != '\n' && *pos != lb_size - 2) {
+		++*pos;
+		return;
+	}
+
+	if (*pos != lb_size - 2) {
+		line_buf[*pos] = '\0';
+	} else {
+		line_buf[*pos + 1] = '\0';
+	}
+	if (config_info->flags & IPM_CONSOLE_PRINTK) {
+		printk("%s: '%s'\n", d->config->name, line_buf);
+	}
+	if (config_info->flags & IPM_CONSOLE_STDOUT) {
+		printf("%s: '%s'\n", d->config->name, line_buf);
+	}
+	*pos = 0;
+}
+
 static void ipm_console_thread(void *arg1, void *arg2, void *arg3)
 {
-	uint8_t size32;
+	uint32_t data[BATCH_SIZE32];
+	uint8_t size32, value;
 	uint16_t type;
-	int ret, key;
+	int ret, key, i;
 	struct device *d;
-	const struct ipm_console_receiver_config_info *config_info;
 	struct ipm_console_receiver_runtime_data *driver_data;
 	int pos;
 
 	d = (struct device *)arg1;
 	driver_data = d->driver_data;
-	config_info = d->config->config_info;
 	ARG_UNUSED(arg2);
-	size32 = 0;
 	pos = 0;
 
 	while (1) {
 		k_sem_take(&driver_data->sem, TICKS_UNLIMITED);
 
-		ret = sys_ring_buf_get(&driver_data->rb, &type,
-				       (uint8_t *)&config_info->line_buf[pos],
-				       NULL, &size32);
-		if (ret) {
-			/* Shouldn't ever happen... */
-			printk("ipm console ring buffer error: %d\n", ret);
-			size32 = 0;
-			continue;
-		}
+		/* Print all the characters received so far */
+		while (1) {
+			size32 = BATCH_SIZE32;
+			ret = sys_ring_buf_get(&driver_data->rb, &type, &value,
+					       data, &size32);
+			if (ret == -EAGAIN) {
+				break;
+			}
 
-		if (config_info->line_buf[pos] == '\n' ||
-		    pos == config_info->lb_size - 2) {
-			if (pos != config_info->lb_size - 2) {
-				config_info->line_buf[pos] = '\0';
-			} else {
-				config_info->line_buf[pos + 1] = '\0';
+			if (ret) {
+				/* Shouldn't ever happen... */
+				printk("ipm console ring buffer error: %d\n",
+				       ret);
+				break;
 			}
-			if (config_info->flags & IPM_CONSOLE_PRINTK) {
-				printk("%s: '%s'\n", d->config->name,
-				       config_info->line_buf);
+
+			if (!type) {
+				ipm_console_putc(d, value, &pos);
+				continue;
 			}
-			if (config_info->flags & IPM_CONSOLE_STDOUT) {
-				printf("%s: '%s'\n", d->config->name,
-				       config_info->line_buf);
+
+			for (i = 0; i < type; i++) {
+				ipm_console_putc(d, ((char *)data)[i], &pos);
 			}
-			pos = 0;
-		} else {
-			++pos;
 		}
 
 		/* ISR may have disabled the channel due to full buffer at
@@ -85,7 +114,7 @@ static void ipm_console_thread(void *arg1, void *arg2, void *arg3)
 		 * clearing the channel_disabled flag.
 		 */
 		if (driver_data->channel_disabled &&
-		    sys_ring_buf_space_get(&driver_data->rb)) {
+		    sys_ring_buf_space_get(&driver_data->rb) >= ITEM_SIZE32) {
 			key = irq_lock();
 			ipm_set_enabled(driver_data->ipm_device, 1);
 			driver_data->channel_disabled = 0;
@@ -99,26 +128,42 @@ static void ipm_console_receive_callback(void *context, uint32_t id,
 {
 	struct device *d;
 	struct ipm_console_receiver_runtime_data *driver_data;
-	int ret;
+	uint32_t batch[BATCH_SIZE32];
+	int ret, len, i;
 
-	ARG_UNUSED(data);
 	d = context;
 	driver_data = d->driver_data;
 
-	/* Should always be at least one free buffer slot */
-	ret = sys_ring_buf_put(&driver_data->rb, 0, id, NULL, 0);
+	/* Should always be room for one more message */
+	if (id & IPM_CONSOLE_BATCH) {
+		len = id & 0xFF;
+		if (len > IPM_CONSOLE_BATCH_SIZE) {
+			len = IPM_CONSOLE_BATCH_SIZE;
+		}
+
+		/* The mailbox is released on return, copy its data */
+		for (i = 0; i < (len + 3) / 4; i++) {
+			batch[i] = ((volatile uint32_t *)data)[i];
+		}
+
+		ret = sys_ring_buf_put(&driver_data->rb, len, 0, batch,
+				       (len + 3) / 4);
+	} else {
+		ret = sys_ring_buf_put(&driver_data->rb, 0, id, NULL, 0);
+	}
 	__ASSERT(ret == 0, "Failed to insert data into ring buffer");
 	k_sem_give(&driver_data->sem);
 
-	/* If the buffer is now full, disable future interrupts for this channel
-	 * until the thread has a chance to consume characters.
+	/* If the buffer cannot hold another message, disable future
+	 * interrupts for this channel until the thread has a chance to
+	 * consume characters.
 	 *
 	 * This works without losing data if the sending side tries to send
 	 * more characters because the sending side is making an ipm_send()
 	 * call with the wait flag enabled.  It blocks until the receiver side
 	 * re-enables the channel and consumes the data.
 	 */
-	if (sys_ring_buf_space_get(&driver_data->rb) == 0) {
+	if (sys_ring_buf_space_get(&driver_data->rb) < ITEM_SIZE32) {
 		ipm_set_enabled(driver_data->ipm_device, 0);
 		driver_data->channel_disabled = 1;
 	}
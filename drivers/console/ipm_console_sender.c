@@ -25,17 +25,67 @@
 
 static struct device *ipm_console_device;
 
+/* Characters waiting to be sent in a batch */
+static uint8_t batch[IPM_CONSOLE_BATCH_SIZE];
+static int batch_len;
+static int batch_size;
+
+/*
+ * Sends the batch without waiting for the remote side to take it, which
+ * would keep interrupts locked for a round trip to the other core: the
+ * caller locks interrupts, so that no other batch can overtake this one,
+ * and retries on -EBUSY with interrupts unlocked in between.
+ */
+static int batch_send(void)
+{
+	int ret;
+
+	ret = ipm_send(ipm_console_device, 0, IPM_CONSOLE_BATCH | batch_len,
+		       batch, batch_len);
+	if (ret != -EBUSY) {
+		/* sent, or never sendable */
+		batch_len = 0;
+	}
+
+	return ret;
+}
+
 static int consoleOut(int character)
 {
+	int key;
+
 	if (character == '\r') {
 		return character;
 	}
 
-	/*
-	 * We just stash the character into the id field and don't supply
-	 * any extra data
-	 */
-	ipm_send(ipm_console_device, 1, character, NULL, 0);
+	if (batch_size <= 0) {
+		/*
+		 * We just stash the character into the id field and don't
+		 * supply any extra data
+		 */
+		ipm_send(ipm_console_device, 1, character, NULL, 0);
+		return character;
+	}
+
+	key = irq_lock();
+
+	/* a full batch is left by a sender preempted while retrying */
+	while (batch_len == batch_size && batch_send() == -EBUSY) {
+		irq_unlock(key);
+		key = irq_lock();
+	}
+
+	batch[batch_len++] = character;
+
+	/* characters added while retrying are sent along */
+	if (character == '\n' || batch_len == batch_size) {
+		while (batch_len && batch_send() == -EBUSY) {
+			irq_unlock(key);
+			key = irq_lock();
+		}
+	}
+
+	irq_unlock(key);
 
 	return character;
 }
@@ -56,6 +106,15 @@ int ipm_console_sender_init(struct device *d)
 		return -EINVAL;
 	}
 
+	/* Send characters in batches if the driver can carry them */
+	if (ipm_max_id_val_get(ipm_console_device) >=
+	    (IPM_CONSOLE_BATCH | 0xFF)) {
+		batch_size = ipm_max_data_size_get(ipm_console_device);
+		if (batch_size > IPM_CONSOLE_BATCH_SIZE) {
+			batch_size = IPM_CONSOLE_BATCH_SIZE;
+		}
+	}
+
 	if (config_info->flags & IPM_CONSOLE_STDOUT) {
 		__stdout_hook_install(consoleOut);
 	}
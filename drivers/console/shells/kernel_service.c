@@ -18,6 +18,10 @@
 #include <misc/shell.h>
 #include <init.h>
 
+#if defined(CONFIG_THREAD_STATS) && defined(CONFIG_THREAD_MONITOR)
+#include <kernel_structs.h>
+#endif
+
 #define SHELL_KERNEL "kernel"
 
 static int shell_cmd_version(int argc, char *argv[])
@@ -45,11 +49,39 @@ static int shell_cmd_cycles(int argc, char *argv[])
 	return 0;
 }
 
+#if defined(CONFIG_THREAD_STATS) && defined(CONFIG_THREAD_MONITOR)
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+	return (uint32_t)(cycles * USEC_PER_SEC / sys_clock_hw_cycles_per_sec);
+}
+
+static int shell_cmd_threads(int argc, char *argv[])
+{
+	struct k_thread_stats stats;
+	struct k_thread *thread;
+
+	for (thread = _kernel.threads; thread; thread = thread->next_thread) {
+		k_thread_stats_get(thread, &stats);
+
+		printk("%p prio %d: run %u us, ready %u us, "
+		       "%u preemptions, %u voluntary switches\n",
+		       thread, thread->base.prio,
+		       cycles_to_us(stats.run_time),
+		       cycles_to_us(stats.ready_time),
+		       stats.preemptions, stats.voluntary_switches);
+	}
+
+	return 0;
+}
+#endif
 
 struct shell_cmd kernel_commands[] = {
 	{ "version", shell_cmd_version, "show kernel version" },
 	{ "uptime", shell_cmd_uptime, "show system uptime in milliseconds" },
 	{ "cycles", shell_cmd_cycles, "show system hardware cycles" },
+#if defined(CONFIG_THREAD_STATS) && defined(CONFIG_THREAD_MONITOR)
+	{ "threads", shell_cmd_threads, "show thread execution statistics" },
+#endif
 	{ NULL, NULL }
 };
 
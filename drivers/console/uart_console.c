@@ -20,7 +20,8 @@
  *
  *
  * Serial console driver.
- * Hooks into the printk and fputc (for printf) modules. Poll driven.
+ * Hooks into the printk and fputc (for printf) modules. Poll driven, or
+ * buffered and sent from the UART interrupt with UART_CONSOLE_DEFERRED.
  */
 
 #include <nanokernel.h>
@@ -87,6 +88,119 @@ static int console_in(void)
 }
 #endif
 
+#ifdef CONFIG_UART_CONSOLE_DEFERRED
+
+#define TX_BUF_SIZE CONFIG_UART_CONSOLE_DEFERRED_BUF_SIZE
+#define TX_BUF_MASK (TX_BUF_SIZE - 1)
+
+#if TX_BUF_SIZE & TX_BUF_MASK
+#error "CONFIG_UART_CONSOLE_DEFERRED_BUF_SIZE must be a power of two"
+#endif
+
+/* Characters are added at tx_head and sent from tx_tail, the indexes
+ * wrapping around at 2^32.
+ */
+static uint8_t tx_buf[TX_BUF_SIZE];
+static uint32_t tx_head;
+static uint32_t tx_tail;
+static uint32_t tx_dropped;
+/* TX interrupt enabled, the interrupt will send any character added */
+static int tx_busy;
+
+static void console_tx_put(const uint8_t *data, uint32_t len)
+{
+	unsigned int key;
+	int idle;
+
+	key = irq_lock();
+
+	if (tx_head - tx_tail + len > TX_BUF_SIZE) {
+		tx_dropped += len;
+		irq_unlock(key);
+		return;
+	}
+
+	while (len--) {
+		tx_buf[tx_head++ & TX_BUF_MASK] = *data++;
+	}
+
+	idle = !tx_busy;
+	tx_busy = 1;
+
+	irq_unlock(key);
+
+	if (idle) {
+		uart_irq_tx_enable(uart_console_dev);
+	}
+}
+
+/* Called from the UART interrupt when the TX FIFO has room */
+static void console_tx_isr(void)
+{
+	unsigned int key;
+	uint32_t len;
+	int sent;
+
+	key = irq_lock();
+
+	while (tx_tail != tx_head) {
+		len = tx_head - tx_tail;
+		if (len > TX_BUF_SIZE - (tx_tail & TX_BUF_MASK)) {
+			len = TX_BUF_SIZE - (tx_tail & TX_BUF_MASK);
+		}
+
+		sent = uart_fifo_fill(uart_console_dev,
+				      &tx_buf[tx_tail & TX_BUF_MASK], len);
+		if (sent <= 0) {
+			break;
+		}
+
+		tx_tail += sent;
+	}
+
+	if (tx_tail == tx_head) {
+		uart_irq_tx_disable(uart_console_dev);
+		tx_busy = 0;
+	}
+
+	irq_unlock(key);
+}
+
+void uart_console_flush(void)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	while (tx_tail != tx_head) {
+		uart_poll_out(uart_console_dev,
+			      tx_buf[tx_tail++ & TX_BUF_MASK]);
+	}
+
+	irq_unlock(key);
+}
+
+uint32_t uart_console_dropped(void)
+{
+	return tx_dropped;
+}
+
+#if !defined(CONFIG_CONSOLE_HANDLER)
+static void console_isr(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	while (uart_irq_update(uart_console_dev) &&
+	       uart_irq_is_pending(uart_console_dev)) {
+		if (uart_irq_tx_ready(uart_console_dev)) {
+			console_tx_isr();
+		}
+	}
+}
+#endif
+
+#endif /* CONFIG_UART_CONSOLE_DEFERRED */
+
 #if defined(CONFIG_PRINTK) || defined(CONFIG_STDOUT_CONSOLE)
 /**
  *
@@ -111,10 +225,22 @@ static int console_out(int c)
 
 #endif /* CONFIG_UART_CONSOLE_DEBUG_SERVER_HOOKS */
 
+#ifdef CONFIG_UART_CONSOLE_DEFERRED
+	if ('\n' == c) {
+		static const uint8_t crlf[] = { '\r', '\n' };
+
+		console_tx_put(crlf, sizeof(crlf));
+	} else {
+		uint8_t byte = c;
+
+		console_tx_put(&byte, 1);
+	}
+#else
 	if ('\n' == c) {
 		uart_poll_out(uart_console_dev, '\r');
 	}
 	uart_poll_out(uart_console_dev, c);
+#endif
 
 	return c;
 }
@@ -353,6 +479,12 @@ void uart_console_isr(struct device *unused)
 		uint8_t byte;
 		int rx;
 
+#ifdef CONFIG_UART_CONSOLE_DEFERRED
+		if (uart_irq_tx_ready(uart_console_dev)) {
+			console_tx_isr();
+		}
+#endif
+
 		if (!uart_irq_rx_ready(uart_console_dev)) {
 			continue;
 		}
@@ -444,7 +576,10 @@ static void console_input_init(void)
 	uint8_t c;
 
 	uart_irq_rx_disable(uart_console_dev);
+#ifndef CONFIG_UART_CONSOLE_DEFERRED
+	/* Deferred output keeps the TX interrupt until it is all sent */
 	uart_irq_tx_disable(uart_console_dev);
+#endif
 
 	uart_irq_callback_set(uart_console_dev, uart_console_isr);
 
@@ -513,6 +648,11 @@ static int uart_console_init(struct device *arg)
 	sys_thread_busy_wait(1000000);
 #endif
 
+#if defined(CONFIG_UART_CONSOLE_DEFERRED) && !defined(CONFIG_CONSOLE_HANDLER)
+	uart_irq_tx_disable(uart_console_dev);
+	uart_irq_callback_set(uart_console_dev, console_isr);
+#endif
+
 	uart_console_hook_install();
 
 	return 0;
@@ -20,25 +20,92 @@
 #include <spi.h>
 #include <init.h>
 #include <string.h>
+#include <misc/util.h>
 #include "spi_flash_w25qxxdv_defs.h"
 #include "spi_flash_w25qxxdv.h"
 
-static inline int spi_flash_wb_id(struct device *dev)
+/*
+ * Send a command header followed by len bytes, sent from tx or received
+ * into rx. Data are streamed directly from and into the caller's buffer
+ * when the SPI driver supports scatter-gather transfers, and go through
+ * the bounce buffer, up to CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN bytes,
+ * otherwise.
+ */
+static int spi_flash_wb_xfer(struct device *dev, uint8_t *hdr,
+			     uint32_t hdr_len, const void *tx, void *rx,
+			     uint32_t len)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
-	uint8_t buf[W25QXXDV_LEN_CMD_AND_ID];
-	uint32_t temp_data;
+	const struct spi_buf tx_bufs[] = {
+		{ .buf = hdr, .len = hdr_len },
+		{ .buf = (void *)tx, .len = len },
+	};
+	const struct spi_buf rx_bufs[] = {
+		{ .buf = NULL, .len = hdr_len },
+		{ .buf = rx, .len = len },
+	};
+	uint8_t *buf = driver_data->buf;
+	int ret;
+
+	if (driver_data->sg) {
+		ret = spi_transceive_sg(driver_data->spi, tx_bufs, tx ? 2 : 1,
+					rx_bufs, rx ? 2 : 0);
+		if (ret != -ENOTSUP) {
+			return ret ? -EIO : 0;
+		}
+
+		driver_data->sg = false;
+	}
+
+	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN) {
+		return -EINVAL;
+	}
+
+	memcpy(buf, hdr, hdr_len);
+
+	if (tx) {
+		memcpy(buf + hdr_len, tx, len);
+	} else {
+		memset(buf + hdr_len, 0, len);
+	}
+
+	if (spi_transceive(driver_data->spi, buf, hdr_len + len,
+			   rx ? buf : NULL, rx ? hdr_len + len : 0) != 0) {
+		return -EIO;
+	}
+
+	if (rx) {
+		memcpy(rx, buf + hdr_len, len);
+	}
 
-	buf[0] = W25QXXDV_CMD_RDID;
+	return 0;
+}
+
+/* Largest part of len transferred by spi_flash_wb_xfer() */
+static inline size_t spi_flash_wb_chunk(struct device *dev, size_t len)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
 
-	if (spi_transceive(driver_data->spi, buf, W25QXXDV_LEN_CMD_AND_ID,
-			   buf, W25QXXDV_LEN_CMD_AND_ID) != 0) {
+	if (driver_data->sg) {
+		return len;
+	}
+
+	return min(len, CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN);
+}
+
+static inline int spi_flash_wb_id(struct device *dev)
+{
+	uint8_t cmd = W25QXXDV_CMD_RDID;
+	uint8_t buf[W25QXXDV_LEN_CMD_AND_ID - 1];
+	uint32_t temp_data;
+
+	if (spi_flash_wb_xfer(dev, &cmd, 1, NULL, buf, sizeof(buf)) != 0) {
 		return -EIO;
 	}
 
-	temp_data = ((uint32_t) buf[1]) << 16;
-	temp_data |= ((uint32_t) buf[2]) << 8;
-	temp_data |= (uint32_t) buf[3];
+	temp_data = ((uint32_t) buf[0]) << 16;
+	temp_data |= ((uint32_t) buf[1]) << 8;
+	temp_data |= (uint32_t) buf[2];
 
 	if (temp_data != W25QXXDV_RDID_VALUE) {
 		return -ENODEV;
@@ -83,16 +150,31 @@ static int spi_flash_wb_reg_read(struct device *dev, uint8_t *data)
 	return 0;
 }
 
-static inline void wait_for_flash_idle(struct device *dev)
+/*
+ * Poll the status register until the flash is idle, at the pace of the
+ * last program or erase command: sleeping between polls during erases,
+ * which take tens of milliseconds, instead of keeping the SPI bus busy.
+ */
+static int wait_for_flash_idle(struct device *dev)
 {
+	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t buf[2];
 
-	buf[0] = W25QXXDV_CMD_RDSR;
-	spi_flash_wb_reg_read(dev, buf);
-
-	while (buf[1] & W25QXXDV_WIP_BIT) {
+	for (;;) {
 		buf[0] = W25QXXDV_CMD_RDSR;
-		spi_flash_wb_reg_read(dev, buf);
+		if (spi_flash_wb_reg_read(dev, buf) != 0) {
+			return -EIO;
+		}
+
+		if (!(buf[1] & W25QXXDV_WIP_BIT)) {
+			return 0;
+		}
+
+		if (driver_data->poll_us >= USEC_PER_MSEC) {
+			k_sleep(driver_data->poll_us / USEC_PER_MSEC);
+		} else {
+			k_busy_wait(driver_data->poll_us);
+		}
 	}
 }
 
@@ -101,7 +183,9 @@ static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t buf;
 
-	wait_for_flash_idle(dev);
+	if (wait_for_flash_idle(dev) != 0) {
+		return -EIO;
+	}
 
 	if (spi_transceive(driver_data->spi, data, 1,
 			   &buf /*dummy */, 1) != 0) {
@@ -115,9 +199,13 @@ static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 			     size_t len)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
-	uint8_t *buf = driver_data->buf;
+	uint8_t cmd[W25QXXDV_LEN_CMD_ADDRESS + W25QXXDV_LEN_DUMMY];
+	uint8_t *buf = data;
+	size_t chunk;
+	int ret;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if (offset < 0 ||
+	    offset + len > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) {
 		return -ENODEV;
 	}
 
@@ -128,35 +216,42 @@ static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
+	ret = wait_for_flash_idle(dev);
 
-	buf[0] = W25QXXDV_CMD_READ;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
+	/* A read goes on up to the end of the flash */
+	while (len && !ret) {
+		chunk = spi_flash_wb_chunk(dev, len);
 
-	memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0, len);
+		cmd[0] = W25QXXDV_READ_CMD;
+		cmd[1] = (uint8_t) (offset >> 16);
+		cmd[2] = (uint8_t) (offset >> 8);
+		cmd[3] = (uint8_t) offset;
+		cmd[4] = 0; /* dummy byte of Fast Read */
 
-	if (spi_transceive(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS,
-			   buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
-	}
+		ret = spi_flash_wb_xfer(dev, cmd, W25QXXDV_LEN_READ_CMD,
+					NULL, buf, chunk);
 
-	memcpy(data, buf + W25QXXDV_LEN_CMD_ADDRESS, len);
+		buf += chunk;
+		offset += chunk;
+		len -= chunk;
+	}
 
 	k_sem_give(&driver_data->sem);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write(struct device *dev, off_t offset,
 			      const void *data, size_t len)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
-	uint8_t *buf = driver_data->buf;
+	uint8_t cmd[W25QXXDV_LEN_CMD_ADDRESS];
+	const uint8_t *buf = data;
+	size_t chunk;
+	int ret;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if (offset < 0 ||
+	    offset + len > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) {
 		return -ENOTSUP;
 	}
 
@@ -167,37 +262,48 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
-
-	buf[0] = W25QXXDV_CMD_RDSR;
-	spi_flash_wb_reg_read(dev, buf);
-
-	if (!(buf[1] & W25QXXDV_WEL_BIT)) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+	ret = wait_for_flash_idle(dev);
+	if (!ret) {
+		cmd[0] = W25QXXDV_CMD_RDSR;
+		if (spi_flash_wb_reg_read(dev, cmd) != 0 ||
+		    !(cmd[1] & W25QXXDV_WEL_BIT)) {
+			ret = -EIO;
+		}
 	}
 
-	wait_for_flash_idle(dev);
+	while (len && !ret) {
+		/* A page program wraps around at the end of the page */
+		chunk = W25QXXDV_PAGE_SIZE - (offset & (W25QXXDV_PAGE_SIZE - 1));
+		chunk = spi_flash_wb_chunk(dev, min(len, chunk));
+
+		/* Write protection was disabled for the first page, it is
+		 * turned on again at the completion of each page program.
+		 */
+		if (buf != data) {
+			cmd[0] = W25QXXDV_CMD_WREN;
+			ret = spi_flash_wb_reg_write(dev, cmd);
+			if (ret) {
+				break;
+			}
+		}
 
-	buf[0] = W25QXXDV_CMD_PP;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
+		cmd[0] = W25QXXDV_CMD_PP;
+		cmd[1] = (uint8_t) (offset >> 16);
+		cmd[2] = (uint8_t) (offset >> 8);
+		cmd[3] = (uint8_t) offset;
 
-	memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, data, len);
+		ret = spi_flash_wb_xfer(dev, cmd, W25QXXDV_LEN_CMD_ADDRESS,
+					buf, NULL, chunk);
+		driver_data->poll_us = W25QXXDV_PP_POLL_US;
 
-	/* Assume write protection has been disabled. Note that w25qxxdv
-	 * flash automatically turns on write protection at the completion
-	 * of each write or erase transaction.
-	 */
-	if (spi_write(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		buf += chunk;
+		offset += chunk;
+		len -= chunk;
 	}
 
 	k_sem_give(&driver_data->sem);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write_protection_set(struct device *dev, bool enable)
@@ -277,6 +383,8 @@ static inline int spi_flash_wb_erase_internal(struct device *dev,
 	buf[2] = (uint8_t) (offset >> 8);
 	buf[3] = (uint8_t) offset;
 
+	driver_data->poll_us = W25QXXDV_ERASE_POLL_US;
+
 	/* Assume write protection has been disabled. Note that w25qxxdv
 	 * flash automatically turns on write protection at the completion
 	 * of each write or erase transaction.
@@ -306,9 +414,8 @@ static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 	}
 
 	buf[0] = W25QXXDV_CMD_RDSR;
-	spi_flash_wb_reg_read(dev, buf);
-
-	if (!(buf[1] & W25QXXDV_WEL_BIT)) {
+	if (spi_flash_wb_reg_read(dev, buf) != 0 ||
+	    !(buf[1] & W25QXXDV_WEL_BIT)) {
 		k_sem_give(&driver_data->sem);
 		return -EIO;
 	}
@@ -368,6 +475,8 @@ static int spi_flash_init(struct device *dev)
 	}
 
 	data->spi = spi_dev;
+	data->sg = true;
+	data->poll_us = W25QXXDV_PP_POLL_US;
 
 	k_sem_init(&data->sem, 0, UINT_MAX);
 	k_sem_give(&data->sem);
@@ -26,9 +26,13 @@
 
 struct spi_flash_data {
 	struct device *spi;
+	/* bounce buffer, used without scatter-gather SPI transfers */
 	uint8_t buf[CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN +
-		    W25QXXDV_LEN_CMD_ADDRESS];
+		    W25QXXDV_LEN_READ_CMD];
 	struct k_sem sem;
+	/* status polling interval of the last program or erase command */
+	uint32_t poll_us;
+	bool sg;
 };
 
 
@@ -50,6 +50,7 @@
 #define W25QXXDV_ADDRESS_WIDTH        (3)
 #define W25QXXDV_LEN_CMD_ADDRESS      (4)
 #define W25QXXDV_LEN_CMD_AND_ID       (4)
+#define W25QXXDV_LEN_DUMMY            (1)
 
 /* relevant status register bits */
 #define W25QXXDV_WIP_BIT         (0x1 << 0)
@@ -70,6 +71,9 @@
 
 #define W25QXXDV_SECTOR_MASK     (0xFFF)
 
+/* page program size */
+#define W25QXXDV_PAGE_SIZE       (0x100)
+
 /* ID comands */
 #define W25QXXDV_CMD_RDID        0x9F
 #define W25QXXDV_CMD_RES         0xAB
@@ -93,6 +97,15 @@
 #define W25QXXDV_CMD_QREAD       0x6B
 #define W25QXXDV_CMD_RDSFDP      0x5A
 
+/* Fast Read allows the highest clock frequency, with a dummy byte */
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_FAST_READ
+#define W25QXXDV_READ_CMD        W25QXXDV_CMD_FASTREAD
+#define W25QXXDV_LEN_READ_CMD    (W25QXXDV_LEN_CMD_ADDRESS + W25QXXDV_LEN_DUMMY)
+#else
+#define W25QXXDV_READ_CMD        W25QXXDV_CMD_READ
+#define W25QXXDV_LEN_READ_CMD    W25QXXDV_LEN_CMD_ADDRESS
+#endif
+
 /* Program comands */
 #define W25QXXDV_CMD_WREN        0x06
 #define W25QXXDV_CMD_WRDI        0x04
@@ -115,6 +128,12 @@
 #define W25QXXDV_CMD_RST         0x99
 #define W25QXXDV_CMD_RSTQIO      0xF5
 
+/* Status polling intervals, in microseconds: a page program takes 0.7 ms,
+ * a sector erase 45 ms (typical)
+ */
+#define W25QXXDV_PP_POLL_US      (100)
+#define W25QXXDV_ERASE_POLL_US   (10000)
+
 /* Security comands */
 #define W25QXXDV_CMD_ERSR        0x44
 #define W25QXXDV_CMD_PRSR        0x42
@@ -176,6 +176,115 @@ static int _i2c_dw_data_send(struct device *dev)
 	return 0;
 }
 
+static void _i2c_dw_msg_start(struct device *dev)
+{
+	struct i2c_dw_dev_config * const dw = dev->driver_data;
+	uint8_t pflags = dw->xfr_flags;
+
+	volatile struct i2c_dw_registers * const regs =
+		(struct i2c_dw_registers *)dw->base_address;
+
+	dw->xfr_buf = dw->cur_msg->buf;
+	dw->xfr_len = dw->cur_msg->len;
+	dw->xfr_flags = dw->cur_msg->flags;
+	dw->rx_pending = 0;
+
+	/* Need to RESTART if changing transfer direction */
+	if ((pflags & I2C_MSG_RW_MASK)
+	    != (dw->xfr_flags & I2C_MSG_RW_MASK)) {
+		dw->xfr_flags |= I2C_MSG_RESTART;
+	}
+
+	/* Send STOP if this is the last message */
+	if (dw->msg_left == 1) {
+		dw->xfr_flags |= I2C_MSG_STOP;
+	}
+
+	dw->state &= ~(I2C_DW_CMD_SEND | I2C_DW_CMD_RECV);
+
+	if ((dw->xfr_flags & I2C_MSG_RW_MASK) == I2C_MSG_WRITE) {
+		dw->state |= I2C_DW_CMD_SEND;
+		dw->request_bytes = 0;
+	} else {
+		dw->state |= I2C_DW_CMD_RECV;
+		dw->request_bytes = dw->xfr_len;
+	}
+
+	/* Enable interrupts to trigger ISR */
+	if (regs->ic_con.bits.master_mode) {
+		/* Enable necessary interrupts */
+		regs->ic_intr_mask.raw = (DW_ENABLE_TX_INT_I2C_MASTER |
+					  DW_ENABLE_RX_INT_I2C_MASTER);
+	} else {
+		/* Enable necessary interrupts */
+		regs->ic_intr_mask.raw = DW_ENABLE_TX_INT_I2C_SLAVE;
+	}
+}
+
+static int _i2c_dw_setup(struct device *dev, uint16_t slave_address);
+
+/* Called with interrupts locked */
+static int _i2c_dw_transaction_start(struct device *dev)
+{
+	struct i2c_dw_dev_config * const dw = dev->driver_data;
+	struct i2c_transaction *trans = dw->head;
+	int ret;
+
+	volatile struct i2c_dw_registers * const regs =
+		(struct i2c_dw_registers *)dw->base_address;
+
+	ret = _i2c_dw_setup(dev, trans->addr);
+	if (ret) {
+		return ret;
+	}
+
+	/* Enable controller */
+	regs->ic_enable.bits.enable = 1;
+
+	dw->state = I2C_DW_BUSY;
+	dw->cur_msg = trans->msgs;
+	dw->msg_left = trans->num_msgs;
+
+	_i2c_dw_msg_start(dev);
+
+	return 0;
+}
+
+static void _i2c_dw_transaction_done(struct device *dev, int status)
+{
+	struct i2c_dw_dev_config * const dw = dev->driver_data;
+	struct i2c_transaction *trans;
+	unsigned int key;
+	int ret;
+
+	do {
+		ret = 0;
+
+		/* Start the next transaction before notifying this one, the
+		 * callback being free to queue more.
+		 */
+		key = irq_lock();
+
+		trans = dw->head;
+		dw->head = trans->next;
+		if (dw->head) {
+			ret = _i2c_dw_transaction_start(dev);
+		} else {
+			dw->tail = NULL;
+			dw->state = I2C_DW_STATE_READY;
+			device_busy_clear(dev);
+		}
+
+		irq_unlock(key);
+
+		trans->next = NULL;
+		trans->callback(dev, trans, status);
+
+		/* The next transaction could not start: fail it as well */
+		status = ret;
+	} while (ret);
+}
+
 static inline void _i2c_dw_transfer_complete(struct device *dev)
 {
 	struct i2c_dw_dev_config * const dw = dev->driver_data;
@@ -187,7 +296,24 @@ static inline void _i2c_dw_transfer_complete(struct device *dev)
 	regs->ic_intr_mask.raw = DW_DISABLE_ALL_I2C_INT;
 	value = regs->ic_clr_intr;
 
-	device_sync_call_complete(&dw->sync);
+	if (!dw->head) {
+		return;
+	}
+
+	/* Something wrong if there is something left to do */
+	if ((dw->state & I2C_DW_CMD_ERROR) || (dw->xfr_len > 0)) {
+		_i2c_dw_transaction_done(dev, -EIO);
+		return;
+	}
+
+	if (--dw->msg_left) {
+		/* Go on with the next message right from the ISR */
+		dw->cur_msg++;
+		_i2c_dw_msg_start(dev);
+		return;
+	}
+
+	_i2c_dw_transaction_done(dev, 0);
 }
 
 static void i2c_dw_isr(void *arg)
@@ -411,119 +537,76 @@ static int _i2c_dw_setup(struct device *dev, uint16_t slave_address)
 	return 0;
 }
 
-static int i2c_dw_transfer(struct device *dev,
-			   struct i2c_msg *msgs, uint8_t num_msgs,
-			   uint16_t slave_address)
+static int i2c_dw_transfer_async(struct device *dev,
+				 struct i2c_transaction *trans)
 {
 	struct i2c_dw_dev_config * const dw = dev->driver_data;
-	struct i2c_msg *cur_msg = msgs;
-	uint8_t msg_left = num_msgs;
-	uint8_t pflags;
-	int ret;
+	struct i2c_transaction *last;
+	unsigned int key;
+	int ret = 0;
 
 	volatile struct i2c_dw_registers * const regs =
 		(struct i2c_dw_registers *)dw->base_address;
 
 	/* Why bother processing no messages */
-	if (!msgs || !num_msgs) {
-		return -ENOTSUP;
-	}
+	for (last = trans; ; last = last->next) {
+		if (!last->msgs || !last->num_msgs) {
+			return -ENOTSUP;
+		}
 
-	/* First step, check if there is current activity */
-	if ((regs->ic_status.bits.activity) || (dw->state & I2C_DW_BUSY)) {
-		return -EIO;
+		if (!last->next) {
+			break;
+		}
 	}
 
-	dw->state |= I2C_DW_BUSY;
+	key = irq_lock();
 
-	ret = _i2c_dw_setup(dev, slave_address);
-	if (ret) {
-		dw->state = I2C_DW_STATE_READY;
-		return ret;
+	if (dw->head) {
+		dw->tail->next = trans;
+		dw->tail = last;
+		irq_unlock(key);
+		return 0;
 	}
 
-	/* Enable controller */
-	regs->ic_enable.bits.enable = 1;
+	/* First step, check if there is current activity */
+	if (regs->ic_status.bits.activity) {
+		irq_unlock(key);
+		return -EIO;
+	}
+
+	dw->head = trans;
+	dw->tail = last;
 
 	/*
-	 * While waiting at device_sync_call_wait(), kernel can switch to idle
-	 * task which in turn can call _sys_soc_suspend() hook of Power
-	 * Management App (PMA).
+	 * Until the queue is empty, the kernel can switch to the idle task
+	 * which in turn can call _sys_soc_suspend() hook of Power Management
+	 * App (PMA).
 	 * device_busy_set() call here, would indicate to PMA that it should not
 	 * execute PM policies that would turn off this ip block, causing an
 	 * ongoing hw transaction to be left in an inconsistent state.
-	 * Note : This is just a sample to show a possible use of the API, it is
-	 * upto the driver expert to see, if he actually needs it here, or
-	 * somewhere else, or not needed as the driver's suspend()/resume()
-	 * can handle everything
 	 */
 	device_busy_set(dev);
 
-		/* Process all the messages */
-	while (msg_left > 0) {
-		pflags = dw->xfr_flags;
-
-		dw->xfr_buf = cur_msg->buf;
-		dw->xfr_len = cur_msg->len;
-		dw->xfr_flags = cur_msg->flags;
-		dw->rx_pending = 0;
-
-		/* Need to RESTART if changing transfer direction */
-		if ((pflags & I2C_MSG_RW_MASK)
-		    != (dw->xfr_flags & I2C_MSG_RW_MASK)) {
-			dw->xfr_flags |= I2C_MSG_RESTART;
-		}
-
-		/* Send STOP if this is the last message */
-		if (msg_left == 1) {
-			dw->xfr_flags |= I2C_MSG_STOP;
-		}
-
-		dw->state &= ~(I2C_DW_CMD_SEND | I2C_DW_CMD_RECV);
-
-		if ((dw->xfr_flags & I2C_MSG_RW_MASK) == I2C_MSG_WRITE) {
-			dw->state |= I2C_DW_CMD_SEND;
-			dw->request_bytes = 0;
-		} else {
-			dw->state |= I2C_DW_CMD_RECV;
-			dw->request_bytes = dw->xfr_len;
-		}
-
-		/* Enable interrupts to trigger ISR */
-		if (regs->ic_con.bits.master_mode) {
-			/* Enable necessary interrupts */
-			regs->ic_intr_mask.raw = (DW_ENABLE_TX_INT_I2C_MASTER |
-						  DW_ENABLE_RX_INT_I2C_MASTER);
-		} else {
-			/* Enable necessary interrupts */
-			regs->ic_intr_mask.raw = DW_ENABLE_TX_INT_I2C_SLAVE;
-		}
-
-		/* Wait for transfer to be done */
-		device_sync_call_wait(&dw->sync);
-
-		if (dw->state & I2C_DW_CMD_ERROR) {
-			ret = -EIO;
-			break;
-		}
-
-		/* Something wrong if there is something left to do */
-		if (dw->xfr_len > 0) {
-			ret = -EIO;
-			break;
-		}
-
-		cur_msg++;
-		msg_left--;
+	ret = _i2c_dw_transaction_start(dev);
+	if (ret) {
+		dw->head = NULL;
+		dw->tail = NULL;
+		dw->state = I2C_DW_STATE_READY;
+		device_busy_clear(dev);
 	}
 
-	device_busy_clear(dev);
-
-	dw->state = I2C_DW_STATE_READY;
+	irq_unlock(key);
 
 	return ret;
 }
 
+static int i2c_dw_transfer(struct device *dev,
+			   struct i2c_msg *msgs, uint8_t num_msgs,
+			   uint16_t slave_address)
+{
+	return _i2c_transfer_sync(dev, msgs, num_msgs, slave_address);
+}
+
 static int i2c_dw_runtime_configure(struct device *dev, uint32_t config)
 {
 	struct i2c_dw_dev_config * const dw = dev->driver_data;
@@ -632,6 +715,7 @@ static int i2c_dw_runtime_configure(struct device *dev, uint32_t config)
 static const struct i2c_driver_api funcs = {
 	.configure = i2c_dw_runtime_configure,
 	.transfer = i2c_dw_transfer,
+	.transfer_async = i2c_dw_transfer_async,
 };
 
 
@@ -672,8 +756,6 @@ static int i2c_dw_initialize(struct device *port)
 		return -EPERM;
 	}
 
-	device_sync_call_init(&dev->sync);
-
 	regs = (struct i2c_dw_registers *) dev->base_address;
 
 	/* verify that we have a valid DesignWare register first */
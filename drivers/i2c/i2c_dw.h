@@ -107,9 +107,13 @@ struct i2c_dw_rom_config {
 
 struct i2c_dw_dev_config {
 	uint32_t base_address;
-	device_sync_call_t	sync;
 	union dev_config	app_config;
 
+	/* Queue of transactions, the head one being in progress */
+	struct i2c_transaction	*head;
+	struct i2c_transaction	*tail;
+	struct i2c_msg		*cur_msg;
+	uint8_t			msg_left;
 
 	uint8_t			*xfr_buf;
 	uint32_t		xfr_len;
@@ -15,6 +15,7 @@
  */
 
 #include <errno.h>
+#include <string.h>
 #include <device.h>
 #include <i2c.h>
 #include <board.h>
@@ -37,9 +38,14 @@ struct i2c_qmsi_ss_config_info {
 };
 
 struct i2c_qmsi_ss_driver_data {
-	device_sync_call_t sync;
-	int transfer_status;
 	struct k_sem sem;
+	/* Queue of transactions, the head one being in progress */
+	struct i2c_transaction *head;
+	struct i2c_transaction *tail;
+	qm_ss_i2c_transfer_t xfer;
+	int transfer_status;
+	uint8_t msg;
+	bool msg_done;
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	uint32_t device_power_state;
 #ifdef CONFIG_SYS_POWER_DEEP_SLEEP
@@ -121,9 +127,12 @@ static int ss_i2c_device_ctrl(struct device *dev, uint32_t ctrl_command,
 
 static int i2c_qmsi_ss_init(struct device *dev);
 
+static void i2c_qmsi_ss_msg_done(struct device *dev);
+
 static void i2c_qmsi_ss_isr(void *arg)
 {
 	struct device *dev = arg;
+	struct i2c_qmsi_ss_driver_data *driver_data = GET_DRIVER_DATA(dev);
 	qm_ss_i2c_t instance = GET_CONTROLLER_INSTANCE(dev);
 
 	if (instance == QM_SS_I2C_0) {
@@ -131,6 +140,15 @@ static void i2c_qmsi_ss_isr(void *arg)
 	} else {
 		qm_ss_i2c_1_isr(NULL);
 	}
+
+	/* The next message is started here rather than from the QMSI
+	 * callback, the QMSI handler still using the state of the finished
+	 * transfer after calling it.
+	 */
+	if (driver_data->msg_done) {
+		driver_data->msg_done = false;
+		i2c_qmsi_ss_msg_done(dev);
+	}
 }
 
 #ifdef CONFIG_I2C_0
@@ -302,60 +320,158 @@ static void transfer_complete(void *data, int rc, qm_ss_i2c_status_t status,
 
 	driver_data = GET_DRIVER_DATA(dev);
 	driver_data->transfer_status = rc;
-	device_sync_call_complete(&driver_data->sync);
+	driver_data->msg_done = true;
 }
 
-static int i2c_qmsi_ss_transfer(struct device *dev, struct i2c_msg *msgs,
-			     uint8_t num_msgs, uint16_t addr)
+/* Called with interrupts locked */
+static int i2c_qmsi_ss_msg_start(struct device *dev)
 {
 	struct i2c_qmsi_ss_driver_data *driver_data = GET_DRIVER_DATA(dev);
 	qm_ss_i2c_t instance = GET_CONTROLLER_INSTANCE(dev);
-	int rc;
+	struct i2c_transaction *trans = driver_data->head;
+	struct i2c_msg *msg = &trans->msgs[driver_data->msg];
+	qm_ss_i2c_transfer_t *xfer = &driver_data->xfer;
+	uint8_t op = msg->flags & I2C_MSG_RW_MASK;
 
-	if  (msgs == NULL || num_msgs == 0) {
-		return -ENOTSUP;
+	memset(xfer, 0, sizeof(*xfer));
+
+	if (op == I2C_MSG_WRITE) {
+		xfer->tx = msg->buf;
+		xfer->tx_len = msg->len;
+	} else {
+		xfer->rx = msg->buf;
+		xfer->rx_len = msg->len;
 	}
 
-	for (int i = 0; i < num_msgs; i++) {
-		uint8_t *buf = msgs[i].buf;
-		uint32_t len = msgs[i].len;
-		uint8_t op =  msgs[i].flags & I2C_MSG_RW_MASK;
-		bool stop = (msgs[i].flags & I2C_MSG_STOP) == I2C_MSG_STOP;
-		qm_ss_i2c_transfer_t xfer = { 0 };
+	xfer->callback = transfer_complete;
+	xfer->callback_data = dev;
 
-		if (op == I2C_MSG_WRITE) {
-			xfer.tx = buf;
-			xfer.tx_len = len;
+	/* The controller only issues a repeated start when the direction
+	 * changes: a message restarting in the same direction is preceded
+	 * by a STOP and a new START instead.
+	 */
+	if (driver_data->msg == trans->num_msgs - 1) {
+		xfer->stop = true;
+	} else {
+		xfer->stop = (msg->flags & I2C_MSG_STOP) ||
+			((msg[1].flags & I2C_MSG_RESTART) &&
+			 (msg[1].flags & I2C_MSG_RW_MASK) == op);
+	}
+
+	if (qm_ss_i2c_master_irq_transfer(instance, xfer, trans->addr)) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static void i2c_qmsi_ss_transaction_done(struct device *dev, int status)
+{
+	struct i2c_qmsi_ss_driver_data *driver_data = GET_DRIVER_DATA(dev);
+	struct i2c_transaction *trans;
+	unsigned int key;
+	int ret;
+
+	do {
+		ret = 0;
+
+		/* Start the next transaction before notifying this one, the
+		 * callback being free to queue more.
+		 */
+		key = irq_lock();
+
+		trans = driver_data->head;
+		driver_data->head = trans->next;
+		if (driver_data->head) {
+			driver_data->msg = 0;
+			ret = i2c_qmsi_ss_msg_start(dev);
 		} else {
-			xfer.rx = buf;
-			xfer.rx_len = len;
+			driver_data->tail = NULL;
 		}
 
-		xfer.callback = transfer_complete;
-		xfer.callback_data = dev;
-		xfer.stop = stop;
+		irq_unlock(key);
 
-		k_sem_take(&driver_data->sem, K_FOREVER);
-		rc = qm_ss_i2c_master_irq_transfer(instance, &xfer, addr);
-		k_sem_give(&driver_data->sem);
-		if (rc != 0) {
-			return -EIO;
+		trans->next = NULL;
+		trans->callback(dev, trans, status);
+
+		/* The next transaction could not start: fail it as well */
+		status = ret;
+	} while (ret);
+}
+
+static void i2c_qmsi_ss_msg_done(struct device *dev)
+{
+	struct i2c_qmsi_ss_driver_data *driver_data = GET_DRIVER_DATA(dev);
+	int status = driver_data->transfer_status ? -EIO : 0;
+	unsigned int key;
+
+	if (!driver_data->head) {
+		return;
+	}
+
+	if (!status && ++driver_data->msg < driver_data->head->num_msgs) {
+		/* Go on with the next message right from the ISR */
+		key = irq_lock();
+		status = i2c_qmsi_ss_msg_start(dev);
+		irq_unlock(key);
+
+		if (!status) {
+			return;
 		}
+	}
 
-		/* Block current thread until the I2C transfer completes. */
-		device_sync_call_wait(&driver_data->sync);
+	i2c_qmsi_ss_transaction_done(dev, status);
+}
+
+static int i2c_qmsi_ss_transfer_async(struct device *dev,
+				      struct i2c_transaction *trans)
+{
+	struct i2c_qmsi_ss_driver_data *driver_data = GET_DRIVER_DATA(dev);
+	struct i2c_transaction *last;
+	unsigned int key;
+	int ret = 0;
 
-		if (driver_data->transfer_status != 0) {
-			return -EIO;
+	for (last = trans; ; last = last->next) {
+		if (last->msgs == NULL || last->num_msgs == 0) {
+			return -ENOTSUP;
+		}
+
+		if (!last->next) {
+			break;
 		}
 	}
 
-	return 0;
+	key = irq_lock();
+
+	if (driver_data->head) {
+		driver_data->tail->next = trans;
+	} else {
+		driver_data->head = trans;
+		driver_data->msg = 0;
+		ret = i2c_qmsi_ss_msg_start(dev);
+	}
+
+	if (ret) {
+		driver_data->head = NULL;
+	} else {
+		driver_data->tail = last;
+	}
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+static int i2c_qmsi_ss_transfer(struct device *dev, struct i2c_msg *msgs,
+			     uint8_t num_msgs, uint16_t addr)
+{
+	return _i2c_transfer_sync(dev, msgs, num_msgs, addr);
 }
 
 static const struct i2c_driver_api api = {
 	.configure = i2c_qmsi_ss_configure,
 	.transfer = i2c_qmsi_ss_transfer,
+	.transfer_async = i2c_qmsi_ss_transfer_async,
 };
 
 static int i2c_qmsi_ss_init(struct device *dev)
@@ -377,7 +493,6 @@ static int i2c_qmsi_ss_init(struct device *dev)
 		return err;
 	}
 
-	device_sync_call_init(&driver_data->sync);
 	dev->driver_api = &api;
 
 	ss_i2c_qmsi_set_power_state(dev, DEVICE_PM_ACTIVE_STATE);
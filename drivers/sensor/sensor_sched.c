@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Sensor sampling scheduler
+ *
+ * The timer only wakes up the sampling thread, the fetches themselves
+ * may sleep on their bus. Deadlines are absolute cycle counts: the timer
+ * is rounded up to the next tick, and the lateness of each fetch is
+ * accounted for as jitter instead of shifting the following deadlines.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <misc/util.h>
+#include <drivers/sensor/sensor_sched.h>
+
+#define WINDOW_CYCLES \
+	((uint64_t)CONFIG_SENSOR_SCHED_WINDOW_US * \
+	 sys_clock_hw_cycles_per_sec / USEC_PER_SEC)
+
+static void sensor_sched_expiry(struct k_timer *timer)
+{
+	struct sensor_sched *sched =
+		CONTAINER_OF(timer, struct sensor_sched, timer);
+
+	k_sem_give(&sched->sem);
+}
+
+/* Extends the cycle counter to 64 bits, it has to be read at least once
+ * per wrap
+ */
+static uint64_t cycles_get(struct sensor_sched *sched)
+{
+	uint32_t now = k_cycle_get_32();
+
+	sched->cycles += now - sched->last_cycles;
+	sched->last_cycles = now;
+
+	return sched->cycles;
+}
+
+static int is_due(struct sensor_sched_entry *entry, uint64_t now,
+		  uint64_t slack)
+{
+	return entry->next <= now + slack;
+}
+
+static void sensor_sched_fetch(struct sensor_sched *sched,
+			       struct sensor_sched_entry *entry)
+{
+	uint64_t now = cycles_get(sched);
+	uint32_t jitter;
+
+	jitter = now > entry->next ? now - entry->next : entry->next - now;
+	entry->jitter_sum += jitter;
+	if (jitter > entry->jitter_max) {
+		entry->jitter_max = jitter;
+	}
+
+	entry->timestamp = now;
+	if (entry->fetch) {
+		entry->error = entry->fetch(entry, now);
+	} else {
+		entry->error = sensor_sample_fetch(entry->dev);
+	}
+	entry->fetches++;
+	entry->window = sched->windows;
+
+	/* skip the deadlines already passed, rather than fetching in a burst
+	 * to catch up
+	 */
+	entry->next += entry->period_cycles;
+	now = cycles_get(sched);
+	while (entry->next <= now) {
+		entry->next += entry->period_cycles;
+		entry->missed++;
+	}
+}
+
+/* Fetches the entries due, each one followed by the other entries on its
+ * bus due within the window
+ */
+static void sensor_sched_run(struct sensor_sched *sched)
+{
+	struct sensor_sched_entry *entry, *other;
+	sys_snode_t *node, *next;
+	uint64_t start = cycles_get(sched);
+
+	sched->windows++;
+
+	SYS_SLIST_FOR_EACH_NODE(&sched->entries, node) {
+		entry = CONTAINER_OF(node, struct sensor_sched_entry, node);
+
+		if (entry->window == sched->windows ||
+		    !is_due(entry, start, 0)) {
+			continue;
+		}
+
+		sensor_sched_fetch(sched, entry);
+
+		if (!entry->bus) {
+			continue;
+		}
+
+		SYS_SLIST_FOR_EACH_NODE(&sched->entries, next) {
+			other = CONTAINER_OF(next, struct sensor_sched_entry,
+					     node);
+
+			if (other->bus == entry->bus &&
+			    other->window != sched->windows &&
+			    is_due(other, start, WINDOW_CYCLES)) {
+				sensor_sched_fetch(sched, other);
+			}
+		}
+	}
+
+	sched->busy += cycles_get(sched) - start;
+}
+
+/* Arms the timer for the earliest deadline */
+static void sensor_sched_arm(struct sensor_sched *sched)
+{
+	struct sensor_sched_entry *entry;
+	uint64_t now = cycles_get(sched);
+	uint64_t next = UINT64_MAX;
+	uint32_t cycles_per_ms = sys_clock_hw_cycles_per_sec / MSEC_PER_SEC;
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&sched->entries, node) {
+		entry = CONTAINER_OF(node, struct sensor_sched_entry, node);
+		next = min(next, entry->next);
+	}
+
+	if (next == UINT64_MAX) {
+		return;
+	}
+
+	if (next <= now) {
+		k_sem_give(&sched->sem);
+		return;
+	}
+
+	k_timer_start(&sched->timer,
+		      (next - now + cycles_per_ms - 1) / cycles_per_ms, 0);
+}
+
+void sensor_sched_init(struct sensor_sched *sched)
+{
+	sys_slist_init(&sched->entries);
+	k_timer_init(&sched->timer, sensor_sched_expiry, NULL);
+	k_sem_init(&sched->sem, 0, 1);
+
+	sched->last_cycles = k_cycle_get_32();
+	sched->cycles = 0;
+}
+
+int sensor_sched_add(struct sensor_sched *sched,
+		     struct sensor_sched_entry *entry)
+{
+	uint64_t period_cycles = (uint64_t)entry->period *
+		sys_clock_hw_cycles_per_sec / MSEC_PER_SEC;
+
+	if (!period_cycles || period_cycles > INT32_MAX) {
+		return -EINVAL;
+	}
+
+	entry->period_cycles = period_cycles;
+	sys_slist_append(&sched->entries, &entry->node);
+
+	return 0;
+}
+
+void sensor_sched_start(struct sensor_sched *sched)
+{
+	struct sensor_sched_entry *entry;
+	sys_snode_t *node;
+
+	sched->start = cycles_get(sched);
+	sched->busy = 0;
+	sched->windows = 0;
+
+	SYS_SLIST_FOR_EACH_NODE(&sched->entries, node) {
+		entry = CONTAINER_OF(node, struct sensor_sched_entry, node);
+
+		entry->next = sched->start + (uint64_t)entry->phase *
+			sys_clock_hw_cycles_per_sec / MSEC_PER_SEC;
+		entry->timestamp = 0;
+		entry->error = 0;
+		entry->fetches = 0;
+		entry->missed = 0;
+		entry->jitter_max = 0;
+		entry->jitter_sum = 0;
+		entry->window = 0;
+	}
+
+	k_sem_reset(&sched->sem);
+	sensor_sched_arm(sched);
+}
+
+int sensor_sched_wait(struct sensor_sched *sched, int32_t timeout)
+{
+	if (k_sem_take(&sched->sem, timeout)) {
+		return -EAGAIN;
+	}
+
+	sensor_sched_run(sched);
+	sensor_sched_arm(sched);
+
+	return 0;
+}
+
+void sensor_sched_stop(struct sensor_sched *sched)
+{
+	k_timer_stop(&sched->timer);
+	k_sem_reset(&sched->sem);
+}
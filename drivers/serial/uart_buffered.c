@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Buffered UART
+ *
+ * The rings are only updated with interrupts locked, by the caller and by
+ * the UART interrupt. The TX interrupt is enabled while the TX ring holds
+ * data, the RX interrupt while the RX ring has room: data left in the UART
+ * RX FIFO then waits for the reader.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <kernel.h>
+#include <misc/util.h>
+#include <drivers/serial/uart_buffered.h>
+
+/* Instances, to find the one of a UART from its interrupt callback */
+static sys_slist_t instances;
+
+static struct uart_buffered *instance_get(struct device *uart)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&instances, node) {
+		struct uart_buffered *ub;
+
+		ub = CONTAINER_OF(node, struct uart_buffered, node);
+		if (ub->uart == uart) {
+			return ub;
+		}
+	}
+
+	return NULL;
+}
+
+static void uart_buffered_tx_isr(struct uart_buffered *ub)
+{
+	uint32_t len, offset;
+	unsigned int key;
+	int sent = 0;
+	int idle = 0;
+	int n;
+
+	key = irq_lock();
+
+	while (ub->tx_tail != ub->tx_head) {
+		offset = ub->tx_tail & (ub->tx_size - 1);
+		len = min(ub->tx_head - ub->tx_tail, ub->tx_size - offset);
+
+		n = uart_fifo_fill(ub->uart, &ub->tx_buf[offset], len);
+		if (n <= 0) {
+			break;
+		}
+
+		ub->tx_tail += n;
+		sent += n;
+	}
+
+	if (ub->tx_tail == ub->tx_head) {
+		uart_irq_tx_disable(ub->uart);
+		ub->tx_busy = 0;
+		idle = 1;
+	}
+
+	irq_unlock(key);
+
+	if (sent || idle) {
+		k_sem_give(&ub->tx_sem);
+	}
+}
+
+static void uart_buffered_rx_isr(struct uart_buffered *ub)
+{
+	uint32_t len, offset;
+	unsigned int key;
+	int received = 0;
+	int n;
+
+	key = irq_lock();
+
+	while (ub->rx_head - ub->rx_tail < ub->rx_size) {
+		offset = ub->rx_head & (ub->rx_size - 1);
+		len = min(ub->rx_size - (ub->rx_head - ub->rx_tail),
+			  ub->rx_size - offset);
+
+		n = uart_fifo_read(ub->uart, &ub->rx_buf[offset], len);
+		if (n <= 0) {
+			break;
+		}
+
+		ub->rx_head += n;
+		received += n;
+	}
+
+	if (ub->rx_head - ub->rx_tail == ub->rx_size) {
+		uart_irq_rx_disable(ub->uart);
+		ub->rx_stopped = 1;
+	}
+
+	irq_unlock(key);
+
+	if (received) {
+		k_sem_give(&ub->rx_sem);
+	}
+}
+
+static void uart_buffered_isr(struct device *uart)
+{
+	struct uart_buffered *ub = instance_get(uart);
+
+	if (!ub) {
+		return;
+	}
+
+	while (uart_irq_update(uart) && uart_irq_is_pending(uart)) {
+		if (uart_irq_rx_ready(uart)) {
+			uart_buffered_rx_isr(ub);
+		}
+
+		if (uart_irq_tx_ready(uart)) {
+			uart_buffered_tx_isr(ub);
+		}
+	}
+}
+
+int uart_buffered_init(struct uart_buffered *ub, struct device *uart,
+		       uint8_t *tx_buf, uint32_t tx_size,
+		       uint8_t *rx_buf, uint32_t rx_size)
+{
+	unsigned int key;
+
+	if (!tx_size || (tx_size & (tx_size - 1)) ||
+	    !rx_size || (rx_size & (rx_size - 1))) {
+		return -EINVAL;
+	}
+
+	uart_irq_rx_disable(uart);
+	uart_irq_tx_disable(uart);
+
+	ub->uart = uart;
+	ub->tx_buf = tx_buf;
+	ub->tx_size = tx_size;
+	ub->tx_head = 0;
+	ub->tx_tail = 0;
+	ub->tx_busy = 0;
+	k_sem_init(&ub->tx_sem, 0, 1);
+	ub->rx_buf = rx_buf;
+	ub->rx_size = rx_size;
+	ub->rx_head = 0;
+	ub->rx_tail = 0;
+	ub->rx_stopped = 0;
+	k_sem_init(&ub->rx_sem, 0, 1);
+
+	key = irq_lock();
+	sys_slist_find_and_remove(&instances, &ub->node);
+	sys_slist_append(&instances, &ub->node);
+	irq_unlock(key);
+
+	uart_irq_callback_set(uart, uart_buffered_isr);
+	uart_irq_rx_enable(uart);
+
+	return 0;
+}
+
+int uart_buffered_write(struct uart_buffered *ub, const uint8_t *data,
+			int len, int32_t timeout)
+{
+	uint32_t room, offset, n;
+	unsigned int key;
+	int done = 0;
+	int start;
+
+	while (len > 0) {
+		key = irq_lock();
+
+		room = ub->tx_size - (ub->tx_head - ub->tx_tail);
+		n = min((uint32_t)len, room);
+
+		/* at most two copies, before and after the end of the ring */
+		offset = ub->tx_head & (ub->tx_size - 1);
+		if (n > ub->tx_size - offset) {
+			memcpy(&ub->tx_buf[offset], data, ub->tx_size - offset);
+			memcpy(ub->tx_buf, data + ub->tx_size - offset,
+			       n - (ub->tx_size - offset));
+		} else {
+			memcpy(&ub->tx_buf[offset], data, n);
+		}
+		ub->tx_head += n;
+
+		start = n && !ub->tx_busy;
+		if (start) {
+			ub->tx_busy = 1;
+		}
+
+		irq_unlock(key);
+
+		if (start) {
+			uart_irq_tx_enable(ub->uart);
+		}
+
+		data += n;
+		len -= n;
+		done += n;
+
+		if (len && k_sem_take(&ub->tx_sem, timeout)) {
+			break;
+		}
+	}
+
+	return done;
+}
+
+int uart_buffered_read(struct uart_buffered *ub, uint8_t *data, int len,
+		       int32_t timeout)
+{
+	uint32_t offset, n;
+	unsigned int key;
+	int restart;
+
+	if (len <= 0) {
+		return 0;
+	}
+
+	for (;;) {
+		key = irq_lock();
+
+		n = min((uint32_t)len, ub->rx_head - ub->rx_tail);
+
+		offset = ub->rx_tail & (ub->rx_size - 1);
+		if (n > ub->rx_size - offset) {
+			memcpy(data, &ub->rx_buf[offset], ub->rx_size - offset);
+			memcpy(data + ub->rx_size - offset, ub->rx_buf,
+			       n - (ub->rx_size - offset));
+		} else {
+			memcpy(data, &ub->rx_buf[offset], n);
+		}
+		ub->rx_tail += n;
+
+		restart = n && ub->rx_stopped;
+		if (restart) {
+			ub->rx_stopped = 0;
+		}
+
+		irq_unlock(key);
+
+		if (restart) {
+			uart_irq_rx_enable(ub->uart);
+		}
+
+		if (n) {
+			return n;
+		}
+
+		if (k_sem_take(&ub->rx_sem, timeout)) {
+			return 0;
+		}
+	}
+}
+
+int uart_buffered_flush(struct uart_buffered *ub, int32_t timeout)
+{
+	while (ub->tx_busy) {
+		if (k_sem_take(&ub->tx_sem, timeout)) {
+			return -EAGAIN;
+		}
+	}
+
+	return 0;
+}
@@ -125,6 +125,18 @@
 #define FCR_FIFO_8 0x80  /* 8 bytes in RCVR FIFO */
 #define FCR_FIFO_14 0xC0 /* 14 bytes in RCVR FIFO */
 
+#if defined(CONFIG_UART_NS16550_RX_TRIGGER_1)
+#define FCR_FIFO_TRIGGER FCR_FIFO_1
+#elif defined(CONFIG_UART_NS16550_RX_TRIGGER_4)
+#define FCR_FIFO_TRIGGER FCR_FIFO_4
+#elif defined(CONFIG_UART_NS16550_RX_TRIGGER_14)
+#define FCR_FIFO_TRIGGER FCR_FIFO_14
+#else
+#define FCR_FIFO_TRIGGER FCR_FIFO_8
+#endif
+
+#define TX_FIFO_SIZE 16 /* bytes in XMIT FIFO */
+
 /* constants for line control register */
 
 #define LCR_CS5 0x00   /* 5 bits data size */
@@ -245,7 +257,7 @@ static inline void set_dlf(struct device *dev, uint32_t val)
 }
 #endif
 
-static void set_baud_rate(struct device *dev, uint32_t baud_rate)
+static int set_baud_rate(struct device *dev, uint32_t baud_rate)
 {
 	const struct uart_ns16550_device_config * const dev_cfg = DEV_CFG(dev);
 	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
@@ -256,6 +268,11 @@ static void set_baud_rate(struct device *dev, uint32_t baud_rate)
 		/* calculate baud rate divisor */
 		divisor = (dev_cfg->sys_clk_freq / baud_rate) >> 4;
 
+		/* faster than the clock of the UART allows */
+		if (divisor == 0) {
+			return -EINVAL;
+		}
+
 		/* set the DLAB to access the baud rate divisor registers */
 		lcr_cache = INBYTE(LCR(dev));
 		OUTBYTE(LCR(dev), LCR_DLAB);
@@ -267,6 +284,8 @@ static void set_baud_rate(struct device *dev, uint32_t baud_rate)
 
 		dev_data->baud_rate = baud_rate;
 	}
+
+	return 0;
 }
 
 #if defined(CONFIG_UART_NS16550_PCI)
@@ -343,11 +362,11 @@ static int uart_ns16550_init(struct device *dev)
 
 	/*
 	 * Program FIFO: enabled, mode 0 (set for compatibility with quark),
-	 * generate the interrupt at 8th byte
+	 * generate the interrupt at the configured RX trigger level
 	 * Clear TX and RX FIFO
 	 */
-	OUTBYTE(FCR(dev),
-		FCR_FIFO | FCR_MODE0 | FCR_FIFO_8 | FCR_RCVRCLR | FCR_XMITCLR);
+	OUTBYTE(FCR(dev), FCR_FIFO | FCR_MODE0 | FCR_FIFO_TRIGGER |
+		FCR_RCVRCLR | FCR_XMITCLR);
 
 	/* clear the port */
 	INBYTE(RDR(dev));
@@ -427,6 +446,9 @@ static int uart_ns16550_err_check(struct device *dev)
 /**
  * @brief Fill FIFO with data
  *
+ * THRE is only set once the whole XMIT FIFO is empty, so the FIFO is
+ * filled up to its size from a single LSR read.
+ *
  * @param dev UART device struct
  * @param tx_data Data to transmit
  * @param size Number of bytes to send
@@ -438,7 +460,11 @@ static int uart_ns16550_fifo_fill(struct device *dev, const uint8_t *tx_data,
 {
 	int i;
 
-	for (i = 0; i < size && (INBYTE(LSR(dev)) & LSR_THRE) != 0; i++) {
+	if ((INBYTE(LSR(dev)) & LSR_THRE) == 0) {
+		return 0;
+	}
+
+	for (i = 0; i < size && i < TX_FIFO_SIZE; i++) {
 		OUTBYTE(THR(dev), tx_data[i]);
 	}
 	return i;
@@ -654,8 +680,7 @@ static int uart_ns16550_line_ctrl_set(struct device *dev,
 
 	switch (ctrl) {
 	case LINE_CTRL_BAUD_RATE:
-		set_baud_rate(dev, val);
-		return 0;
+		return set_baud_rate(dev, val);
 
 	case LINE_CTRL_RTS:
 	case LINE_CTRL_DTR:
@@ -702,6 +727,34 @@ static int uart_ns16550_drv_cmd(struct device *dev, uint32_t cmd, uint32_t p)
 		return 0;
 #endif
 
+	case CMD_SET_RX_FIFO_TRIGGER:
+		switch (p) {
+		case 1:
+			p = FCR_FIFO_1;
+			break;
+		case 4:
+			p = FCR_FIFO_4;
+			break;
+		case 8:
+			p = FCR_FIFO_8;
+			break;
+		case 14:
+			p = FCR_FIFO_14;
+			break;
+		default:
+			return -EINVAL;
+		}
+		OUTBYTE(FCR(dev), FCR_FIFO | FCR_MODE0 | p);
+		return 0;
+
+	case CMD_SET_LOOPBACK:
+		if (p) {
+			OUTBYTE(MDC(dev), INBYTE(MDC(dev)) | MCR_LOOP);
+		} else {
+			OUTBYTE(MDC(dev), INBYTE(MDC(dev)) & ~MCR_LOOP);
+		}
+		return 0;
+
 	}
 
 	return -ENOTSUP;
@@ -22,5 +22,9 @@
 #define _UART_NS16550_H_
 
 #define CMD_SET_DLF	0x01
+/* RX FIFO trigger level, in bytes: 1, 4, 8 or 14 */
+#define CMD_SET_RX_FIFO_TRIGGER	0x02
+/* Internal loopback of the TX output to the RX input, on if non-zero */
+#define CMD_SET_LOOPBACK	0x03
 
 #endif /* _UART_NS16550_H_ */
@@ -33,6 +33,10 @@
 #include <spi.h>
 #include <spi_dw.h>
 
+#ifdef CONFIG_SPI_DW_DMA
+#include <dma.h>
+#endif
+
 #ifdef CONFIG_IOAPIC
 #include <drivers/ioapic.h>
 #endif
@@ -63,39 +67,75 @@
 		((CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC / ssi_clk_hz) & 0xFFFF)
 #endif
 
+static void start_transaction(struct device *dev,
+			      struct spi_transaction *trans);
+
+static bool transfer_done(struct spi_dw_data *spi)
+{
+#ifdef CONFIG_SPI_DW_DMA
+	if (spi->dma_xfer) {
+		return !spi->dma_pending;
+	}
+#endif
+
+	/*
+	* Writing is done once everything is pushed: last_tx. When reading,
+	* last_tx is set by the first push of dummy frames and rx_buf_len
+	* has to be zero as well.
+	*/
+	return spi->last_tx && !(spi->receive && spi->rx_buf_len);
+}
+
+/* Move to the next non-empty segment of the tx set */
+static void next_tx_buf(struct spi_dw_data *spi)
+{
+	while (!spi->tx_seg_len) {
+		spi->tx_buf = spi->tx_bufs->buf;
+		spi->tx_seg_len = spi->tx_bufs->len / spi->dfs;
+		spi->tx_bufs++;
+	}
+}
+
+static void next_rx_buf(struct spi_dw_data *spi)
+{
+	while (!spi->rx_seg_len) {
+		spi->rx_buf = spi->rx_bufs->buf;
+		spi->rx_seg_len = spi->rx_bufs->len / spi->dfs;
+		spi->rx_bufs++;
+	}
+}
+
 static void completed(struct device *dev, int error)
 {
 	const struct spi_dw_config *info = dev->config->config_info;
 	struct spi_dw_data *spi = dev->driver_data;
+	struct spi_transaction *trans;
+	unsigned int key;
 
-	if (error) {
-		goto out;
+	if (!spi->head || (!error && !transfer_done(spi))) {
+		return;
 	}
 
-	/*
-	* There are several situations here.
-	* 1. spi_write w rx_buf - need last_tx && rx_buf_len zero to be done.
-	* 2. spi_write w/o rx_buf - only need to determine when write is done.
-	* 3. spi_read - need rx_buf_len zero.
-	*/
-	if (spi->tx_buf && spi->rx_buf) {
-		if (!spi->last_tx || spi->rx_buf_len)
-			return;
-	} else if (spi->tx_buf) {
-		if (!spi->last_tx)
-			return;
-	} else { /* or, spi->rx_buf!=0 */
-		if (spi->rx_buf_len)
-			return;
+#ifdef CONFIG_SPI_DW_DMA
+	if (spi->dma_xfer) {
+		if (spi->dma_pending) {
+			dma_transfer_stop(spi->dma, info->dma_tx_channel);
+			dma_transfer_stop(spi->dma, info->dma_rx_channel);
+		}
+
+		/* DMA completion only means the TX FIFO was filled */
+		while (!error && !test_bit_sr_tfe(info->regs)) {
+		}
+
+		write_dmacr(0, info->regs);
+		spi->dma_xfer = 0;
 	}
+#endif
 
-out:
 	/* need to give time for FIFOs to drain before issuing more commands */
 	while (test_bit_sr_busy(info->regs)) {
 	}
 
-	spi->error = error;
-
 	/* Disabling interrupts */
 	write_imr(DW_SPI_IMR_MASK, info->regs);
 	/* Disabling the controller */
@@ -106,7 +146,23 @@ out:
 	SYS_LOG_DBG("SPI transaction completed %s error",
 	    error ? "with" : "without");
 
-	device_sync_call_complete(&spi->sync);
+	/* Start the next transaction before notifying this one, the
+	 * callback being free to queue more.
+	 */
+	key = irq_lock();
+
+	trans = spi->head;
+	spi->head = trans->next;
+	if (spi->head) {
+		start_transaction(dev, spi->head);
+	} else {
+		spi->tail = NULL;
+	}
+
+	irq_unlock(key);
+
+	trans->next = NULL;
+	trans->callback(dev, trans, error ? -EIO : 0);
 }
 
 static void push_data(struct device *dev)
@@ -117,7 +173,7 @@ static void push_data(struct device *dev)
 	uint32_t f_tx;
 	DBG_COUNTER_INIT();
 
-	if (spi->rx_buf) {
+	if (spi->receive) {
 		f_tx = DW_SPI_FIFO_DEPTH - read_txflr(info->regs) -
 					read_rxflr(info->regs);
 		if ((int)f_tx < 0) {
@@ -131,24 +187,35 @@ static void push_data(struct device *dev)
 		spi->last_tx = 1; /* setting last_tx indicates TX is done */
 	}
 	while (f_tx) {
-		if (spi->tx_buf && spi->tx_buf_len > 0) {
-			switch (spi->dfs) {
-			case 1:
-				data = UNALIGNED_GET((uint8_t *)(spi->tx_buf));
-				break;
-			case 2:
-				data = UNALIGNED_GET((uint16_t *)(spi->tx_buf));
-				break;
+		if (spi->tx_buf_len > 0) {
+			next_tx_buf(spi);
+
+			if (!spi->tx_buf) {
+				data = 0;
+			} else {
+				switch (spi->dfs) {
+				case 1:
+					data = UNALIGNED_GET((uint8_t *)
+							     (spi->tx_buf));
+					break;
+				case 2:
+					data = UNALIGNED_GET((uint16_t *)
+							     (spi->tx_buf));
+					break;
 #ifndef CONFIG_ARC
-			case 4:
-				data = UNALIGNED_GET((uint32_t *)(spi->tx_buf));
-				break;
+				case 4:
+					data = UNALIGNED_GET((uint32_t *)
+							     (spi->tx_buf));
+					break;
 #endif
+				}
+
+				spi->tx_buf += spi->dfs;
 			}
 
-			spi->tx_buf += spi->dfs;
+			spi->tx_seg_len--;
 			spi->tx_buf_len--;
-		} else if (spi->rx_buf && spi->rx_buf_len > 0) {
+		} else if (spi->rx_buf_len > 0) {
 			/* No need to push more than necessary */
 			if (spi->rx_buf_len - spi->fifo_diff <= 0) {
 				break;
@@ -185,22 +252,31 @@ static void pull_data(struct device *dev)
 		data = read_dr(info->regs);
 		DBG_COUNTER_INC();
 
-		if (spi->rx_buf && spi->rx_buf_len > 0) {
-			switch (spi->dfs) {
-			case 1:
-				UNALIGNED_PUT(data, (uint8_t *)spi->rx_buf);
-				break;
-			case 2:
-				UNALIGNED_PUT(data, (uint16_t *)spi->rx_buf);
-				break;
+		if (spi->rx_buf_len > 0) {
+			next_rx_buf(spi);
+
+			if (spi->rx_buf) {
+				switch (spi->dfs) {
+				case 1:
+					UNALIGNED_PUT(data,
+						      (uint8_t *)spi->rx_buf);
+					break;
+				case 2:
+					UNALIGNED_PUT(data,
+						      (uint16_t *)spi->rx_buf);
+					break;
 #ifndef CONFIG_ARC
-			case 4:
-				UNALIGNED_PUT(data, (uint32_t *)spi->rx_buf);
-				break;
+				case 4:
+					UNALIGNED_PUT(data,
+						      (uint32_t *)spi->rx_buf);
+					break;
 #endif
+				}
+
+				spi->rx_buf += spi->dfs;
 			}
 
-			spi->rx_buf += spi->dfs;
+			spi->rx_seg_len--;
 			spi->rx_buf_len--;
 		}
 
@@ -301,36 +377,187 @@ static int spi_dw_slave_select(struct device *dev, uint32_t slave)
 	return 0;
 }
 
-static int spi_dw_transceive(struct device *dev,
-			     const void *tx_buf, uint32_t tx_buf_len,
-			     void *rx_buf, uint32_t rx_buf_len)
+#ifdef CONFIG_SPI_DW_DMA
+static void dma_done(struct device *dma, void *data)
+{
+	struct device *dev = data;
+	struct spi_dw_data *spi = dev->driver_data;
+
+	spi->dma_pending--;
+	completed(dev, 0);
+}
+
+static void dma_error(struct device *dma, void *data)
+{
+	completed(data, 1);
+}
+
+static int dma_start_channel(struct device *dev, uint32_t channel,
+			     uint32_t handshake,
+			     enum dma_channel_direction direction,
+			     void *src, void *dst)
+{
+	struct spi_dw_data *spi = dev->driver_data;
+	struct dma_channel_config chan = {
+		.handshake_interface = handshake,
+		.handshake_polarity = HANDSHAKE_POLARITY_HIGH,
+		.channel_direction = direction,
+		.source_transfer_width = TRANS_WIDTH_8,
+		.destination_transfer_width = TRANS_WIDTH_8,
+		.source_burst_length = BURST_TRANS_LENGTH_1,
+		.destination_burst_length = BURST_TRANS_LENGTH_1,
+		.dma_transfer = dma_done,
+		.dma_error = dma_error,
+		.callback_data = dev,
+	};
+	struct dma_transfer_config xfer = {
+		.block_size = spi->tx_buf_len,
+		.source_address = src,
+		.destination_address = dst,
+	};
+
+	if (dma_channel_config(spi->dma, channel, &chan) ||
+	    dma_transfer_config(spi->dma, channel, &xfer) ||
+	    dma_transfer_start(spi->dma, channel)) {
+		return -EIO;
+	}
+
+	spi->dma_pending++;
+
+	return 0;
+}
+
+/*
+ * Let the DMA controller move the frames between the buffers and the data
+ * register instead of the FIFO interrupts. Only 8 bits frames sent from a
+ * single buffer, and fully received into a single buffer if received at
+ * all, are supported.
+ */
+static int dma_start(struct device *dev)
+{
+	const struct spi_dw_config *info = dev->config->config_info;
+	struct spi_dw_data *spi = dev->driver_data;
+	void *dr = (void *)(info->regs + DW_SPI_REG_DR);
+	uint32_t dmacr = DW_SPI_DMACR_TDMAE;
+	uint32_t imask = DW_SPI_IMR_TXOIM;
+
+	if (!spi->dma || spi->dfs != 1 || !spi->tx_buf ||
+	    spi->tx_buf_len < CONFIG_SPI_DW_DMA_THRESHOLD ||
+	    spi->tx_buf_len > SPI_DW_DMA_MAX_FRAMES ||
+	    spi->tx_bufs->len != spi->tx_buf_len) {
+		return -ENOTSUP;
+	}
+
+	if (spi->receive && (!spi->rx_buf ||
+			     spi->rx_bufs->len != spi->rx_buf_len ||
+			     spi->rx_buf_len != spi->tx_buf_len)) {
+		return -ENOTSUP;
+	}
+
+	spi->dma_pending = 0;
+
+	if (spi->receive) {
+		if (dma_start_channel(dev, info->dma_rx_channel,
+				      info->dma_rx_handshake,
+				      PERIPHERAL_TO_MEMORY,
+				      dr, spi->rx_buf)) {
+			return -EIO;
+		}
+
+		dmacr |= DW_SPI_DMACR_RDMAE;
+		imask |= DW_SPI_IMR_RXUIM | DW_SPI_IMR_RXOIM;
+	}
+
+	if (dma_start_channel(dev, info->dma_tx_channel,
+			      info->dma_tx_handshake, MEMORY_TO_PERIPHERAL,
+			      (void *)spi->tx_buf, dr)) {
+		if (spi->dma_pending) {
+			dma_transfer_stop(spi->dma, info->dma_rx_channel);
+		}
+
+		return -EIO;
+	}
+
+	/* Requests are raised as soon as a frame can be moved */
+	write_dmatdlr(DW_SPI_FIFO_DEPTH - 1, info->regs);
+	write_dmardlr(0, info->regs);
+	write_dmacr(dmacr, info->regs);
+
+	write_imr(imask, info->regs);
+
+	spi->dma_xfer = 1;
+
+	return 0;
+}
+#endif /* CONFIG_SPI_DW_DMA */
+
+/* Called with the controller disabled and interrupts locked */
+static void start_transaction(struct device *dev,
+			      struct spi_transaction *trans)
 {
 	const struct spi_dw_config *info = dev->config->config_info;
 	struct spi_dw_data *spi = dev->driver_data;
 	uint32_t rx_thsld = DW_SPI_RXFTLR_DFLT;
 	uint32_t imask;
 
-	SYS_LOG_DBG("%s: %p, %p, %u, %p, %u",
-	    __func__, dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
+	const struct spi_buf *tx_bufs = trans->tx_bufs;
+	const struct spi_buf *rx_bufs = trans->rx_bufs;
+	uint32_t tx_count = trans->tx_count;
+	uint32_t rx_count = trans->rx_count;
+	uint32_t i;
+
+	SYS_LOG_DBG("%s: %p, %p, %u, %p, %u", __func__, dev,
+		    trans->tx_buf, trans->tx_buf_len,
+		    trans->rx_buf, trans->rx_buf_len);
+
+	/* A single buffer is a set of one segment */
+	if (!tx_bufs) {
+		spi->tx_one.buf = (void *)trans->tx_buf;
+		spi->tx_one.len = trans->tx_buf_len;
+		tx_bufs = &spi->tx_one;
+		tx_count = 1;
+	}
 
-	/* Check status */
-	if (!_spi_dw_is_controller_ready(dev)) {
-		SYS_LOG_DBG("%s: Controller is busy", __func__);
-		return -EBUSY;
+	if (!rx_bufs) {
+		spi->rx_one.buf = trans->rx_buf;
+		spi->rx_one.len = trans->rx_buf_len;
+		rx_bufs = &spi->rx_one;
+		rx_count = trans->rx_buf ? 1 : 0;
 	}
 
-	/* Set buffers info */
-	spi->tx_buf = tx_buf;
-	spi->tx_buf_len = tx_buf_len/spi->dfs;
-	spi->rx_buf = rx_buf;
-	if (rx_buf) {
-		spi->rx_buf_len = rx_buf_len/spi->dfs;
-	} else {
-		spi->rx_buf_len = 0; /* must be zero if no buffer */
+	/* Set buffers info, lengths being the frames of the whole sets */
+	spi->tx_bufs = tx_bufs;
+	spi->tx_buf = tx_bufs->buf;
+	spi->tx_seg_len = 0;
+	spi->tx_buf_len = 0;
+	for (i = 0; i < tx_count; i++) {
+		spi->tx_buf_len += tx_bufs[i].len/spi->dfs;
+	}
+
+	spi->rx_bufs = rx_bufs;
+	spi->rx_buf = rx_bufs->buf;
+	spi->rx_seg_len = 0;
+	spi->rx_buf_len = 0; /* must be zero if no buffer */
+	for (i = 0; i < rx_count; i++) {
+		spi->rx_buf_len += rx_bufs[i].len/spi->dfs;
 	}
+
+	spi->receive = rx_count != 0;
 	spi->fifo_diff = 0;
 	spi->last_tx = 0;
 
+	/* Slave select */
+	write_ser(spi->slave, info->regs);
+
+	_spi_control_cs(dev, 1);
+
+#ifdef CONFIG_SPI_DW_DMA
+	if (!dma_start(dev)) {
+		set_bit_ssienr(info->regs);
+		return;
+	}
+#endif
+
 	/* Tx Threshold */
 	write_txftlr(DW_SPI_TXFTLR_DFLT, info->regs);
 
@@ -344,14 +571,9 @@ static int spi_dw_transceive(struct device *dev,
 
 	write_rxftlr(rx_thsld, info->regs);
 
-	/* Slave select */
-	write_ser(spi->slave, info->regs);
-
-	_spi_control_cs(dev, 1);
-
 	/* Enable interrupts */
 	imask = DW_SPI_IMR_UNMASK;
-	if (!rx_buf) {
+	if (!spi->receive) {
 		/* if there is no rx buffer, keep all rx interrupts masked */
 		imask &= DW_SPI_IMR_MASK_RX;
 	}
@@ -360,17 +582,57 @@ static int spi_dw_transceive(struct device *dev,
 
 	/* Enable the controller */
 	set_bit_ssienr(info->regs);
+}
 
-	device_sync_call_wait(&spi->sync);
+static int spi_dw_transceive_async(struct device *dev,
+				   struct spi_transaction *trans)
+{
+	struct spi_dw_data *spi = dev->driver_data;
+	struct spi_transaction *last;
+	unsigned int key;
 
-	if (spi->error) {
-		spi->error = 0;
-		return -EIO;
+	for (last = trans; last->next; last = last->next) {
+	}
+
+	key = irq_lock();
+
+	if (spi->head) {
+		spi->tail->next = trans;
+	} else {
+		spi->head = trans;
+		start_transaction(dev, trans);
 	}
 
+	spi->tail = last;
+
+	irq_unlock(key);
+
 	return 0;
 }
 
+static int spi_dw_transceive(struct device *dev,
+			     const void *tx_buf, uint32_t tx_buf_len,
+			     void *rx_buf, uint32_t rx_buf_len)
+{
+	struct _spi_sync sync;
+	struct spi_transaction trans = {
+		.tx_buf = tx_buf,
+		.tx_buf_len = tx_buf_len,
+		.rx_buf = rx_buf,
+		.rx_buf_len = rx_buf_len,
+		.callback = _spi_sync_done,
+		.user_data = &sync,
+	};
+
+	k_sem_init(&sync.sem, 0, 1);
+
+	spi_dw_transceive_async(dev, &trans);
+
+	k_sem_take(&sync.sem, K_FOREVER);
+
+	return sync.status;
+}
+
 void spi_dw_isr(void *arg)
 {
 	struct device *dev = (struct device *)arg;
@@ -405,12 +667,15 @@ static const struct spi_driver_api dw_spi_api = {
 	.configure = spi_dw_configure,
 	.slave_select = spi_dw_slave_select,
 	.transceive = spi_dw_transceive,
+	.transceive_async = spi_dw_transceive_async,
 };
 
 int spi_dw_init(struct device *dev)
 {
 	const struct spi_dw_config *info = dev->config->config_info;
+#ifdef CONFIG_SPI_DW_DMA
 	struct spi_dw_data *spi = dev->driver_data;
+#endif
 
 	_clock_config(dev);
 	_clock_on(dev);
@@ -427,7 +692,9 @@ int spi_dw_init(struct device *dev)
 
 	info->config_func();
 
-	device_sync_call_init(&spi->sync);
+#ifdef CONFIG_SPI_DW_DMA
+	spi->dma = device_get_binding(CONFIG_SPI_DW_DMA_DRV_NAME);
+#endif
 
 	_spi_config_cs(dev);
 
@@ -454,6 +721,12 @@ const struct spi_dw_config spi_dw_config_0 = {
 #ifdef CONFIG_SPI_DW_CS_GPIO
 	.cs_gpio_name = CONFIG_SPI_0_CS_GPIO_PORT,
 	.cs_gpio_pin = CONFIG_SPI_0_CS_GPIO_PIN,
+#endif
+#ifdef CONFIG_SPI_DW_DMA
+	.dma_tx_channel = CONFIG_SPI_DW_PORT_0_DMA_TX_CHANNEL,
+	.dma_rx_channel = CONFIG_SPI_DW_PORT_0_DMA_RX_CHANNEL,
+	.dma_tx_handshake = CONFIG_SPI_DW_PORT_0_DMA_TX_HANDSHAKE,
+	.dma_rx_handshake = CONFIG_SPI_DW_PORT_0_DMA_RX_HANDSHAKE,
 #endif
 	.config_func = spi_config_0_irq
 };
@@ -501,6 +774,12 @@ static const struct spi_dw_config spi_dw_config_1 = {
 #ifdef CONFIG_SPI_DW_CS_GPIO
 	.cs_gpio_name = CONFIG_SPI_1_CS_GPIO_PORT,
 	.cs_gpio_pin = CONFIG_SPI_1_CS_GPIO_PIN,
+#endif
+#ifdef CONFIG_SPI_DW_DMA
+	.dma_tx_channel = CONFIG_SPI_DW_PORT_1_DMA_TX_CHANNEL,
+	.dma_rx_channel = CONFIG_SPI_DW_PORT_1_DMA_RX_CHANNEL,
+	.dma_tx_handshake = CONFIG_SPI_DW_PORT_1_DMA_TX_HANDSHAKE,
+	.dma_rx_handshake = CONFIG_SPI_DW_PORT_1_DMA_RX_HANDSHAKE,
 #endif
 	.config_func = spi_config_1_irq
 };
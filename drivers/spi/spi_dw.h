@@ -37,27 +37,47 @@ struct spi_dw_config {
 	char *cs_gpio_name;
 	uint32_t cs_gpio_pin;
 #endif /* CONFIG_SPI_DW_CS_GPIO */
+#ifdef CONFIG_SPI_DW_DMA
+	uint32_t dma_tx_channel;
+	uint32_t dma_rx_channel;
+	uint32_t dma_tx_handshake;
+	uint32_t dma_rx_handshake;
+#endif /* CONFIG_SPI_DW_DMA */
 	spi_dw_config_t config_func;
 };
 
 struct spi_dw_data {
-	device_sync_call_t sync;
-	uint32_t error:1;
+	/* Transaction in progress, followed by the queued ones */
+	struct spi_transaction *head;
+	struct spi_transaction *tail;
 	uint32_t dfs:3; /* dfs in bytes: 1,2 or 4 */
 	uint32_t slave:17; /* up 16 slaves */
 	uint32_t fifo_diff:9; /* cannot be bigger than FIFO depth */
 	uint32_t last_tx:1;
-	uint32_t _unused:1;
+	uint32_t dma_xfer:1; /* frames moved by the DMA controller */
+	uint32_t receive:1; /* rx buffers given */
+#ifdef CONFIG_SPI_DW_DMA
+	struct device *dma;
+	uint8_t dma_pending; /* channels not completed yet */
+#endif /* CONFIG_SPI_DW_DMA */
 #ifdef CONFIG_SPI_DW_CLOCK_GATE
 	struct device *clock;
 #endif /* CONFIG_SPI_DW_CLOCK_GATE */
 #ifdef CONFIG_SPI_DW_CS_GPIO
 	struct device *cs_gpio_port;
 #endif /* CONFIG_SPI_DW_CS_GPIO */
+	/* Current segments, lengths of the sets being in frames */
 	const uint8_t *tx_buf;
+	uint32_t tx_seg_len;
 	uint32_t tx_buf_len;
+	const struct spi_buf *tx_bufs;
 	uint8_t *rx_buf;
+	uint32_t rx_seg_len;
 	uint32_t rx_buf_len;
+	const struct spi_buf *rx_bufs;
+	/* Segments of the single buffers of a transaction */
+	struct spi_buf tx_one;
+	struct spi_buf rx_one;
 };
 
 /* Helper macros */
@@ -140,6 +160,7 @@ struct spi_dw_data {
 /* SR bits and values */
 #define DW_SPI_SR_BUSY_BIT		(0)
 #define DW_SPI_SR_TFNF_BIT		(1)
+#define DW_SPI_SR_TFE_BIT		(2)
 #define DW_SPI_SR_RFNE_BIT		(3)
 
 /* IMR bits (ISR valid as well) */
@@ -171,6 +192,13 @@ struct spi_dw_data {
 					 DW_SPI_ISR_RXUIS | \
 					 DW_SPI_ISR_RXOIS | \
 					 DW_SPI_ISR_MSTIS)
+/* DMACR bits */
+#define DW_SPI_DMACR_RDMAE		BIT(0)
+#define DW_SPI_DMACR_TDMAE		BIT(1)
+
+/* Largest block of the DesignWare DMA controller */
+#define SPI_DW_DMA_MAX_FRAMES		4095
+
 /* ICR Bit */
 #define DW_SPI_SR_ICR_BIT		(0)
 
@@ -267,6 +295,7 @@ DEFINE_SET_BIT_OP(ssienr, DW_SPI_REG_SSIENR, DW_SPI_SSIENR_SSIEN_BIT)
 DEFINE_CLEAR_BIT_OP(ssienr, DW_SPI_REG_SSIENR, DW_SPI_SSIENR_SSIEN_BIT)
 DEFINE_TEST_BIT_OP(ssienr, DW_SPI_REG_SSIENR, DW_SPI_SSIENR_SSIEN_BIT)
 DEFINE_TEST_BIT_OP(sr_busy, DW_SPI_REG_SR, DW_SPI_SR_BUSY_BIT)
+DEFINE_TEST_BIT_OP(sr_tfe, DW_SPI_REG_SR, DW_SPI_SR_TFE_BIT)
 
 #ifdef __cplusplus
 }
@@ -28,6 +28,86 @@
 #include <diskio.h>	/* FatFs lower layer API */
 #include <ffconf.h>
 #include <disk_access.h>
+#include <string.h>
+
+#if CONFIG_FS_FAT_READ_AHEAD
+/* Read-ahead of sequential reads. FatFs reads single sectors into its
+ * window when a file is read in pieces smaller than a sector: from the
+ * second read of a sequence, each read missing the buffer fills it with
+ * twice as many sectors as the previous one, up to the buffer size.
+ */
+static struct {
+	BYTE buf[CONFIG_FS_FAT_READ_AHEAD * _MIN_SS];
+	/* Sectors in the buffer */
+	DWORD start;
+	UINT count;
+	/* Sector following the last one read, and sectors to read on the
+	 * next sequential miss
+	 */
+	DWORD next;
+	UINT window;
+	uint32_t disk_sectors;
+} ra;
+
+static int read_ahead(BYTE *buff, DWORD sector, UINT count)
+{
+	UINT n;
+	int ret;
+
+	if (sector >= ra.start && sector + count <= ra.start + ra.count) {
+		memcpy(buff, &ra.buf[(sector - ra.start) * _MIN_SS],
+		       count * _MIN_SS);
+		ra.next = sector + count;
+		return 0;
+	}
+
+	if (sector != ra.next) {
+		ra.window = 0;
+	}
+	ra.next = sector + count;
+
+	/* The first read of a sequence, and reads as large as the buffer,
+	 * go straight to the caller's buffer
+	 */
+	if (count >= CONFIG_FS_FAT_READ_AHEAD || !ra.window) {
+		ra.window = 1;
+		return disk_access_read(buff, sector, count);
+	}
+
+	ra.window = ra.window * 2;
+	if (ra.window > CONFIG_FS_FAT_READ_AHEAD) {
+		ra.window = CONFIG_FS_FAT_READ_AHEAD;
+	}
+
+	n = ra.window;
+	if (n < count) {
+		n = count;
+	}
+	if (n > ra.disk_sectors - sector) {
+		n = ra.disk_sectors - sector;
+	}
+
+	ra.count = 0;
+	ret = disk_access_read(ra.buf, sector, n);
+	if (ret != 0) {
+		return ret;
+	}
+	ra.start = sector;
+	ra.count = n;
+
+	memcpy(buff, ra.buf, count * _MIN_SS);
+
+	return 0;
+}
+
+/* Drops the buffer if it holds any of the sectors written */
+static void read_ahead_invalidate(DWORD sector, UINT count)
+{
+	if (sector < ra.start + ra.count && sector + count > ra.start) {
+		ra.count = 0;
+	}
+}
+#endif /* CONFIG_FS_FAT_READ_AHEAD */
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
@@ -50,9 +130,18 @@ DSTATUS disk_initialize(BYTE pdrv)
 {
 	if (disk_access_init() != 0) {
 		return STA_NOINIT;
-	} else {
-		return RES_OK;
 	}
+
+#if CONFIG_FS_FAT_READ_AHEAD
+	ra.count = 0;
+	ra.window = 0;
+	if (disk_access_ioctl(DISK_IOCTL_GET_SECTOR_COUNT,
+			      &ra.disk_sectors) != 0) {
+		return STA_NOINIT;
+	}
+#endif
+
+	return RES_OK;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -61,7 +150,11 @@ DSTATUS disk_initialize(BYTE pdrv)
 
 DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 {
+#if CONFIG_FS_FAT_READ_AHEAD
+	if (read_ahead(buff, sector, count) != 0) {
+#else
 	if (disk_access_read(buff, sector, count) != 0) {
+#endif
 		return RES_ERROR;
 	} else {
 		return RES_OK;
@@ -74,6 +167,10 @@ DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 /*-----------------------------------------------------------------------*/
 DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 {
+#if CONFIG_FS_FAT_READ_AHEAD
+	read_ahead_invalidate(sector, count);
+#endif
+
 	if(disk_access_write(buff, sector, count) != 0) {
 		return RES_ERROR;
 	} else {
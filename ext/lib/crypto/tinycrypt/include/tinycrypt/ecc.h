@@ -268,6 +268,9 @@ void EccPoint_add(EccPointJacobi *P1, EccPointJacobi *P2);
 /*
  * @brief Elliptic curve scalar multiplication with result in Jacobi coordinates
  *
+ * Multiples of curve_G, passed by address, use a precomputed table and are
+ * about four times faster than multiples of other points.
+ *
  * @param p_result OUT -- Product of p_point by p_scalar.
  * @param p_point IN -- Elliptic curve point
  * @param p_scalar IN -- Scalar integer
@@ -70,19 +70,24 @@ static void ccm_cbc_mac(uint8_t *T, const uint8_t *data, uint32_t dlen,
 	if (flag > 0) {
 		T[0] ^= (uint8_t)(dlen >> 8);
 		T[1] ^= (uint8_t)(dlen);
-		dlen += 2; i = 2;
+		i = 2;
 	} else {
 		i = 0;
 	}
 
-	while (i < dlen) {
-		T[i++ % (Nb * Nk)] ^= *data++;
-		if (((i % (Nb * Nk)) == 0) || dlen == i) {
-			(void) tc_aes_encrypt(T, T, sched);
+	/* i is the number of bytes already in the current block */
+	while (dlen > 0) {
+		for (; i < TC_AES_BLOCK_SIZE && dlen > 0; ++i, --dlen) {
+			T[i] ^= *data++;
 		}
+		(void) tc_aes_encrypt(T, T, sched);
+		i = 0;
 	}
 }
 
+/* number of counter blocks encrypted per tc_aes_encrypt_blocks() call */
+#define CCM_CTR_BATCH_BLOCKS 4
+
 /**
  * Variation of CTR mode used in CCM.
  * The CTR mode used by CCM is slightly different than the conventional CTR
@@ -94,9 +99,11 @@ static int32_t ccm_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 			     uint32_t inlen, uint8_t *ctr, const TCAesKeySched_t sched)
 {
 
-	uint8_t buffer[TC_AES_BLOCK_SIZE];
-	uint8_t nonce[TC_AES_BLOCK_SIZE];
+	uint8_t buffer[CCM_CTR_BATCH_BLOCKS * TC_AES_BLOCK_SIZE];
+	uint8_t *block;
 	uint16_t block_num;
+	uint32_t nblocks;
+	uint32_t len;
 	uint32_t i;
 
 	/* input sanity check: */
@@ -110,26 +117,46 @@ static int32_t ccm_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 		return TC_CRYPTO_FAIL;
 	}
 
-	/* copy the counter to the nonce */
-	(void) _copy(nonce, sizeof(nonce), ctr, sizeof(nonce));
-
 	/* select the last 2 bytes of the nonce to be incremented */
-	block_num = (uint16_t) ((nonce[14] << 8)|(nonce[15]));
-	for (i = 0; i < inlen; ++i) {
-		if ((i % (TC_AES_BLOCK_SIZE)) == 0) {
+	block_num = (uint16_t) ((ctr[14] << 8)|(ctr[15]));
+	while (inlen > 0) {
+		nblocks = (inlen + TC_AES_BLOCK_SIZE - 1) / TC_AES_BLOCK_SIZE;
+		if (nblocks > CCM_CTR_BATCH_BLOCKS) {
+			nblocks = CCM_CTR_BATCH_BLOCKS;
+		}
+
+		/* lay out the next counter blocks and encrypt them at once */
+		for (i = 0; i < nblocks; ++i) {
+			block = buffer + i * TC_AES_BLOCK_SIZE;
+			(void) _copy(block, TC_AES_BLOCK_SIZE, ctr,
+				     TC_AES_BLOCK_SIZE - 2);
 			block_num++;
-			nonce[14] = (uint8_t)(block_num >> 8);
-			nonce[15] = (uint8_t)(block_num);
-			if (!tc_aes_encrypt(buffer, nonce, sched)) {
-				return TC_CRYPTO_FAIL;
-			}
+			block[14] = (uint8_t)(block_num >> 8);
+			block[15] = (uint8_t)(block_num);
 		}
+		if (!tc_aes_encrypt_blocks(buffer, buffer, nblocks, sched)) {
+			return TC_CRYPTO_FAIL;
+		}
+
 		/* update the output */
-		*out++ = buffer[i % (TC_AES_BLOCK_SIZE)] ^ *in++;
+		len = nblocks * TC_AES_BLOCK_SIZE;
+		if (len > inlen) {
+			len = inlen;
+		}
+		for (i = 0; i < len; ++i) {
+			out[i] = buffer[i] ^ in[i];
+		}
+		out += len;
+		in += len;
+		inlen -= len;
 	}
 
 	/* update the counter */
-	ctr[14] = nonce[14]; ctr[15] = nonce[15];
+	ctr[14] = (uint8_t)(block_num >> 8);
+	ctr[15] = (uint8_t)(block_num);
+
+	/* zeroing out the key stream */
+	_set(buffer, TC_ZERO_BYTE, sizeof(buffer));
 
 	return TC_CRYPTO_SUCCESS;
 }
@@ -34,13 +34,18 @@
 #include <tinycrypt/ctr_mode.h>
 #include <tinycrypt/utils.h>
 
+/* number of counter blocks encrypted per tc_aes_encrypt_blocks() call */
+#define CTR_BATCH_BLOCKS 4
+
 int32_t tc_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 		    uint32_t inlen, uint8_t *ctr, const TCAesKeySched_t sched)
 {
 
-	uint8_t buffer[TC_AES_BLOCK_SIZE];
-	uint8_t nonce[TC_AES_BLOCK_SIZE];
+	uint8_t buffer[CTR_BATCH_BLOCKS * TC_AES_BLOCK_SIZE];
+	uint8_t *block;
 	uint32_t block_num;
+	uint32_t nblocks;
+	uint32_t len;
 	uint32_t i;
 
 	/* input sanity check: */
@@ -54,32 +59,49 @@ int32_t tc_ctr_mode(uint8_t *out, uint32_t outlen, const uint8_t *in,
 		return TC_CRYPTO_FAIL;
 	}
 
-	/* copy the ctr to the nonce */
-	(void)_copy(nonce, sizeof(nonce), ctr, sizeof(nonce));
-
 	/* select the last 4 bytes of the nonce to be incremented */
-	block_num = (nonce[12] << 24) | (nonce[13] << 16) |
-		    (nonce[14] << 8) | (nonce[15]);
-	for (i = 0; i < inlen; ++i) {
-		if ((i % (TC_AES_BLOCK_SIZE)) == 0) {
-			/* encrypt data using the current nonce */
-			if (tc_aes_encrypt(buffer, nonce, sched)) {
-				block_num++;
-				nonce[12] = (uint8_t)(block_num >> 24);
-				nonce[13] = (uint8_t)(block_num >> 16);
-				nonce[14] = (uint8_t)(block_num >> 8);
-				nonce[15] = (uint8_t)(block_num);
-			} else {
-				return TC_CRYPTO_FAIL;
-			}
+	block_num = (ctr[12] << 24) | (ctr[13] << 16) |
+		    (ctr[14] << 8) | (ctr[15]);
+	while (inlen > 0) {
+		nblocks = (inlen + TC_AES_BLOCK_SIZE - 1) / TC_AES_BLOCK_SIZE;
+		if (nblocks > CTR_BATCH_BLOCKS) {
+			nblocks = CTR_BATCH_BLOCKS;
+		}
+
+		/* lay out the next counter blocks and encrypt them at once */
+		for (i = 0; i < nblocks; ++i) {
+			block = buffer + i * TC_AES_BLOCK_SIZE;
+			(void)_copy(block, TC_AES_BLOCK_SIZE, ctr,
+				    TC_AES_BLOCK_SIZE - 4);
+			block[12] = (uint8_t)(block_num >> 24);
+			block[13] = (uint8_t)(block_num >> 16);
+			block[14] = (uint8_t)(block_num >> 8);
+			block[15] = (uint8_t)(block_num);
+			block_num++;
+		}
+		if (!tc_aes_encrypt_blocks(buffer, buffer, nblocks, sched)) {
+			return TC_CRYPTO_FAIL;
 		}
+
 		/* update the output */
-		*out++ = buffer[i%(TC_AES_BLOCK_SIZE)] ^ *in++;
+		len = nblocks * TC_AES_BLOCK_SIZE;
+		if (len > inlen) {
+			len = inlen;
+		}
+		for (i = 0; i < len; ++i) {
+			out[i] = buffer[i] ^ in[i];
+		}
+		out += len;
+		in += len;
+		inlen -= len;
 	}
 
 	/* update the counter */
-	ctr[12] = nonce[12]; ctr[13] = nonce[13];
-	ctr[14] = nonce[14]; ctr[15] = nonce[15];
+	ctr[12] = (uint8_t)(block_num >> 24); ctr[13] = (uint8_t)(block_num >> 16);
+	ctr[14] = (uint8_t)(block_num >> 8); ctr[15] = (uint8_t)(block_num);
+
+	/* zeroing out the key stream */
+	_set(buffer, TC_ZERO_BYTE, sizeof(buffer));
 
 	return TC_CRYPTO_SUCCESS;
 }
@@ -114,44 +114,6 @@ uint32_t vli_isZero(uint32_t *p_vli)
 	return (!acc);
 }
 
-/*
- * Find the right-most nonzero 32-bit "digits" in p_vli.
- *
- * Side-channel countermeasure: algorithm strengthened against timing attack.
- */
-static uint32_t vli_numDigits(uint32_t *p_vli)
-{
-	int32_t i;
-	uint32_t digits = 0;
-
-	for (i = NUM_ECC_DIGITS - 1; i >= 0 ; --i) {
-		digits += p_vli[i] || digits;
-	}
-
-	return digits;
-}
-
-/*
- * Find the left-most non-zero bit in p_vli.
- *
- * Side-channel countermeasure: algorithm strengthened against timing attack.
- */
-static uint32_t vli_numBits(uint32_t *p_vli)
-{
-	uint32_t l_digit;
-	uint32_t i, acc = 32;
-	uint32_t l_numDigits = vli_numDigits(p_vli);
-
-	l_digit = p_vli[l_numDigits - 1];
-
-	for (i = 0; i < 32; ++i) {
-		acc -= !l_digit;
-		l_digit >>= 1;
-	}
-
-	return ((l_numDigits - 1) * 32 + acc);
-}
-
 /*
  * Computes p_result = p_left + p_right, returns carry.
  *
@@ -280,15 +242,104 @@ static void vli_mmod_barrett(uint32_t *p_result, uint32_t *p_product,
 }
 
 /*
- * Computes modular exponentiation.
+ * Computes p_result = p_product % curve_p, using the special form of the
+ * P-256 prime (FIPS 186-4, D.2.3): the high words are folded back into the
+ * low ones with additions and subtractions, then at most two corrections by
+ * p are applied.
  *
  * Side-channel countermeasure: algorithm strengthened against timing attack.
  */
+static void vli_mmod_fast(uint32_t *p_result, uint32_t *p_product)
+{
+	const uint32_t *c = p_product;
+	uint32_t tmp[NUM_ECC_DIGITS];
+	uint32_t borrow;
+	int64_t acc;
+	int32_t carry;
+
+	/*
+	 * result = s1 + 2 s2 + 2 s3 + s4 + s5 - s6 - s7 - s8 - s9, summed word
+	 * by word with a signed carry.
+	 */
+	acc = (int64_t)c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+	p_result[0] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+	p_result[1] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+	p_result[2] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[3] + 2 * ((int64_t)c[11] + c[12]) + c[13] - c[15] -
+	       c[8] - c[9];
+	p_result[3] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[4] + 2 * ((int64_t)c[12] + c[13]) + c[14] - c[9] -
+	       c[10];
+	p_result[4] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[5] + 2 * ((int64_t)c[13] + c[14]) + c[15] - c[10] -
+	       c[11];
+	p_result[5] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[6] + c[13] + 3 * (int64_t)c[14] + 2 * (int64_t)c[15] -
+	       c[8] - c[9];
+	p_result[6] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)c[7] + c[8] + 3 * (int64_t)c[15] - c[10] - c[11] -
+	       c[12] - c[13];
+	p_result[7] = (uint32_t)acc;
+	carry = (int32_t)(acc >> 32);
+
+	/*
+	 * Fold the carry back in, as 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod p).
+	 * What is left is a carry of -1, 0 or 1.
+	 */
+	acc = (int64_t)p_result[0] + carry;
+	p_result[0] = (uint32_t)acc;
+	acc >>= 32;
+	acc += p_result[1];
+	p_result[1] = (uint32_t)acc;
+	acc >>= 32;
+	acc += p_result[2];
+	p_result[2] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)p_result[3] - carry;
+	p_result[3] = (uint32_t)acc;
+	acc >>= 32;
+	acc += p_result[4];
+	p_result[4] = (uint32_t)acc;
+	acc >>= 32;
+	acc += p_result[5];
+	p_result[5] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)p_result[6] - carry;
+	p_result[6] = (uint32_t)acc;
+	acc >>= 32;
+	acc += (int64_t)p_result[7] + carry;
+	p_result[7] = (uint32_t)acc;
+	carry = (int32_t)(acc >> 32);
+
+	/* negative: add p once */
+	vli_add(tmp, p_result, curve_p);
+	vli_cond_set(p_result, tmp, p_result, carry < 0);
+
+	/* 2^256 or more, or at least p: subtract p once */
+	borrow = vli_sub(tmp, p_result, curve_p, NUM_ECC_DIGITS);
+	vli_cond_set(p_result, tmp, p_result, (carry > 0) | !borrow);
+}
+
+/*
+ * Computes modular exponentiation by a public exponent.
+ *
+ * Side-channel countermeasure: algorithm strengthened against timing attack
+ * on the base.
+ */
 static void vli_modExp(uint32_t *p_result, uint32_t *p_base,
 		       uint32_t *p_exp, uint32_t *p_mod, uint32_t *p_barrett)
 {
 
-	uint32_t acc[NUM_ECC_DIGITS], tmp[NUM_ECC_DIGITS], product[2 * NUM_ECC_DIGITS];
+	uint32_t acc[NUM_ECC_DIGITS], product[2 * NUM_ECC_DIGITS];
 	uint32_t j;
 	int32_t i;
 
@@ -299,15 +350,69 @@ static void vli_modExp(uint32_t *p_result, uint32_t *p_base,
 		for (j = 1 << 31; j > 0; j = j >> 1) {
 			vli_square(product, acc);
 			vli_mmod_barrett(acc, product, p_mod, p_barrett);
-			vli_mult(product, acc, p_base, NUM_ECC_DIGITS);
-			vli_mmod_barrett(tmp, product, p_mod, p_barrett);
-			vli_cond_set(acc, tmp, acc, j & p_exp[i]);
+			/* the exponent is public: only the base is secret */
+			if (j & p_exp[i]) {
+				vli_mult(product, acc, p_base, NUM_ECC_DIGITS);
+				vli_mmod_barrett(acc, product, p_mod, p_barrett);
+			}
 		}
 	}
 
 	vli_set(p_result, acc);
 }
 
+/* Computes p_result = p_left^(2^n) mod curve_p. */
+static void vli_modSquare_n(uint32_t *p_result, uint32_t *p_left, uint32_t n)
+{
+	vli_modSquare_fast(p_result, p_left);
+	while (--n) {
+		vli_modSquare_fast(p_result, p_result);
+	}
+}
+
+/*
+ * Computes p_result = 1 / p_input mod curve_p, as p_input^(p - 2).
+ *
+ * p - 2 = 2^256 - 2^224 + 2^192 + 2^96 - 3 is a run of 32 ones, 31 zeros, a
+ * one, 96 zeros, 94 ones, a zero and a one: the runs of ones are built from
+ * x_k = p_input^(2^k - 1), for 255 squarings and 12 multiplications.
+ *
+ * Side-channel countermeasure: algorithm strengthened against timing attack.
+ */
+static void vli_modInv_p(uint32_t *p_result, uint32_t *p_input)
+{
+	uint32_t x2[NUM_ECC_DIGITS], x4[NUM_ECC_DIGITS], x8[NUM_ECC_DIGITS];
+	uint32_t x16[NUM_ECC_DIGITS], x32[NUM_ECC_DIGITS], t[NUM_ECC_DIGITS];
+
+	vli_modSquare_fast(t, p_input);
+	vli_modMult_fast(x2, t, p_input);
+	vli_modSquare_n(t, x2, 2);
+	vli_modMult_fast(x4, t, x2);
+	vli_modSquare_n(t, x4, 4);
+	vli_modMult_fast(x8, t, x4);
+	vli_modSquare_n(t, x8, 8);
+	vli_modMult_fast(x16, t, x8);
+	vli_modSquare_n(t, x16, 16);
+	vli_modMult_fast(x32, t, x16);
+
+	vli_modSquare_n(t, x32, 32);
+	vli_modMult_fast(t, t, p_input);	/* 32 ones, 31 zeros, 1 */
+	vli_modSquare_n(t, t, 96 + 32);
+	vli_modMult_fast(t, t, x32);		/* 96 zeros, 32 ones */
+	vli_modSquare_n(t, t, 32);
+	vli_modMult_fast(t, t, x32);		/* 64 ones */
+	vli_modSquare_n(t, t, 16);
+	vli_modMult_fast(t, t, x16);
+	vli_modSquare_n(t, t, 8);
+	vli_modMult_fast(t, t, x8);
+	vli_modSquare_n(t, t, 4);
+	vli_modMult_fast(t, t, x4);
+	vli_modSquare_n(t, t, 2);
+	vli_modMult_fast(t, t, x2);		/* 94 ones */
+	vli_modSquare_n(t, t, 2);
+	vli_modMult_fast(p_result, t, p_input);	/* 0, 1 */
+}
+
 /* Conversion from Affine coordinates to Jacobi coordinates. */
 static void EccPoint_fromAffine(EccPointJacobi *p_point_jacobi,
 	EccPoint *p_point) {
@@ -439,7 +544,7 @@ void vli_modMult_fast(uint32_t *p_result, uint32_t *p_left,
 	uint32_t l_product[2 * NUM_ECC_DIGITS];
 
 	vli_mult(l_product, p_left, p_right, NUM_ECC_DIGITS);
-	vli_mmod_barrett(p_result, l_product, curve_p, curve_pb);
+	vli_mmod_fast(p_result, l_product);
 }
 
 void vli_modSquare_fast(uint32_t *p_result, uint32_t *p_left)
@@ -447,7 +552,7 @@ void vli_modSquare_fast(uint32_t *p_result, uint32_t *p_left)
 	uint32_t l_product[2 * NUM_ECC_DIGITS];
 
 	vli_square(l_product, p_left);
-	vli_mmod_barrett(p_result, l_product, curve_p, curve_pb);
+	vli_mmod_fast(p_result, l_product);
 }
 
 void vli_modMult(uint32_t *p_result, uint32_t *p_left, uint32_t *p_right,
@@ -491,8 +596,7 @@ void EccPoint_toAffine(EccPoint *p_point, EccPointJacobi *p_point_jacobi)
 
 	uint32_t z[NUM_ECC_DIGITS];
 
-	vli_set(z, p_point_jacobi->Z);
-	vli_modInv(z, z, curve_p, curve_pb);
+	vli_modInv_p(z, p_point_jacobi->Z);
 	vli_modSquare_fast(p_point->x, z);
 	vli_modMult_fast(p_point->y, p_point->x, z);
 	vli_modMult_fast(p_point->x, p_point->x, p_point_jacobi->X);
@@ -542,29 +646,268 @@ void EccPoint_add(EccPointJacobi *P1, EccPointJacobi *P2)
 	vli_modSub(P1->Y, P1->Y, t, curve_p); /* Y3 = r(u1 h^2 - X3) - s1 h^3 */
 }
 
+/*
+ * Starting value of the accumulator of the scalar multiplications, standing
+ * for the point at infinity until the first non-zero digit is added: with
+ * Z = 0 it is a point at infinity, doubling it gives it back, and adding a
+ * point to it does not hit the special cases of the addition formulas, which
+ * would take a different time.
+ */
+static void EccPointJacobi_setInfinity(EccPointJacobi *P)
+{
+	vli_clear(P->X);
+	vli_clear(P->Y);
+	vli_clear(P->Z);
+	P->X[0] = 1;
+	P->Y[0] = 1;
+}
+
+/* Sets target to input if cond is nonzero. */
+static void EccPointJacobi_condSet(EccPointJacobi *target,
+				   EccPointJacobi *input, uint32_t cond)
+{
+	vli_cond_set(target->X, input->X, target->X, cond);
+	vli_cond_set(target->Y, input->Y, target->Y, cond);
+	vli_cond_set(target->Z, input->Z, target->Z, cond);
+}
+
+/*
+ * Elliptic curve point addition of a point in Jacobi coordinates and a point
+ * in affine coordinates (Z2 = 1): P1 = P1 + P2.
+ *
+ * Requires 3 squares and 8 multiplications.
+ */
+static void EccPoint_addAffine(EccPointJacobi *P1, EccPoint *P2)
+{
+
+	uint32_t t[NUM_ECC_DIGITS], h[NUM_ECC_DIGITS], r[NUM_ECC_DIGITS];
+
+	vli_modSquare_fast(r, P1->Z);
+	vli_modMult_fast(h, P2->x, r);
+	vli_modMult_fast(r, P2->y, r);
+	vli_modMult_fast(r, r, P1->Z);
+	vli_modSub(h, h, P1->X, curve_p); /* h = X2 Z1^2 - X1 */
+	vli_modSub(r, r, P1->Y, curve_p); /* r = Y2 Z1^3 - Y1 */
+
+	if (vli_isZero(h)) {
+		if (vli_isZero(r)) {
+			/* P1 = P2 */
+			EccPoint_double(P1);
+			return;
+		}
+		/* point at infinity */
+		vli_clear(P1->Z);
+		return;
+	}
+
+	vli_modMult_fast(P1->Z, P1->Z, h); /* Z3 = h Z1 */
+	vli_modSquare_fast(t, h);
+	vli_modMult_fast(h, t, h);
+	vli_modMult_fast(P1->X, P1->X, t); /* u1 h^2 */
+	vli_modSquare_fast(t, r);
+	vli_modSub(t, t, h, curve_p);
+	vli_modSub(t, t, P1->X, curve_p);
+	vli_modSub(t, t, P1->X, curve_p); /* X3 = r^2 - h^3 - 2 u1 h^2 */
+	vli_modSub(P1->X, P1->X, t, curve_p);
+	vli_modMult_fast(P1->X, P1->X, r);
+	vli_modMult_fast(h, P1->Y, h);
+	vli_modSub(P1->Y, P1->X, h, curve_p); /* Y3 = r(u1 h^2 - X3) - s1 h^3 */
+	vli_set(P1->X, t);
+}
+
+/*
+ * Fixed-base comb for the generator: entry w - 1 is the sum of 2^(64 j) G for
+ * each bit j set in w. The scalar is cut in four 64-bit rows, and bit i of
+ * each row forms the comb index of column i.
+ */
+#define COMB_TEETH 4
+#define COMB_SPACING 64
+
+static const EccPoint curve_G_comb[(1 << COMB_TEETH) - 1] = {
+	/* G */
+	{{0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81,
+	   0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2},
+	 {0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357,
+	   0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2}},
+	/* 2^64 G */
+	{{0x8E14DB63, 0x90E75CB4, 0xAD651F7E, 0x29493BAA,
+	   0x326E25DE, 0x8492592E, 0x2811AAA5, 0x0FA822BC},
+	 {0x5F462EE7, 0xE4112454, 0x50FE82F5, 0x34B1A650,
+	   0xB3DF188B, 0x6F4AD4BC, 0xF5DBA80D, 0xBFF44AE8}},
+	/* G + 2^64 G */
+	{{0x097992AF, 0x93391CE2, 0x0D35F1FA, 0xE96C98FD,
+	   0x95E02789, 0xB257C0DE, 0x89D6726F, 0x300A4BBC},
+	 {0xC08127A0, 0xAA54A291, 0xA9D806A5, 0x5BB1EEAD,
+	   0xFF1E3C6F, 0x7F1DDB25, 0xD09B4644, 0x72AAC7E0}},
+	/* 2^128 G */
+	{{0xD789BD85, 0x57C84FC9, 0xC297EAC3, 0xFC35FF7D,
+	   0x88C6766E, 0xFB982FD5, 0xEEDB5E67, 0x447D739B},
+	 {0x72E25B32, 0x0C7E33C9, 0xA7FAE500, 0x3D349B95,
+	   0x3A4AAFF7, 0xE12E9D95, 0x834131EE, 0x2D4825AB}},
+	/* G + 2^128 G */
+	{{0x2A1D367F, 0x13949C93, 0x1A0A11B7, 0xEF7FBD2B,
+	   0xB91DFC60, 0xDDC6068B, 0x8A9C72FF, 0xEF951932},
+	 {0x7376D8A8, 0x196035A7, 0x95CA1740, 0x23183B08,
+	   0x022C219C, 0xC1EE9807, 0x7DBB2C9B, 0x611E9FC3}},
+	/* 2^64 G + 2^128 G */
+	{{0x0B57F4BC, 0xCAE2B192, 0xC6C9BC36, 0x2936DF5E,
+	   0xE11238BF, 0x7DEA6482, 0x7B51F5D8, 0x55066379},
+	 {0x348A964C, 0x44FFE216, 0xDBDEFBE1, 0x9FB3D576,
+	   0x8D9D50E5, 0x0AFA4001, 0x8AECB851, 0x15716484}},
+	/* G + 2^64 G + 2^128 G */
+	{{0xFC5CDE01, 0xE48ECAFF, 0x0D715F26, 0x7CCD84E7,
+	   0xF43E4391, 0xA2E8F483, 0xB21141EA, 0xEB5D7745},
+	 {0x731A3479, 0xCAC917E2, 0x2844B645, 0x85F22CFE,
+	   0x58006CEE, 0x0990E6A1, 0xDBECC17B, 0xEAFD72EB}},
+	/* 2^192 G */
+	{{0x313728BE, 0x6CF20FFB, 0xA3C6B94A, 0x96439591,
+	   0x44315FC5, 0x2736FF83, 0xA7849276, 0xA6D39677},
+	 {0xC357F5F4, 0xF2BAB833, 0x2284059B, 0x824A920C,
+	   0x2D27ECDF, 0x66B8BABD, 0x9B0B8816, 0x674F8474}},
+	/* G + 2^192 G */
+	{{0x677C8A3E, 0x2DF48C04, 0x0203A56B, 0x74E02F08,
+	   0xB8C7FEDB, 0x31855F7D, 0x72C9DDAD, 0x4E769E76},
+	 {0xB824BBB0, 0xA4C36165, 0x3B9122A5, 0xFB9AE16F,
+	   0x06947281, 0x1EC00572, 0xDE830663, 0x42B99082}},
+	/* 2^64 G + 2^192 G */
+	{{0xDDA868B9, 0x6EF95150, 0x9C0CE131, 0xD1F89E79,
+	   0x08A1C478, 0x7FDC1CA0, 0x1C6CE04D, 0x78878EF6},
+	 {0x1FE0D976, 0x9C62B912, 0xBDE08D4F, 0x6ACE570E,
+	   0x12309DEF, 0xDE53142C, 0x7B72C321, 0xB6CB3F5D}},
+	/* G + 2^64 G + 2^192 G */
+	{{0xC31A3573, 0x7F991ED2, 0xD54FB496, 0x5B82DD5B,
+	   0x812FFCAE, 0x595C5220, 0x716B1287, 0x0C88BC4D},
+	 {0x5F48ACA8, 0x3A57BF63, 0xDF2564F3, 0x7C8181F4,
+	   0x9C04E6AA, 0x18D1B5B3, 0xF3901DC6, 0xDD5DDEA3}},
+	/* 2^128 G + 2^192 G */
+	{{0x3E72AD0C, 0xE96A79FB, 0x42BA792F, 0x43A0A28C,
+	   0x083E49F3, 0xEFE0A423, 0x6B317466, 0x68F344AF},
+	 {0x3FB24D4A, 0xCDFE17DB, 0x71F5C626, 0x668BFC22,
+	   0x24D67FF3, 0x604ED93C, 0xF8540A20, 0x31B9C405}},
+	/* G + 2^128 G + 2^192 G */
+	{{0xA2582E7F, 0xD36B4789, 0x4EC39C28, 0x0D1A1014,
+	   0xEDBAD7A0, 0x663C62C3, 0x6F461DB9, 0x4052BF4B},
+	 {0x188D25EB, 0x235A27C3, 0x99BFCC5B, 0xE724F339,
+	   0x71D70CC8, 0x862BE6BD, 0x90B0FC61, 0xFECF4D51}},
+	/* 2^64 G + 2^128 G + 2^192 G */
+	{{0xA1D4CFAC, 0x74346C10, 0x8526A7A4, 0xAFDF5CC0,
+	   0xF62BFF7A, 0x123202A8, 0xC802E41A, 0x1EDDBAE2},
+	 {0xD603F844, 0x8FA0AF2D, 0x4C701917, 0x36E06B7E,
+	   0x73DB33A0, 0x0C45F452, 0x560EBCFC, 0x43104D86}},
+	/* G + 2^64 G + 2^128 G + 2^192 G */
+	{{0x0D1D78E5, 0x9615B511, 0x25C4744B, 0x66B0DE32,
+	   0x6AAF363A, 0x0A4A46FB, 0x84F7A21C, 0xB48E26B4},
+	 {0x21A01B2D, 0x06EBB0F6, 0x8B7B0F98, 0xC004E404,
+	   0xFED6F668, 0x64131BCD, 0x4D4D3DAB, 0xFAC01540}}
+};
+
+/*
+ * Sets p_result to entry index - 1 of the comb table, reading every entry so
+ * that the memory accesses do not depend on the index.
+ */
+static void EccPoint_combSelect(EccPoint *p_result, uint32_t index)
+{
+	uint32_t i, j, mask;
+
+	for (j = 0; j < NUM_ECC_DIGITS; j++) {
+		p_result->x[j] = 0;
+		p_result->y[j] = 0;
+	}
+
+	for (i = 0; i < (1 << COMB_TEETH) - 1; i++) {
+		mask = -(uint32_t)(i + 1 == index);
+		for (j = 0; j < NUM_ECC_DIGITS; j++) {
+			p_result->x[j] |= curve_G_comb[i].x[j] & mask;
+			p_result->y[j] |= curve_G_comb[i].y[j] & mask;
+		}
+	}
+}
+
+/*
+ * Scalar multiplication of the generator with the comb table: 63 doublings
+ * and 64 mixed additions, instead of 255 of each.
+ */
+static void EccPoint_multBase(EccPointJacobi *p_result, uint32_t *p_scalar)
+{
+
+	int32_t i;
+	uint32_t j, w, infinity = 1;
+	EccPointJacobi p_tmp;
+	EccPoint p_point;
+
+	EccPointJacobi_setInfinity(p_result);
+
+	for (i = COMB_SPACING - 1; i >= 0; i--) {
+		EccPoint_double(p_result);
+
+		w = 0;
+		for (j = 0; j < COMB_TEETH; j++) {
+			w |= (vli_testBit(p_scalar, i + j * COMB_SPACING) != 0) << j;
+		}
+
+		/* for a zero column, add G and throw the sum away */
+		EccPoint_combSelect(&p_point, w | (w == 0));
+		EccPointJacobi_set(&p_tmp, p_result);
+		EccPoint_addAffine(&p_tmp, &p_point);
+		EccPointJacobi_condSet(p_result, &p_tmp, !infinity & (w != 0));
+
+		/* first non-zero column: the entry itself */
+		EccPoint_fromAffine(&p_tmp, &p_point);
+		EccPointJacobi_condSet(p_result, &p_tmp, infinity & (w != 0));
+		infinity &= (w == 0);
+	}
+}
+
 /*
  * Elliptic curve scalar multiplication with result in Jacobi coordinates:
  *
  * p_result = p_scalar * p_point.
+ *
+ * Multiples of the generator use the comb table. Other points use a fixed
+ * window of 2 bits over P, 2P and 3P, converted to affine coordinates for
+ * cheaper additions: 256 doublings and 128 mixed additions.
  */
 void EccPoint_mult(EccPointJacobi *p_result, EccPoint *p_point, uint32_t *p_scalar)
 {
 
 	int32_t i;
-	uint32_t bit;
-	EccPointJacobi p_point_jacobi, p_tmp;
+	uint32_t w, infinity = 1;
+	EccPoint p_2P, p_3P, p_entry;
+	EccPointJacobi p_tmp;
+
+	if (p_point == &curve_G) {
+		EccPoint_multBase(p_result, p_scalar);
+		return;
+	}
+
+	EccPoint_fromAffine(&p_tmp, p_point);
+	EccPoint_double(&p_tmp);
+	EccPoint_toAffine(&p_2P, &p_tmp);
+	EccPoint_addAffine(&p_tmp, p_point);
+	EccPoint_toAffine(&p_3P, &p_tmp);
 
-	EccPoint_fromAffine(p_result, p_point);
-	EccPoint_fromAffine(&p_point_jacobi, p_point);
+	EccPointJacobi_setInfinity(p_result);
 
-	for (i = vli_numBits(p_scalar) - 2; i >= 0; i--) {
+	for (i = NUM_ECC_DIGITS * 32 - 2; i >= 0; i -= 2) {
 		EccPoint_double(p_result);
+		EccPoint_double(p_result);
+
+		w = (p_scalar[i / 32] >> (i % 32)) & 3;
+
+		/* read every entry; for a zero digit, add P and throw it away */
+		vli_cond_set(p_entry.x, p_2P.x, p_point->x, w == 2);
+		vli_cond_set(p_entry.y, p_2P.y, p_point->y, w == 2);
+		vli_cond_set(p_entry.x, p_3P.x, p_entry.x, w == 3);
+		vli_cond_set(p_entry.y, p_3P.y, p_entry.y, w == 3);
+
 		EccPointJacobi_set(&p_tmp, p_result);
-		EccPoint_add(&p_tmp, &p_point_jacobi);
-		bit = vli_testBit(p_scalar, i);
-		vli_cond_set(p_result->X, p_tmp.X, p_result->X, bit);
-		vli_cond_set(p_result->Y, p_tmp.Y, p_result->Y, bit);
-		vli_cond_set(p_result->Z, p_tmp.Z, p_result->Z, bit);
+		EccPoint_addAffine(&p_tmp, &p_entry);
+		EccPointJacobi_condSet(p_result, &p_tmp, !infinity & (w != 0));
+
+		/* first non-zero digit: the entry itself */
+		EccPoint_fromAffine(&p_tmp, &p_entry);
+		EccPointJacobi_condSet(p_result, &p_tmp, infinity & (w != 0));
+		infinity &= (w == 0);
 	}
 }
 
@@ -22,6 +22,7 @@
 #ifndef __INCLUDE_ADC_H__
 #define __INCLUDE_ADC_H__
 
+#include <errno.h>
 #include <stdint.h>
 #include <device.h>
 
@@ -73,6 +74,51 @@ struct adc_seq_table {
 	uint8_t stride[3];
 };
 
+struct adc_stream;
+
+/**
+ * @brief Callback for a block of samples of a stream
+ *
+ * Called from interrupt context. The driver is already filling the other
+ * buffer of the stream, so the block must be consumed before that one is
+ * full.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param stream Stream the block belongs to.
+ * @param buffer Buffer holding the block, of stream->buffer_length bytes.
+ */
+typedef void (*adc_stream_callback_t)(struct device *dev,
+				      struct adc_stream *stream,
+				      uint8_t *buffer);
+
+/**
+ * @brief ADC driver stream
+ *
+ * This structure describes a continuous sampling of one channel at a
+ * fixed rate, timed by the ADC, into two buffers used in turn.
+ */
+struct adc_stream {
+	/** Sampling rate, in Hz. */
+	uint32_t sampling_rate;
+
+	/** Buffers where the samples are written, in turn. */
+	uint8_t *buffer[2];
+
+	/** Length of each buffer, in bytes. */
+	uint32_t buffer_length;
+
+	/** Called each time a buffer is full. */
+	adc_stream_callback_t callback;
+
+	/** Number of blocks lost, as the ADC could not keep up. */
+	uint32_t overruns;
+
+	/** Channel ID that should be sampled from the ADC */
+	uint8_t channel_id;
+
+	uint8_t stride[3];
+};
+
 /**
  * @brief ADC driver API
  *
@@ -87,6 +133,12 @@ struct adc_driver_api {
 
 	/** Pointer to the read routine. */
 	int (*read)(struct device *dev, struct adc_seq_table *seq_table);
+
+	/** Pointer to the stream start routine, optional. */
+	int (*stream_start)(struct device *dev, struct adc_stream *stream);
+
+	/** Pointer to the stream stop routine, optional. */
+	void (*stream_stop)(struct device *dev);
 };
 
 /**
@@ -145,6 +197,54 @@ static inline int adc_read(struct device *dev, struct adc_seq_table *seq_table)
 	return api->read(dev, seq_table);
 }
 
+/**
+ * @brief Start a continuous sampling.
+ *
+ * This routine starts sampling one channel at the stream rate, timed by
+ * the ADC hardware, into the two buffers of the stream in turn. The
+ * stream callback receives each buffer once full, from interrupt context,
+ * without any thread waking up per sample. adc_read() waits until the
+ * stream is stopped.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param stream Pointer to the stream, kept by the driver until stopped.
+ *
+ * @retval 0 On success
+ * @retval -EINVAL If the sampling rate cannot be reached.
+ * @retval -ENOTSUP If the driver has no continuous sampling.
+ * @retval else Otherwise.
+ */
+static inline int adc_stream_start(struct device *dev,
+				   struct adc_stream *stream)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->stream_start) {
+		return -ENOTSUP;
+	}
+
+	return api->stream_start(dev, stream);
+}
+
+/**
+ * @brief Stop a continuous sampling.
+ *
+ * This routine stops the sampling, the block in progress is discarded.
+ * No stream callback is called once it returns.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @return N/A
+ */
+static inline void adc_stream_stop(struct device *dev)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (api->stream_stop) {
+		api->stream_stop(dev);
+	}
+}
+
 /**
  * @}
  */
@@ -30,6 +30,16 @@ extern "C" {
 #define IPM_CONSOLE_STDOUT	(1 << 0)
 #define IPM_CONSOLE_PRINTK	(1 << 1)
 
+/*
+ * Messages either carry one character in their id, or, with the
+ * IPM_CONSOLE_BATCH id flag, up to IPM_CONSOLE_BATCH_SIZE characters in
+ * their data, the number of characters being the low byte of the id.
+ * Batches end at the end of a line: the characters of a partial line,
+ * such as a prompt, are only sent once the line ends or the batch is full.
+ */
+#define IPM_CONSOLE_BATCH	(1 << 8)
+#define IPM_CONSOLE_BATCH_SIZE	16
+
 /*
  * Good way to determine these numbers other than trial-and-error?
  * using printf() in the thread seems to require a lot more stack space
@@ -53,7 +63,10 @@ struct ipm_console_receiver_config_info {
 	 */
 	uint32_t *ring_buf_data;
 
-	/** Size of ring_buf_data in 32-bit chunks */
+	/**
+	 * Size of ring_buf_data in 32-bit chunks, a message takes up to
+	 * 1 + IPM_CONSOLE_BATCH_SIZE / 4 of them
+	 */
 	unsigned int rb_size32;
 
 	/**
@@ -48,6 +48,29 @@ struct uart_console_input {
 void uart_register_input(struct k_fifo *avail, struct nano_fifo *lines,
 			 uint8_t (*completion)(char *str, uint8_t len));
 
+#ifdef CONFIG_UART_CONSOLE_DEFERRED
+/** @brief Send the buffered console output
+ *
+ *  Polls out the characters not sent yet, with interrupts locked. To be
+ *  used before halting the system: _SysFatalErrorHandler() calls it, and
+ *  it does nothing without CONFIG_UART_CONSOLE_DEFERRED.
+ *
+ *  @return N/A
+ */
+void uart_console_flush(void);
+
+/** @brief Get the number of characters dropped
+ *
+ *  @return Number of characters of console output dropped because the
+ *  output buffer was full.
+ */
+uint32_t uart_console_dropped(void);
+#else
+#define uart_console_flush()			\
+	do {/* nothing */			\
+	} while ((0))
+#endif
+
 /*
  * Allows having debug hooks in the console driver for handling incoming
  * control characters, and letting other ones through.
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Sensor sampling scheduler
+ *
+ * Fetches samples from several sensors, each at its own period and phase,
+ * from a single kernel timer armed for the next deadline. Deadlines are
+ * kept on a common timebase, the hardware cycle counter, so that a late
+ * fetch does not delay the next ones, and every sample is stamped with
+ * the cycle count at which its fetch started.
+ *
+ * Entries on the same bus are fetched back to back in one window: once
+ * a bus is in use, the entries on that bus due within
+ * CONFIG_SENSOR_SCHED_WINDOW_US are fetched right away instead of waking
+ * up again shortly after.
+ */
+
+#ifndef _DRIVERS_SENSOR_SCHED_H_
+#define _DRIVERS_SENSOR_SCHED_H_
+
+#include <kernel.h>
+#include <sensor.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sensor_sched_entry;
+
+/**
+ * @brief Fetch a sample
+ *
+ * @param entry Entry of the sensor.
+ * @param timestamp Cycle count at which the fetch started.
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+typedef int (*sensor_sched_fetch_t)(struct sensor_sched_entry *entry,
+				    uint64_t timestamp);
+
+/**
+ * @brief Sensor sampled by the scheduler
+ *
+ * The fields up to phase are set before adding the entry, the statistics
+ * are updated by the scheduler.
+ */
+struct sensor_sched_entry {
+	sys_snode_t node;
+
+	/** Sensor, fetched by sensor_sample_fetch() if fetch is NULL */
+	struct device *dev;
+	/** Bus of the sensor, or NULL */
+	struct device *bus;
+	sensor_sched_fetch_t fetch;
+	/** Sampling period, in milliseconds */
+	uint32_t period;
+	/** Offset of the first sample from the scheduler start, in ms */
+	uint32_t phase;
+
+	/** Cycle count at which the last fetch started */
+	uint64_t timestamp;
+	/** Result of the last fetch */
+	int error;
+	uint32_t fetches;
+	/** Deadlines skipped, the previous fetch ending too late */
+	uint32_t missed;
+	/** Largest and total distance of the fetches from their deadline,
+	 * in cycles
+	 */
+	uint32_t jitter_max;
+	uint64_t jitter_sum;
+
+	/* Private */
+	uint64_t next;
+	uint64_t period_cycles;
+	uint32_t window;
+};
+
+/**
+ * @brief Sensor sampling scheduler
+ *
+ * All fields are private, except the statistics.
+ */
+struct sensor_sched {
+	sys_slist_t entries;
+	struct k_timer timer;
+	struct k_sem sem;
+
+	/* 64 bits extension of the cycle counter */
+	uint32_t last_cycles;
+	uint64_t cycles;
+
+	/** Cycle count at the start */
+	uint64_t start;
+	/** Cycles spent fetching samples */
+	uint64_t busy;
+	/** Fetch windows, each after a single wake up */
+	uint32_t windows;
+};
+
+/**
+ * @brief Initialize a scheduler
+ *
+ * @param sched Scheduler.
+ */
+void sensor_sched_init(struct sensor_sched *sched);
+
+/**
+ * @brief Add a sensor to a scheduler
+ *
+ * Entries are added before sensor_sched_start().
+ *
+ * @param sched Scheduler.
+ * @param entry Entry of the sensor.
+ *
+ * @return 0 if successful, -EINVAL if the period is 0, or too long for
+ *         the cycle counter, which has to be read at least once per wrap.
+ */
+int sensor_sched_add(struct sensor_sched *sched,
+		     struct sensor_sched_entry *entry);
+
+/**
+ * @brief Start sampling
+ *
+ * @param sched Scheduler.
+ */
+void sensor_sched_start(struct sensor_sched *sched);
+
+/**
+ * @brief Fetch the samples due
+ *
+ * Waits for the next deadline and fetches the samples due, from the
+ * calling thread. Called in a loop by the thread sampling the sensors.
+ *
+ * @param sched Scheduler.
+ * @param timeout Longest wait for a deadline, in milliseconds, or
+ *        K_FOREVER.
+ *
+ * @return 0 if samples were fetched, -EAGAIN if the wait timed out.
+ */
+int sensor_sched_wait(struct sensor_sched *sched, int32_t timeout);
+
+/**
+ * @brief Stop sampling
+ *
+ * @param sched Scheduler.
+ */
+void sensor_sched_stop(struct sensor_sched *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DRIVERS_SENSOR_SCHED_H_ */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Buffered UART
+ *
+ * Interrupt driven reads and writes through TX and RX ring buffers, on top
+ * of the interrupt API of any UART driver. The UART interrupt moves data
+ * between the rings and the UART FIFOs with uart_fifo_fill() and
+ * uart_fifo_read(), so the caller only waits for room in, or data from,
+ * the rings.
+ */
+
+#ifndef _DRIVERS_UART_BUFFERED_H_
+#define _DRIVERS_UART_BUFFERED_H_
+
+#include <kernel.h>
+#include <uart.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Buffered UART instance
+ *
+ * The ring indexes wrap around at 2^32, the ring sizes are powers of two.
+ * All fields are private.
+ */
+struct uart_buffered {
+	sys_snode_t node;
+	struct device *uart;
+
+	uint8_t *tx_buf;
+	uint32_t tx_size;
+	uint32_t tx_head;
+	uint32_t tx_tail;
+	/* TX interrupt enabled, the interrupt will send any data added */
+	int tx_busy;
+	struct k_sem tx_sem;
+
+	uint8_t *rx_buf;
+	uint32_t rx_size;
+	uint32_t rx_head;
+	uint32_t rx_tail;
+	/* RX interrupt disabled while the ring is full */
+	int rx_stopped;
+	struct k_sem rx_sem;
+};
+
+/**
+ * @brief Set up a buffered UART
+ *
+ * Takes over the interrupt callback of the UART and enables its RX
+ * interrupt.
+ *
+ * @param ub Buffered UART instance
+ * @param uart UART device, with interrupt support
+ * @param tx_buf TX ring buffer
+ * @param tx_size Size of the TX ring, a power of two
+ * @param rx_buf RX ring buffer
+ * @param rx_size Size of the RX ring, a power of two
+ *
+ * @return 0 if successful, -EINVAL if a size is not a power of two.
+ */
+int uart_buffered_init(struct uart_buffered *ub, struct device *uart,
+		       uint8_t *tx_buf, uint32_t tx_size,
+		       uint8_t *rx_buf, uint32_t rx_size);
+
+/**
+ * @brief Write data
+ *
+ * Copies the data to the TX ring, waiting for room in it as long as
+ * needed. With K_NO_WAIT only what fits in the ring is taken, and the
+ * call never blocks.
+ *
+ * @param ub Buffered UART instance
+ * @param data Data to send
+ * @param len Number of bytes to send
+ * @param timeout Longest wait for room in the ring, in milliseconds, for
+ *        each time it is full, or K_NO_WAIT or K_FOREVER
+ *
+ * @return Number of bytes added to the ring.
+ */
+int uart_buffered_write(struct uart_buffered *ub, const uint8_t *data,
+			int len, int32_t timeout);
+
+/**
+ * @brief Read data
+ *
+ * Takes what is in the RX ring, up to len bytes. If the ring is empty,
+ * waits for data for up to timeout.
+ *
+ * @param ub Buffered UART instance
+ * @param data Buffer for the data received
+ * @param len Size of the buffer
+ * @param timeout Longest wait for data, in milliseconds, or K_NO_WAIT or
+ *        K_FOREVER
+ *
+ * @return Number of bytes read, 0 if no data arrived in time.
+ */
+int uart_buffered_read(struct uart_buffered *ub, uint8_t *data, int len,
+		       int32_t timeout);
+
+/**
+ * @brief Wait until the TX ring is empty
+ *
+ * The last bytes may still be in the UART FIFO on return.
+ *
+ * @param ub Buffered UART instance
+ * @param timeout Longest wait, in milliseconds, or K_FOREVER
+ *
+ * @return 0 if the ring is empty, -EAGAIN if the wait timed out.
+ */
+int uart_buffered_flush(struct uart_buffered *ub, int32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DRIVERS_UART_BUFFERED_H_ */
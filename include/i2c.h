@@ -33,6 +33,7 @@
 extern "C" {
 #endif
 
+#include <errno.h>
 #include <stdint.h>
 #include <device.h>
 
@@ -128,10 +129,57 @@ typedef int (*i2c_api_full_io_t)(struct device *dev,
 				 struct i2c_msg *msgs,
 				 uint8_t num_msgs,
 				 uint16_t addr);
+/**
+ * @endcond
+ */
+
+struct i2c_transaction;
+
+/**
+ * @typedef i2c_callback_t
+ * @brief Completion callback of an asynchronous transaction
+ *
+ * Called from interrupt context once all the messages of the transaction
+ * are done, or on the first failure.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Completed transaction.
+ * @param status 0 on success, negative errno code on failure.
+ */
+typedef void (*i2c_callback_t)(struct device *dev,
+			       struct i2c_transaction *trans, int status);
+
+/**
+ * @brief I2C asynchronous transaction
+ *
+ * The messages are sent to the device at addr as for i2c_transfer(), the
+ * driver moving from one message to the next from its interrupt handler.
+ * The last message always ends with a STOP.
+ *
+ * Transactions can be chained through next before being submitted: they
+ * are then performed in order, each with its own completion callback. A
+ * transaction, its messages and their buffers belong to the driver until
+ * its callback is called.
+ */
+struct i2c_transaction {
+	struct i2c_transaction *next;
+	struct i2c_msg *msgs;
+	uint8_t num_msgs;
+	uint16_t addr;
+	i2c_callback_t callback;
+	void *user_data;
+};
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+typedef int (*i2c_api_transfer_async_t)(struct device *dev,
+					struct i2c_transaction *trans);
 
 struct i2c_driver_api {
 	i2c_api_configure_t configure;
 	i2c_api_full_io_t transfer;
+	i2c_api_transfer_async_t transfer_async;
 };
 /**
  * @endcond
@@ -230,6 +278,79 @@ static inline int i2c_transfer(struct device *dev,
 	return api->transfer(dev, msgs, num_msgs, addr);
 }
 
+/**
+ * @brief Queue transactions without waiting for their completion.
+ *
+ * The transactions are appended to the queue of the controller and are
+ * performed in order. Synchronous transfers go through the same queue
+ * on drivers supporting this call.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans First transaction of a chain terminated by a NULL next.
+ *
+ * @retval 0 If the transactions are queued.
+ * @retval -ENOTSUP If the driver only supports synchronous transfers.
+ * @retval Negative errno code if failure.
+ */
+static inline int i2c_transfer_async(struct device *dev,
+				     struct i2c_transaction *trans)
+{
+	const struct i2c_driver_api *api = dev->driver_api;
+
+	if (!api->transfer_async) {
+		return -ENOTSUP;
+	}
+
+	return api->transfer_async(dev, trans);
+}
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+struct _i2c_sync {
+	struct k_sem sem;
+	int status;
+};
+
+static inline void _i2c_sync_done(struct device *dev,
+				  struct i2c_transaction *trans, int status)
+{
+	struct _i2c_sync *sync = trans->user_data;
+
+	sync->status = status;
+	k_sem_give(&sync->sem);
+}
+
+/* Synchronous transfer of drivers built on their asynchronous one */
+static inline int _i2c_transfer_sync(struct device *dev,
+				     struct i2c_msg *msgs, uint8_t num_msgs,
+				     uint16_t addr)
+{
+	struct _i2c_sync sync;
+	struct i2c_transaction trans = {
+		.msgs = msgs,
+		.num_msgs = num_msgs,
+		.addr = addr,
+		.callback = _i2c_sync_done,
+		.user_data = &sync,
+	};
+	int ret;
+
+	k_sem_init(&sync.sem, 0, 1);
+
+	ret = i2c_transfer_async(dev, &trans);
+	if (ret) {
+		return ret;
+	}
+
+	k_sem_take(&sync.sem, K_FOREVER);
+
+	return sync.status;
+}
+/**
+ * @endcond
+ */
+
 /**
  * @brief Read multiple bytes from an internal address of an I2C device.
  *
@@ -373,6 +494,270 @@ static inline int i2c_reg_update_byte(struct device *dev, uint8_t dev_addr,
 	return i2c_reg_write_byte(dev, dev_addr, reg_addr, new_value);
 }
 
+/** Most register operations of a single i2c_reg_transfer() call */
+#define I2C_REG_OPS_MAX			8
+
+/**
+ * @brief Register operation of a batch
+ *
+ * Reads or writes len bytes from, or to, the internal registers of an
+ * I2C device starting at reg.
+ */
+struct i2c_reg_op {
+	/** Data buffer in bytes */
+	uint8_t		*buf;
+
+	/** Length of buffer in bytes */
+	uint8_t		len;
+
+	/** Internal address of the first register */
+	uint8_t		reg;
+
+	/** I2C_MSG_READ or I2C_MSG_WRITE */
+	uint8_t		flags;
+};
+
+/**
+ * @brief Build the messages of a batch of register operations.
+ *
+ * Each operation takes two messages: the register address, then the data
+ * written or read. Operations are separated by a repeated start instead
+ * of a STOP and a new START, and the last message ends with a STOP.
+ *
+ * @param ops Register operations, their reg fields must stay valid as
+ * long as the messages are in use.
+ * @param num_ops Number of register operations.
+ * @param msgs Messages built, at least 2 * num_ops of them.
+ *
+ * @return Number of messages built.
+ */
+static inline uint8_t i2c_reg_ops_msgs(struct i2c_reg_op *ops,
+				       uint8_t num_ops, struct i2c_msg *msgs)
+{
+	struct i2c_msg *msg = msgs;
+	uint8_t i;
+
+	for (i = 0; i < num_ops; i++) {
+		msg->buf = &ops[i].reg;
+		msg->len = 1;
+		msg->flags = I2C_MSG_WRITE | (i ? I2C_MSG_RESTART : 0);
+		msg++;
+
+		msg->buf = ops[i].buf;
+		msg->len = ops[i].len;
+		msg->flags = ops[i].flags & I2C_MSG_RW_MASK;
+		if (msg->flags == I2C_MSG_READ) {
+			msg->flags |= I2C_MSG_RESTART;
+		}
+		msg++;
+	}
+
+	if (msg != msgs) {
+		msg[-1].flags |= I2C_MSG_STOP;
+	}
+
+	return msg - msgs;
+}
+
+/**
+ * @brief Perform a batch of register operations in a single transfer.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param dev_addr Address of the I2C device.
+ * @param ops Register operations, in order.
+ * @param num_ops Number of register operations, up to I2C_REG_OPS_MAX.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If there are too many operations.
+ * @retval Negative errno code if failure.
+ */
+static inline int i2c_reg_transfer(struct device *dev, uint16_t dev_addr,
+				   struct i2c_reg_op *ops, uint8_t num_ops)
+{
+	const struct i2c_driver_api *api = dev->driver_api;
+	struct i2c_msg msgs[2 * I2C_REG_OPS_MAX];
+
+	if (!num_ops || num_ops > I2C_REG_OPS_MAX) {
+		return -EINVAL;
+	}
+
+	return api->transfer(dev, msgs, i2c_reg_ops_msgs(ops, num_ops, msgs),
+			     dev_addr);
+}
+
+/**
+ * @brief Cached copy of a range of 8-bit registers of an I2C device
+ *
+ * Keeps the last value read from, or written to, up to 32 consecutive
+ * registers, so that their read-modify-write updates only cost the
+ * write, or nothing when the value does not change. Registers changed
+ * by the device itself must be left out of the range, or invalidated
+ * before being read.
+ */
+struct i2c_reg_shadow {
+	struct device *dev;
+	uint16_t dev_addr;
+	uint8_t first;
+	uint8_t count;
+	uint8_t *values;
+	uint32_t valid;
+};
+
+/**
+ * @brief Initialize a register shadow, with no value cached.
+ *
+ * @param shadow Register shadow.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param dev_addr Address of the I2C device.
+ * @param first Internal address of the first register of the range.
+ * @param values Storage for the cached values, count bytes.
+ * @param count Number of registers of the range, up to 32.
+ */
+static inline void i2c_reg_shadow_init(struct i2c_reg_shadow *shadow,
+				       struct device *dev, uint16_t dev_addr,
+				       uint8_t first, uint8_t *values,
+				       uint8_t count)
+{
+	shadow->dev = dev;
+	shadow->dev_addr = dev_addr;
+	shadow->first = first;
+	shadow->count = count;
+	shadow->values = values;
+	shadow->valid = 0;
+}
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+static inline uint32_t _i2c_reg_shadow_bit(struct i2c_reg_shadow *shadow,
+					   uint8_t reg_addr)
+{
+	uint8_t index = reg_addr - shadow->first;
+
+	return index < shadow->count ? 1U << index : 0;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Record the value of a register written by other means.
+ *
+ * @param shadow Register shadow.
+ * @param reg_addr Address of the internal register.
+ * @param value Value of the register.
+ */
+static inline void i2c_reg_shadow_set(struct i2c_reg_shadow *shadow,
+				      uint8_t reg_addr, uint8_t value)
+{
+	uint32_t bit = _i2c_reg_shadow_bit(shadow, reg_addr);
+
+	if (bit) {
+		shadow->values[reg_addr - shadow->first] = value;
+		shadow->valid |= bit;
+	}
+}
+
+/**
+ * @brief Forget the cached value of a register.
+ *
+ * @param shadow Register shadow.
+ * @param reg_addr Address of the internal register.
+ */
+static inline void i2c_reg_shadow_invalidate(struct i2c_reg_shadow *shadow,
+					     uint8_t reg_addr)
+{
+	shadow->valid &= ~_i2c_reg_shadow_bit(shadow, reg_addr);
+}
+
+/**
+ * @brief Read a register, from the cache when possible.
+ *
+ * @param shadow Register shadow.
+ * @param reg_addr Address of the internal register being read.
+ * @param value Memory pool that stores the register value.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+static inline int i2c_reg_shadow_read(struct i2c_reg_shadow *shadow,
+				      uint8_t reg_addr, uint8_t *value)
+{
+	int rc;
+
+	if (shadow->valid & _i2c_reg_shadow_bit(shadow, reg_addr)) {
+		*value = shadow->values[reg_addr - shadow->first];
+		return 0;
+	}
+
+	rc = i2c_reg_read_byte(shadow->dev, shadow->dev_addr, reg_addr, value);
+	if (rc == 0) {
+		i2c_reg_shadow_set(shadow, reg_addr, *value);
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Write a register and cache its value.
+ *
+ * @param shadow Register shadow.
+ * @param reg_addr Address of the internal register being written.
+ * @param value Value to be written to the register.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+static inline int i2c_reg_shadow_write(struct i2c_reg_shadow *shadow,
+				       uint8_t reg_addr, uint8_t value)
+{
+	int rc;
+
+	rc = i2c_reg_write_byte(shadow->dev, shadow->dev_addr, reg_addr,
+				value);
+	if (rc == 0) {
+		i2c_reg_shadow_set(shadow, reg_addr, value);
+	} else {
+		i2c_reg_shadow_invalidate(shadow, reg_addr);
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Update a set of bits of a register through its cached value.
+ *
+ * The register is only read if its value is not cached, and only written
+ * if the update changes it.
+ *
+ * @param shadow Register shadow.
+ * @param reg_addr Address of the internal register being updated.
+ * @param mask Bitmask for updating the register.
+ * @param value Value for updating the register.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+static inline int i2c_reg_shadow_update(struct i2c_reg_shadow *shadow,
+					uint8_t reg_addr, uint8_t mask,
+					uint8_t value)
+{
+	uint8_t old_value, new_value;
+	int rc;
+
+	rc = i2c_reg_shadow_read(shadow, reg_addr, &old_value);
+	if (rc != 0) {
+		return rc;
+	}
+
+	new_value = (old_value & ~mask) | (value & mask);
+	if (new_value == old_value) {
+		return 0;
+	}
+
+	return i2c_reg_shadow_write(shadow, reg_addr, new_value);
+}
+
 struct i2c_client_config {
 	char *i2c_master;
 	uint16_t i2c_addr;
@@ -79,6 +79,15 @@ typedef sys_dlist_t _wait_q_t;
 #define _DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(type)
 #endif
 
+#ifdef CONFIG_POLL
+#define _POLL_EVENT_OBJ_INIT \
+	.poll_event = NULL,
+#define _POLL_EVENT struct k_poll_event *poll_event
+#else
+#define _POLL_EVENT_OBJ_INIT
+#define _POLL_EVENT
+#endif
+
 #define tcs k_thread
 struct k_thread;
 struct k_mutex;
@@ -93,6 +102,8 @@ struct k_stack;
 struct k_mem_slab;
 struct k_mem_pool;
 struct k_timer;
+struct k_poll_event;
+struct k_poll_signal;
 
 typedef struct k_thread *k_tid_t;
 
@@ -382,6 +393,43 @@ extern void k_thread_suspend(k_tid_t thread);
  */
 extern void k_thread_resume(k_tid_t thread);
 
+#ifdef CONFIG_THREAD_STATS
+/**
+ * @brief Thread execution statistics.
+ *
+ * All times are in hardware cycles. A switch away from a thread that is
+ * still ready to run (preemption, time slice expiry or k_yield()) counts as
+ * a preemption, a switch away from a thread that blocks, sleeps, is
+ * suspended or terminates counts as a voluntary switch.
+ */
+struct k_thread_stats {
+	/* time spent running */
+	uint64_t run_time;
+
+	/* time spent ready to run, waiting for the CPU */
+	uint64_t ready_time;
+
+	/* number of times the thread was switched out while still ready */
+	uint32_t preemptions;
+
+	/* number of times the thread was switched out while not ready */
+	uint32_t voluntary_switches;
+};
+
+/**
+ * @brief Get a thread's execution statistics.
+ *
+ * The statistics of the current thread include the time it has been running
+ * since it was last switched in.
+ *
+ * @param thread ID of thread to query.
+ * @param stats Buffer receiving the statistics.
+ *
+ * @return N/A
+ */
+extern void k_thread_stats_get(k_tid_t thread, struct k_thread_stats *stats);
+#endif
+
 /**
  * @brief Set time-slicing period and scope.
  *
@@ -765,6 +813,7 @@ extern uint32_t k_cycle_get_32(void);
 struct k_fifo {
 	_wait_q_t wait_q;
 	sys_slist_t data_q;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_fifo);
 };
@@ -852,6 +901,7 @@ extern void *k_fifo_get(struct k_fifo *fifo, int32_t timeout);
 	{ \
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
 	.data_q = SYS_SLIST_STATIC_INIT(&obj.data_q), \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -1034,6 +1084,26 @@ struct k_work;
 
 typedef void (*k_work_handler_t)(struct k_work *);
 
+#ifdef CONFIG_WORKQUEUE_STATS
+/**
+ * @brief Workqueue statistics.
+ *
+ * Latency is measured from submission to the start of the handler, runtime
+ * is the time spent inside the handler. All times are in hardware cycles.
+ */
+struct k_work_q_stats {
+	uint32_t submitted;
+	uint32_t processed;
+	uint32_t batches;
+	uint32_t depth;
+	uint32_t max_depth;
+	uint32_t max_latency;
+	uint32_t max_runtime;
+	uint64_t total_latency;
+	uint64_t total_runtime;
+};
+#endif
+
 /**
  * A workqueue is a thread that executes @ref k_work items that are
  * queued to it.  This is useful for drivers which need to schedule
@@ -1042,7 +1112,15 @@ typedef void (*k_work_handler_t)(struct k_work *);
  * space.
  */
 struct k_work_q {
+#ifdef CONFIG_WORKQUEUE_BATCH
+	sys_slist_t lanes[CONFIG_WORKQUEUE_NUM_LANES];
+	_wait_q_t wait_q;
+#ifdef CONFIG_WORKQUEUE_STATS
+	struct k_work_q_stats stats;
+#endif
+#else
 	struct k_fifo fifo;
+#endif
 };
 
 /**
@@ -1059,8 +1137,30 @@ struct k_work {
 	void *_reserved;		/* Used by k_fifo implementation. */
 	k_work_handler_t handler;
 	atomic_t flags[1];
+#ifdef CONFIG_WORKQUEUE_BATCH
+	uint8_t lane;
+#ifdef CONFIG_WORKQUEUE_STATS
+	uint32_t submit_time;
+#endif
+#endif
 };
 
+#ifdef CONFIG_WORKQUEUE_BATCH
+/**
+ * @brief Highest priority workqueue lane, used by default.
+ */
+#define K_WORK_LANE_HIGHEST 0
+
+/**
+ * @brief Lowest priority workqueue lane.
+ */
+#define K_WORK_LANE_LOWEST (CONFIG_WORKQUEUE_NUM_LANES - 1)
+
+#define _K_WORK_LANE_INITIALIZER .lane = K_WORK_LANE_HIGHEST,
+#else
+#define _K_WORK_LANE_INITIALIZER
+#endif
+
 /**
  * @brief Statically initialize work item
  */
@@ -1068,7 +1168,8 @@ struct k_work {
 	{ \
 	._reserved = NULL, \
 	.handler = work_handler, \
-	.flags = { 0 } \
+	.flags = { 0 }, \
+	_K_WORK_LANE_INITIALIZER \
 	}
 
 /**
@@ -1078,8 +1179,33 @@ static inline void k_work_init(struct k_work *work, k_work_handler_t handler)
 {
 	atomic_clear_bit(work->flags, K_WORK_STATE_PENDING);
 	work->handler = handler;
+#ifdef CONFIG_WORKQUEUE_BATCH
+	work->lane = K_WORK_LANE_HIGHEST;
+#endif
 }
 
+#ifdef CONFIG_WORKQUEUE_BATCH
+/**
+ * @brief Set the priority lane of a work item.
+ *
+ * Workqueues always drain lower numbered lanes first, so bulk producers
+ * (e.g. sensor triggers) can be moved to a higher numbered lane to keep
+ * latency sensitive work from queuing behind them. The lane must not be
+ * changed while the work item is pending.
+ *
+ * @param work Work item
+ * @param lane Lane, from K_WORK_LANE_HIGHEST to K_WORK_LANE_LOWEST
+ *
+ * @return N/A
+ */
+static inline void k_work_lane_set(struct k_work *work, unsigned int lane)
+{
+	__ASSERT(lane < CONFIG_WORKQUEUE_NUM_LANES, "invalid lane %u", lane);
+
+	work->lane = lane;
+}
+#endif
+
 /**
  * @brief Submit a work item to a workqueue.
  *
@@ -1095,6 +1221,10 @@ static inline void k_work_init(struct k_work *work, k_work_handler_t handler)
  *
  * @return N/A
  */
+#ifdef CONFIG_WORKQUEUE_BATCH
+extern void k_work_submit_to_queue(struct k_work_q *work_q,
+				   struct k_work *work);
+#else
 static inline void k_work_submit_to_queue(struct k_work_q *work_q,
 					  struct k_work *work)
 {
@@ -1102,6 +1232,7 @@ static inline void k_work_submit_to_queue(struct k_work_q *work_q,
 		k_fifo_put(&work_q->fifo, work);
 	}
 }
+#endif
 
 /**
  * @brief Check if work item is pending.
@@ -1130,6 +1261,30 @@ static inline int k_work_pending(struct k_work *work)
 extern void k_work_q_start(struct k_work_q *work_q, char *stack,
 			   unsigned stack_size, unsigned prio);
 
+#ifdef CONFIG_WORKQUEUE_STATS
+/**
+ * @brief Read workqueue statistics.
+ *
+ * @param work_q Pointer to Work queue
+ * @param stats Buffer receiving a consistent snapshot of the statistics
+ *
+ * @return N/A
+ */
+extern void k_work_q_stats_get(struct k_work_q *work_q,
+			       struct k_work_q_stats *stats);
+
+/**
+ * @brief Reset workqueue statistics.
+ *
+ * The current depth is preserved, every other counter is cleared.
+ *
+ * @param work_q Pointer to Work queue
+ *
+ * @return N/A
+ */
+extern void k_work_q_stats_reset(struct k_work_q *work_q);
+#endif
+
 #if defined(CONFIG_SYS_CLOCK_EXISTS)
 
 /**
@@ -1332,6 +1487,7 @@ struct k_sem {
 	_wait_q_t wait_q;
 	unsigned int count;
 	unsigned int limit;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_sem);
 };
@@ -1414,6 +1570,7 @@ static inline unsigned int k_sem_count_get(struct k_sem *sem)
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
 	.count = initial_count, \
 	.limit = count_limit, \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -1545,6 +1702,7 @@ struct k_msgq {
 	char *read_ptr;
 	char *write_ptr;
 	uint32_t used_msgs;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_msgq);
 };
@@ -1559,6 +1717,7 @@ struct k_msgq {
 	.read_ptr = q_buffer, \
 	.write_ptr = q_buffer, \
 	.used_msgs = 0, \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -1890,6 +2049,8 @@ struct k_pipe {
 		_wait_q_t      writers; /* Writer wait queue */
 	} wait_q;
 
+	_POLL_EVENT;
+
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_pipe);
 };
 
@@ -1902,6 +2063,7 @@ struct k_pipe {
 	.write_index = 0,                                             \
 	.wait_q.writers = SYS_DLIST_STATIC_INIT(&obj.wait_q.writers), \
 	.wait_q.readers = SYS_DLIST_STATIC_INIT(&obj.wait_q.readers), \
+	_POLL_EVENT_OBJ_INIT                                          \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT                            \
 	}
 
@@ -2449,6 +2611,277 @@ extern void *k_malloc(size_t size);
  */
 extern void k_free(void *ptr);
 
+/* polling API - PRIVATE */
+
+/* private - implementation data created as needed, per-type */
+struct _poller {
+	struct k_thread *thread;
+	volatile int is_polling;
+};
+
+/* private - types bit positions */
+enum _poll_types_bits {
+	/* can be used to ignore an event */
+	_POLL_TYPE_IGNORE,
+
+	/* to be signaled by k_poll_signal() */
+	_POLL_TYPE_SIGNAL,
+
+	/* semaphore availability */
+	_POLL_TYPE_SEM_AVAILABLE,
+
+	/* fifo data availability */
+	_POLL_TYPE_FIFO_DATA_AVAILABLE,
+
+	/* message queue data availability */
+	_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+
+	/* pipe buffer data availability */
+	_POLL_TYPE_PIPE_DATA_AVAILABLE,
+
+	_POLL_NUM_TYPES
+};
+
+#define _POLL_TYPE_BIT(type) (1 << ((type) - 1))
+
+/* private - states bit positions */
+enum _poll_states_bits {
+	/* default state when creating event */
+	_POLL_STATE_NOT_READY,
+
+	/* there was another poller already on the object */
+	_POLL_STATE_EADDRINUSE,
+
+	/* signaled by k_poll_signal() */
+	_POLL_STATE_SIGNALED,
+
+	/* semaphore is available */
+	_POLL_STATE_SEM_AVAILABLE,
+
+	/* data is available to read on fifo */
+	_POLL_STATE_FIFO_DATA_AVAILABLE,
+
+	/* data is available to read on message queue */
+	_POLL_STATE_MSGQ_DATA_AVAILABLE,
+
+	/* data is available to read from pipe buffer */
+	_POLL_STATE_PIPE_DATA_AVAILABLE,
+
+	_POLL_NUM_STATES
+};
+
+#define _POLL_STATE_BIT(state) (1 << ((state) - 1))
+
+#define _POLL_EVENT_NUM_UNUSED_BITS \
+	(32 - (_POLL_NUM_TYPES + _POLL_NUM_STATES + 1 /* modes */))
+
+#if _POLL_EVENT_NUM_UNUSED_BITS < 0
+#error overflow of 32-bit word in struct k_poll_event
+#endif
+
+/* end of polling API - PRIVATE */
+
+
+/* polling API - PUBLIC */
+
+/* public - values for k_poll_event.type bitfield */
+#define K_POLL_TYPE_IGNORE 0
+#define K_POLL_TYPE_SIGNAL _POLL_TYPE_BIT(_POLL_TYPE_SIGNAL)
+#define K_POLL_TYPE_SEM_AVAILABLE _POLL_TYPE_BIT(_POLL_TYPE_SEM_AVAILABLE)
+#define K_POLL_TYPE_FIFO_DATA_AVAILABLE \
+	_POLL_TYPE_BIT(_POLL_TYPE_FIFO_DATA_AVAILABLE)
+#define K_POLL_TYPE_MSGQ_DATA_AVAILABLE \
+	_POLL_TYPE_BIT(_POLL_TYPE_MSGQ_DATA_AVAILABLE)
+#define K_POLL_TYPE_PIPE_DATA_AVAILABLE \
+	_POLL_TYPE_BIT(_POLL_TYPE_PIPE_DATA_AVAILABLE)
+
+/* public - polling modes */
+enum k_poll_modes {
+	/* polling thread does not take ownership of objects when available */
+	K_POLL_MODE_NOTIFY_ONLY = 0,
+
+	K_POLL_NUM_MODES
+};
+
+/* public - values for k_poll_event.state bitfield */
+#define K_POLL_STATE_NOT_READY 0
+#define K_POLL_STATE_EADDRINUSE _POLL_STATE_BIT(_POLL_STATE_EADDRINUSE)
+#define K_POLL_STATE_SIGNALED _POLL_STATE_BIT(_POLL_STATE_SIGNALED)
+#define K_POLL_STATE_SEM_AVAILABLE _POLL_STATE_BIT(_POLL_STATE_SEM_AVAILABLE)
+#define K_POLL_STATE_FIFO_DATA_AVAILABLE \
+	_POLL_STATE_BIT(_POLL_STATE_FIFO_DATA_AVAILABLE)
+#define K_POLL_STATE_MSGQ_DATA_AVAILABLE \
+	_POLL_STATE_BIT(_POLL_STATE_MSGQ_DATA_AVAILABLE)
+#define K_POLL_STATE_PIPE_DATA_AVAILABLE \
+	_POLL_STATE_BIT(_POLL_STATE_PIPE_DATA_AVAILABLE)
+
+/* public - poll signal object */
+struct k_poll_signal {
+	/* PRIVATE - DO NOT TOUCH */
+	struct k_poll_event *poll_event;
+
+	/*
+	 * 1 if the event has been signaled, 0 otherwise. Stays set to 1 until
+	 * user resets it to 0.
+	 */
+	unsigned int signaled;
+
+	/* custom result value passed to k_poll_signal() if needed */
+	int result;
+};
+
+#define K_POLL_SIGNAL_INITIALIZER() \
+	{ \
+	.poll_event = NULL, \
+	.signaled = 0, \
+	.result = 0, \
+	}
+
+struct k_poll_event {
+	/* PRIVATE - DO NOT TOUCH */
+	struct _poller *poller;
+
+	/* optional user-specified tag, opaque, untouched by the API */
+	uint32_t tag:8;
+
+	/* bitfield of event types (bitwise-ORed K_POLL_TYPE_xxx values) */
+	uint32_t type:_POLL_NUM_TYPES;
+
+	/* bitfield of event states (bitwise-ORed K_POLL_STATE_xxx values) */
+	uint32_t state:_POLL_NUM_STATES;
+
+	/* mode of operation, from enum k_poll_modes */
+	uint32_t mode:1;
+
+	/* unused bits in 32-bit word */
+	uint32_t unused:_POLL_EVENT_NUM_UNUSED_BITS;
+
+	/* per-type data */
+	union {
+		void *obj;
+		struct k_poll_signal *signal;
+		struct k_sem *sem;
+		struct k_fifo *fifo;
+		struct k_msgq *msgq;
+		struct k_pipe *pipe;
+	};
+};
+
+#define K_POLL_EVENT_INITIALIZER(event_type, event_mode, event_data) \
+	{ \
+	.poller = NULL, \
+	.type = event_type, \
+	.state = K_POLL_STATE_NOT_READY, \
+	.mode = event_mode, \
+	.unused = 0, \
+	.obj = event_data, \
+	}
+
+/**
+ * @brief Initialize one struct k_poll_event instance
+ *
+ * After this routine is called on a poll event, the event it ready to be
+ * placed in an event array to be passed to k_poll().
+ *
+ * @param event The event to initialize.
+ * @param type A bitfield of the types of event, from the K_POLL_TYPE_xxx
+ *             values. Only values that apply to the same object being polled
+ *             can be used together. Choosing K_POLL_TYPE_IGNORE disables the
+ *             event.
+ * @param mode Future. Use K_POLL_MODE_NOTIFY_ONLY.
+ * @param obj Kernel object or poll signal.
+ *
+ * @return N/A
+ */
+extern void k_poll_event_init(struct k_poll_event *event, uint32_t type,
+			      int mode, void *obj);
+
+/**
+ * @brief Wait for one or many of multiple poll events to occur
+ *
+ * This routine allows a thread to wait concurrently for one or many of
+ * multiple poll events to have occurred. Such events can be a kernel object
+ * being available, like a semaphore, or a poll signal event.
+ *
+ * When an event notifies that a kernel object is available, the kernel object
+ * is not "given" to the thread calling k_poll(): it merely signals the fact
+ * that the object was available when the k_poll() call was in effect. Also,
+ * all threads trying to acquire an object the regular way, i.e. by pending on
+ * the object, have precedence over the thread polling on the object. This
+ * means that the polling thread will never get the poll event on an object
+ * until the object becomes available and its pend queue is empty. For this
+ * reason, the k_poll() call is more effective when the objects being polled
+ * only have one thread, the polling thread, trying to acquire them.
+ *
+ * Only one thread can be polling for a particular object at a given time. If
+ * another thread tries to poll on it, the k_poll() call returns -EADDRINUSE
+ * and returns as soon as it has finished handling the other events. This means
+ * that k_poll() can return -EADDRINUSE and have the state value of some events
+ * be non-K_POLL_STATE_NOT_READY. When this condition occurs, the @a timeout
+ * parameter is ignored.
+ *
+ * When k_poll() returns 0 or -EADDRINUSE, the caller should loop on all the
+ * events that were passed to k_poll() and check the state field for the values
+ * that were expected and take the associated actions.
+ *
+ * Before being reused for another call to k_poll(), the user has to reset the
+ * state field to K_POLL_STATE_NOT_READY.
+ *
+ * @param events An array of pointers to events to be polled for.
+ * @param num_events The number of events in the array.
+ * @param timeout Waiting period for an event to be ready (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 One or more events are ready.
+ * @retval -EADDRINUSE One or more objects already had a poller.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+extern int k_poll(struct k_poll_event *events, int num_events,
+		  int32_t timeout);
+
+/**
+ * @brief Initialize a poll signal object.
+ *
+ * Ready a poll signal object to be signaled via k_poll_signal().
+ *
+ * @param signal A poll signal.
+ *
+ * @return N/A
+ */
+static inline void k_poll_signal_init(struct k_poll_signal *signal)
+{
+	signal->poll_event = NULL;
+	signal->signaled = 0;
+	/* signal->result is left unitialized */
+}
+
+/**
+ * @brief Signal a poll signal object.
+ *
+ * This routine makes ready a poll signal, which is basically a poll event of
+ * type K_POLL_TYPE_SIGNAL. If a thread was polling on that event, it will be
+ * made ready to run.
+ *
+ * A @a result value can be specified.
+ *
+ * The poll signal contains a 'signaled' field that, when set by
+ * k_poll_signal(), stays set until the user sets it back to 0. It thus has to
+ * be reset by the user before being passed again to k_poll() or k_poll() will
+ * consider it being signaled, and will return immediately.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param signal A poll signal.
+ * @param result The value to store in the result field of the signal.
+ *
+ * @retval 0 The signal was delivered successfully.
+ */
+extern int k_poll_signal(struct k_poll_signal *signal, int result);
+
+/* private internal function */
+extern int _handle_obj_poll_event(struct k_poll_event **obj_poll_event,
+				  uint32_t state);
+
 /*
  * legacy.h must be before arch/cpu.h to allow the ioapic/loapic drivers to
  * hook into the device subsystem, which itself uses nanokernel semaphores,
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Lock-free event trace ring.
+ */
+
+#ifndef __EVENT_TRACE_H__
+#define __EVENT_TRACE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* event IDs below 0x0100 are reserved for the kernel */
+#define SYS_TRACE_INT_LATENCY_EVENT_ID 0x0010
+
+/* maximum number of 32-bit arguments of an event */
+#define SYS_TRACE_MAX_ARGS 3
+
+#ifndef _ASMLANGUAGE
+
+#include <kernel.h>
+#include <atomic.h>
+
+/**
+ * @brief Event Trace
+ * @defgroup event_trace Event Trace
+ * @{
+ */
+
+/*
+ * Events are stored as records of 32-bit words: a header holding the event
+ * ID and the number of arguments, a cycle count timestamp and up to
+ * SYS_TRACE_MAX_ARGS arguments. Producers reserve space in the ring with an
+ * atomic compare-and-swap on the head index, so events can be recorded from
+ * any context without locking interrupts. A single reader consumes records
+ * from the tail index.
+ */
+struct sys_trace {
+	uint32_t *buf;
+	uint32_t size;
+	uint32_t watermark;
+	atomic_t head;
+	uint32_t tail;
+	atomic_t dropped;
+	atomic_t reader_waiting;
+	struct k_sem sem;
+};
+
+/**
+ * @brief An event read back from a trace ring.
+ */
+struct sys_trace_record {
+	uint16_t event_id;
+	uint8_t nargs;
+	uint32_t timestamp;
+	uint32_t args[SYS_TRACE_MAX_ARGS];
+};
+
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+/**
+ * Trace ring used for kernel events.
+ */
+extern struct sys_trace sys_k_trace;
+#endif
+
+/**
+ * @brief Initialize a trace ring.
+ *
+ * @param trace     Trace ring to be initialized.
+ * @param buffer    Buffer used to store the records.
+ * @param size      Size of the buffer in 32-bit words, a power of two.
+ * @param watermark Fill level, in 32-bit words, at which a waiting reader is
+ *                  woken up.
+ *
+ * @return N/A
+ */
+void sys_trace_init(struct sys_trace *trace, uint32_t *buffer, uint32_t size,
+		    uint32_t watermark);
+
+/**
+ * @brief Record an event.
+ *
+ * This routine can be called from any context, including ISRs and the
+ * kernel's context switch code. The event is dropped if the ring is full.
+ *
+ * @param trace    Trace ring.
+ * @param event_id Event ID.
+ * @param args     Event arguments.
+ * @param nargs    Number of arguments, at most SYS_TRACE_MAX_ARGS.
+ *
+ * @return N/A
+ */
+void sys_trace_event(struct sys_trace *trace, uint16_t event_id,
+		     const uint32_t *args, unsigned int nargs);
+
+/**
+ * @brief Record an event without arguments.
+ */
+static inline void sys_trace_event0(struct sys_trace *trace, uint16_t event_id)
+{
+	sys_trace_event(trace, event_id, NULL, 0);
+}
+
+/**
+ * @brief Record an event with one argument.
+ */
+static inline void sys_trace_event1(struct sys_trace *trace, uint16_t event_id,
+				    uint32_t arg0)
+{
+	sys_trace_event(trace, event_id, &arg0, 1);
+}
+
+/**
+ * @brief Record an event with two arguments.
+ */
+static inline void sys_trace_event2(struct sys_trace *trace, uint16_t event_id,
+				    uint32_t arg0, uint32_t arg1)
+{
+	uint32_t args[2] = { arg0, arg1 };
+
+	sys_trace_event(trace, event_id, args, 2);
+}
+
+/**
+ * @brief Record an event with three arguments.
+ */
+static inline void sys_trace_event3(struct sys_trace *trace, uint16_t event_id,
+				    uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+	uint32_t args[3] = { arg0, arg1, arg2 };
+
+	sys_trace_event(trace, event_id, args, 3);
+}
+
+/**
+ * @brief Read the oldest event from a trace ring.
+ *
+ * Only one thread may read from a given trace ring.
+ *
+ * @param trace  Trace ring.
+ * @param record Buffer receiving the event.
+ *
+ * @retval 1 If an event was read.
+ * @retval 0 If no complete event is available.
+ */
+int sys_trace_get(struct sys_trace *trace, struct sys_trace_record *record);
+
+/**
+ * @brief Wait until a trace ring reaches its watermark.
+ *
+ * The reader is woken up once by the first event that brings the ring to
+ * its watermark, instead of once per event. The routine may return before
+ * the watermark is reached.
+ *
+ * @param trace   Trace ring.
+ * @param timeout Waiting period in milliseconds, or one of the special
+ *                values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 If the watermark was reached.
+ * @retval -EAGAIN If the waiting period timed out.
+ */
+int sys_trace_wait(struct sys_trace *trace, int32_t timeout);
+
+/**
+ * @brief Get and clear the number of dropped events.
+ *
+ * @param trace Trace ring.
+ *
+ * @return Number of events dropped since the last call.
+ */
+static inline uint32_t sys_trace_dropped_get(struct sys_trace *trace)
+{
+	return atomic_clear(&trace->dropped);
+}
+
+/**
+ * @brief Drain a trace ring to the console.
+ *
+ * Every event is printed with printk() on a line of the form
+ * "TR <id> <timestamp> [<arg>...]", in hexadecimal, followed by a
+ * "TR-DROP <count>" line if events were dropped. The output can be turned
+ * into a timeline with scripts/trace_decode.py.
+ *
+ * @param trace Trace ring.
+ *
+ * @return N/A
+ */
+void sys_trace_dump(struct sys_trace *trace);
+
+/**
+ * @}
+ */
+
+#endif /* _ASMLANGUAGE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EVENT_TRACE_H__ */
@@ -411,6 +411,11 @@ struct net_buf {
 	/** Function to be called when the buffer is freed. */
 	void (*const destroy)(struct net_buf *buf);
 
+	/** Buffer owning the data storage, if the data of this buffer
+	 *  references another buffer (see net_buf_slice()), NULL otherwise.
+	 */
+	struct net_buf *owner;
+
 	/* Union for convenience access to the net_buf_simple members, also
 	 * preserving the old API.
 	 */
@@ -575,6 +580,9 @@ struct net_buf *net_buf_ref(struct net_buf *buf);
  *  @brief Duplicate buffer
  *
  *  Duplicate given buffer including any data and headers currently stored.
+ *  The data is copied, so the original buffer can be modified or reused
+ *  afterwards. Use net_buf_slice() instead to share the data of a buffer
+ *  that will not be modified anymore, e.g. to send it to several peers.
  *
  *  @param buf A valid pointer on a buffer
  *
@@ -582,6 +590,34 @@ struct net_buf *net_buf_ref(struct net_buf *buf);
  */
 struct net_buf *net_buf_clone(struct net_buf *buf);
 
+/**
+ *  @brief Create a buffer referencing the data of another buffer
+ *
+ *  Get a buffer from @a fifo whose data points to @a len bytes of the data
+ *  of @a buf, starting at @a offset, without copying them. The slice holds
+ *  a reference to the buffer owning the data storage, which is released
+ *  when the slice is freed, so @a buf can be unreferenced right away. A
+ *  slice of a slice references the original storage directly.
+ *
+ *  The data is shared: it must not be modified while slices of it exist.
+ *  Slices can be pulled from, and can be linked in fragment chains like
+ *  other buffers, but nothing can be added or pushed to them: their
+ *  headroom and tailroom are meaningless. The user data of a slice is its
+ *  own and is not initialized.
+ *
+ *  Since no data is stored in it, a slice can come from a pool with a
+ *  data size of zero.
+ *
+ *  @param fifo Free buffers FIFO to get the slice from.
+ *  @param buf A valid pointer on a buffer.
+ *  @param offset Offset of the slice in the data of @a buf.
+ *  @param len Length of the slice.
+ *
+ *  @return Slice or NULL if out of buffers.
+ */
+struct net_buf *net_buf_slice(struct k_fifo *fifo, struct net_buf *buf,
+			      size_t offset, size_t len);
+
 /**
  *  @brief Get a pointer to the user data of a buffer.
  *
@@ -881,6 +917,24 @@ struct net_buf *net_buf_frag_add(struct net_buf *head, struct net_buf *frag);
  */
 struct net_buf *net_buf_frag_del(struct net_buf *parent, struct net_buf *frag);
 
+/** @brief Create slices referencing the data of a fragment chain.
+ *
+ *  Same as net_buf_slice() for @a len bytes starting @a offset bytes into
+ *  the fragment chain @a buf: returns a chain with one slice for each
+ *  fragment the data spans, so a part of a packet can be shared without
+ *  copying it even when its data is scattered over several buffers.
+ *
+ *  @param fifo Free buffers FIFO to get the slices from.
+ *  @param buf First fragment of the chain.
+ *  @param offset Offset of the data in the chain.
+ *  @param len Length of the data, at least one byte.
+ *
+ *  @return Chain of slices, or NULL if out of buffers or if the chain
+ *          holds less than @a offset + @a len bytes.
+ */
+struct net_buf *net_buf_frags_slice(struct k_fifo *fifo, struct net_buf *buf,
+				    size_t offset, size_t len);
+
 /** @brief Calculate amount of bytes stored in fragments.
  *
  *  Calculates the total amount of data stored in the given buffer and the
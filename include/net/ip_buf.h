@@ -303,6 +303,30 @@ struct net_buf *ip_buf_get_reserve_rx(uint16_t reserve_head);
 struct net_buf *ip_buf_get_reserve_tx(uint16_t reserve_head);
 #endif
 
+/**
+ * @brief Get RX buffer from pool, waiting for one at most timeout.
+ *
+ * @details Same as ip_buf_get_reserve_rx(), for the code holding RX
+ * buffers that must not wait for the buffers it holds itself.
+ *
+ * @param reserve_head How many bytes to reserve for headroom.
+ * @param timeout K_NO_WAIT, K_FOREVER, or the number of milliseconds to
+ *        wait for a buffer.
+ *
+ * @return Network buffer if successful, NULL otherwise.
+ */
+#ifdef DEBUG_IP_BUFS
+#define ip_buf_get_reserve_rx_timeout(res, timeout)			\
+	ip_buf_get_reserve_rx_timeout_debug(res, timeout, __func__, __LINE__)
+struct net_buf *ip_buf_get_reserve_rx_timeout_debug(uint16_t reserve_head,
+						    int32_t timeout,
+						    const char *caller,
+						    int line);
+#else
+struct net_buf *ip_buf_get_reserve_rx_timeout(uint16_t reserve_head,
+					      int32_t timeout);
+#endif
+
 /**
  * @brief Place buffer back into the available buffers pool.
  *
@@ -29,6 +29,7 @@
  * @{
  */
 
+#include <errno.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <device.h>
@@ -98,10 +99,70 @@ typedef int (*spi_api_io)(struct device *dev,
 			  const void *tx_buf, uint32_t tx_buf_len,
 			  void *rx_buf, uint32_t rx_buf_len);
 
+struct spi_transaction;
+
+/**
+ * @typedef spi_callback_t
+ * @brief Completion callback of an asynchronous transaction
+ *
+ * Called from interrupt context once the transaction is done.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Completed transaction.
+ * @param status 0 on success, negative errno code on failure.
+ */
+typedef void (*spi_callback_t)(struct device *dev,
+			       struct spi_transaction *trans, int status);
+
+/**
+ * @brief Segment of a scatter-gather buffer set
+ *
+ * A NULL buf sends zeros, or discards the received frames, for len bytes.
+ */
+struct spi_buf {
+	void *buf;
+	uint32_t len;
+};
+
+/**
+ * @brief SPI asynchronous transaction
+ *
+ * Buffers are described as for spi_transceive(), or as sets of segments
+ * sent, or received, back to back: tx_bufs and rx_bufs, when not NULL,
+ * are used instead of tx_buf and rx_buf.
+ *
+ * Transactions can be chained through next before being submitted: they
+ * are then performed in order, each of them with its own chip select
+ * assertion and its own completion callback. A transaction, and its
+ * buffers, belong to the driver until its callback is called.
+ */
+struct spi_transaction {
+	struct spi_transaction *next;
+	const void *tx_buf;
+	uint32_t tx_buf_len;
+	void *rx_buf;
+	uint32_t rx_buf_len;
+	const struct spi_buf *tx_bufs;
+	uint32_t tx_count;
+	const struct spi_buf *rx_bufs;
+	uint32_t rx_count;
+	spi_callback_t callback;
+	void *user_data;
+};
+
+/**
+ * @typedef spi_api_io_async
+ * @brief Callback API for asynchronous I/O
+ * See spi_transceive_async() for argument descriptions
+ */
+typedef int (*spi_api_io_async)(struct device *dev,
+				struct spi_transaction *trans);
+
 struct spi_driver_api {
 	spi_api_configure configure;
 	spi_api_slave_select slave_select;
 	spi_api_io transceive;
+	spi_api_io_async transceive_async;
 };
 
 /**
@@ -202,6 +263,101 @@ static inline int spi_transceive(struct device *dev,
 	return api->transceive(dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
 }
 
+/**
+ * @brief Queue transactions without waiting for their completion.
+ *
+ * The transactions are appended to the queue of the controller and are
+ * performed, in order, with the configuration and slave selected at the
+ * time they start. Synchronous calls are queued the same way, so the
+ * configuration should not change before the queue is empty.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans First transaction of a chain terminated by a NULL next.
+ *
+ * @retval 0 If the transactions are queued.
+ * @retval -ENOTSUP If the driver only supports synchronous transfers.
+ * @retval Negative errno code if failure.
+ */
+static inline int spi_transceive_async(struct device *dev,
+				       struct spi_transaction *trans)
+{
+	const struct spi_driver_api *api = dev->driver_api;
+
+	if (!api->transceive_async) {
+		return -ENOTSUP;
+	}
+
+	return api->transceive_async(dev, trans);
+}
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+struct _spi_sync {
+	struct k_sem sem;
+	int status;
+};
+
+static inline void _spi_sync_done(struct device *dev,
+				  struct spi_transaction *trans, int status)
+{
+	struct _spi_sync *sync = trans->user_data;
+
+	sync->status = status;
+	k_sem_give(&sync->sem);
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Read and write sets of buffers in a single transfer.
+ *
+ * The segments of each set follow each other on the bus, with the chip
+ * select kept asserted, e.g. a command header from one buffer followed
+ * by data streamed into another. As many frames as the longest set are
+ * exchanged: zeros are sent after the last tx segment, frames received
+ * after the last rx segment are discarded.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param tx_bufs Segments to send.
+ * @param tx_count Number of segments to send.
+ * @param rx_bufs Segments to receive into.
+ * @param rx_count Number of segments to receive, 0 to ignore the input.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the driver only supports synchronous transfers.
+ * @retval Negative errno code if failure.
+ */
+static inline int spi_transceive_sg(struct device *dev,
+				    const struct spi_buf *tx_bufs,
+				    uint32_t tx_count,
+				    const struct spi_buf *rx_bufs,
+				    uint32_t rx_count)
+{
+	struct _spi_sync sync;
+	struct spi_transaction trans = {
+		.tx_bufs = tx_bufs,
+		.tx_count = tx_count,
+		.rx_bufs = rx_bufs,
+		.rx_count = rx_count,
+		.callback = _spi_sync_done,
+		.user_data = &sync,
+	};
+	int ret;
+
+	k_sem_init(&sync.sem, 0, 1);
+
+	ret = spi_transceive_async(dev, &trans);
+	if (ret) {
+		return ret;
+	}
+
+	k_sem_take(&sync.sem, K_FOREVER);
+
+	return sync.status;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Lock-free event trace ring.
+ */
+
+#include <misc/event_trace.h>
+#include <misc/__assert.h>
+#include <misc/printk.h>
+#include <init.h>
+#include <string.h>
+
+/*
+ * Record header: the valid bit is set last by the producer, once the rest
+ * of the record has been written, and consumed words are cleared by the
+ * reader, so a reserved but incomplete record is never read.
+ */
+#define HDR_VALID 0x80000000
+#define HDR_NARGS_SHIFT 16
+#define HDR_NARGS_MASK 0x3
+#define HDR_ID_MASK 0xffff
+
+#define HDR(id, nargs) (HDR_VALID | ((nargs) << HDR_NARGS_SHIFT) | (id))
+
+/* header and timestamp */
+#define RECORD_OVERHEAD 2
+
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+static uint32_t sys_k_trace_buffer[CONFIG_EVENT_TRACE_BUFFER_SIZE];
+
+struct sys_trace sys_k_trace;
+
+static int sys_k_trace_init(struct device *arg)
+{
+	ARG_UNUSED(arg);
+
+	sys_trace_init(&sys_k_trace, sys_k_trace_buffer,
+		       CONFIG_EVENT_TRACE_BUFFER_SIZE,
+		       CONFIG_EVENT_TRACE_WATERMARK);
+
+	return 0;
+}
+SYS_INIT(sys_k_trace_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+#endif /* CONFIG_EVENT_TRACE_KERNEL */
+
+void sys_trace_init(struct sys_trace *trace, uint32_t *buffer, uint32_t size,
+		    uint32_t watermark)
+{
+	__ASSERT((size & (size - 1)) == 0, "size must be a power of two");
+
+	memset(buffer, 0, size * sizeof(uint32_t));
+
+	trace->buf = buffer;
+	trace->size = size;
+	trace->watermark = watermark;
+	trace->head = 0;
+	trace->tail = 0;
+	trace->dropped = 0;
+	trace->reader_waiting = 0;
+	k_sem_init(&trace->sem, 0, 1);
+}
+
+void sys_trace_event(struct sys_trace *trace, uint16_t event_id,
+		     const uint32_t *args, unsigned int nargs)
+{
+	extern void _sem_give_non_preemptible(struct k_sem *sem);
+
+	uint32_t mask = trace->size - 1;
+	uint32_t len = RECORD_OVERHEAD + nargs;
+	atomic_val_t head;
+	unsigned int i;
+
+	__ASSERT(nargs <= SYS_TRACE_MAX_ARGS, "too many arguments");
+
+	/* no trace ring (yet) */
+	if (!trace->buf) {
+		return;
+	}
+
+	do {
+		head = atomic_get(&trace->head);
+
+		if ((uint32_t)head - trace->tail + len > trace->size) {
+			atomic_inc(&trace->dropped);
+			return;
+		}
+	} while (!atomic_cas(&trace->head, head, head + len));
+
+	trace->buf[(head + 1) & mask] = k_cycle_get_32();
+	for (i = 0; i < nargs; i++) {
+		trace->buf[(head + RECORD_OVERHEAD + i) & mask] = args[i];
+	}
+
+	barrier();
+
+	trace->buf[head & mask] = HDR(event_id, nargs);
+
+	if ((uint32_t)head + len - trace->tail >= trace->watermark &&
+	    atomic_cas(&trace->reader_waiting, 1, 0)) {
+		unsigned int key = irq_lock();
+
+		/*
+		 * Do not reschedule: events are recorded from within the
+		 * kernel, including from the context switch code.
+		 */
+		_sem_give_non_preemptible(&trace->sem);
+
+		irq_unlock(key);
+	}
+}
+
+int sys_trace_get(struct sys_trace *trace, struct sys_trace_record *record)
+{
+	uint32_t mask = trace->size - 1;
+	uint32_t tail = trace->tail;
+	uint32_t hdr;
+	uint32_t len;
+	unsigned int i;
+
+	if (tail == (uint32_t)atomic_get(&trace->head)) {
+		return 0;
+	}
+
+	hdr = trace->buf[tail & mask];
+	if (!(hdr & HDR_VALID)) {
+		/* the oldest record is still being written */
+		return 0;
+	}
+
+	record->event_id = hdr & HDR_ID_MASK;
+	record->nargs = (hdr >> HDR_NARGS_SHIFT) & HDR_NARGS_MASK;
+	len = RECORD_OVERHEAD + record->nargs;
+
+	record->timestamp = trace->buf[(tail + 1) & mask];
+	for (i = 0; i < record->nargs; i++) {
+		record->args[i] = trace->buf[(tail + RECORD_OVERHEAD + i) & mask];
+	}
+
+	for (i = 0; i < len; i++) {
+		trace->buf[(tail + i) & mask] = 0;
+	}
+
+	barrier();
+
+	trace->tail = tail + len;
+
+	return 1;
+}
+
+int sys_trace_wait(struct sys_trace *trace, int32_t timeout)
+{
+	atomic_set(&trace->reader_waiting, 1);
+
+	if ((uint32_t)atomic_get(&trace->head) - trace->tail >=
+	    trace->watermark) {
+		atomic_clear(&trace->reader_waiting);
+		return 0;
+	}
+
+	if (k_sem_take(&trace->sem, timeout)) {
+		atomic_clear(&trace->reader_waiting);
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+void sys_trace_dump(struct sys_trace *trace)
+{
+	struct sys_trace_record record;
+	uint32_t dropped;
+	unsigned int i;
+
+	while (sys_trace_get(trace, &record)) {
+		printk("TR %x %x", record.event_id, record.timestamp);
+		for (i = 0; i < record.nargs; i++) {
+			printk(" %x", record.args[i]);
+		}
+		printk("\n");
+	}
+
+	dropped = sys_trace_dropped_get(trace);
+	if (dropped) {
+		printk("TR-DROP %u\n", dropped);
+	}
+}
@@ -61,10 +61,26 @@ void k_fifo_init(struct k_fifo *fifo)
 {
 	sys_slist_init(&fifo->data_q);
 	sys_dlist_init(&fifo->wait_q);
+#ifdef CONFIG_POLL
+	fifo->poll_event = NULL;
+#endif
 
 	SYS_TRACING_OBJ_INIT(k_fifo, fifo);
 }
 
+/* returns 1 if a reschedule must take place, 0 otherwise */
+static inline int handle_poll_event(struct k_fifo *fifo)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
+
+	return fifo->poll_event ?
+	       _handle_obj_poll_event(&fifo->poll_event, state) : 0;
+#else
+	return 0;
+#endif
+}
+
 static void prepare_thread_to_run(struct k_thread *thread, void *data)
 {
 	_abort_thread_timeout(thread);
@@ -89,6 +105,10 @@ void k_fifo_put(struct k_fifo *fifo, void *data)
 		}
 	} else {
 		sys_slist_append(&fifo->data_q, data);
+		if (handle_poll_event(fifo)) {
+			(void)_Swap(key);
+			return;
+		}
 	}
 
 	irq_unlock(key);
@@ -111,6 +131,10 @@ void k_fifo_put_list(struct k_fifo *fifo, void *head, void *tail)
 
 	if (head) {
 		sys_slist_append_list(&fifo->data_q, head, tail);
+		if (handle_poll_event(fifo)) {
+			(void)_Swap(key);
+			return;
+		}
 	}
 
 	if (first_thread) {
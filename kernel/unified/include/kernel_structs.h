@@ -95,6 +95,17 @@ struct k_thread {
 	int errno_var;
 #endif
 
+#ifdef CONFIG_THREAD_STATS
+	/* execution statistics, updated on every context switch */
+	struct k_thread_stats stats;
+
+	/* cycle count when last switched in */
+	uint32_t switched_in;
+
+	/* cycle count when last made ready */
+	uint32_t ready_since;
+#endif
+
 	/* arch-specifics: must always be at the end */
 	struct _thread_arch arch;
 };
@@ -106,8 +117,13 @@ struct _ready_q {
 	/* next thread to run if known, NULL otherwise */
 	struct k_thread *cache;
 
+#if (K_NUM_PRIO_BITMAPS > 1)
+	/* bitmap of prio_bmap words that have at least one bit set */
+	uint32_t prio_bmap_summary;
+#endif
+
 	/* bitmap of priorities that contain at least one ready thread */
-	uint32_t prio_bmap[1];
+	uint32_t prio_bmap[K_NUM_PRIO_BITMAPS];
 
 	/* ready queues, one per priority */
 	sys_dlist_t q[K_NUM_PRIORITIES];
@@ -31,6 +31,9 @@ extern void _pend_thread(struct k_thread *thread,
 extern void _pend_current_thread(_wait_q_t *wait_q, int32_t timeout);
 extern void _move_thread_to_end_of_prio_q(struct k_thread *thread);
 extern struct k_thread *_get_next_ready_thread(void);
+#ifdef CONFIG_THREAD_STATS
+extern struct k_thread *_thread_stats_swap(void);
+#endif
 extern int __must_switch_threads(void);
 extern int32_t _ms_to_ticks(int32_t ms);
 extern void idle(void *, void *, void *);
@@ -167,17 +170,30 @@ static inline int _get_ready_q_q_index(int prio)
 	return prio + CONFIG_NUM_COOP_PRIORITIES;
 }
 
-#if (K_NUM_PRIORITIES > 32)
-	#error not supported yet
+#if (K_NUM_PRIO_BITMAPS > 32)
+	#error too many priorities (maximum is 1024)
 #endif
 
 /* find out the currently highest priority where a thread is ready to run */
 /* interrupts must be locked */
 static inline int _get_highest_ready_prio(void)
 {
+#if (K_NUM_PRIO_BITMAPS > 1)
+	/*
+	 * Two-level lookup: the summary word gives the first bitmap word that
+	 * has a ready priority, so the cost does not depend on the number of
+	 * priorities.
+	 */
+	int bmap_index = find_lsb_set(_ready_q.prio_bmap_summary) - 1;
+	uint32_t ready = _ready_q.prio_bmap[bmap_index];
+
+	return (bmap_index << 5) + find_lsb_set(ready) - 1 -
+	       CONFIG_NUM_COOP_PRIORITIES;
+#else
 	uint32_t ready = _ready_q.prio_bmap[0];
 
 	return find_lsb_set(ready) - 1 - CONFIG_NUM_COOP_PRIORITIES;
+#endif
 }
 
 /*
@@ -28,6 +28,9 @@
 #define K_NUM_PRIORITIES \
 	(CONFIG_NUM_COOP_PRIORITIES + CONFIG_NUM_PREEMPT_PRIORITIES + 1)
 
+/* number of 32-bit words in the ready queue priority bitmap */
+#define K_NUM_PRIO_BITMAPS ((K_NUM_PRIORITIES + 31) >> 5)
+
 #ifndef _ASMLANGUAGE
 
 #ifdef __cplusplus
@@ -79,6 +82,16 @@ extern void _thread_monitor_exit(struct k_thread *thread);
 	} while (0)
 #endif /* CONFIG_THREAD_MONITOR */
 
+/* reset the execution statistics of a new thread */
+
+#if defined(CONFIG_THREAD_STATS)
+extern void _thread_stats_init(struct k_thread *thread);
+#else
+#define _thread_stats_init(thread) \
+	do {/* nothing */    \
+	} while (0)
+#endif /* CONFIG_THREAD_STATS */
+
 #ifdef __cplusplus
 }
 #endif
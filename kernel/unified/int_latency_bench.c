@@ -23,6 +23,9 @@
 #include <misc/printk.h> /* printk */
 #include <sys_clock.h>
 #include <drivers/system_timer.h>
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+#include <misc/event_trace.h>
+#endif
 
 #define NB_CACHE_WARMING_DRY_RUN 7
 
@@ -109,8 +112,18 @@ void _int_latency_stop(void)
 			delta -= delayOverhead;
 
 		/* update max */
-		if (delta > int_locked_latency_max)
+		if (delta > int_locked_latency_max) {
 			int_locked_latency_max = delta;
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+			/*
+			 * Interrupts are still locked and int_locked_timestamp
+			 * is still set here, so the interrupt locking done by
+			 * the trace ring does not recurse into this routine.
+			 */
+			sys_trace_event1(&sys_k_trace,
+					 SYS_TRACE_INT_LATENCY_EVENT_ID, delta);
+#endif
+		}
 
 		/* update min */
 		if (delta < int_locked_latency_min)
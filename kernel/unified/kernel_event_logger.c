@@ -26,6 +26,7 @@
 #include <kernel_structs.h>
 #include <kernel_event_logger_arch.h>
 #include <misc/__assert.h>
+#include <misc/event_trace.h>
 
 uint32_t _sys_k_event_logger_buffer[CONFIG_KERNEL_EVENT_LOGGER_BUFFER_SIZE];
 
@@ -82,6 +83,7 @@ void sys_k_event_logger_put_timed(uint16_t event_id)
 void _sys_k_event_logger_context_switch(void)
 {
 	extern struct _kernel _kernel;
+#ifndef CONFIG_EVENT_TRACE_KERNEL
 	uint32_t data[2];
 
 	extern void _sys_event_logger_put_non_preemptible(
@@ -89,6 +91,7 @@ void _sys_k_event_logger_context_switch(void)
 		uint16_t event_id,
 		uint32_t *event_data,
 		uint8_t data_size);
+#endif
 
 	const int event_id = KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID;
 
@@ -96,6 +99,9 @@ void _sys_k_event_logger_context_switch(void)
 		return;
 	}
 
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+	sys_trace_event1(&sys_k_trace, event_id, (uint32_t)_kernel.current);
+#else
 	/* if the kernel event logger has not been initialized, do nothing */
 	if (sys_k_event_logger.ring_buf.buf == NULL) {
 		return;
@@ -128,6 +134,7 @@ void _sys_k_event_logger_context_switch(void)
 	_sys_event_logger_put_non_preemptible(&sys_k_event_logger,
 		KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, data,
 		ARRAY_SIZE(data));
+#endif /* CONFIG_EVENT_TRACE_KERNEL */
 }
 
 #define ASSERT_CURRENT_IS_COOP_THREAD() \
@@ -145,12 +152,18 @@ void sys_k_event_logger_register_as_collector(void)
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
 void _sys_k_event_logger_interrupt(void)
 {
+#ifndef CONFIG_EVENT_TRACE_KERNEL
 	uint32_t data[2];
+#endif
 
 	if (!sys_k_must_log_event(KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID)) {
 		return;
 	}
 
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+	sys_trace_event1(&sys_k_trace, KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID,
+			 _sys_current_irq_key_get());
+#else
 	/* if the kernel event logger has not been initialized, we do nothing */
 	if (sys_k_event_logger.ring_buf.buf == NULL) {
 		return;
@@ -161,6 +174,7 @@ void _sys_k_event_logger_interrupt(void)
 
 	sys_k_event_logger_put(KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID, data,
 		ARRAY_SIZE(data));
+#endif /* CONFIG_EVENT_TRACE_KERNEL */
 }
 #endif /* CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT */
 
@@ -197,8 +211,14 @@ void _sys_k_event_logger_exit_sleep(void)
 		 */
 		_sys_k_event_logger_sleep_start_time = 0;
 
+#ifdef CONFIG_EVENT_TRACE_KERNEL
+		sys_trace_event2(&sys_k_trace,
+				 KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID,
+				 data[1], data[2]);
+#else
 		sys_k_event_logger_put(KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID, data,
 			ARRAY_SIZE(data));
+#endif
 	}
 }
 #endif /* CONFIG_KERNEL_EVENT_LOGGER_SLEEP */
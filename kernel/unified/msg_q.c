@@ -67,9 +67,25 @@ void k_msgq_init(struct k_msgq *q, char *buffer,
 	q->write_ptr = buffer;
 	q->used_msgs = 0;
 	sys_dlist_init(&q->wait_q);
+#ifdef CONFIG_POLL
+	q->poll_event = NULL;
+#endif
 	SYS_TRACING_OBJ_INIT(k_msgq, q);
 }
 
+/* returns 1 if a reschedule must take place, 0 otherwise */
+static inline int handle_poll_event(struct k_msgq *q)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_MSGQ_DATA_AVAILABLE;
+
+	return q->poll_event ?
+	       _handle_obj_poll_event(&q->poll_event, state) : 0;
+#else
+	return 0;
+#endif
+}
+
 int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 {
 	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
@@ -101,6 +117,10 @@ int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 				q->write_ptr = q->buffer_start;
 			}
 			q->used_msgs++;
+			if (handle_poll_event(q)) {
+				_Swap(key);
+				return 0;
+			}
 		}
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
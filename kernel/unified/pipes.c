@@ -143,6 +143,9 @@ void k_pipe_init(struct k_pipe *pipe, unsigned char *buffer, size_t size)
 	pipe->write_index = 0;
 	sys_dlist_init(&pipe->wait_q.writers);
 	sys_dlist_init(&pipe->wait_q.readers);
+#ifdef CONFIG_POLL
+	pipe->poll_event = NULL;
+#endif
 	SYS_TRACING_OBJ_INIT(k_pipe, pipe);
 }
 
@@ -388,6 +391,28 @@ static void _pipe_thread_ready(struct k_thread *thread)
 	irq_unlock(key);
 }
 
+/**
+ * @brief Notify a thread polling for data on the pipe buffer
+ *
+ * The scheduler must be locked: the polling thread is made ready, and runs
+ * once the caller unlocks the scheduler.
+ */
+static void _pipe_poll_notify(struct k_pipe *pipe)
+{
+#ifdef CONFIG_POLL
+	unsigned int key = irq_lock();
+
+	if (pipe->poll_event && pipe->bytes_used > 0) {
+		(void)_handle_obj_poll_event(&pipe->poll_event,
+					     K_POLL_STATE_PIPE_DATA_AVAILABLE);
+	}
+
+	irq_unlock(key);
+#else
+	ARG_UNUSED(pipe);
+#endif
+}
+
 /**
  * @brief Internal API used to send data to a pipe
  */
@@ -481,6 +506,8 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 		_pipe_buffer_put(pipe, data + num_bytes_written,
 				 bytes_to_write - num_bytes_written);
 
+	_pipe_poll_notify(pipe);
+
 	if (num_bytes_written == bytes_to_write) {
 		*bytes_written = num_bytes_written;
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
@@ -646,6 +673,8 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 		desc->bytes_to_xfer  -= bytes_copied;
 	}
 
+	_pipe_poll_notify(pipe);
+
 	if (num_bytes_read == bytes_to_read) {
 		k_sched_unlock();
 
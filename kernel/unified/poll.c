@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Kernel asynchronous event polling interface.
+ *
+ * This polling mechanism allows waiting on multiple events concurrently,
+ * either events triggered directly, or from kernel objects or other kernel
+ * constructs.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <misc/slist.h>
+#include <misc/dlist.h>
+#include <misc/__assert.h>
+
+void k_poll_event_init(struct k_poll_event *event, uint32_t type,
+		       int mode, void *obj)
+{
+	__ASSERT(mode == K_POLL_MODE_NOTIFY_ONLY,
+		 "only NOTIFY_ONLY mode is supported\n");
+	__ASSERT(type < (1 << _POLL_NUM_TYPES), "invalid type\n");
+	__ASSERT(obj, "must provide an object\n");
+
+	event->poller = NULL;
+	/* event->tag is left uninitialized: the user will set it if needed */
+	event->type = type;
+	event->state = K_POLL_STATE_NOT_READY;
+	event->mode = mode;
+	event->unused = 0;
+	event->obj = obj;
+}
+
+/* must be called with interrupts locked */
+static inline int is_condition_met(struct k_poll_event *event, uint32_t *state)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		if (k_sem_count_get(event->sem) > 0) {
+			*state = K_POLL_STATE_SEM_AVAILABLE;
+			return 1;
+		}
+		break;
+	case K_POLL_TYPE_FIFO_DATA_AVAILABLE:
+		if (!sys_slist_is_empty(&event->fifo->data_q)) {
+			*state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
+			return 1;
+		}
+		break;
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		if (event->msgq->used_msgs > 0) {
+			*state = K_POLL_STATE_MSGQ_DATA_AVAILABLE;
+			return 1;
+		}
+		break;
+	case K_POLL_TYPE_PIPE_DATA_AVAILABLE:
+		if (event->pipe->bytes_used > 0) {
+			*state = K_POLL_STATE_PIPE_DATA_AVAILABLE;
+			return 1;
+		}
+		break;
+	case K_POLL_TYPE_SIGNAL:
+		if (event->signal->signaled) {
+			*state = K_POLL_STATE_SIGNALED;
+			return 1;
+		}
+		break;
+	case K_POLL_TYPE_IGNORE:
+		return 0;
+	default:
+		__ASSERT(0, "invalid event type (0x%x)\n", event->type);
+		break;
+	}
+
+	return 0;
+}
+
+/* must be called with interrupts locked */
+static inline struct k_poll_event **obj_poll_event(struct k_poll_event *event)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		__ASSERT(event->sem, "invalid semaphore\n");
+		return &event->sem->poll_event;
+	case K_POLL_TYPE_FIFO_DATA_AVAILABLE:
+		__ASSERT(event->fifo, "invalid fifo\n");
+		return &event->fifo->poll_event;
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		__ASSERT(event->msgq, "invalid message queue\n");
+		return &event->msgq->poll_event;
+	case K_POLL_TYPE_PIPE_DATA_AVAILABLE:
+		__ASSERT(event->pipe, "invalid pipe\n");
+		return &event->pipe->poll_event;
+	case K_POLL_TYPE_SIGNAL:
+		__ASSERT(event->signal, "invalid poll signal\n");
+		return &event->signal->poll_event;
+	case K_POLL_TYPE_IGNORE:
+		/* nothing to do */
+		return NULL;
+	default:
+		__ASSERT(0, "invalid event type\n");
+		return NULL;
+	}
+}
+
+/* must be called with interrupts locked */
+static inline int register_event(struct k_poll_event *event)
+{
+	struct k_poll_event **slot = obj_poll_event(event);
+
+	if (!slot) {
+		return 0;
+	}
+
+	if (*slot) {
+		return -EADDRINUSE;
+	}
+
+	*slot = event;
+
+	return 0;
+}
+
+/* must be called with interrupts locked */
+static inline void clear_event_registration(struct k_poll_event *event)
+{
+	struct k_poll_event **slot = obj_poll_event(event);
+
+	event->poller = NULL;
+
+	/* the object may since have been handed to another poller */
+	if (slot && *slot == event) {
+		*slot = NULL;
+	}
+}
+
+/* must be called with interrupts locked */
+static inline void clear_event_registrations(struct k_poll_event *events,
+					      int last_registered,
+					      unsigned int key)
+{
+	for (; last_registered >= 0; last_registered--) {
+		clear_event_registration(&events[last_registered]);
+		irq_unlock(key);
+		key = irq_lock();
+	}
+}
+
+static inline void set_event_ready(struct k_poll_event *event, uint32_t state)
+{
+	event->poller = NULL;
+	event->state |= state;
+}
+
+int k_poll(struct k_poll_event *events, int num_events, int32_t timeout)
+{
+	__ASSERT(!_is_in_isr(), "");
+	__ASSERT(events, "NULL events\n");
+	__ASSERT(num_events > 0, "zero events\n");
+
+	int last_registered = -1, in_use = 0, rc;
+	unsigned int key;
+
+	struct _poller poller = { .thread = _current, .is_polling = 1, };
+
+	/* find events whose condition is already fulfilled */
+	for (int ii = 0; ii < num_events; ii++) {
+		uint32_t state;
+
+		key = irq_lock();
+		if (is_condition_met(&events[ii], &state)) {
+			set_event_ready(&events[ii], state);
+			poller.is_polling = 0;
+		} else if (timeout != K_NO_WAIT && poller.is_polling &&
+			   !in_use) {
+			rc = register_event(&events[ii]);
+			if (rc == 0) {
+				events[ii].poller = &poller;
+				++last_registered;
+			} else if (rc == -EADDRINUSE) {
+				/*
+				 * Setting in_use also prevents any further
+				 * registrations by the current thread.
+				 */
+				in_use = -EADDRINUSE;
+				events[ii].state = K_POLL_STATE_EADDRINUSE;
+				poller.is_polling = 0;
+			} else {
+				__ASSERT(0, "unexpected return code\n");
+			}
+		}
+		irq_unlock(key);
+	}
+
+	key = irq_lock();
+
+	/*
+	 * If we're not polling anymore, it means that at least one event
+	 * condition is met, either when looping through the events here or
+	 * because one of the events registered has had its state changed, or
+	 * that one of the objects we wanted to poll on already had a thread
+	 * polling on it. We can remove all registrations and return either
+	 * success or a -EADDRINUSE error. In the case of a -EADDRINUSE error,
+	 * the events that were available are still flagged as such, and it is
+	 * valid for the caller to consider them available, as if this function
+	 * returned success.
+	 */
+	if (!poller.is_polling) {
+		clear_event_registrations(events, last_registered, key);
+		irq_unlock(key);
+		return in_use;
+	}
+
+	poller.is_polling = 0;
+
+	if (timeout == K_NO_WAIT) {
+		irq_unlock(key);
+		return -EAGAIN;
+	}
+
+	_wait_q_t wait_q;
+
+	sys_dlist_init(&wait_q);
+
+	_pend_current_thread(&wait_q, timeout);
+
+	int swap_rc = _Swap(key);
+
+	/*
+	 * Clear all event registrations. If events happen while we're in this
+	 * loop, and we already had one that triggered, that's OK: they will
+	 * end up in the list of events that are ready; if we timed out, and
+	 * events happen while we're in this loop, that is OK as well since
+	 * we've already know the return code (-EAGAIN), and even if they are
+	 * added to the list of events that occurred, the user has to check the
+	 * return code first, which invalidates the whole list of event states.
+	 */
+	key = irq_lock();
+	clear_event_registrations(events, last_registered, key);
+	irq_unlock(key);
+
+	return swap_rc;
+}
+
+/* must be called with interrupts locked */
+static int _signal_poll_event(struct k_poll_event *event, uint32_t state,
+			      int *must_reschedule)
+{
+	*must_reschedule = 0;
+
+	if (!event->poller) {
+		goto ready_event;
+	}
+
+	struct k_thread *thread = event->poller->thread;
+
+	__ASSERT(event->poller->thread, "poller should have a thread\n");
+
+	event->poller->is_polling = 0;
+
+	/*
+	 * A thread whose timeout has expired has already been unpended by the
+	 * timeout handler: it will see -EAGAIN but still find the event ready.
+	 */
+	if (!_is_thread_pending(thread)) {
+		goto ready_event;
+	}
+
+	_unpend_thread(thread);
+	_abort_thread_timeout(thread);
+	_ready_thread(thread);
+	_set_thread_return_value(thread, 0);
+
+	*must_reschedule = !_is_in_isr() && _must_switch_threads();
+
+ready_event:
+	set_event_ready(event, state);
+	return 0;
+}
+
+/*
+ * Hand the event registered on a kernel object its new state and wake up the
+ * polling thread if it is pending.
+ *
+ * *obj_poll_event is guaranteed to not be NULL.
+ *
+ * Must be called with interrupts locked.
+ *
+ * @return 1 if a reschedule must take place, 0 otherwise
+ */
+int _handle_obj_poll_event(struct k_poll_event **obj_poll_event,
+			   uint32_t state)
+{
+	struct k_poll_event *poll_event = *obj_poll_event;
+	int must_reschedule;
+
+	*obj_poll_event = NULL;
+	(void)_signal_poll_event(poll_event, state, &must_reschedule);
+	return must_reschedule;
+}
+
+int k_poll_signal(struct k_poll_signal *signal, int result)
+{
+	unsigned int key = irq_lock();
+	int must_reschedule;
+
+	signal->result = result;
+	signal->signaled = 1;
+
+	if (!signal->poll_event) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	int rc = _signal_poll_event(signal->poll_event, K_POLL_STATE_SIGNALED,
+				    &must_reschedule);
+
+	signal->poll_event = NULL;
+
+	if (must_reschedule) {
+		(void)_Swap(key);
+	} else {
+		irq_unlock(key);
+	}
+
+	return rc;
+}
@@ -30,6 +30,10 @@ static void _set_ready_q_prio_bit(int prio)
 	uint32_t *bmap = &_ready_q.prio_bmap[bmap_index];
 
 	*bmap |= _get_ready_q_prio_bit(prio);
+
+#if (K_NUM_PRIO_BITMAPS > 1)
+	_ready_q.prio_bmap_summary |= (1 << bmap_index);
+#endif
 }
 
 /* clear the bit corresponding to prio in ready q bitmap */
@@ -39,6 +43,12 @@ static void _clear_ready_q_prio_bit(int prio)
 	uint32_t *bmap = &_ready_q.prio_bmap[bmap_index];
 
 	*bmap &= ~_get_ready_q_prio_bit(prio);
+
+#if (K_NUM_PRIO_BITMAPS > 1)
+	if (!*bmap) {
+		_ready_q.prio_bmap_summary &= ~(1 << bmap_index);
+	}
+#endif
 }
 
 /*
@@ -59,6 +69,10 @@ void _add_thread_to_ready_q(struct k_thread *thread)
 	_set_ready_q_prio_bit(thread->base.prio);
 	sys_dlist_append(q, &thread->base.k_q_node);
 
+#ifdef CONFIG_THREAD_STATS
+	thread->ready_since = k_cycle_get_32();
+#endif
+
 	struct k_thread **cache = &_ready_q.cache;
 
 	*cache = *cache && _is_prio_higher(thread->base.prio,
@@ -348,7 +362,9 @@ k_tid_t k_current_get(void)
 /* debug aid */
 void _dump_ready_q(void)
 {
-	K_DEBUG("bitmap: %x\n", _ready_q.prio_bmap[0]);
+	for (int i = 0; i < K_NUM_PRIO_BITMAPS; i++) {
+		K_DEBUG("bitmap[%d]: %x\n", i, _ready_q.prio_bmap[i]);
+	}
 	for (int prio = 0; prio < K_NUM_PRIORITIES; prio++) {
 		K_DEBUG("prio: %d, head: %p\n",
 			prio - CONFIG_NUM_COOP_PRIORITIES,
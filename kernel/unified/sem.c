@@ -83,6 +83,9 @@ void k_sem_init(struct k_sem *sem, unsigned int initial_count,
 	sem->count = initial_count;
 	sem->limit = limit;
 	sys_dlist_init(&sem->wait_q);
+#ifdef CONFIG_POLL
+	sem->poll_event = NULL;
+#endif
 	SYS_TRACING_OBJ_INIT(k_sem, sem);
 }
 
@@ -239,6 +242,19 @@ static int handle_sem_group(struct k_sem *sem, struct k_thread *thread)
 #define handle_sem_group(sem, thread) 0
 #endif
 
+/* returns 1 if a reschedule must take place, 0 otherwise */
+static inline int handle_poll_event(struct k_sem *sem)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_SEM_AVAILABLE;
+
+	return sem->poll_event ?
+	       _handle_obj_poll_event(&sem->poll_event, state) : 0;
+#else
+	return 0;
+#endif
+}
+
 /**
  * @brief Common semaphore give code
  *
@@ -256,7 +272,7 @@ static bool sem_give_common(struct k_sem *sem)
 		 * its limit has already been reached.
 		 */
 		sem->count += (sem->count != sem->limit);
-		return false;
+		return handle_poll_event(sem);
 	}
 
 	_abort_thread_timeout(thread);
@@ -288,6 +304,7 @@ void _sem_give_non_preemptible(struct k_sem *sem)
 	if (!thread) {
 		/* increment semaphore's count unless limit is reached */
 		sem->count += (sem->count != sem->limit);
+		(void)handle_poll_event(sem);
 		return;
 	}
 
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * Per-thread execution time accounting
+ */
+
+#include <string.h>
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <ksched.h>
+
+/*
+ * Called by the architecture's _new_thread(): the thread structure sits at
+ * the base of a stack that is not zeroed, or is filled under
+ * CONFIG_INIT_STACKS, so the statistics must not start from its contents.
+ */
+void _thread_stats_init(struct k_thread *thread)
+{
+	memset(&thread->stats, 0, sizeof(thread->stats));
+	thread->switched_in = k_cycle_get_32();
+	thread->ready_since = thread->switched_in;
+}
+
+/*
+ * Called by the architecture's context switch code in place of
+ * _get_next_ready_thread(), while _current is still the outgoing thread.
+ *
+ * Must be called with interrupts locked.
+ */
+struct k_thread *_thread_stats_swap(void)
+{
+	struct k_thread *old = _current;
+	struct k_thread *new = _get_next_ready_thread();
+	uint32_t now;
+
+	if (new == old) {
+		return new;
+	}
+
+	now = k_cycle_get_32();
+
+	old->stats.run_time += now - old->switched_in;
+	if (_is_thread_ready(old)) {
+		old->stats.preemptions++;
+		old->ready_since = now;
+	} else {
+		old->stats.voluntary_switches++;
+	}
+
+	new->stats.ready_time += now - new->ready_since;
+	new->switched_in = now;
+
+	return new;
+}
+
+void k_thread_stats_get(k_tid_t thread, struct k_thread_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	*stats = thread->stats;
+
+	if (thread == _current) {
+		stats->run_time += k_cycle_get_32() - thread->switched_in;
+	}
+
+	irq_unlock(key);
+}
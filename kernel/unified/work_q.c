@@ -23,7 +23,213 @@
 
 #include <kernel_structs.h>
 #include <wait_q.h>
+#include <ksched.h>
 #include <errno.h>
+#include <string.h>
+
+#ifdef CONFIG_WORKQUEUE_BATCH
+
+#define BATCH_MAX_CYCLES ((uint32_t)((uint64_t)CONFIG_WORKQUEUE_BATCH_MAX_US * \
+				     sys_clock_hw_cycles_per_sec / USEC_PER_SEC))
+
+void k_work_submit_to_queue(struct k_work_q *work_q, struct k_work *work)
+{
+	struct k_thread *thread;
+	unsigned int key;
+
+	if (atomic_test_and_set_bit(work->flags, K_WORK_STATE_PENDING)) {
+		return;
+	}
+
+	key = irq_lock();
+
+#ifdef CONFIG_WORKQUEUE_STATS
+	work->submit_time = k_cycle_get_32();
+	work_q->stats.submitted++;
+	if (++work_q->stats.depth > work_q->stats.max_depth) {
+		work_q->stats.max_depth = work_q->stats.depth;
+	}
+#endif
+
+	sys_slist_append(&work_q->lanes[work->lane], (sys_snode_t *)work);
+
+	thread = _unpend_first_thread(&work_q->wait_q);
+	if (thread) {
+		_abort_thread_timeout(thread);
+		_ready_thread(thread);
+		_set_thread_return_value(thread, 0);
+
+		if (!_is_in_isr() && _must_switch_threads()) {
+			(void)_Swap(key);
+			return;
+		}
+	}
+
+	irq_unlock(key);
+}
+
+/* Must be called with interrupts locked */
+static struct k_work *work_q_next(struct k_work_q *work_q)
+{
+	int lane;
+
+	for (lane = 0; lane < CONFIG_WORKQUEUE_NUM_LANES; lane++) {
+		if (!sys_slist_is_empty(&work_q->lanes[lane])) {
+			return (struct k_work *)
+				sys_slist_get_not_empty(&work_q->lanes[lane]);
+		}
+	}
+
+	return NULL;
+}
+
+static void work_q_process(struct k_work_q *work_q, struct k_work *work)
+{
+	k_work_handler_t handler = work->handler;
+#ifdef CONFIG_WORKQUEUE_STATS
+	uint32_t start = k_cycle_get_32();
+	uint32_t latency = start - work->submit_time;
+	uint32_t runtime;
+	unsigned int key;
+#endif
+
+	/* Reset pending state so it can be resubmitted by handler */
+	if (atomic_test_and_clear_bit(work->flags, K_WORK_STATE_PENDING)) {
+		handler(work);
+	}
+
+#ifdef CONFIG_WORKQUEUE_STATS
+	runtime = k_cycle_get_32() - start;
+
+	key = irq_lock();
+
+	work_q->stats.processed++;
+	work_q->stats.total_latency += latency;
+	work_q->stats.total_runtime += runtime;
+	if (latency > work_q->stats.max_latency) {
+		work_q->stats.max_latency = latency;
+	}
+	if (runtime > work_q->stats.max_runtime) {
+		work_q->stats.max_runtime = runtime;
+	}
+
+	irq_unlock(key);
+#endif
+}
+
+static void work_q_main(void *work_q_ptr, void *p2, void *p3)
+{
+	struct k_work_q *work_q = work_q_ptr;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		struct k_work *work;
+		unsigned int key;
+		uint32_t start;
+		int count;
+
+		key = irq_lock();
+
+		work = work_q_next(work_q);
+		if (!work) {
+			_pend_current_thread(&work_q->wait_q, K_FOREVER);
+			(void)_Swap(key);
+			continue;
+		}
+
+		irq_unlock(key);
+
+		start = k_cycle_get_32();
+		count = 0;
+
+		/*
+		 * Drain several items per wakeup, highest priority lane
+		 * first, but stop once the item or time budget is spent so
+		 * that a steady backlog does not starve other threads.
+		 */
+		while (1) {
+#ifdef CONFIG_WORKQUEUE_STATS
+			key = irq_lock();
+			work_q->stats.depth--;
+			irq_unlock(key);
+#endif
+			work_q_process(work_q, work);
+
+			if (++count >= CONFIG_WORKQUEUE_BATCH_MAX_ITEMS) {
+				break;
+			}
+
+			if (CONFIG_WORKQUEUE_BATCH_MAX_US &&
+			    k_cycle_get_32() - start >= BATCH_MAX_CYCLES) {
+				break;
+			}
+
+			key = irq_lock();
+			work = work_q_next(work_q);
+			irq_unlock(key);
+
+			if (!work) {
+				break;
+			}
+		}
+
+#ifdef CONFIG_WORKQUEUE_STATS
+		key = irq_lock();
+		work_q->stats.batches++;
+		irq_unlock(key);
+#endif
+
+		/* Make sure we don't hog up the CPU if the lanes never (or
+		 * very rarely) get empty.
+		 */
+		k_yield();
+	}
+}
+
+void k_work_q_start(struct k_work_q *work_q, char *stack,
+		    unsigned stack_size, unsigned prio)
+{
+	int lane;
+
+	for (lane = 0; lane < CONFIG_WORKQUEUE_NUM_LANES; lane++) {
+		sys_slist_init(&work_q->lanes[lane]);
+	}
+	sys_dlist_init(&work_q->wait_q);
+
+#ifdef CONFIG_WORKQUEUE_STATS
+	memset(&work_q->stats, 0, sizeof(work_q->stats));
+#endif
+
+	k_thread_spawn(stack, stack_size,
+		       work_q_main, work_q, 0, 0,
+		       prio, 0, 0);
+}
+
+#ifdef CONFIG_WORKQUEUE_STATS
+void k_work_q_stats_get(struct k_work_q *work_q, struct k_work_q_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	*stats = work_q->stats;
+
+	irq_unlock(key);
+}
+
+void k_work_q_stats_reset(struct k_work_q *work_q)
+{
+	unsigned int key = irq_lock();
+	uint32_t depth = work_q->stats.depth;
+
+	memset(&work_q->stats, 0, sizeof(work_q->stats));
+	work_q->stats.depth = depth;
+
+	irq_unlock(key);
+}
+#endif /* CONFIG_WORKQUEUE_STATS */
+
+#else
 
 static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 {
@@ -63,6 +269,8 @@ void k_work_q_start(struct k_work_q *work_q, char *stack,
 		       prio, 0, 0);
 }
 
+#endif /* CONFIG_WORKQUEUE_BATCH */
+
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 static void work_timeout(struct _timeout *t)
 {
@@ -39,6 +39,9 @@ struct option_context {
 
 #define BASIC_HEADER_SIZE 4
 
+/* Longest request path that can be matched against a resource */
+#define MAX_PATH_SEGMENTS 16
+
 static uint8_t coap_option_header_get_delta(uint8_t buf)
 {
 	return (buf & 0xF0) >> 4;
@@ -78,7 +81,7 @@ static int decode_delta(int num, const uint8_t *buf, int16_t buflen,
 			return -EINVAL;
 		}
 
-		num = sys_be16_to_cpu((uint16_t)*buf) + 269;
+		num = sys_get_be16(buf) + 269;
 		hdrlen += 2;
 		break;
 	case 15:
@@ -149,6 +152,22 @@ static int coap_parse_option(const struct zoap_packet *pkt,
 	return context->used;
 }
 
+static void coap_index_option(struct zoap_packet *pkt, uint16_t code,
+			      const uint8_t *value, uint16_t len)
+{
+	struct zoap_option_entry *entry;
+
+	if (pkt->optcount < CONFIG_ZOAP_OPTION_INDEX_SIZE) {
+		entry = &pkt->options[pkt->optcount];
+		entry->code = code;
+		entry->offset = value - (uint8_t *)ip_buf_appdata(pkt->buf);
+		entry->len = len;
+	}
+
+	pkt->optcount++;
+	pkt->last_code = code;
+}
+
 static int coap_parse_options(struct zoap_packet *pkt, unsigned int offset)
 {
 	struct net_buf *buf = pkt->buf;
@@ -160,7 +179,9 @@ static int coap_parse_options(struct zoap_packet *pkt, unsigned int offset)
 		.buf = &appdata[offset] };
 
 	while (true) {
-		int r = coap_parse_option(pkt, &context, NULL, NULL);
+		uint8_t *value;
+		uint16_t len;
+		int r = coap_parse_option(pkt, &context, &value, &len);
 
 		if (r < 0) {
 			return -EINVAL;
@@ -169,6 +190,8 @@ static int coap_parse_options(struct zoap_packet *pkt, unsigned int offset)
 		if (r == 0) {
 			break;
 		}
+
+		coap_index_option(pkt, context.delta, value, len);
 	}
 	return context.used;
 }
@@ -279,6 +302,13 @@ static int coap_option_encode(struct option_context *context, uint16_t code,
 	int delta, offset, r;
 	uint8_t data;
 
+	if (context->buflen < 1) {
+		return -EINVAL;
+	}
+
+	/* A failed attempt may have left bits in the header byte */
+	context->buf[0] = 0;
+
 	delta = code - context->delta;
 
 	offset = 1;
@@ -481,19 +511,159 @@ void zoap_pending_clear(struct zoap_pending *pending)
 	pending->timeout = 0;
 }
 
-static bool uri_path_eq(const struct zoap_packet *pkt,
-			const char * const *path)
+/* Times wrap around, only their difference is meaningful */
+static bool expires_before(const struct zoap_pending *a,
+			   const struct zoap_pending *b)
 {
-	struct zoap_option options[16];
-	uint16_t count = 16;
-	int i, r;
+	return (int32_t)(a->expiry - b->expiry) < 0;
+}
 
-	r = zoap_find_options(pkt, ZOAP_OPTION_URI_PATH, options, count);
-	if (r < 0) {
-		return false;
+static void heap_set(struct zoap_pending_queue *queue, int i,
+		     struct zoap_pending *pending)
+{
+	queue->heap[i] = pending;
+	pending->index = i;
+}
+
+static int heap_sift_up(struct zoap_pending_queue *queue, int i)
+{
+	struct zoap_pending *pending = queue->heap[i];
+
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+
+		if (!expires_before(pending, queue->heap[parent])) {
+			break;
+		}
+
+		heap_set(queue, i, queue->heap[parent]);
+		i = parent;
+	}
+
+	heap_set(queue, i, pending);
+
+	return i;
+}
+
+static void heap_sift_down(struct zoap_pending_queue *queue, int i)
+{
+	struct zoap_pending *pending = queue->heap[i];
+
+	while (true) {
+		int child = 2 * i + 1;
+
+		if (child >= queue->count) {
+			break;
+		}
+
+		if (child + 1 < queue->count &&
+		    expires_before(queue->heap[child + 1], queue->heap[child])) {
+			child++;
+		}
+
+		if (!expires_before(queue->heap[child], pending)) {
+			break;
+		}
+
+		heap_set(queue, i, queue->heap[child]);
+		i = child;
+	}
+
+	heap_set(queue, i, pending);
+}
+
+void zoap_pending_queue_init(struct zoap_pending_queue *queue,
+			     struct zoap_pending **heap, uint16_t max)
+{
+	queue->heap = heap;
+	queue->max = max;
+	queue->count = 0;
+}
+
+int zoap_pending_queue_add(struct zoap_pending_queue *queue,
+			   struct zoap_pending *pending, uint32_t now)
+{
+	if (queue->count == queue->max) {
+		return -ENOMEM;
+	}
+
+	pending->expiry = now + pending->timeout;
+
+	heap_set(queue, queue->count, pending);
+	heap_sift_up(queue, queue->count++);
+
+	return 0;
+}
+
+void zoap_pending_queue_remove(struct zoap_pending_queue *queue,
+			       struct zoap_pending *pending)
+{
+	struct zoap_pending *last;
+	int i = pending->index;
+
+	if (i >= queue->count || queue->heap[i] != pending) {
+		return;
+	}
+
+	last = queue->heap[--queue->count];
+	if (last == pending) {
+		return;
+	}
+
+	/* The last one takes its place, then moves either up or down */
+	heap_set(queue, i, last);
+	heap_sift_down(queue, heap_sift_up(queue, i));
+}
+
+struct zoap_pending *zoap_pending_queue_next(
+	const struct zoap_pending_queue *queue)
+{
+	if (!queue->count) {
+		return NULL;
+	}
+
+	return queue->heap[0];
+}
+
+struct zoap_pending *zoap_pending_queue_expired(
+	struct zoap_pending_queue *queue, uint32_t now)
+{
+	struct zoap_pending *pending = zoap_pending_queue_next(queue);
+
+	if (!pending || (int32_t)(now - pending->expiry) < 0) {
+		return NULL;
+	}
+
+	zoap_pending_queue_remove(queue, pending);
+
+	return pending;
+}
+
+struct zoap_pending *zoap_pending_queue_received(
+	struct zoap_pending_queue *queue,
+	const struct zoap_packet *response)
+{
+	int i;
+
+	for (i = 0; i < queue->count; i++) {
+		struct zoap_pending *p = queue->heap[i];
+
+		if (!match_response(&p->request, response)) {
+			continue;
+		}
+
+		zoap_pending_queue_remove(queue, p);
+		zoap_pending_clear(p);
+		return p;
 	}
 
-	count = r;
+	return NULL;
+}
+
+static bool uri_path_eq(const struct zoap_option *options, int count,
+			const char * const *path)
+{
+	int i;
 
 	for (i = 0; i < count && path[i]; i++) {
 		size_t len;
@@ -529,32 +699,203 @@ static zoap_method_t method_from_code(const struct zoap_resource *resource,
 	}
 }
 
+static int handle_resource(struct zoap_resource *resource,
+			   struct zoap_packet *pkt,
+			   const uip_ipaddr_t *addr, uint16_t port)
+{
+	zoap_method_t method;
+	uint8_t code;
+
+	code = zoap_header_get_code(pkt);
+	method = method_from_code(resource, code);
+
+	if (!method) {
+		return 0;
+	}
+
+	return method(resource, pkt, addr, port);
+}
+
 int zoap_handle_request(struct zoap_packet *pkt,
 			struct zoap_resource *resources,
 			const uip_ipaddr_t *addr, uint16_t port)
 {
+	struct zoap_option options[MAX_PATH_SEGMENTS];
 	struct zoap_resource *resource;
+	int count;
 
-	for (resource = resources; resource && resource->path; resource++) {
-		zoap_method_t method;
-		uint8_t code;
+	count = zoap_find_options(pkt, ZOAP_OPTION_URI_PATH,
+				  options, MAX_PATH_SEGMENTS);
+	if (count < 0) {
+		return -ENOENT;
+	}
 
+	for (resource = resources; resource && resource->path; resource++) {
 		/* FIXME: deal with hierarchical resources */
-		if (!uri_path_eq(pkt, resource->path)) {
+		if (!uri_path_eq(options, count, resource->path)) {
 			continue;
 		}
 
-		code = zoap_header_get_code(pkt);
-		method = method_from_code(resource, code);
+		return handle_resource(resource, pkt, addr, port);
+	}
+
+	return -ENOENT;
+}
+
+/* Segments are ordered by length first, so most comparisons are cheap */
+static int segment_cmp(const struct zoap_dispatch_node *node,
+		       const void *segment, uint16_t len)
+{
+	if (node->len != len) {
+		return node->len < len ? -1 : 1;
+	}
 
-		if (!method) {
-			return 0;
+	return memcmp(node->segment, segment, len);
+}
+
+/*
+ * Returns the index of the child of @a parent matching @a segment or, if
+ * there is none, minus one minus the index where it would be inserted.
+ */
+static int find_child(const struct zoap_dispatch_node *nodes,
+		      const struct zoap_dispatch_node *parent,
+		      const void *segment, uint16_t len)
+{
+	int lo = parent->first_child;
+	int hi = lo + parent->children;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int r = segment_cmp(&nodes[mid], segment, len);
+
+		if (r == 0) {
+			return mid;
 		}
 
-		return method(resource, pkt, addr, port);
+		if (r < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
 	}
 
-	return -ENOENT;
+	return -lo - 1;
+}
+
+static int insert_child(struct zoap_dispatch *dispatch, int parent,
+			const char *segment, uint16_t len)
+{
+	struct zoap_dispatch_node *nodes = dispatch->nodes;
+	int pos, i;
+
+	pos = find_child(nodes, &nodes[parent], segment, len);
+	if (pos >= 0) {
+		return pos;
+	}
+
+	if (dispatch->used == dispatch->max_nodes) {
+		return -ENOMEM;
+	}
+
+	/*
+	 * A node is always stored before its children, so the nodes that
+	 * move to make room are after the parent. The first child of any
+	 * node moving along must be updated.
+	 */
+	if (nodes[parent].children) {
+		pos = -pos - 1;
+	} else {
+		pos = dispatch->used;
+		nodes[parent].first_child = pos;
+	}
+
+	memmove(&nodes[pos + 1], &nodes[pos],
+		(dispatch->used - pos) * sizeof(*nodes));
+	dispatch->used++;
+
+	for (i = 0; i < dispatch->used; i++) {
+		if (i != parent && nodes[i].children &&
+		    nodes[i].first_child >= pos) {
+			nodes[i].first_child++;
+		}
+	}
+
+	memset(&nodes[pos], 0, sizeof(nodes[pos]));
+	nodes[pos].segment = segment;
+	nodes[pos].len = len;
+	nodes[parent].children++;
+
+	return pos;
+}
+
+int zoap_dispatch_init(struct zoap_dispatch *dispatch,
+		       struct zoap_resource *resources,
+		       struct zoap_dispatch_node *nodes, uint16_t max_nodes)
+{
+	struct zoap_resource *resource;
+
+	if (max_nodes < 1) {
+		return -ENOMEM;
+	}
+
+	dispatch->nodes = nodes;
+	dispatch->max_nodes = max_nodes;
+	dispatch->used = 1;
+
+	/* The root node, matching the empty path */
+	memset(&nodes[0], 0, sizeof(nodes[0]));
+
+	for (resource = resources; resource && resource->path; resource++) {
+		const char * const *segment;
+		int node = 0;
+
+		for (segment = resource->path; *segment; segment++) {
+			node = insert_child(dispatch, node, *segment,
+					    strlen(*segment));
+			if (node < 0) {
+				return node;
+			}
+		}
+
+		/* As with zoap_handle_request(), the first resource wins */
+		if (!nodes[node].resource) {
+			nodes[node].resource = resource;
+		}
+	}
+
+	return 0;
+}
+
+int zoap_dispatch_request(const struct zoap_dispatch *dispatch,
+			  struct zoap_packet *pkt,
+			  const uip_ipaddr_t *addr, uint16_t port)
+{
+	struct zoap_option options[MAX_PATH_SEGMENTS];
+	const struct zoap_dispatch_node *node = dispatch->nodes;
+	int count, i;
+
+	count = zoap_find_options(pkt, ZOAP_OPTION_URI_PATH,
+				  options, MAX_PATH_SEGMENTS);
+	if (count < 0) {
+		return -ENOENT;
+	}
+
+	for (i = 0; i < count; i++) {
+		int r = find_child(dispatch->nodes, node,
+				   options[i].value, options[i].len);
+
+		if (r < 0) {
+			return -ENOENT;
+		}
+
+		node = &dispatch->nodes[r];
+	}
+
+	if (!node->resource) {
+		return -ENOENT;
+	}
+
+	return handle_resource(node->resource, pkt, addr, port);
 }
 
 unsigned int zoap_option_value_to_int(const struct zoap_option *option)
@@ -678,6 +1019,53 @@ int zoap_resource_notify(struct zoap_resource *resource)
 	return 0;
 }
 
+int zoap_notification_init(struct zoap_packet *pkt, struct net_buf *buf,
+			   const struct zoap_packet *notification,
+			   const struct zoap_observer *observer,
+			   uint16_t id)
+{
+	uint8_t *src = ip_buf_appdata(notification->buf);
+	uint8_t *dst = ip_buf_appdata(buf);
+	int hdrlen, len, shift, i;
+
+	hdrlen = coap_get_header_len(notification);
+	if (hdrlen < 0) {
+		return -EINVAL;
+	}
+
+	/* Options and payload, copied as they are */
+	len = ip_buf_appdatalen(notification->buf) - hdrlen;
+
+	if (net_buf_tailroom(buf) < BASIC_HEADER_SIZE + observer->tkl + len) {
+		return -ENOMEM;
+	}
+
+	dst[0] = (src[0] & 0xF0) | observer->tkl;
+	dst[1] = src[1];
+	sys_put_be16(id, &dst[2]);
+	memcpy(dst + BASIC_HEADER_SIZE, observer->token, observer->tkl);
+	memcpy(dst + BASIC_HEADER_SIZE + observer->tkl, src + hdrlen, len);
+
+	ip_buf_appdatalen(buf) = BASIC_HEADER_SIZE + observer->tkl + len;
+
+	/* The option index still holds, once moved with the options */
+	memcpy(pkt, notification, sizeof(*pkt));
+	pkt->buf = buf;
+
+	shift = BASIC_HEADER_SIZE + observer->tkl - hdrlen;
+
+	for (i = 0; i < pkt->optcount &&
+		    i < CONFIG_ZOAP_OPTION_INDEX_SIZE; i++) {
+		pkt->options[i].offset += shift;
+	}
+
+	if (notification->start) {
+		pkt->start = dst + (notification->start - src) + shift;
+	}
+
+	return 0;
+}
+
 bool zoap_request_is_observe(const struct zoap_packet *request)
 {
 	return get_observe_option(request) == 0;
@@ -769,46 +1157,34 @@ int zoap_add_option(struct zoap_packet *pkt, uint16_t code,
 		     const void *value, uint16_t len)
 {
 	struct net_buf *buf = pkt->buf;
-	struct option_context context = { .delta = 0,
-					  .used = 0 };
-	int r, offset;
+	struct option_context context;
+	int r;
 
 	if (pkt->start) {
 		return -EINVAL;
 	}
 
-	offset = coap_get_header_len(pkt);
-	if (offset < 0) {
+	/* If the new option code is out of order. */
+	if (code < pkt->last_code) {
 		return -EINVAL;
 	}
 
-	/* We check for options in all the 'used' space. */
-	context.buflen = ip_buf_appdatalen(buf) - offset;
-	context.buf = ip_buf_appdata(buf) + offset;
-
-	while (context.delta <= code) {
-		r = coap_parse_option(pkt, &context, NULL, NULL);
-		if (r < 0) {
-			return -ENOENT;
-		}
-
-		if (r == 0) {
-			break;
-		}
-
-		/* If the new option code is out of order. */
-		if (code < context.delta) {
-			return -EINVAL;
-		}
-	}
-	/* We can now add options using all the available space. */
-	context.buflen = net_buf_tailroom(buf) - (offset + context.used);
+	/*
+	 * Without a payload, the options end with the packet: the new one
+	 * is encoded right there, relative to the last one.
+	 */
+	context.delta = pkt->last_code;
+	context.used = 0;
+	context.buf = ip_buf_appdata(buf) + ip_buf_appdatalen(buf);
+	context.buflen = net_buf_tailroom(buf) - ip_buf_appdatalen(buf);
 
 	r = coap_option_encode(&context, code, value, len);
 	if (r < 0) {
 		return -EINVAL;
 	}
 
+	coap_index_option(pkt, code, context.buf + r - len, len);
+
 	ip_buf_appdatalen(buf) += r;
 
 	return 0;
@@ -840,6 +1216,32 @@ int zoap_add_option_int(struct zoap_packet *pkt, uint16_t code,
 	return zoap_add_option(pkt, code, data, len);
 }
 
+static int find_indexed_options(const struct zoap_packet *pkt, uint16_t code,
+				struct zoap_option *options, uint16_t veclen)
+{
+	uint8_t *appdata = ip_buf_appdata(pkt->buf);
+	int i, count = 0;
+
+	for (i = 0; i < pkt->optcount && count < veclen; i++) {
+		const struct zoap_option_entry *entry = &pkt->options[i];
+
+		/* Options are in numeric order */
+		if (entry->code > code) {
+			break;
+		}
+
+		if (entry->code != code) {
+			continue;
+		}
+
+		options[count].value = appdata + entry->offset;
+		options[count].len = entry->len;
+		count++;
+	}
+
+	return count;
+}
+
 int zoap_find_options(const struct zoap_packet *pkt, uint16_t code,
 		       struct zoap_option *options, uint16_t veclen)
 {
@@ -849,6 +1251,10 @@ int zoap_find_options(const struct zoap_packet *pkt, uint16_t code,
 	int hdrlen, count = 0;
 	uint16_t len;
 
+	if (pkt->optcount <= CONFIG_ZOAP_OPTION_INDEX_SIZE) {
+		return find_indexed_options(pkt, code, options, veclen);
+	}
+
 	hdrlen = coap_get_header_len(pkt);
 	if (hdrlen < 0) {
 		return -EINVAL;
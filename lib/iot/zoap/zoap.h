@@ -192,12 +192,30 @@ struct zoap_observer {
 	uint8_t tkl;
 };
 
+/**
+ * Location of an option value in a packet, relative to the start of
+ * the CoAP header.
+ */
+struct zoap_option_entry {
+	uint16_t code;
+	uint16_t offset;
+	uint16_t len;
+};
+
 /**
  * Representation of a CoAP packet.
+ *
+ * The options are indexed as the packet is parsed or built, so looking
+ * them up doesn't need to decode the option list again. Packets with more
+ * than CONFIG_ZOAP_OPTION_INDEX_SIZE options are still handled, but
+ * looking up their options falls back to decoding the list.
  */
 struct zoap_packet {
 	struct net_buf *buf;
 	uint8_t *start; /* Start of the payload */
+	uint16_t last_code; /* Code of the last option */
+	uint16_t optcount; /* Number of options in the packet */
+	struct zoap_option_entry options[CONFIG_ZOAP_OPTION_INDEX_SIZE];
 };
 
 /**
@@ -214,7 +232,9 @@ typedef int (*zoap_reply_t)(const struct zoap_packet *response,
  */
 struct zoap_pending {
 	struct zoap_packet request;
+	uint32_t expiry; /* When the retransmission is due, in ms */
 	uint16_t timeout;
+	uint16_t index; /* Position in a zoap_pending_queue */
 };
 
 /**
@@ -344,6 +364,66 @@ bool zoap_pending_cycle(struct zoap_pending *pending);
  */
 void zoap_pending_clear(struct zoap_pending *pending);
 
+/**
+ * Pending retransmissions ordered by expiry time.
+ *
+ * The queue is a binary min-heap: the next retransmission due is found
+ * in constant time, and adding or removing a pending retransmission
+ * takes a time logarithmic in the number of pending retransmissions.
+ */
+struct zoap_pending_queue {
+	struct zoap_pending **heap;
+	uint16_t max;
+	uint16_t count;
+};
+
+/**
+ * Initializes an empty queue, using @a heap, an array of @a max pointers,
+ * as storage.
+ */
+void zoap_pending_queue_init(struct zoap_pending_queue *queue,
+			     struct zoap_pending **heap, uint16_t max);
+
+/**
+ * Adds @a pending to the queue, to expire pending->timeout ms after @a now.
+ * The time base of @a now is up to the user, but must be the same for all
+ * the calls on a queue. To be called after zoap_pending_cycle(), once the
+ * request is sent. Returns -ENOMEM if the queue is full.
+ */
+int zoap_pending_queue_add(struct zoap_pending_queue *queue,
+			   struct zoap_pending *pending, uint32_t now);
+
+/**
+ * Removes @a pending from the queue, if it is there.
+ */
+void zoap_pending_queue_remove(struct zoap_pending_queue *queue,
+			       struct zoap_pending *pending);
+
+/**
+ * Returns the next pending retransmission to expire, without removing it
+ * from the queue, or NULL if the queue is empty. pending->expiry informs
+ * when it expires.
+ */
+struct zoap_pending *zoap_pending_queue_next(
+	const struct zoap_pending_queue *queue);
+
+/**
+ * Removes and returns a pending retransmission that expired at @a now, or
+ * returns NULL if there is none. The user is expected to call it until it
+ * returns NULL, and to resend and add back each expired retransmission
+ * for which zoap_pending_cycle() returns true.
+ */
+struct zoap_pending *zoap_pending_queue_expired(
+	struct zoap_pending_queue *queue, uint32_t now);
+
+/**
+ * Same as zoap_pending_received(), for the pending retransmissions of a
+ * queue. The matching pending retransmission is removed from the queue.
+ */
+struct zoap_pending *zoap_pending_queue_received(
+	struct zoap_pending_queue *queue,
+	const struct zoap_packet *response);
+
 /**
  * Cancels awaiting for this reply, so it becomes available again.
  */
@@ -357,12 +437,69 @@ int zoap_handle_request(struct zoap_packet *pkt,
 			struct zoap_resource *resources,
 			const uip_ipaddr_t *addr, uint16_t port);
 
+/**
+ * Node of a resource dispatch tree, one per distinct path prefix.
+ */
+struct zoap_dispatch_node {
+	const char *segment;
+	struct zoap_resource *resource;
+	uint16_t len;
+	uint16_t first_child;
+	uint16_t children;
+};
+
+/**
+ * Resource dispatch tree, keyed by path segments.
+ *
+ * The children of each node are kept contiguous and sorted, so finding
+ * the resource of a request takes a binary search per segment of its
+ * path, whatever the number of resources.
+ */
+struct zoap_dispatch {
+	struct zoap_dispatch_node *nodes;
+	uint16_t max_nodes;
+	uint16_t used;
+};
+
+/**
+ * Builds the dispatch tree of @a resources, in the same form as passed
+ * to zoap_handle_request(), using the @a nodes array as storage. One
+ * node is needed for the root plus one for each distinct path prefix:
+ * the total number of path segments of the resources, plus one, is
+ * always enough. Returns -ENOMEM if @a max_nodes is too small.
+ */
+int zoap_dispatch_init(struct zoap_dispatch *dispatch,
+		       struct zoap_resource *resources,
+		       struct zoap_dispatch_node *nodes, uint16_t max_nodes);
+
+/**
+ * Same as zoap_handle_request(), finding the resource in a dispatch tree
+ * built by zoap_dispatch_init().
+ */
+int zoap_dispatch_request(const struct zoap_dispatch *dispatch,
+			  struct zoap_packet *pkt,
+			  const uip_ipaddr_t *addr, uint16_t port);
+
 /**
  * Indicates that this resource was updated and that the @a notify callback
  * should be called for every registered observer.
  */
 int zoap_resource_notify(struct zoap_resource *resource);
 
+/**
+ * Builds in @a buf the notification to @a observer of a resource update,
+ * from @a notification, with message ID @a id. The options and payload
+ * of @a notification are copied as they are, only the token and message
+ * ID differ. This way, a notification to many observers is encoded only
+ * once: @a notification is built with its type, code, options (Observe
+ * included) and payload, usually without token, then this is called
+ * from the @a notify callback of the resource.
+ */
+int zoap_notification_init(struct zoap_packet *pkt, struct net_buf *buf,
+			   const struct zoap_packet *notification,
+			   const struct zoap_observer *observer,
+			   uint16_t id);
+
 /**
  * Returns if this request is enabling observing a resource.
  */
@@ -61,6 +61,25 @@ static int _reverse_and_pad(char *start, char *end, int minlen)
 	return len;
 }
 
+#ifdef CONFIG_MINIMAL_LIBC_FAST_PRINTF
+/* Writes the specified number into the buffer in base 8 or 16, using
+ * shifts rather than divisions, padding with leading zeros up to the
+ * minimum length.
+ */
+static int _to_x(char *buf, uint32_t n, int base, int minlen)
+{
+	char *buf0 = buf;
+	int shift = (base == 16) ? 4 : 3;
+
+	do {
+		int d = n & (base - 1);
+
+		n >>= shift;
+		*buf++ = '0' + d + (d > 9 ? ('a' - '0' - 10) : 0);
+	} while (n);
+	return _reverse_and_pad(buf0, buf, minlen);
+}
+#else
 /* Writes the specified number into the buffer in the given base,
  * using the digit characters 0-9a-z (i.e. base>36 will start writing
  * odd bytes), padding with leading zeros up to the minimum length.
@@ -77,6 +96,7 @@ static int _to_x(char *buf, uint32_t n, int base, int minlen)
 	} while (n);
 	return _reverse_and_pad(buf0, buf, minlen);
 }
+#endif
 
 static int _to_hex(char *buf, uint32_t value,
 		   int alt_form, int precision, int prefix)
@@ -112,10 +132,61 @@ static int _to_octal(char *buf, uint32_t value, int alt_form, int precision)
 	return (buf - buf0) + _to_x(buf, value, 8, precision);
 }
 
+#ifdef CONFIG_MINIMAL_LIBC_FAST_PRINTF
+static const char _digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* Writes the number two digits at a time, from the last ones. The
+ * division by 100 is a multiplication by its reciprocal, exact for any
+ * 32 bit value, which avoids the division routine on CPUs without a
+ * hardware divider.
+ */
+static int _to_udec(char *buf, uint32_t value, int precision)
+{
+	char *start = buf;
+	char digits[10];
+	char *p = digits + sizeof(digits);
+	uint32_t q;
+	int len;
+
+	while (value >= 100) {
+		q = ((uint64_t)value * 0x51EB851Full) >> 37;
+		p -= 2;
+		memcpy(p, &_digit_pairs[(value - q * 100) * 2], 2);
+		value = q;
+	}
+
+	if (value >= 10) {
+		p -= 2;
+		memcpy(p, &_digit_pairs[value * 2], 2);
+	} else {
+		*--p = '0' + value;
+	}
+
+	len = digits + sizeof(digits) - p;
+	while (precision-- > len) {
+		*buf++ = '0';
+	}
+	memcpy(buf, p, len);
+	buf[len] = 0;
+
+	return buf + len - start;
+}
+#else
 static int _to_udec(char *buf, uint32_t value, int precision)
 {
 	return _to_x(buf, value, 10, precision);
 }
+#endif
 
 static int _to_dec(char *buf, int32_t value, int fplus, int fspace, int precision)
 {
@@ -137,6 +208,45 @@ static int _to_dec(char *buf, int32_t value, int fplus, int fspace, int precisio
 	return (buf + _to_udec(buf, (uint32_t) value, precision)) - start;
 }
 
+/* Writes a fixed point number given as integer and millionths, as in
+ * sensor values, both parts having the same sign. The precision is the
+ * number of fraction digits, 6 by default, the others being truncated.
+ */
+static int _to_fixed(char *buf, int32_t value, int32_t micro,
+		     int fplus, int fspace, int precision)
+{
+	char *start = buf;
+	uint32_t frac;
+
+	if (value < 0 || micro < 0) {
+		*buf++ = '-';
+	} else if (fplus) {
+		*buf++ = '+';
+	} else if (fspace) {
+		*buf++ = ' ';
+	}
+
+	buf += _to_udec(buf, value < 0 ? -(uint32_t)value : value, 0);
+
+	if (precision < 0 || precision > 6) {
+		precision = 6;
+	}
+
+	if (precision > 0) {
+		frac = micro < 0 ? -(uint32_t)micro : micro;
+		if (frac > 999999) {
+			frac = 999999;
+		}
+
+		*buf++ = '.';
+		_to_udec(buf, frac, 6);
+		buf += precision;
+	}
+	*buf = 0;
+
+	return buf - start;
+}
+
 static	void _rlrshift(uint64_t *v)
 {
 	*v = (*v & 1) + (*v >> 1);
@@ -609,6 +719,17 @@ int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 					pad = ' ';
 				break;
 
+			case 'q':
+				/* fixed point: integer part, then millionths */
+				int32_temp = (int32_t) va_arg(vargs, int32_t);
+				uint32_temp = (uint32_t) va_arg(vargs, int32_t);
+				c = _to_fixed(buf, int32_temp, (int32_t) uint32_temp,
+					      fplus, fspace, precision);
+				if (fplus || fspace || (buf[0] == '-'))
+					prefix = 1;
+				need_justifying = true;
+				break;
+
 			case 's':
 				cptr_temp = (char *) va_arg(vargs, char *);
 				/* Get the string length */
@@ -24,6 +24,7 @@
 
 #include <misc/printk.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <toolchain.h>
 #include <sections.h>
 
@@ -198,25 +199,27 @@ static void _printk_hex_ulong(const unsigned long num)
  * @brief Output an unsigned long (32-bit) in decimal format
  *
  * Output an unsigned long on output installed by platform at init time. Only
- * works with 32-bit values.
+ * works with 32-bit values. The division by 10 is a multiplication by its
+ * reciprocal, exact for any 32-bit value, so that no division routine is
+ * needed on CPUs without a hardware divider.
  * @param num Number to output
  *
  * @return N/A
  */
 static void _printk_dec_ulong(const unsigned long num)
 {
-	unsigned long pos = 999999999;
-	unsigned long remainder = num;
-	int found_largest_digit = 0;
-
-	while (pos >= 9) {
-		if (found_largest_digit || remainder > pos) {
-			found_largest_digit = 1;
-			_char_out((int)((remainder / (pos + 1)) + 48));
-		}
-		remainder %= (pos + 1);
-		pos /= 10;
+	char digits[10];
+	uint32_t remainder = num;
+	uint32_t quotient;
+	int len = 0;
+
+	do {
+		quotient = ((uint64_t)remainder * 0xCCCCCCCDULL) >> 35;
+		digits[len++] = (char)(remainder - quotient * 10 + 48);
+		remainder = quotient;
+	} while (remainder);
+
+	while (len) {
+		_char_out((int)digits[--len]);
 	}
-	_char_out((int)(remainder + 48));
 }
-
@@ -74,6 +74,7 @@ struct net_buf *net_buf_get_timeout(struct k_fifo *fifo,
 		net_buf_reserve(buf, reserve_head);
 		buf->flags = 0;
 		buf->frags = NULL;
+		buf->owner = NULL;
 
 		return buf;
 	}
@@ -136,8 +137,10 @@ void net_buf_unref(struct net_buf *buf)
 
 	while (buf && --buf->ref == 0) {
 		struct net_buf *frags = buf->frags;
+		struct net_buf *owner = buf->owner;
 
 		buf->frags = NULL;
+		buf->owner = NULL;
 
 		if (buf->destroy) {
 			buf->destroy(buf);
@@ -145,6 +148,11 @@ void net_buf_unref(struct net_buf *buf)
 			k_fifo_put(buf->free, buf);
 		}
 
+		/* Owners are never slices, this does not recurse further */
+		if (owner) {
+			net_buf_unref(owner);
+		}
+
 		buf = frags;
 	}
 }
@@ -165,12 +173,73 @@ struct net_buf *net_buf_clone(struct net_buf *buf)
 		return NULL;
 	}
 
-	/* TODO: Add reference to the original buffer instead of copying it. */
 	memcpy(net_buf_add(clone, buf->len), buf->data, buf->len);
 
 	return clone;
 }
 
+struct net_buf *net_buf_slice(struct k_fifo *fifo, struct net_buf *buf,
+			      size_t offset, size_t len)
+{
+	struct net_buf *slice;
+
+	NET_BUF_ASSERT(offset + len <= buf->len);
+
+	slice = net_buf_get(fifo, 0);
+	if (!slice) {
+		return NULL;
+	}
+
+	slice->owner = net_buf_ref(buf->owner ? buf->owner : buf);
+	slice->data = buf->data + offset;
+	slice->len = len;
+
+	NET_BUF_DBG("slice %p of buf %p owner %p len %u", slice, buf,
+		    slice->owner, len);
+
+	return slice;
+}
+
+struct net_buf *net_buf_frags_slice(struct k_fifo *fifo, struct net_buf *buf,
+				    size_t offset, size_t len)
+{
+	struct net_buf *head = NULL;
+
+	while (buf && offset >= buf->len) {
+		offset -= buf->len;
+		buf = buf->frags;
+	}
+
+	for (; buf && len; buf = buf->frags, offset = 0) {
+		struct net_buf *slice;
+		size_t chunk = min(buf->len - offset, len);
+
+		if (!chunk) {
+			continue;
+		}
+
+		slice = net_buf_slice(fifo, buf, offset, chunk);
+		if (!slice) {
+			break;
+		}
+
+		if (head) {
+			net_buf_frag_add(head, slice);
+		} else {
+			head = slice;
+		}
+
+		len -= chunk;
+	}
+
+	if (len && head) {
+		net_buf_unref(head);
+		return NULL;
+	}
+
+	return head;
+}
+
 struct net_buf *net_buf_frag_last(struct net_buf *buf)
 {
 	while (buf->frags) {
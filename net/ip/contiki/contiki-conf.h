@@ -142,6 +142,9 @@ typedef unsigned int uip_stats_t;
 #else /* 6lowpan compression method */
 #define SICSLOWPAN_CONF_COMPRESSION SICSLOWPAN_COMPRESSION_IPV6
 #endif /* 6lowpan compression method */
+#ifdef CONFIG_6LOWPAN_REASS_CONTEXTS
+#define SICSLOWPAN_CONF_REASS_CONTEXTS CONFIG_6LOWPAN_REASS_CONTEXTS
+#endif
 #ifdef CONFIG_15_4_BEACON_SUPPORT
 #define FRAMER_802154_HANDLER handler_802154_frame_received
 #endif /* CONFIG_15_4_BEACON_SUPPORT */
@@ -0,0 +1,247 @@
+/* uip-chksum.c - Internet checksum */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The one's complement sum does not depend on the byte order of the words
+ * being summed (RFC 1071, section 2.B): the data is summed in 32-bit native
+ * words with end-around carry, and the result is folded to 16 bits and
+ * converted to host byte order only once.
+ */
+
+#include <stdint.h>
+#include <misc/byteorder.h>
+#include <net/buf.h>
+
+#include "contiki/ip/uip-chksum.h"
+
+#define BLOCK_SIZE 32
+
+struct chksum_block {
+	uint32_t w[BLOCK_SIZE / 4];
+};
+
+/* Add one 32-byte block of 4-byte aligned data to a 32-bit sum */
+#if defined(CONFIG_X86)
+static inline uint32_t sum_block(uint32_t acc, const uint32_t *p)
+{
+	__asm__ ("addl 0(%[p]), %[acc]\n\t"
+		 "adcl 4(%[p]), %[acc]\n\t"
+		 "adcl 8(%[p]), %[acc]\n\t"
+		 "adcl 12(%[p]), %[acc]\n\t"
+		 "adcl 16(%[p]), %[acc]\n\t"
+		 "adcl 20(%[p]), %[acc]\n\t"
+		 "adcl 24(%[p]), %[acc]\n\t"
+		 "adcl 28(%[p]), %[acc]\n\t"
+		 "adcl $0, %[acc]\n\t"
+		 : [acc] "+r" (acc)
+		 : [p] "r" (p), "m" (*(const struct chksum_block *)p)
+		 : "cc");
+
+	return acc;
+}
+#elif defined(CONFIG_ARM) && defined(CONFIG_ISA_THUMB2)
+static inline uint32_t sum_block(uint32_t acc, const uint32_t *p)
+{
+	uint32_t t0, t1, t2, t3;
+
+	__asm__ ("ldr %[t0], [%[p], #0]\n\t"
+		 "ldr %[t1], [%[p], #4]\n\t"
+		 "ldr %[t2], [%[p], #8]\n\t"
+		 "ldr %[t3], [%[p], #12]\n\t"
+		 "adds %[acc], %[acc], %[t0]\n\t"
+		 "adcs %[acc], %[acc], %[t1]\n\t"
+		 "adcs %[acc], %[acc], %[t2]\n\t"
+		 "adcs %[acc], %[acc], %[t3]\n\t"
+		 "ldr %[t0], [%[p], #16]\n\t"
+		 "ldr %[t1], [%[p], #20]\n\t"
+		 "ldr %[t2], [%[p], #24]\n\t"
+		 "ldr %[t3], [%[p], #28]\n\t"
+		 "adcs %[acc], %[acc], %[t0]\n\t"
+		 "adcs %[acc], %[acc], %[t1]\n\t"
+		 "adcs %[acc], %[acc], %[t2]\n\t"
+		 "adcs %[acc], %[acc], %[t3]\n\t"
+		 "adc %[acc], %[acc], #0\n\t"
+		 : [acc] "+r" (acc), [t0] "=&r" (t0), [t1] "=&r" (t1),
+		   [t2] "=&r" (t2), [t3] "=&r" (t3)
+		 : [p] "r" (p), "m" (*(const struct chksum_block *)p)
+		 : "cc");
+
+	return acc;
+}
+#else
+static inline uint32_t sum_block(uint32_t acc, const uint32_t *p)
+{
+	uint64_t sum = acc;
+
+	sum += p[0];
+	sum += p[1];
+	sum += p[2];
+	sum += p[3];
+	sum += p[4];
+	sum += p[5];
+	sum += p[6];
+	sum += p[7];
+
+	/* at most 9 * 0xffffffff: two folds are enough */
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	return (uint32_t)sum + (uint32_t)(sum >> 32);
+}
+#endif
+
+static inline uint32_t add32(uint32_t acc, uint32_t val)
+{
+	acc += val;
+	return acc + (acc < val);
+}
+
+static inline uint16_t fold(uint32_t acc)
+{
+	acc = (acc & 0xffff) + (acc >> 16);
+	acc = (acc & 0xffff) + (acc >> 16);
+	return acc;
+}
+
+/*
+ * Sum 2-byte aligned data as native 16-bit words, and return the sum of the
+ * same data seen as big endian words, in host byte order.
+ */
+static uint16_t sum_aligned(const uint8_t *data, uint16_t len)
+{
+	uint32_t acc = 0;
+
+	if (((uintptr_t)data & 2) && len >= 2) {
+		acc = *(const uint16_t *)data;
+		data += 2;
+		len -= 2;
+	}
+
+	while (len >= BLOCK_SIZE) {
+		acc = sum_block(acc, (const uint32_t *)data);
+		data += BLOCK_SIZE;
+		len -= BLOCK_SIZE;
+	}
+
+	while (len >= 4) {
+		acc = add32(acc, *(const uint32_t *)data);
+		data += 4;
+		len -= 4;
+	}
+
+	if (len >= 2) {
+		acc = add32(acc, *(const uint16_t *)data);
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		/* trailing byte is the high byte of a zero padded word */
+		acc = add32(acc, sys_be16_to_cpu(data[0] << 8));
+	}
+
+	return sys_be16_to_cpu(fold(acc));
+}
+
+/*
+ * Return the sum of data starting at an even (@a odd == 0) or odd
+ * (@a odd == 1) offset of the checksummed byte stream.
+ */
+static uint16_t sum_range(const uint8_t *data, uint16_t len, int odd)
+{
+	uint16_t sum;
+
+	if (!len) {
+		return 0;
+	}
+
+	if ((uintptr_t)data & 1) {
+		/*
+		 * The first byte completes a word, the rest is 2-byte aligned
+		 * and starts at the opposite parity: sum it and swap.
+		 */
+		sum = __bswap_16(sum_aligned(data + 1, len - 1));
+		sum = fold((uint32_t)sum + (data[0] << 8));
+	} else {
+		sum = sum_aligned(data, len);
+	}
+
+	return odd ? __bswap_16(sum) : sum;
+}
+
+uint16_t uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+	return fold((uint32_t)sum + sum_range(data, len, 0));
+}
+
+uint16_t uip_chksum_add_frags(uint16_t sum, struct net_buf *buf,
+			      uint16_t offset, uint16_t len)
+{
+	uint32_t acc = sum;
+	int odd = 0;
+
+	while (buf && offset >= buf->len) {
+		offset -= buf->len;
+		buf = buf->frags;
+	}
+
+	while (buf && len) {
+		uint16_t chunk = buf->len - offset;
+
+		if (chunk > len) {
+			chunk = len;
+		}
+
+		acc += sum_range(buf->data + offset, chunk, odd);
+
+		odd ^= chunk & 1;
+		len -= chunk;
+		offset = 0;
+		buf = buf->frags;
+	}
+
+	return fold(acc);
+}
+
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t old_val,
+			     uint16_t new_val)
+{
+	uint32_t acc;
+
+	/* HC' = ~(~HC + ~m + m') */
+	acc = (uint16_t)~chksum;
+	acc += (uint16_t)~old_val;
+	acc += new_val;
+
+	return ~fold(acc);
+}
+
+uint16_t uip_chksum_update(uint16_t chksum, const uint8_t *old_data,
+			   const uint8_t *new_data, uint16_t len)
+{
+	uint32_t acc;
+
+	/*
+	 * Subtracting the old data is adding its complement: add the sums
+	 * of both runs instead of going word by word. The sums are in host
+	 * byte order, the checksum field is as stored in the packet.
+	 */
+	acc = (uint16_t)~chksum;
+	acc += sys_cpu_to_be16((uint16_t)~uip_chksum_add(0, old_data, len));
+	acc += sys_cpu_to_be16(uip_chksum_add(0, new_data, len));
+
+	return ~fold(acc);
+}
@@ -0,0 +1,91 @@
+/* uip-chksum.h - Internet checksum */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UIP_CHKSUM_H_
+#define UIP_CHKSUM_H_
+
+#include <stdint.h>
+#include <net/buf.h>
+
+/**
+ * @brief Add data to a 16-bit one's complement sum (RFC 1071)
+ *
+ * The data is summed as a sequence of big endian 16-bit words, an odd
+ * trailing byte being padded with zero. The data can have any alignment.
+ *
+ * @param sum Initial sum, in host byte order.
+ * @param data Data to sum.
+ * @param len Length of the data in bytes.
+ *
+ * @return Sum in host byte order, not complemented.
+ */
+uint16_t uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Add the data of a fragment chain to a one's complement sum
+ *
+ * Same as uip_chksum_add(), but sums @a len bytes starting @a offset bytes
+ * into the data of @a buf and continuing through @a buf->frags. Fragments
+ * can have odd lengths: the words straddling two fragments are summed as if
+ * the data was contiguous.
+ *
+ * @param sum Initial sum, in host byte order.
+ * @param buf First fragment.
+ * @param offset Offset of the data to sum in the first fragment.
+ * @param len Length of the data in bytes.
+ *
+ * @return Sum in host byte order, not complemented.
+ */
+uint16_t uip_chksum_add_frags(uint16_t sum, struct net_buf *buf,
+			      uint16_t offset, uint16_t len);
+
+/**
+ * @brief Update a checksum after a 16-bit field changed (RFC 1624)
+ *
+ * Computes HC' = ~(~HC + ~m + m') so that rewriting a header field does not
+ * require summing the whole packet again. All values must use the same byte
+ * order, e.g. all as read from the packet. As for a full computation, a UDP
+ * checksum of zero must be sent as 0xffff.
+ *
+ * @param chksum Checksum field value before the change.
+ * @param old_val Field value before the change.
+ * @param new_val Field value after the change.
+ *
+ * @return New checksum field value.
+ */
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t old_val,
+			     uint16_t new_val);
+
+/**
+ * @brief Update a checksum after a run of 16-bit words changed (RFC 1624)
+ *
+ * Same as uip_chksum_update16() for @a len bytes, e.g. an address, starting
+ * at an even offset in the checksummed data.
+ *
+ * @param chksum Checksum field value before the change, as stored in the
+ *        packet.
+ * @param old_data Data before the change.
+ * @param new_data Data after the change.
+ * @param len Length of the data in bytes, must be even.
+ *
+ * @return New checksum field value.
+ */
+uint16_t uip_chksum_update(uint16_t chksum, const uint8_t *old_data,
+			   const uint8_t *new_data, uint16_t len);
+
+#endif /* UIP_CHKSUM_H_ */
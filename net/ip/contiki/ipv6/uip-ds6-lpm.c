@@ -0,0 +1,277 @@
+/* uip-ds6-lpm.c - IPv6 longest prefix match table */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A lookup visits at most one node per distinct prefix length on the path
+ * to the address, instead of comparing the address with every prefix of
+ * the table, and the bytes of the address already matched by a node are
+ * not compared again by its descendants.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "contiki/ipv6/uip-ds6-lpm.h"
+
+#define ADDR_BITS 128
+
+static inline int bit(const uint8_t *addr, uint8_t pos)
+{
+	return (addr[pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+/* Number of leading bits common to a and b, up to max bits. The first
+ * from bits, rounded down to a byte, are known to be equal.
+ */
+static uint8_t common_len(const uint8_t *a, const uint8_t *b, uint8_t from,
+			  uint8_t max)
+{
+	uint8_t len;
+	int i;
+
+	for (i = from / 8; i * 8 < max; i++) {
+		uint8_t diff = a[i] ^ b[i];
+
+		if (diff) {
+			len = i * 8 + __builtin_clz(diff) - 24;
+			return len < max ? len : max;
+		}
+	}
+
+	return max;
+}
+
+static void mask_prefix(uint8_t *dst, const uint8_t *src, uint8_t len)
+{
+	int bytes = len / 8;
+
+	memcpy(dst, src, bytes);
+	memset(dst + bytes, 0, 16 - bytes);
+
+	if (len % 8) {
+		dst[bytes] = src[bytes] & (0xff << (8 - len % 8));
+	}
+}
+
+static struct uip_ds6_lpm_node *node_alloc(struct uip_ds6_lpm *lpm,
+					   const uint8_t *prefix, uint8_t len,
+					   void *entry)
+{
+	struct uip_ds6_lpm_node *node = lpm->free;
+
+	if (!node) {
+		return NULL;
+	}
+
+	lpm->free = node->child[0];
+
+	node->child[0] = NULL;
+	node->child[1] = NULL;
+	node->parent = NULL;
+	node->entry = entry;
+	mask_prefix(node->prefix, prefix, len);
+	node->len = len;
+
+	return node;
+}
+
+static void node_free(struct uip_ds6_lpm *lpm, struct uip_ds6_lpm_node *node)
+{
+	node->child[0] = lpm->free;
+	lpm->free = node;
+}
+
+/* Link pointing to a node, in its parent or at the root */
+static struct uip_ds6_lpm_node **node_link(struct uip_ds6_lpm *lpm,
+					   struct uip_ds6_lpm_node *node)
+{
+	struct uip_ds6_lpm_node *parent = node->parent;
+
+	if (!parent) {
+		return &lpm->root;
+	}
+
+	return &parent->child[parent->child[1] == node];
+}
+
+static struct uip_ds6_lpm_node *node_find(struct uip_ds6_lpm *lpm,
+					  const uint8_t *prefix, uint8_t len)
+{
+	struct uip_ds6_lpm_node *node = lpm->root;
+	uint8_t from = 0;
+
+	while (node && node->len <= len &&
+	       common_len(node->prefix, prefix, from, node->len) == node->len) {
+		if (node->len == len) {
+			return node;
+		}
+
+		from = node->len;
+		node = node->child[bit(prefix, node->len)];
+	}
+
+	return NULL;
+}
+
+void uip_ds6_lpm_init(struct uip_ds6_lpm *lpm, struct uip_ds6_lpm_node *nodes,
+		      int count)
+{
+	int i;
+
+	lpm->root = NULL;
+	lpm->free = NULL;
+
+	for (i = 0; i < count; i++) {
+		node_free(lpm, &nodes[i]);
+	}
+}
+
+int uip_ds6_lpm_add(struct uip_ds6_lpm *lpm, const uint8_t *prefix,
+		    uint8_t len, void *entry)
+{
+	struct uip_ds6_lpm_node **link = &lpm->root;
+	struct uip_ds6_lpm_node *parent = NULL;
+	struct uip_ds6_lpm_node *node, *new, *glue;
+	uint8_t from = 0;
+	uint8_t common = 0;
+
+	if (len > ADDR_BITS) {
+		return -EINVAL;
+	}
+
+	/* Descend as long as the nodes hold a prefix of the new prefix */
+	for (node = *link; node; node = *link) {
+		common = common_len(node->prefix, prefix, from,
+				    node->len < len ? node->len : len);
+		if (common < node->len) {
+			break;
+		}
+
+		if (node->len == len) {
+			node->entry = entry;
+			return 0;
+		}
+
+		parent = node;
+		from = node->len;
+		link = &node->child[bit(prefix, node->len)];
+	}
+
+	new = node_alloc(lpm, prefix, len, entry);
+	if (!new) {
+		return -ENOMEM;
+	}
+
+	new->parent = parent;
+
+	if (!node) {
+		/* New leaf */
+		*link = new;
+		return 0;
+	}
+
+	if (common == len) {
+		/* The new prefix is a prefix of the node: insert above it */
+		new->child[bit(node->prefix, len)] = node;
+		node->parent = new;
+		*link = new;
+		return 0;
+	}
+
+	/* The prefixes diverge: join the node and the new leaf */
+	glue = node_alloc(lpm, prefix, common, NULL);
+	if (!glue) {
+		node_free(lpm, new);
+		return -ENOMEM;
+	}
+
+	glue->parent = parent;
+	glue->child[bit(prefix, common)] = new;
+	glue->child[bit(node->prefix, common)] = node;
+	new->parent = glue;
+	node->parent = glue;
+	*link = glue;
+
+	return 0;
+}
+
+void *uip_ds6_lpm_remove(struct uip_ds6_lpm *lpm, const uint8_t *prefix,
+			 uint8_t len)
+{
+	struct uip_ds6_lpm_node *node = node_find(lpm, prefix, len);
+	struct uip_ds6_lpm_node *parent, *child;
+	void *entry;
+
+	if (!node || !node->entry) {
+		return NULL;
+	}
+
+	entry = node->entry;
+	node->entry = NULL;
+
+	/* Nodes without entry are only kept to join two subtrees */
+	while (node && !node->entry && !(node->child[0] && node->child[1])) {
+		child = node->child[0] ? node->child[0] : node->child[1];
+		parent = node->parent;
+
+		*node_link(lpm, node) = child;
+		node_free(lpm, node);
+
+		if (child) {
+			child->parent = parent;
+			break;
+		}
+
+		/* The parent lost a child */
+		node = parent;
+	}
+
+	return entry;
+}
+
+void *uip_ds6_lpm_find(struct uip_ds6_lpm *lpm, const uint8_t *prefix,
+		       uint8_t len)
+{
+	struct uip_ds6_lpm_node *node = node_find(lpm, prefix, len);
+
+	return node ? node->entry : NULL;
+}
+
+void *uip_ds6_lpm_lookup(struct uip_ds6_lpm *lpm, const uint8_t *addr)
+{
+	struct uip_ds6_lpm_node *node = lpm->root;
+	void *entry = NULL;
+	uint8_t from = 0;
+
+	while (node &&
+	       common_len(node->prefix, addr, from, node->len) == node->len) {
+		if (node->entry) {
+			entry = node->entry;
+		}
+
+		if (node->len == ADDR_BITS) {
+			break;
+		}
+
+		from = node->len;
+		node = node->child[bit(addr, node->len)];
+	}
+
+	return entry;
+}
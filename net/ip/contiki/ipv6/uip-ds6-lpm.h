@@ -0,0 +1,108 @@
+/* uip-ds6-lpm.h - IPv6 longest prefix match table */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UIP_DS6_LPM_H_
+#define UIP_DS6_LPM_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Node of a longest prefix match table
+ *
+ * The table is a path-compressed binary trie (Patricia tree) of IPv6
+ * prefixes: every node holds a prefix extending the prefix of its parent,
+ * the child being selected by the first bit following the parent prefix.
+ * Nodes without an entry only join two subtrees.
+ */
+struct uip_ds6_lpm_node {
+	struct uip_ds6_lpm_node *child[2];
+	struct uip_ds6_lpm_node *parent;
+	void *entry;
+	/* Bits beyond the prefix length are zero */
+	uint8_t prefix[16];
+	uint8_t len;
+};
+
+/**
+ * @brief Longest prefix match table
+ *
+ * A table with N entries uses at most 2 * N - 1 nodes.
+ */
+struct uip_ds6_lpm {
+	struct uip_ds6_lpm_node *root;
+	struct uip_ds6_lpm_node *free;
+};
+
+/**
+ * @brief Initialize an empty table
+ *
+ * @param lpm Table to initialize.
+ * @param nodes Nodes used by the table.
+ * @param count Number of nodes, twice the number of entries is enough.
+ */
+void uip_ds6_lpm_init(struct uip_ds6_lpm *lpm, struct uip_ds6_lpm_node *nodes,
+		      int count);
+
+/**
+ * @brief Add an entry for a prefix, or replace the entry of the prefix
+ *
+ * @param lpm Table.
+ * @param prefix Prefix, bits beyond the prefix length are ignored.
+ * @param len Prefix length in bits, up to 128.
+ * @param entry Entry to return for addresses matching the prefix.
+ *
+ * @return 0 on success, -ENOMEM if the table is out of nodes.
+ */
+int uip_ds6_lpm_add(struct uip_ds6_lpm *lpm, const uint8_t *prefix,
+		    uint8_t len, void *entry);
+
+/**
+ * @brief Remove the entry of a prefix
+ *
+ * @param lpm Table.
+ * @param prefix Prefix, bits beyond the prefix length are ignored.
+ * @param len Prefix length in bits.
+ *
+ * @return Removed entry, NULL if the prefix has no entry.
+ */
+void *uip_ds6_lpm_remove(struct uip_ds6_lpm *lpm, const uint8_t *prefix,
+			 uint8_t len);
+
+/**
+ * @brief Get the entry of a prefix
+ *
+ * @param lpm Table.
+ * @param prefix Prefix, bits beyond the prefix length are ignored.
+ * @param len Prefix length in bits.
+ *
+ * @return Entry of this exact prefix, NULL if there is none.
+ */
+void *uip_ds6_lpm_find(struct uip_ds6_lpm *lpm, const uint8_t *prefix,
+		       uint8_t len);
+
+/**
+ * @brief Get the entry of the longest prefix matching an address
+ *
+ * @param lpm Table.
+ * @param addr IPv6 address.
+ *
+ * @return Entry of the longest matching prefix, NULL if none matches.
+ */
+void *uip_ds6_lpm_lookup(struct uip_ds6_lpm *lpm, const uint8_t *addr);
+
+#endif /* UIP_DS6_LPM_H_ */
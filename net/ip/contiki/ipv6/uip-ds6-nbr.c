@@ -72,6 +72,51 @@ void LINK_NEIGHBOR_CALLBACK(const linkaddr_t *addr, int status, int numtx);
 
 NBR_TABLE_GLOBAL(uip_ds6_nbr_t, ds6_neighbors);
 
+/* Hash of the neighbor cache by IPv6 address. Each bucket holds the index
+   of its first neighbor plus one, zero for an empty bucket, and
+   ipaddr_next holds, for each neighbor, the index of the next neighbor in
+   its bucket plus one. Only the neighbors in ds6_neighbors are hashed. */
+static uint16_t ipaddr_heads[NBR_TABLE_HASH_SIZE];
+static uint16_t ipaddr_next[NBR_TABLE_MAX_NEIGHBORS];
+
+/*---------------------------------------------------------------------------*/
+static uint16_t *
+ipaddr_bucket(const uip_ipaddr_t *ipaddr)
+{
+  return &ipaddr_heads[nbr_table_hash(ipaddr, sizeof(uip_ipaddr_t)) % NBR_TABLE_HASH_SIZE];
+}
+/*---------------------------------------------------------------------------*/
+static void
+ipaddr_hash_add(uip_ds6_nbr_t *nbr)
+{
+  uint16_t *head = ipaddr_bucket(&nbr->ipaddr);
+  int index = nbr - (uip_ds6_nbr_t *)ds6_neighbors->data;
+
+  ipaddr_next[index] = *head;
+  *head = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+ipaddr_hash_remove(uip_ds6_nbr_t *nbr)
+{
+  uint16_t *link;
+  int index;
+
+  if(nbr == NULL) {
+    return;
+  }
+
+  link = ipaddr_bucket(&nbr->ipaddr);
+  index = nbr - (uip_ds6_nbr_t *)ds6_neighbors->data;
+  while(*link != 0) {
+    if(*link == index + 1) {
+      *link = ipaddr_next[index];
+      return;
+    }
+    link = &ipaddr_next[*link - 1];
+  }
+}
+
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_neighbors_init(void)
@@ -83,9 +128,15 @@ uip_ds6_nbr_t *
 uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
                 uint8_t isrouter, uint8_t state)
 {
-  uip_ds6_nbr_t *nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr);
+  uip_ds6_nbr_t *nbr;
+
+  /* An existing entry for this link-layer address is reinitialized */
+  ipaddr_hash_remove(nbr_table_get_from_lladdr(ds6_neighbors, (linkaddr_t*)lladdr));
+
+  nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr);
   if(nbr) {
     uip_ipaddr_copy(&nbr->ipaddr, ipaddr);
+    ipaddr_hash_add(nbr);
     nbr->isrouter = isrouter;
     nbr->state = state;
   #if UIP_CONF_IPV6_QUEUE_PKT
@@ -121,6 +172,7 @@ uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr)
     uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
     NEIGHBOR_STATE_CHANGED(nbr);
+    ipaddr_hash_remove(nbr);
     nbr_table_remove(ds6_neighbors, nbr);
   }
   return;
@@ -158,13 +210,16 @@ uip_ds6_nbr_num(void)
 uip_ds6_nbr_t *
 uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
 {
-  uip_ds6_nbr_t *nbr = nbr_table_head(ds6_neighbors);
+  uip_ds6_nbr_t *nbr;
+  int index;
+
   if(ipaddr != NULL) {
-    while(nbr != NULL) {
+    for(index = *ipaddr_bucket(ipaddr) - 1; index != -1;
+        index = ipaddr_next[index] - 1) {
+      nbr = (uip_ds6_nbr_t *)ds6_neighbors->data + index;
       if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
         return nbr;
       }
-      nbr = nbr_table_next(ds6_neighbors, nbr);
     }
   }
   return NULL;
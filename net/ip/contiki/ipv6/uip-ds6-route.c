@@ -39,6 +39,7 @@
  *    Routing table manipulation
  */
 #include "contiki/ipv6/uip-ds6.h"
+#include "contiki/ipv6/uip-ds6-lpm.h"
 #include "contiki/ip/uip.h"
 
 #include "lib/list.h"
@@ -61,6 +62,14 @@ MEMB(neighborroutememb, struct uip_ds6_route_neighbor_route, UIP_DS6_ROUTE_NB);
 LIST(routelist);
 MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 
+/* Routes are also indexed by prefix in a longest prefix match tree, so
+   that lookups do not compare the address with every route. */
+static struct uip_ds6_lpm_node route_nodes[2 * UIP_DS6_ROUTE_NB];
+static struct uip_ds6_lpm route_tree;
+
+/* Incremented on every successful lookup */
+static uint32_t lookup_count;
+
 /* Default routes are held on the defaultrouterlist and their
    structures are allocated from the defaultroutermemb memory block.*/
 LIST(defaultrouterlist);
@@ -149,6 +158,7 @@ uip_ds6_route_init(void)
 {
   memb_init(&routememb);
   list_init(routelist);
+  uip_ds6_lpm_init(&route_tree, route_nodes, 2 * UIP_DS6_ROUTE_NB);
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 
@@ -206,30 +216,13 @@ uip_ds6_route_num_routes(void)
 uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
-  uint8_t longestmatch;
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
-
-  found_route = NULL;
-  longestmatch = 0;
-  for(r = uip_ds6_route_head();
-      r != NULL;
-      r = uip_ds6_route_next(r)) {
-    if(r->length >= longestmatch &&
-       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
-      longestmatch = r->length;
-      found_route = r;
-      /* check if total match - e.g. all 128 bits do match */
-      if(longestmatch == 128) {
-	break;
-      }
-    }
-  }
+  found_route = uip_ds6_lpm_lookup(&route_tree, addr->u8);
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -237,23 +230,34 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF(" via ");
     PRINT6ADDR(uip_ds6_route_nexthop(found_route));
     PRINTF("\n");
+
+    /* Time stamp the route with the number of lookups so far: the
+       least recently used route is the one with the oldest stamp. */
+    found_route->last_used = ++lookup_count;
   } else {
     PRINTF("uip-ds6-route: No route found\n");
   }
 
-  if(found_route != NULL && found_route != list_head(routelist)) {
-    /* If we found a route, we put it at the start of the routeslist
-       list. The list is ordered by how recently we looked them up:
-       the least recently used route will be at the end of the
-       list - for fast lookups (assuming multiple packets to the same node). */
-
-    list_remove(routelist, found_route);
-    list_push(routelist, found_route);
-  }
-
   return found_route;
 }
 /*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+least_recently_used(void)
+{
+  uip_ds6_route_t *r;
+  uip_ds6_route_t *oldest;
+
+  /* Ages are computed relative to the counter, so that they remain
+     ordered when it wraps around. */
+  oldest = uip_ds6_route_head();
+  for(r = oldest; r != NULL; r = uip_ds6_route_next(r)) {
+    if(lookup_count - r->last_used > lookup_count - oldest->last_used) {
+      oldest = r;
+    }
+  }
+  return oldest;
+}
+/*---------------------------------------------------------------------------*/
 uip_ds6_route_t *
 uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 		  uip_ipaddr_t *nexthop)
@@ -277,7 +281,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   /* First make sure that we don't add a route twice. If we find an
      existing route for our destination, we'll delete the old
      one first. */
-  r = uip_ds6_route_lookup(ipaddr);
+  r = uip_ds6_lpm_find(&route_tree, ipaddr->u8, length);
   if(r != NULL) {
     uip_ipaddr_t *current_nexthop;
     current_nexthop = uip_ds6_route_nexthop(r);
@@ -298,11 +302,11 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
        least recently used one we have. */
 
     if(uip_ds6_route_num_routes() == UIP_DS6_ROUTE_NB) {
-      /* Removing the oldest route entry from the route table. The
-         least recently used route is the first route on the list. */
+      /* Removing the least recently used route entry from the route
+         table. */
       uip_ds6_route_t *oldest;
 
-      oldest = list_tail(routelist); /* uip_ds6_route_head(); */
+      oldest = least_recently_used();
       PRINTF("uip_ds6_route_add: dropping route to ");
       PRINT6ADDR(&oldest->ipaddr);
       PRINTF("\n");
@@ -372,6 +376,14 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+  r->last_used = lookup_count;
+
+  if(uip_ds6_lpm_add(&route_tree, ipaddr->u8, length, r) < 0) {
+    /* This should not happen, the tree has room for every route. */
+    PRINTF("uip_ds6_route_add: could not index route\n");
+    uip_ds6_route_rm(r);
+    return NULL;
+  }
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -408,8 +420,11 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINT6ADDR(&route->ipaddr);
     PRINTF("\n");
 
-    /* Remove the route from the route list */
+    /* Remove the route from the route list and the prefix tree */
     list_remove(routelist, route);
+    if(uip_ds6_lpm_find(&route_tree, route->ipaddr.u8, route->length) == route) {
+      uip_ds6_lpm_remove(&route_tree, route->ipaddr.u8, route->length);
+    }
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
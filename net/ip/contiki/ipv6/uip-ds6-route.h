@@ -120,6 +120,9 @@ typedef struct uip_ds6_route {
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
 #endif
+  /* Value of the lookup counter when the route was last looked up,
+     used to replace the least recently used route */
+  uint32_t last_used;
   uint8_t length;
 } uip_ds6_route_t;
 
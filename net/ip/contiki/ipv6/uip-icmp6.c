@@ -47,6 +47,7 @@
 #include <string.h>
 #include "contiki/ipv6/uip-ds6.h"
 #include "contiki/ipv6/uip-icmp6.h"
+#include "contiki/ip/uip-chksum.h"
 #include "contiki-default-conf.h"
 
 #ifdef CONFIG_NETWORK_IP_STACK_DEBUG_IPV6_ICMPV6
@@ -122,6 +123,11 @@ echo_request_input(struct net_buf *buf)
 #if UIP_CONF_IPV6_RPL
   uint8_t temp_ext_len;
 #endif /* UIP_CONF_IPV6_RPL */
+  /* the request checksum was verified: if only the ICMP type changes, the
+   * reply checksum can be updated instead of summing the payload again
+   */
+  int update_chksum = 1;
+  uint16_t old_type_code, new_type_code;
   /*
    * we send an echo reply. It is trivial if there was no extension
    * headers in the request otherwise we need to remove the extension
@@ -139,15 +145,18 @@ echo_request_input(struct net_buf *buf)
   if(uip_is_addr_mcast(&UIP_IP_BUF(buf)->destipaddr)){
     uip_ipaddr_copy(&UIP_IP_BUF(buf)->destipaddr, &UIP_IP_BUF(buf)->srcipaddr);
     uip_ds6_select_src(&UIP_IP_BUF(buf)->srcipaddr, &UIP_IP_BUF(buf)->destipaddr);
+    update_chksum = 0;
   } else {
     uip_ipaddr_t tmp_ipaddr;
 
+    /* swapping the addresses leaves the pseudo header sum unchanged */
     uip_ipaddr_copy(&tmp_ipaddr, &UIP_IP_BUF(buf)->srcipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF(buf)->srcipaddr, &UIP_IP_BUF(buf)->destipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF(buf)->destipaddr, &tmp_ipaddr);
   }
 
   if(uip_ext_len(buf) > 0) {
+    update_chksum = 0;
 #if UIP_CONF_IPV6_RPL
     if((temp_ext_len = rpl_invert_header(buf))) {
       /* If there were other extension headers*/
@@ -191,10 +200,19 @@ echo_request_input(struct net_buf *buf)
    */
 
   /* Note: now UIP_ICMP_BUF points to the beginning of the echo reply */
+  memcpy(&old_type_code, &UIP_ICMP_BUF(buf)->type, sizeof(old_type_code));
   UIP_ICMP_BUF(buf)->type = ICMP6_ECHO_REPLY;
   UIP_ICMP_BUF(buf)->icode = 0;
-  UIP_ICMP_BUF(buf)->icmpchksum = 0;
-  UIP_ICMP_BUF(buf)->icmpchksum = ~uip_icmp6chksum(buf);
+  memcpy(&new_type_code, &UIP_ICMP_BUF(buf)->type, sizeof(new_type_code));
+
+  if(update_chksum) {
+    UIP_ICMP_BUF(buf)->icmpchksum =
+      uip_chksum_update16(UIP_ICMP_BUF(buf)->icmpchksum, old_type_code,
+                          new_type_code);
+  } else {
+    UIP_ICMP_BUF(buf)->icmpchksum = 0;
+    UIP_ICMP_BUF(buf)->icmpchksum = ~uip_icmp6chksum(buf);
+  }
 
   PRINTF("Sending Echo Reply to ");
   PRINT6ADDR(&UIP_IP_BUF(buf)->destipaddr);
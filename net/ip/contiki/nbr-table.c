@@ -62,6 +62,12 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+/* Hash of the keys by link-layer address. Each bucket holds the index of
+ * its first key plus one, zero for an empty bucket, and hash_next holds,
+ * for each key, the index of the next key in its bucket plus one. */
+static uint16_t hash_heads[NBR_TABLE_HASH_SIZE];
+static uint16_t hash_next[NBR_TABLE_MAX_NEIGHBORS];
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -105,22 +111,67 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+unsigned
+nbr_table_hash(const void *addr, int len)
+{
+  const uint8_t *p = addr;
+  unsigned hash = 0;
+
+  while(len-- > 0) {
+    hash = hash * 31 + *p++;
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+/* Get the hash bucket of a link-layer address */
+static uint16_t *
+hash_bucket(const linkaddr_t *lladdr)
+{
+  return &hash_heads[nbr_table_hash(lladdr->u8, LINKADDR_SIZE) % NBR_TABLE_HASH_SIZE];
+}
+/*---------------------------------------------------------------------------*/
+/* Add a key to the link-layer address hash */
+static void
+hash_add(nbr_table_key_t *key)
+{
+  uint16_t *head = hash_bucket(&key->lladdr);
+  int index = index_from_key(key);
+
+  hash_next[index] = *head;
+  *head = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the link-layer address hash */
+static void
+hash_remove(nbr_table_key_t *key)
+{
+  uint16_t *link = hash_bucket(&key->lladdr);
+  int index = index_from_key(key);
+
+  while(*link != 0) {
+    if(*link == index + 1) {
+      *link = hash_next[index];
+      return;
+    }
+    link = &hash_next[*link - 1];
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
-  nbr_table_key_t *key;
+  int index;
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
-  key = list_head(nbr_table_keys);
-  while(key != NULL) {
-    if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
-      return index_from_key(key);
+  for(index = *hash_bucket(lladdr) - 1; index != -1;
+      index = hash_next[index] - 1) {
+    if(linkaddr_cmp(lladdr, &key_from_index(index)->lladdr)) {
+      return index;
     }
-    key = list_item_next(key);
   }
   return -1;
 }
@@ -216,8 +267,9 @@ nbr_table_allocate(void)
       }
       /* Empty used map */
       used_map[index_from_key(least_used_key)] = 0;
-      /* Remove neighbor from list */
+      /* Remove neighbor from list and hash */
       list_remove(nbr_table_keys, least_used_key);
+      hash_remove(least_used_key);
       /* Return associated key */
       return least_used_key;
     }
@@ -298,6 +350,7 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr)
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+    hash_add(key);
   }
 
   /* Get item in the current table */
@@ -26,6 +26,12 @@ struct compression {
   void (* init)(void);
   int (* compress)(struct net_buf *buf);
   int (* uncompress)(struct net_buf *buf);
+  /* Append the uncompressed headers at the start of data, a packet or
+     first fragment of len bytes of a datagram of size bytes (0 if not
+     fragmented), to buf. Returns the length of the compressed headers in
+     data, or -1 on error. */
+  int (* uncompress_hdr)(struct net_buf *buf, const uint8_t *data,
+                         uint16_t len, uint16_t size);
 };
 
 #endif /* COMPRESSION_H_ */
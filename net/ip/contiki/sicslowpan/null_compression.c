@@ -48,8 +48,15 @@ static int uncompress(struct net_buf *buf)
 	return 1;
 }
 
+static int uncompress_hdr(struct net_buf *buf, const uint8_t *data,
+			  uint16_t len, uint16_t size)
+{
+	return 0;
+}
+
 const struct compression null_compression = {
 	.init = init,
 	.compress = compress,
 	.uncompress = uncompress,
+	.uncompress_hdr = uncompress_hdr,
 };
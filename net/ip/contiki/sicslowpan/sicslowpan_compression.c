@@ -601,31 +601,31 @@ compress_hdr_iphc(struct net_buf *mbuf, struct net_buf *buf, linkaddr_t *link_de
 
 /*--------------------------------------------------------------------*/
 /**
- * \brief Uncompress IPHC (i.e., IPHC and LOWPAN_UDP) headers and put
- * them in sicslowpan_buf
+ * \brief Uncompress IPHC (i.e., IPHC and LOWPAN_UDP) headers
  *
- * This function is called by the input function when the dispatch is
- * IPHC.
- * We %process the packet in the packetbuf buffer, uncompress the header
- * fields, and copy the result in the sicslowpan buffer.
- * At the end of the decompression, packetbuf_hdr_len and uncompressed_hdr_len
- * are set to the appropriate values
+ * This function is called by the input functions when the dispatch is
+ * IPHC. The header fields are uncompressed from hc straight into buf,
+ * which must be zeroed and have room for UIP_IPUDPH_LEN bytes. The
+ * length fields are left to the caller.
  *
- * \param ip_len Equal to 0 if the packet is not a fragment (IP length
- * is then inferred from the L2 length), non 0 if the packet is a 1st
- * fragment.
+ * \param ibuf Buffer holding the link-layer addresses of the packet.
+ * \param hc Compressed headers.
+ * \param buf Destination of the uncompressed headers.
+ * \param hdr_len Set to the length of the uncompressed headers.
+ *
+ * \return Length of the compressed headers, 0 on error.
  */
 static int
-uncompress_hdr_iphc(struct net_buf *mbuf, struct net_buf *ibuf)
+uncompress_hdr_iphc(struct net_buf *ibuf, const uint8_t *hc, uint8_t *buf,
+                    uint8_t *hdr_len)
 {
   uint8_t tmp, iphc0, iphc1;
-  uint8_t buf[UIP_IPUDPH_LEN] = {}; /* Size of (IP + UDP)  header*/
-  int ip_len;
   /* at least two byte will be used for the encoding */
-  iphc_ptr = uip_packetbuf_ptr(mbuf) + uip_packetbuf_hdr_len(mbuf) + 2;
+  iphc_ptr = (uint8_t *)hc + 2;
+  *hdr_len = 0;
 
-  iphc0 = PACKETBUF_IPHC_BUF(mbuf)[0];
-  iphc1 = PACKETBUF_IPHC_BUF(mbuf)[1];
+  iphc0 = hc[0];
+  iphc1 = hc[1];
 
   /* another if the CID flag is set */
   if(iphc1 & SICSLOWPAN_IPHC_CID) {
@@ -695,7 +695,7 @@ uncompress_hdr_iphc(struct net_buf *mbuf, struct net_buf *ibuf)
   /* context based compression */
   if(iphc1 & SICSLOWPAN_IPHC_SAC) {
     uint8_t sci = (iphc1 & SICSLOWPAN_IPHC_CID) ?
-      PACKETBUF_IPHC_BUF(mbuf)[2] >> 4 : 0;
+      hc[2] >> 4 : 0;
 
     /* Source address - check context != NULL only if SAM bits are != 0*/
     if (tmp != 0) {
@@ -745,7 +745,7 @@ uncompress_hdr_iphc(struct net_buf *mbuf, struct net_buf *ibuf)
     /* Context based */
     if(iphc1 & SICSLOWPAN_IPHC_DAC) {
       uint8_t dci = (iphc1 & SICSLOWPAN_IPHC_CID) ?
-	PACKETBUF_IPHC_BUF(mbuf)[2] & 0x0f : 0;
+	hc[2] & 0x0f : 0;
       context = addr_context_lookup_by_number(dci);
 
       /* all valid cases below need the context! */
@@ -762,7 +762,7 @@ uncompress_hdr_iphc(struct net_buf *mbuf, struct net_buf *ibuf)
                       (uip_lladdr_t *)&ip_buf_ll_dest(ibuf));
     }
   }
-  uip_uncomp_hdr_len(mbuf) += UIP_IPH_LEN;
+  *hdr_len += UIP_IPH_LEN;
 
   /* Next header processing - continued */
   if((iphc0 & SICSLOWPAN_IPHC_NH_C)) {
@@ -825,19 +825,17 @@ uncompress_hdr_iphc(struct net_buf *mbuf, struct net_buf *ibuf)
       } else {
 	PRINTF("IPHC: sicslowpan uncompress_hdr: checksum *NOT* included\n");
       }
-      uip_uncomp_hdr_len(mbuf) += UIP_UDPH_LEN;
+      *hdr_len += UIP_UDPH_LEN;
     }
   }
 
-  uip_packetbuf_hdr_len(mbuf) = iphc_ptr - uip_packetbuf_ptr(mbuf);
-
-  if(uip_first_frag_len(ibuf) > 0) {
-     ip_len = uip_len(ibuf) - UIP_IPH_LEN;
-  } else {
-     ip_len = uip_len(ibuf) + uip_uncomp_hdr_len(mbuf) -
-                                 uip_packetbuf_hdr_len(mbuf) - UIP_IPH_LEN;
-  }
-
+  return iphc_ptr - hc;
+}
+/*--------------------------------------------------------------------*/
+/** \brief Set the length fields of uncompressed IPHC headers */
+static void
+set_hdr_len_iphc(uint8_t *buf, uint16_t ip_len)
+{
   SICSLOWPAN_IP_BUF(buf)->len[0] = ip_len >> 8;
   SICSLOWPAN_IP_BUF(buf)->len[1] = ip_len & 0x00FF;
 
@@ -845,10 +843,6 @@ uncompress_hdr_iphc(struct net_buf *mbuf, struct net_buf *ibuf)
   if(SICSLOWPAN_IP_BUF(buf)->proto == UIP_PROTO_UDP) {
     memcpy(&SICSLOWPAN_UDP_BUF(buf)->udplen, &SICSLOWPAN_IP_BUF(buf)->len[0], 2);
   }
-
-  packetbuf_copyfrom(mbuf, buf, sizeof(buf));
-
-  return 1;
 }
 /** @} */
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC */
@@ -962,44 +956,30 @@ static int compress(struct net_buf *buf)
 
 static int uncompress(struct net_buf *buf)
 {
-  struct net_buf *mbuf;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
+  uint8_t hdr[UIP_IPUDPH_LEN] = {}; /* Size of (IP + UDP)  header*/
+  uint8_t hdr_len;
+  int hc_len, hdr_diff;
+#endif
 
   if (*uip_buf(buf) == SICSLOWPAN_DISPATCH_IPV6) {
         return uncompress_hdr_ipv6(buf);
   }
 
-  mbuf = l2_buf_get_reserve(0);
-  if (!mbuf) {
-     return 0;
-  }
-
-  /* init */
-  uip_uncomp_hdr_len(mbuf) = 0;
-  uip_packetbuf_hdr_len(mbuf) = 0;
-  packetbuf_copyfrom(mbuf, uip_buf(buf), UIP_IPUDPH_LEN); /* Size of (IP + UDP)  header*/
-  uip_packetbuf_ptr(mbuf) = packetbuf_dataptr(mbuf);
-
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
-  if((PACKETBUF_HC1_PTR(mbuf)[PACKETBUF_HC1_DISPATCH] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC) {
-    PRINTF("uncompress: IPHC\n");
-    if(!uncompress_hdr_iphc(mbuf, buf)) {
-       goto fail;
-    }
-  } else
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC */
-  {
+  if((*uip_buf(buf) & 0xe0) != SICSLOWPAN_DISPATCH_IPHC) {
+#endif
       /* unknown header */
-      PRINTF("uncompress: unknown dispatch: %x--%x\n",
-             PACKETBUF_HC1_PTR(mbuf)[PACKETBUF_HC1_DISPATCH], *uip_buf(buf));
-      goto fail;
+      PRINTF("uncompress: unknown dispatch: %x\n", *uip_buf(buf));
+      return 0;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
   }
 
-#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
-  /* Check if memmove would go past the end of the buffer */
-  if ((uip_uncomp_hdr_len(mbuf) - uip_packetbuf_hdr_len(mbuf)) >
-      net_buf_tailroom(buf)) {
-    PRINTF("uncompress: not enough space to store uncompressed headers\n");
-    goto fail;
+  PRINTF("uncompress: IPHC\n");
+  /* The headers overlap their compressed form: uncompress them apart */
+  hc_len = uncompress_hdr_iphc(buf, uip_buf(buf), hdr, &hdr_len);
+  if(!hc_len) {
+    return 0;
   }
 
   /* If the packet contains some garbage, then it is possible that
@@ -1007,43 +987,79 @@ static int uncompress(struct net_buf *buf)
    * We need to check here that the memmove() will contain sane length
    * value.
    */
-  if (uip_len(buf) <= uip_packetbuf_hdr_len(mbuf)) {
+  if (uip_len(buf) <= hc_len) {
     PRINTF("uncompress: buf len (%d) <= hdr len (%d), packet discarded.\n",
-           uip_len(buf), uip_packetbuf_hdr_len(mbuf));
-    goto fail;
+           uip_len(buf), hc_len);
+    return 0;
   }
 
-#if defined(CONFIG_NETWORKING_WITH_15_4)
-  if (uip_first_frag_len(buf) > 0) {
-     memmove(uip_buf(buf) + uip_uncomp_hdr_len(mbuf),
-                uip_buf(buf) + uip_packetbuf_hdr_len(mbuf),
-                uip_first_frag_len(buf) - uip_packetbuf_hdr_len(mbuf));
-     memcpy(uip_buf(buf), uip_packetbuf_ptr(mbuf), uip_uncomp_hdr_len(mbuf));
-     ip_buf_len(buf) = uip_len(buf);
-  } else {
-     memmove(uip_buf(buf) + uip_uncomp_hdr_len(mbuf),
-                uip_buf(buf) + uip_packetbuf_hdr_len(mbuf),
-                uip_len(buf) - uip_packetbuf_hdr_len(mbuf));
-     memcpy(uip_buf(buf), uip_packetbuf_ptr(mbuf), uip_uncomp_hdr_len(mbuf));
-     uip_len(buf) += (uip_uncomp_hdr_len(mbuf) - uip_packetbuf_hdr_len(mbuf));
-     ip_buf_len(buf) += (uip_uncomp_hdr_len(mbuf) - uip_packetbuf_hdr_len(mbuf));
+  /* Check if memmove would go past the end of the buffer */
+  hdr_diff = hdr_len - hc_len;
+  if (hdr_diff > (int)net_buf_tailroom(buf)) {
+    PRINTF("uncompress: not enough space to store uncompressed headers\n");
+    return 0;
   }
-#elif defined(CONFIG_NETWORKING_WITH_BT)
-     memmove(uip_buf(buf) + uip_uncomp_hdr_len(mbuf),
-                uip_buf(buf) + uip_packetbuf_hdr_len(mbuf),
-                uip_len(buf) - uip_packetbuf_hdr_len(mbuf));
-     memcpy(uip_buf(buf), uip_packetbuf_ptr(mbuf), uip_uncomp_hdr_len(mbuf));
-     uip_len(buf) += (uip_uncomp_hdr_len(mbuf) - uip_packetbuf_hdr_len(mbuf));
-     ip_buf_len(buf) += (uip_uncomp_hdr_len(mbuf) - uip_packetbuf_hdr_len(mbuf));
+
+  memmove(uip_buf(buf) + hdr_len, uip_buf(buf) + hc_len,
+          uip_len(buf) - hc_len);
+  uip_len(buf) += hdr_diff;
+  ip_buf_len(buf) += hdr_diff;
+
+  set_hdr_len_iphc(hdr, uip_len(buf) - UIP_IPH_LEN);
+  memcpy(uip_buf(buf), hdr, hdr_len);
+
+  return 1;
 #endif
+}
+
+/*
+ * Uncompress the headers at the start of a packet or first fragment
+ * directly at the end of buf, so that the payload following them in
+ * data can then be copied once, after the headers.
+ */
+static int uncompress_hdr(struct net_buf *buf, const uint8_t *data,
+                          uint16_t len, uint16_t size)
+{
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
+  uint8_t *hdr;
+  uint8_t hdr_len;
+  int hc_len;
 #endif
 
-  l2_buf_unref(mbuf);
-  return 1;
+  if(len > 0 && data[0] == SICSLOWPAN_DISPATCH_IPV6) {
+    /* The IPv6 header follows the dispatch as is */
+    return SICSLOWPAN_IPV6_HDR_LEN;
+  }
 
-fail:
-  l2_buf_unref(mbuf);
-  return 0;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
+  if(len >= 2 && (data[0] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC) {
+    if(net_buf_tailroom(buf) < UIP_IPUDPH_LEN) {
+      return -1;
+    }
+
+    hdr = net_buf_tail(buf);
+    memset(hdr, 0, UIP_IPUDPH_LEN);
+
+    hc_len = uncompress_hdr_iphc(buf, data, hdr, &hdr_len);
+    if(!hc_len || hc_len > len) {
+      PRINTF("uncompress_hdr: invalid IPHC headers\n");
+      return -1;
+    }
+
+    /* The size of a packet that is not fragmented comes from the frame */
+    if(!size) {
+      size = len - hc_len + hdr_len;
+    }
+
+    set_hdr_len_iphc(hdr, size - UIP_IPH_LEN);
+    net_buf_add(buf, hdr_len);
+
+    return hc_len;
+  }
+#endif
+
+  PRINTF("uncompress_hdr: unknown dispatch: %x\n", len > 0 ? data[0] : 0);
+  return -1;
 }
 
 static void init(void)
@@ -1098,5 +1114,6 @@ static void init(void)
 const struct compression sicslowpan_compression = {
 	.init = init,
 	.compress = compress,
-	.uncompress = uncompress
+	.uncompress = uncompress,
+	.uncompress_hdr = uncompress_hdr
 };
@@ -152,31 +152,22 @@ static int last_rssi;
 /** Datagram tag to be put in the fragments I send. */
 static uint16_t my_tag;
 
-/* This needs to be defined in NBR / Nodes depending on available RAM   */
-/*   and expected reassembly requirements                               */
-#ifdef SICSLOWPAN_CONF_FRAGMENT_BUFFERS
-#define SICSLOWPAN_FRAGMENT_BUFFERS SICSLOWPAN_CONF_FRAGMENT_BUFFERS
-#else
-#define SICSLOWPAN_FRAGMENT_BUFFERS 16
-#endif
-
 /* REASS_CONTEXTS corresponds to the number of simultaneous             */
-/* reassemblys that can be made.                                        */
+/* reassemblys that can be made. Each of them holds an IP buffer.       */
 #ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
 #define SICSLOWPAN_REASS_CONTEXTS SICSLOWPAN_CONF_REASS_CONTEXTS
 #else
-#define SICSLOWPAN_REASS_CONTEXTS 2
+#define SICSLOWPAN_REASS_CONTEXTS 1
 #endif
 
-/* The size of each fragment (IP payload) for the 6lowpan fragmentation */
-#ifdef SICSLOWPAN_CONF_FRAGMENT_SIZE
-#define SICSLOWPAN_FRAGMENT_SIZE SICSLOWPAN_CONF_FRAGMENT_SIZE
-#else
-#define SICSLOWPAN_FRAGMENT_SIZE 110
+/* Incomplete packets must leave an IP buffer to the other packets */
+#if defined(CONFIG_IP_BUF_RX_SIZE) && \
+    SICSLOWPAN_REASS_CONTEXTS >= CONFIG_IP_BUF_RX_SIZE
+#error "CONFIG_6LOWPAN_REASS_CONTEXTS must be lower than CONFIG_IP_BUF_RX_SIZE"
 #endif
 
-/* Assuming that the worst growth for uncompression is 38 bytes */
-#define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
+/* Fragment offsets are in units of 8 bytes */
+#define SICSLOWPAN_FRAG_UNITS ((IP_BUF_MAX_DATA + 7) / 8)
 
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
@@ -186,218 +177,229 @@ struct sicslowpan_frag_info {
   linkaddr_t receiver;
   /** When reassembling, the tag in the fragments being merged. */
   uint16_t tag;
-  /** Total length of the fragmented packet */
+  /** Total length of the fragmented packet, 0 if the context is free */
   uint16_t len;
-  /** Current length of reassembled fragments */
-  uint16_t reassembled_len;
-  /** Last fragment */
-  uint8_t last_fragment;
+  /** Number of 8 byte units of the packet received so far */
+  uint16_t received_units;
+  /** Bitmap of the 8 byte units of the packet received so far */
+  uint8_t received[(SICSLOWPAN_FRAG_UNITS + 7) / 8];
+  /** Buffer in which the fragments are merged */
+  struct net_buf *buf;
   /** Reassembly %process %timer. */
   struct timer reass_timer;
 };
 
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
 
-struct sicslowpan_frag_buf {
-  /* the index of the frag_info */
-  uint8_t index;
-  /* Fragment offset */
-  uint8_t offset;
-  /* Length of this fragment (if zero this buffer is not allocated) */
-  uint8_t len;
-  uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
-};
-
-static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
-
 /*---------------------------------------------------------------------------*/
-static int
-clear_fragments(uint8_t frag_info_index)
+static void
+clear_fragments(struct sicslowpan_frag_info *info)
 {
-  int i, clear_count;
-  clear_count = 0;
-  frag_info[frag_info_index].len = 0;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len > 0 && frag_buf[i].index == frag_info_index) {
-      /* deallocate the buffer */
-      frag_buf[i].len = 0;
-      clear_count++;
-    }
+  if(info->buf) {
+    ip_buf_unref(info->buf);
+    info->buf = NULL;
   }
-  return clear_count;
+  info->len = 0;
 }
 /*---------------------------------------------------------------------------*/
-static int
-store_fragment(struct net_buf *mbuf, uint8_t index, uint8_t offset)
+/* Free the buffers of the packets whose fragments stopped coming */
+static void
+expire_contexts(void)
 {
+  struct sicslowpan_frag_info *info;
   int i;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len == 0) {
-      /* copy over the data from packetbuf into the fragment buffer
-       * and store offset and len */
-      frag_buf[i].offset = offset; /* frag offset */
-      frag_buf[i].len = packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf);
-      frag_buf[i].index = index;
-      memcpy(frag_buf[i].data, uip_packetbuf_ptr(mbuf) + uip_packetbuf_hdr_len(mbuf),
-             packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf));
-
-      PRINTF("Fragment payload length: %d\n", frag_buf[i].len);
-      /* return the length of the stored fragment */
-      return frag_buf[i].len;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    info = &frag_info[i];
+
+    if(info->len > 0 && timer_expired(&info->reass_timer)) {
+      PRINTF("reassemble: timeout, tag %d dropped\n", info->tag);
+      clear_fragments(info);
     }
   }
-  /* failed */
-  return -1;
 }
 /*---------------------------------------------------------------------------*/
-/* add a new fragment to the buffer */
-static int8_t
-add_fragment(struct net_buf *mbuf, uint16_t tag, uint16_t frag_size, uint8_t offset)
+/* find the context of a fragment, or start a new one */
+static struct sicslowpan_frag_info *
+get_context(struct net_buf *mbuf, uint16_t tag, uint16_t frag_size)
 {
+  struct sicslowpan_frag_info *info, *found = NULL;
+  const linkaddr_t *sender = packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER);
   int i;
-  int len;
-  int8_t found = -1;
-
-  if(offset == 0) {
-    /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-       clear_fragments(i);
-      }
 
-      /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    info = &frag_info[i];
+
+    if(info->len == 0) {
+      if(!found) {
+        found = info;
       }
+      continue;
     }
 
-    if(found < 0) {
-      PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
-      return -1;
-    }
+    if(info->tag == tag && linkaddr_cmp(&info->sender, sender)) {
+      /* Tag and Sender match - this must be the correct info to store in */
+      if(info->len == frag_size) {
+        return info;
+      }
 
-    /* Found a free fragment info to store data in */
-    frag_info[found].len = frag_size;
-    frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER));
-    linkaddr_copy(&frag_info[found].receiver,
-                  packetbuf_addr(mbuf, PACKETBUF_ADDR_RECEIVER));
-
-    timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-    i = found;
-    goto store;
+      /* The sender reused the tag of an unfinished datagram */
+      clear_fragments(info);
+      if(!found) {
+        found = info;
+      }
+    }
   }
 
-  /* This is a N-fragment - should find the info */
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER))) {
-      /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
-    }
+  if(!found) {
+    PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
+    return NULL;
   }
 
-  if(found < 0) {
-    /* no entry found for storing the new fragment */
-    PRINTF("*** Failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
-    return -1;
+  /* Fragments can arrive in any order, the first one starts the context.
+   * Waiting for a buffer would block the only fiber that frees the
+   * buffers held by the other contexts, drop the fragment instead.
+   */
+  found->buf = ip_buf_get_reserve_rx_timeout(0, K_NO_WAIT);
+  if(!found->buf) {
+    PRINTF("reassemble: no buffer, tag %d dropped\n", tag);
+    return NULL;
   }
 
-store:
-  /* i is the index of the reassembly context */
-  len = store_fragment(mbuf, i, offset);
-  if(len > 0) {
-    frag_info[i].reassembled_len += len;
-    if((offset << 3)+ len >= frag_size) {
-      frag_info[i].last_fragment = 1;
-    } else {
-      frag_info[i].last_fragment = 0;
+  found->len = frag_size;
+  found->tag = tag;
+  found->received_units = 0;
+  memset(found->received, 0, sizeof(found->received));
+  linkaddr_copy(&found->sender, sender);
+  linkaddr_copy(&found->receiver,
+                packetbuf_addr(mbuf, PACKETBUF_ADDR_RECEIVER));
+
+  timer_set(&found->reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+/* Mark the bytes from offset to end of the packet as received. Only the last
+ * fragment may end in the middle of an 8 byte unit.
+ */
+static void
+mark_received(struct sicslowpan_frag_info *info, uint16_t offset, uint16_t end)
+{
+  uint16_t unit, last;
+
+  last = (end == info->len) ? (end + 7) / 8 : end / 8;
+
+  for(unit = offset / 8; unit < last; unit++) {
+    if(!(info->received[unit / 8] & (1 << (unit % 8)))) {
+      info->received[unit / 8] |= 1 << (unit % 8);
+      info->received_units++;
     }
-    return i;
-  } else {
-    /* should we also clear all fragments since we failed to store this fragment? */
-    PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
-    return -1;
   }
 }
-
 /*---------------------------------------------------------------------------*/
-/* Copy all the fragments that are associated with a specific context into uip */
-static struct net_buf *copy_frags2uip(int context)
+/* Copy a fragment straight to its place in the packet being reassembled. The
+ * headers of the first fragment are uncompressed in place.
+ */
+static int
+add_fragment(struct sicslowpan_frag_info *info, struct net_buf *mbuf,
+             uint8_t first_fragment, uint8_t offset)
 {
-  int i, total_len = 0;
-  struct net_buf *buf;
+  const uint8_t *data = uip_packetbuf_ptr(mbuf) + uip_packetbuf_hdr_len(mbuf);
+  uint16_t len = packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf);
+  uint16_t frag_offset = (uint16_t)offset << 3;
+  int hc_len;
+
+  if(first_fragment) {
+    if(info->received[0] & 1) {
+      PRINTF("reassemble: duplicate first fragment, tag %d\n", info->tag);
+      return 0;
+    }
 
-  buf = ip_buf_get_reserve_rx(0);
-  if(!buf) {
-    return NULL;
+    hc_len = NETSTACK_COMPRESS.uncompress_hdr(info->buf, data, len,
+                                              info->len);
+    if(hc_len < 0) {
+      return -1;
+    }
+
+    data += hc_len;
+    len -= hc_len;
+    frag_offset = ip_buf_len(info->buf);
   }
 
-  /* Copy from the fragment context info buffer first */
-  linkaddr_copy(&ip_buf_ll_dest(buf), &frag_info[context].receiver);
-  linkaddr_copy(&ip_buf_ll_src(buf), &frag_info[context].sender);
-
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(i == 0) {
-       uip_first_frag_len(buf) = frag_buf[i].len;
-       if(frag_buf[i].data[0] == SICSLOWPAN_DISPATCH_IPV6) {
-         memmove(frag_buf[i].data, frag_buf[i].data + 1, frag_buf[i].len - 1);
-         frag_buf[i].len -= 1;
-         uip_uncompressed(buf) = 1;
-        } else {
-         uip_uncompressed(buf) = 0;
-        }
-    }
-    /* And also copy all matching fragments */
-    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
-      memcpy(uip_buf(buf) + (uint16_t)(frag_buf[i].offset << 3),
-            (uint8_t *)frag_buf[i].data, frag_buf[i].len);
-      total_len += frag_buf[i].len;
+  if(frag_offset + len > info->len) {
+    if(first_fragment || frag_offset >= info->len) {
+      PRINTF("reassemble: fragment beyond packet size %d\n", info->len);
+      return -1;
     }
+
+    /* We must be liberal in what we accept, ignore extraneous bytes */
+    len = info->len - frag_offset;
   }
-  net_buf_add(buf, total_len);
-  uip_len(buf) = total_len;
 
-  /* deallocate all the fragments for this context */
-  clear_fragments(context);
+  memcpy(uip_buf(info->buf) + frag_offset, data, len);
+
+  mark_received(info, first_fragment ? 0 : frag_offset, frag_offset + len);
+
+  PRINTF("Fragment payload length: %d\n", len);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Hand over the buffer of a complete packet */
+static struct net_buf *
+complete_packet(struct sicslowpan_frag_info *info)
+{
+  struct net_buf *buf = info->buf;
+
+  linkaddr_copy(&ip_buf_ll_dest(buf), &info->receiver);
+  linkaddr_copy(&ip_buf_ll_src(buf), &info->sender);
+
+  ip_buf_len(buf) = info->len;
+  uip_len(buf) = info->len;
+  uip_first_frag_len(buf) = 0;
+  uip_uncompressed(buf) = 1;
+
+  info->buf = NULL;
+  info->len = 0;
 
   return buf;
 }
 
+/* Uncompress a packet that is not fragmented straight into an IP buffer */
 static struct net_buf *copy_buf(struct net_buf *mbuf)
 {
   struct net_buf *buf;
+  const uint8_t *data = packetbuf_dataptr(mbuf);
+  uint16_t len = packetbuf_datalen(mbuf);
+  int hc_len;
 
-  buf = ip_buf_get_reserve_rx(0);
+  PRINTF("%s: mbuf datalen %d dataptr %p\n", __FUNCTION__,
+	  packetbuf_datalen(mbuf), packetbuf_dataptr(mbuf));
+  if(len == 0 || len > UIP_BUFSIZE - UIP_LLH_LEN) {
+    return NULL;
+  }
+
+  /* Do not wait for the buffers held by reassembly contexts */
+  buf = ip_buf_get_reserve_rx_timeout(0, K_NO_WAIT);
   if(!buf) {
     return NULL;
   }
 
-  /* Copy from the fragment context info buffer first */
   linkaddr_copy(&ip_buf_ll_dest(buf),
 		packetbuf_addr(mbuf, PACKETBUF_ADDR_RECEIVER));
   linkaddr_copy(&ip_buf_ll_src(buf),
 		packetbuf_addr(mbuf, PACKETBUF_ADDR_SENDER));
 
-  PRINTF("%s: mbuf datalen %d dataptr %p buf %p\n", __FUNCTION__,
-	  packetbuf_datalen(mbuf), packetbuf_dataptr(mbuf), uip_buf(buf));
-  if(packetbuf_datalen(mbuf) > 0 &&
-     packetbuf_datalen(mbuf) <= UIP_BUFSIZE - UIP_LLH_LEN) {
-    memcpy(uip_buf(buf), packetbuf_dataptr(mbuf), packetbuf_datalen(mbuf));
-    uip_len(buf) = packetbuf_datalen(mbuf);
-    net_buf_add(buf, uip_len(buf));
-  } else {
+  hc_len = NETSTACK_COMPRESS.uncompress_hdr(buf, data, len, 0);
+  if(hc_len < 0 || len - hc_len > net_buf_tailroom(buf)) {
     ip_buf_unref(buf);
-    buf = NULL;
+    return NULL;
   }
 
+  memcpy(net_buf_add(buf, len - hc_len), data + hc_len, len - hc_len);
+  uip_len(buf) = ip_buf_len(buf);
+
   uip_first_frag_len(buf) = 0;
-  uip_uncompressed(buf) = 0;
+  uip_uncompressed(buf) = 1;
   return buf;
 }
 
@@ -621,14 +623,13 @@ static int reassemble(struct net_buf *mbuf)
 {
   /* size of the IP packet (read from fragment) */
   uint16_t frag_size = 0;
-  int8_t frag_context = 0;
+  struct sicslowpan_frag_info *info;
   /* offset of the fragment in the IP packet */
   uint8_t frag_offset = 0;
-  uint8_t is_fragment = 0;
   /* tag of the fragment */
   uint16_t frag_tag = 0;
-  uint8_t first_fragment = 0, last_fragment = 0;
-  struct net_buf *buf = NULL; 
+  uint8_t first_fragment = 0;
+  struct net_buf *buf = NULL;
 
   /* init */
   uip_uncomp_hdr_len(mbuf) = 0;
@@ -641,6 +642,11 @@ static int reassemble(struct net_buf *mbuf)
      want to query us for it later. */
   last_rssi = (signed short)packetbuf_attr(mbuf, PACKETBUF_ATTR_RSSI);
 
+  /* Expire on every frame, fragmented or not, so that the buffers of
+   * incomplete packets are released even if no fragment comes anymore
+   */
+  expire_contexts();
+
    /*
    * Since we don't support the mesh and broadcast header, the first header
    * we look for is the fragmentation header
@@ -648,28 +654,8 @@ static int reassemble(struct net_buf *mbuf)
   switch((GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_DISPATCH_SIZE) & 0xf800) >> 8) {
     case SICSLOWPAN_DISPATCH_FRAG1:
       PRINTF("reassemble: FRAG1 ");
-      frag_offset = 0;
-      frag_size = GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
-      frag_tag = GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_TAG);
-
-      PRINTF("size %d, tag %d, offset %d\n", frag_size, frag_tag, frag_offset);
-
-      if (frag_size > IP_BUF_MAX_DATA) {
-        PRINTF("Too big packet %d bytes (max %d), fragment discarded\n",
-	       frag_size, IP_BUF_MAX_DATA);
-	goto fail;
-      }
-
       uip_packetbuf_hdr_len(mbuf) += SICSLOWPAN_FRAG1_HDR_LEN;
       first_fragment = 1;
-      is_fragment = 1;
-
-      /* Add the fragment to the fragmentation context (this will also copy the payload)*/
-      frag_context = add_fragment(mbuf, frag_tag, frag_size, frag_offset);
-      if(frag_context == -1) {
-        goto fail;
-      }
-
       break;
 
     case SICSLOWPAN_DISPATCH_FRAGN:
@@ -679,26 +665,7 @@ static int reassemble(struct net_buf *mbuf)
        */
       PRINTF("reassemble: FRAGN ");
       frag_offset = uip_packetbuf_ptr(mbuf)[PACKETBUF_FRAG_OFFSET];
-      frag_tag = GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_TAG);
-      frag_size = GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
-
-      PRINTF("reassemble: size %d, tag %d, offset %d\n", frag_size, frag_tag, frag_offset);
-
       uip_packetbuf_hdr_len(mbuf) += SICSLOWPAN_FRAGN_HDR_LEN;
-
-      /* If this is the last fragment, we may shave off any extrenous
-         bytes at the end. We must be liberal in what we accept. */
-      /* Add the fragment to the fragmentation context  (this will also copy the payload) */
-      frag_context = add_fragment(mbuf, frag_tag, frag_size, frag_offset);
-      if(frag_context == -1) {
-        goto fail;
-      }
-
-      if(frag_info[frag_context].reassembled_len >= frag_size
-         || frag_info[frag_context].last_fragment) {
-        last_fragment = 1;
-      }
-      is_fragment = 1;
       break;
 
     default:
@@ -712,60 +679,41 @@ static int reassemble(struct net_buf *mbuf)
       goto out;
   }
 
-  /*
-   * copy "payload" from the packetbuf buffer to the sicslowpan_buf
-   * if this is a first fragment or not fragmented packet,
-   * we have already copied the compressed headers, uncomp_hdr_len
-   * and packetbuf_hdr_len are non 0, frag_offset is.
-   * If this is a subsequent fragment, this is the contrary.
-   */
   if(packetbuf_datalen(mbuf) < uip_packetbuf_hdr_len(mbuf)) {
     PRINTF("reassemble: packet dropped due to header > total packet\n");
     goto fail;
   }
 
-  uip_packetbuf_payload_len(mbuf) = packetbuf_datalen(mbuf) - uip_packetbuf_hdr_len(mbuf);
+  frag_size = GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
+  frag_tag = GET16(uip_packetbuf_ptr(mbuf), PACKETBUF_FRAG_TAG);
 
-  /* Sanity-check size of incoming packet to avoid buffer overflow */
-  {
-    int req_size = UIP_LLH_LEN + (uint16_t)(frag_offset << 3)
-        + uip_packetbuf_payload_len(mbuf);
+  PRINTF("size %d, tag %d, offset %d\n", frag_size, frag_tag, frag_offset);
 
-    if(req_size > UIP_BUFSIZE) {
-      PRINTF("reassemble: packet dropped, minimum required IP_BUF size: %d+%d+%d=%d (current size: %d)\n", UIP_LLH_LEN, (uint16_t)(frag_offset << 3),
-              uip_packetbuf_payload_len(mbuf), req_size, UIP_BUFSIZE);
-      goto fail;
-    }
+  /* Sanity-check size of incoming packet to avoid buffer overflow */
+  if(frag_size < UIP_IPH_LEN || frag_size > IP_BUF_MAX_DATA - UIP_LLH_LEN) {
+    PRINTF("Bad packet size %d bytes (max %d), fragment discarded\n",
+           frag_size, IP_BUF_MAX_DATA - UIP_LLH_LEN);
+    goto fail;
   }
 
-  if(frag_size > 0) {
-    /* Add the size of the header only for the first fragment. */
-    if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uip_uncomp_hdr_len(mbuf) + uip_packetbuf_payload_len(mbuf);
-    }
+  info = get_context(mbuf, frag_tag, frag_size);
+  if(!info) {
+    goto fail;
+  }
 
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
-    if(last_fragment != 0) {
-      frag_info[frag_context].reassembled_len = frag_size;
-      /* copy to uip(net_buf) */
-      buf = copy_frags2uip(frag_context);
-      if(!buf)
-        goto fail;
-    }
+  /* Add the fragment to the fragmentation context (this will also copy the payload)*/
+  if(add_fragment(info, mbuf, first_fragment, frag_offset) < 0) {
+    PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d\n",
+           frag_tag);
+    clear_fragments(info);
+    goto fail;
   }
 
   /*
-   * If we have a full IP packet in sicslowpan_buf, deliver it to
-   * the IP stack
+   * If we have a full IP packet, deliver it to the IP stack
    */
-  if(!is_fragment || last_fragment) {
-    /* packet is in uip already - just set length */
-    if(is_fragment != 0 && last_fragment != 0) {
-      uip_len(buf) = frag_size;
-    } else {
-      uip_len(buf) = uip_packetbuf_payload_len(mbuf) + uip_uncomp_hdr_len(mbuf);
-    }
+  if(info->received_units == (frag_size + 7) / 8) {
+    buf = complete_packet(info);
 
     PRINTF("reassemble: IP packet ready (length %d)\n", uip_len(buf));
 
@@ -174,14 +174,27 @@ static inline const char *type2str(enum ip_buf_type type)
 	return NULL;
 }
 
+/* K_FOREVER waits, except in an ISR, like net_buf_get() */
+static inline struct net_buf *get_free_buf(struct nano_fifo *fifo,
+					   int32_t timeout)
+{
+	if (timeout == K_FOREVER) {
+		return net_buf_get(fifo, 0);
+	}
+
+	return net_buf_get_timeout(fifo, 0, timeout);
+}
+
 #ifdef DEBUG_IP_BUFS
 static struct net_buf *ip_buf_get_reserve_debug(enum ip_buf_type type,
 						uint16_t reserve_head,
+						int32_t timeout,
 						const char *caller,
 						int line)
 #else
 static struct net_buf *ip_buf_get_reserve(enum ip_buf_type type,
-					  uint16_t reserve_head)
+					  uint16_t reserve_head,
+					  int32_t timeout)
 #endif
 {
 	struct net_buf *buf = NULL;
@@ -198,11 +211,11 @@ static struct net_buf *ip_buf_get_reserve(enum ip_buf_type type,
 	 */
 	switch (type) {
 	case IP_BUF_RX:
-		buf = net_buf_get(&free_rx_bufs, 0);
+		buf = get_free_buf(&free_rx_bufs, timeout);
 		dec_free_rx_bufs(buf);
 		break;
 	case IP_BUF_TX:
-		buf = net_buf_get(&free_tx_bufs, 0);
+		buf = get_free_buf(&free_tx_bufs, timeout);
 		dec_free_tx_bufs(buf);
 		break;
 	}
@@ -243,10 +256,28 @@ struct net_buf *ip_buf_get_reserve_rx(uint16_t reserve_head)
 #endif
 {
 #ifdef DEBUG_IP_BUFS
-	return ip_buf_get_reserve_debug(IP_BUF_RX, reserve_head,
+	return ip_buf_get_reserve_debug(IP_BUF_RX, reserve_head, K_FOREVER,
+					caller, line);
+#else
+	return ip_buf_get_reserve(IP_BUF_RX, reserve_head, K_FOREVER);
+#endif
+}
+
+#ifdef DEBUG_IP_BUFS
+struct net_buf *ip_buf_get_reserve_rx_timeout_debug(uint16_t reserve_head,
+						    int32_t timeout,
+						    const char *caller,
+						    int line)
+#else
+struct net_buf *ip_buf_get_reserve_rx_timeout(uint16_t reserve_head,
+					      int32_t timeout)
+#endif
+{
+#ifdef DEBUG_IP_BUFS
+	return ip_buf_get_reserve_debug(IP_BUF_RX, reserve_head, timeout,
 					caller, line);
 #else
-	return ip_buf_get_reserve(IP_BUF_RX, reserve_head);
+	return ip_buf_get_reserve(IP_BUF_RX, reserve_head, timeout);
 #endif
 }
 
@@ -257,10 +288,10 @@ struct net_buf *ip_buf_get_reserve_tx(uint16_t reserve_head)
 #endif
 {
 #ifdef DEBUG_IP_BUFS
-	return ip_buf_get_reserve_debug(IP_BUF_TX, reserve_head,
+	return ip_buf_get_reserve_debug(IP_BUF_TX, reserve_head, K_FOREVER,
 					caller, line);
 #else
-	return ip_buf_get_reserve(IP_BUF_TX, reserve_head);
+	return ip_buf_get_reserve(IP_BUF_TX, reserve_head, K_FOREVER);
 #endif
 }
 
@@ -295,9 +326,9 @@ static struct net_buf *ip_buf_get(enum ip_buf_type type,
 	}
 
 #ifdef DEBUG_IP_BUFS
-	buf = ip_buf_get_reserve_debug(type, reserve, caller, line);
+	buf = ip_buf_get_reserve_debug(type, reserve, K_FOREVER, caller, line);
 #else
-	buf = ip_buf_get_reserve(type, reserve);
+	buf = ip_buf_get_reserve(type, reserve, K_FOREVER);
 #endif
 	if (!buf) {
 		return buf;
@@ -236,7 +236,7 @@ static void stats(void)
 	static clock_time_t last_print;
 
 	/* See contiki/ip/uip.h for descriptions of the different values */
-	if (clock_time() > (last_print + PRINT_STATISTICS_INTERVAL)) {
+	if (clock_time() >= (last_print + PRINT_STATISTICS_INTERVAL)) {
 #if NET_MAC_CONF_STATS
 #define MAC_STAT(s) (net_mac_stats.s)
 		NET_DBG("L2 bytes recv  %d\tsent\t%d\n",
@@ -854,6 +854,36 @@ static int check_and_send_packet(struct net_buf *buf)
 	return ret;
 }
 
+/* Send one packet queued by an application */
+static void net_tx_packet(struct net_buf *buf)
+{
+	int ret;
+
+	NET_DBG("Sending (buf %p, len %u) to IP stack\n", buf, buf->len);
+
+	/* What to do with the buffer:
+	 *  <0: error, release the buffer
+	 *   0: message was discarded by uIP, release the buffer here
+	 *  >0: message was sent ok, buffer released already
+	 */
+	ret = check_and_send_packet(buf);
+	if (ret < 0) {
+		ip_buf_unref(buf);
+		return;
+	} else if (ret > 0) {
+		return;
+	}
+
+	NET_BUF_CHECK_IF_NOT_IN_USE(buf);
+
+	/* Check for any events that we might need to process */
+	do {
+		ret = process_run(buf);
+	} while (ret > 0);
+
+	ip_buf_unref(buf);
+}
+
 static void net_tx_fiber(void)
 {
 	NET_DBG("Starting TX fiber (stack %zu bytes)\n",
@@ -861,42 +891,25 @@ static void net_tx_fiber(void)
 
 	while (1) {
 		struct net_buf *buf;
-		int ret;
+		int count = 0;
 
 		/* Get next packet from application - wait if necessary */
 		buf = net_buf_get_timeout(&netdev.tx_queue, 0, TICKS_UNLIMITED);
 
-		NET_DBG("Sending (buf %p, len %u) to IP stack\n",
-			buf, buf->len);
-
-		/* What to do with the buffer:
-		 *  <0: error, release the buffer
-		 *   0: message was discarded by uIP, release the buffer here
-		 *  >0: message was sent ok, buffer released already
+		/* Send the packets queued meanwhile without waiting again,
+		 * but let the other network fibers run between batches.
 		 */
-		ret = check_and_send_packet(buf);
-		if (ret < 0) {
-			ip_buf_unref(buf);
-			goto wait_next;
-		} else if (ret > 0) {
-			goto wait_next;
-		}
-
-		NET_BUF_CHECK_IF_NOT_IN_USE(buf);
-
-		/* Check for any events that we might need to process */
 		do {
-			ret = process_run(buf);
-		} while (ret > 0);
+			net_tx_packet(buf);
 
-		ip_buf_unref(buf);
-
-	wait_next:
-		/* Check stack usage (no-op if not enabled) */
-		net_analyze_stack("TX fiber", tx_fiber_stack,
-				  sizeof(tx_fiber_stack));
+			if (++count == CONFIG_IP_TX_BATCH_SIZE) {
+				fiber_yield();
+				count = 0;
+			}
 
-		net_print_statistics();
+			buf = net_buf_get_timeout(&netdev.tx_queue, 0,
+						  TICKS_NONE);
+		} while (buf);
 	}
 }
 
@@ -910,10 +923,6 @@ static void net_rx_fiber(void)
 	while (1) {
 		buf = net_buf_get_timeout(&netdev.rx_queue, 0, TICKS_UNLIMITED);
 
-		/* Check stack usage (no-op if not enabled) */
-		net_analyze_stack("RX fiber", rx_fiber_stack,
-				  sizeof(rx_fiber_stack));
-
 		NET_DBG("Received buf %p\n", buf);
 
 		if (!tcpip_input(buf)) {
@@ -922,10 +931,32 @@ static void net_rx_fiber(void)
 		/* The buffer is on to its way to receiver at this
 		 * point. We must not remove it here.
 		 */
+	}
+}
 
-		net_print_statistics();
+#ifdef CONFIG_INIT_STACKS
+#define PRINT_CYCLE (60 * sys_clock_ticks_per_sec)
+
+/* Print stack usage of the network fibers every PRINT_CYCLE ticks */
+static void analyze_stacks(void)
+{
+	static uint32_t next_print;
+	uint32_t curr = sys_tick_get_32();
+
+	if (next_print && (int32_t)(curr - next_print) < 0) {
+		return;
 	}
+
+	net_analyze_stack("RX fiber", rx_fiber_stack, sizeof(rx_fiber_stack));
+	net_analyze_stack("TX fiber", tx_fiber_stack, sizeof(tx_fiber_stack));
+	net_analyze_stack("timer fiber", timer_fiber_stack,
+			  sizeof(timer_fiber_stack));
+
+	next_print = curr + PRINT_CYCLE;
 }
+#else
+#define analyze_stacks()
+#endif
 
 /*
  * Run various Contiki timers.
@@ -943,42 +974,27 @@ static void net_timer_fiber(void)
 		/* Run various timers */
 		next_wakeup = etimer_request_poll();
 
-		if (next_wakeup == 0) {
+		if (next_wakeup == 0 || next_wakeup > MAX_TIMER_WAKEUP) {
 			/* There was no timers, wait again */
 			next_wakeup = MAX_TIMER_WAKEUP;
-		} else {
-			if (next_wakeup > MAX_TIMER_WAKEUP) {
-				next_wakeup = MAX_TIMER_WAKEUP;
-			}
+		}
 
-#ifdef CONFIG_INIT_STACKS
-			{
-#define PRINT_CYCLE (60 * sys_clock_ticks_per_sec)
+		/* Statistics and stack usage are reported from here rather
+		 * than per packet, keep waking up often enough for them.
+		 */
+		net_print_statistics();
+		analyze_stacks();
 
-				static uint32_t next_print;
-				uint32_t curr = sys_tick_get_32();
-
-				/* Print stack usage every n. sec */
-				if (!next_print ||
-				    (next_print < curr &&
-				     (!((curr - next_print) > PRINT_CYCLE)))) {
-					uint32_t new_print;
-
-					net_analyze_stack("timer fiber",
-							  timer_fiber_stack,
-						  sizeof(timer_fiber_stack));
-					new_print = curr + PRINT_CYCLE;
-					if (new_print > curr) {
-						next_print = new_print;
-					} else {
-						/* Overflow */
-						next_print = PRINT_CYCLE -
-							(0xffffffff - curr);
-					}
-				}
-			}
+#ifdef CONFIG_NETWORKING_STATISTICS
+		if (next_wakeup > PRINT_STATISTICS_INTERVAL) {
+			next_wakeup = PRINT_STATISTICS_INTERVAL;
+		}
 #endif
+#ifdef CONFIG_INIT_STACKS
+		if (next_wakeup > PRINT_CYCLE) {
+			next_wakeup = PRINT_CYCLE;
 		}
+#endif
 
 		fiber_sleep(next_wakeup);
 	}
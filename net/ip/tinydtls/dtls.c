@@ -77,7 +77,7 @@ static NET_BUF_POOL(tx_buffer, 1, IP_BUF_MAX_DATA - UIP_IPUDPH_LEN,
 #define DTLS_HS_LENGTH sizeof(dtls_handshake_header_t)
 #define DTLS_CH_LENGTH sizeof(dtls_client_hello_t) /* no variable length fields! */
 #define DTLS_COOKIE_LENGTH_MAX 32
-#define DTLS_CH_LENGTH_MAX sizeof(dtls_client_hello_t) + DTLS_COOKIE_LENGTH_MAX + 12 + 26
+#define DTLS_CH_LENGTH_MAX sizeof(dtls_client_hello_t) + DTLS_SESSION_ID_LENGTH_MAX + DTLS_COOKIE_LENGTH_MAX + 12 + 26
 #define DTLS_HV_LENGTH sizeof(dtls_hello_verify_t)
 #define DTLS_SH_LENGTH (2 + DTLS_RANDOM_LENGTH + 1 + 2 + 1)
 #define DTLS_CE_LENGTH (3 + 3 + 27 + DTLS_EC_KEY_SIZE + DTLS_EC_KEY_SIZE)
@@ -212,21 +212,129 @@ dtls_send(dtls_context_t *ctx, dtls_peer_t *peer, unsigned char type,
  */
 static void dtls_stop_retransmission(dtls_context_t *context, dtls_peer_t *peer);
 
+#define PEER_BUCKET(Session) (dtls_session_hash(Session) % DTLS_PEER_HASH_SIZE)
+
 dtls_peer_t *
 dtls_get_peer(const dtls_context_t *ctx, const session_t *session) {
-  dtls_peer_t *p = NULL;
+  dtls_peer_t *p;
 
-  for (p = list_head(ctx->peers); p; p = list_item_next(p))
+  for (p = ctx->peer_hash[PEER_BUCKET(session)]; p; p = p->hash_next)
     if (dtls_session_equals(&p->session, session))
       return p;
 
-  return p;
+  return NULL;
 }
 
 static void
 dtls_add_peer(dtls_context_t *ctx, dtls_peer_t *peer) {
+  dtls_peer_t **bucket = &ctx->peer_hash[PEER_BUCKET(&peer->session)];
+
   list_add(ctx->peers, peer);
+  peer->hash_next = *bucket;
+  *bucket = peer;
+}
+
+static void
+dtls_remove_peer(dtls_context_t *ctx, dtls_peer_t *peer) {
+  dtls_peer_t **p = &ctx->peer_hash[PEER_BUCKET(&peer->session)];
+
+  list_remove(ctx->peers, peer);
+  while (*p && *p != peer)
+    p = &(*p)->hash_next;
+  if (*p)
+    *p = peer->hash_next;
+}
+
+#if DTLS_SESSION_CACHE_MAX > 0
+#define SESSION_CACHE_END(Ctx) ((Ctx)->session_cache + DTLS_SESSION_CACHE_MAX)
+
+static inline void
+dtls_cache_touch(dtls_context_t *ctx, dtls_cached_session_t *cached) {
+  cached->last_used = ++ctx->session_cache_clock;
+}
+
+/** Returns the session a client offers to resume with the server @p session. */
+static dtls_cached_session_t *
+dtls_cache_find_server(dtls_context_t *ctx, const session_t *session) {
+  dtls_cached_session_t *c;
+
+  for (c = ctx->session_cache; c < SESSION_CACHE_END(ctx); c++)
+    if (c->id_length && c->role == DTLS_CLIENT &&
+	dtls_session_equals(&c->session, session))
+      return c;
+
+  return NULL;
+}
+
+/** Returns the session a client asks a server to resume. */
+static dtls_cached_session_t *
+dtls_cache_find_id(dtls_context_t *ctx, const uint8 *id, size_t id_length) {
+  dtls_cached_session_t *c;
+
+  if (!id_length)
+    return NULL;
+
+  for (c = ctx->session_cache; c < SESSION_CACHE_END(ctx); c++)
+    if (c->id_length == id_length && c->role == DTLS_SERVER &&
+	memcmp(c->id, id, id_length) == 0)
+      return c;
+
+  return NULL;
+}
+
+/**
+ * Stores the session just established with @p peer, replacing the
+ * least recently used entry when the cache is full.
+ */
+static void
+dtls_cache_store(dtls_context_t *ctx, dtls_peer_t *peer) {
+  dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *c, *victim = NULL;
+
+  if (!handshake->session_id_length)
+    return;
+
+  if (peer->role == DTLS_CLIENT)
+    victim = dtls_cache_find_server(ctx, &peer->session);
+  else
+    victim = dtls_cache_find_id(ctx, handshake->session_id,
+				handshake->session_id_length);
+
+  if (!victim) {
+    /* take a free entry, or else the least recently used one */
+    victim = ctx->session_cache;
+    for (c = victim + 1; victim->id_length && c < SESSION_CACHE_END(ctx); c++)
+      if (!c->id_length || (int)(c->last_used - victim->last_used) < 0)
+	victim = c;
+  }
+
+  victim->session = peer->session;
+  victim->role = peer->role;
+  victim->cipher = handshake->cipher;
+  victim->compression = handshake->compression;
+  victim->id_length = handshake->session_id_length;
+  memcpy(victim->id, handshake->session_id, handshake->session_id_length);
+  memcpy(victim->master_secret, handshake->tmp.master_secret,
+	 DTLS_MASTER_SECRET_LENGTH);
+  dtls_cache_touch(ctx, victim);
+}
+
+/** Forgets the sessions with @p session, e.g. after a fatal alert. */
+static void
+dtls_cache_remove(dtls_context_t *ctx, const session_t *session) {
+  dtls_cached_session_t *c;
+
+  for (c = ctx->session_cache; c < SESSION_CACHE_END(ctx); c++)
+    if (c->id_length && dtls_session_equals(&c->session, session))
+      memset(c, 0, sizeof(*c));
 }
+#else /* DTLS_SESSION_CACHE_MAX */
+#define dtls_cache_touch(Ctx, Cached)
+#define dtls_cache_find_server(Ctx, Session) NULL
+#define dtls_cache_find_id(Ctx, Id, Length) NULL
+#define dtls_cache_store(Ctx, Peer)
+#define dtls_cache_remove(Ctx, Session)
+#endif /* DTLS_SESSION_CACHE_MAX */
 
 int
 dtls_write(struct dtls_context_t *ctx, 
@@ -588,6 +696,36 @@ static char *dtls_handshake_type_to_name(int type)
   }
 }
 
+/**
+ * Derive the key block of @p security from @p master_secret and the
+ * client and server random. The master secret then replaces the random
+ * in @p handshake, for use in the Finished messages.
+ */
+static void
+derive_key_block(dtls_handshake_parameters_t *handshake,
+		 dtls_security_parameters_t *security,
+		 const uint8 *master_secret,
+		 dtls_peer_type role) {
+  /* create key_block from master_secret
+   * key_block = PRF(master_secret,
+                    "key expansion" + tmp.random.server + tmp.random.client) */
+
+  dtls_prf(master_secret,
+	   DTLS_MASTER_SECRET_LENGTH,
+	   PRF_LABEL(key), PRF_LABEL_SIZE(key),
+	   handshake->tmp.random.server, DTLS_RANDOM_LENGTH,
+	   handshake->tmp.random.client, DTLS_RANDOM_LENGTH,
+	   security->key_block,
+	   dtls_kb_size(security, role));
+
+  memcpy(handshake->tmp.master_secret, master_secret, DTLS_MASTER_SECRET_LENGTH);
+  dtls_debug_keyblock(security);
+
+  security->cipher = handshake->cipher;
+  security->compression = handshake->compression;
+  security->rseq = 0;
+}
+
 /**
  * Calculate the pre master secret and after that calculate the master-secret.
  */
@@ -671,24 +809,30 @@ calculate_key_block(dtls_context_t *ctx,
 
   dtls_debug_dump("master_secret", master_secret, DTLS_MASTER_SECRET_LENGTH);
 
-  /* create key_block from master_secret
-   * key_block = PRF(master_secret,
-                    "key expansion" + tmp.random.server + tmp.random.client) */
+  derive_key_block(handshake, security, master_secret, role);
 
-  dtls_prf(master_secret,
-	   DTLS_MASTER_SECRET_LENGTH,
-	   PRF_LABEL(key), PRF_LABEL_SIZE(key),
-	   handshake->tmp.random.server, DTLS_RANDOM_LENGTH,
-	   handshake->tmp.random.client, DTLS_RANDOM_LENGTH,
-	   security->key_block,
-	   dtls_kb_size(security, role));
+  return 0;
+}
 
-  memcpy(handshake->tmp.master_secret, master_secret, DTLS_MASTER_SECRET_LENGTH);
-  dtls_debug_keyblock(security);
+/**
+ * Calculate the key block of an abbreviated handshake from the master
+ * secret of the @p cached session.
+ */
+static int
+resume_key_block(dtls_handshake_parameters_t *handshake,
+		 dtls_peer_t *peer,
+		 const dtls_cached_session_t *cached) {
+  dtls_security_parameters_t *security = dtls_security_params_next(peer);
 
-  security->cipher = handshake->cipher;
-  security->compression = handshake->compression;
-  security->rseq = 0;
+  if (!security) {
+    return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+  }
+
+  handshake->cipher = cached->cipher;
+  handshake->compression = cached->compression;
+  handshake->resumed = 1;
+
+  derive_key_block(handshake, security, cached->master_secret, peer->role);
 
   return 0;
 }
@@ -913,6 +1057,15 @@ dtls_update_parameters(dtls_context_t *ctx,
   data += DTLS_RANDOM_LENGTH;
   data_length -= DTLS_RANDOM_LENGTH;
 
+  /* remember the session id the client wants to resume */
+  i = dtls_uint8_to_int(data);
+  if (i <= DTLS_SESSION_ID_LENGTH_MAX && data_length >= i + sizeof(uint8)) {
+    memcpy(config->session_id, data + sizeof(uint8), i);
+    config->session_id_length = i;
+  } else {
+    config->session_id_length = 0;
+  }
+
   /* Caution: SKIP_VAR_FIELD may jump to error: */
   SKIP_VAR_FIELD(data, data_length, uint8);	/* skip session id */
   SKIP_VAR_FIELD(data, data_length, uint8);	/* skip cookie */
@@ -1531,7 +1684,7 @@ static void dtls_destroy_peer(dtls_context_t *ctx, dtls_peer_t *peer, int unlink
   if (peer->state != DTLS_STATE_CLOSED && peer->state != DTLS_STATE_CLOSING)
     dtls_close(ctx, &peer->session);
   if (unlink) {
-    list_remove(ctx->peers, peer);
+    dtls_remove_peer(ctx, peer);
     dtls_dsrv_log_addr(DTLS_LOG_DEBUG, "removed peer", &peer->session);
   }
   dtls_free_peer(peer);
@@ -1754,7 +1907,7 @@ dtls_send_server_hello(dtls_context_t *ctx, dtls_peer_t *peer)
   /* Ensure that the largest message to create fits in our source
    * buffer. (The size of the destination buffer is checked by the
    * encoding function, so we do not need to guess.) */
-  uint8 buf[DTLS_SH_LENGTH + 2 + 5 + 5 + 8 + 6];
+  uint8 buf[DTLS_SH_LENGTH + DTLS_SESSION_ID_LENGTH_MAX + 2 + 5 + 5 + 8 + 6];
   uint8 *p;
   int ecdsa;
   uint8 extension_size;
@@ -1781,7 +1934,11 @@ dtls_send_server_hello(dtls_context_t *ctx, dtls_peer_t *peer)
   memcpy(p, handshake->tmp.random.server, DTLS_RANDOM_LENGTH);
   p += DTLS_RANDOM_LENGTH;
 
-  *p++ = 0;			/* no session id */
+  /* session id, echoed when resuming a session */
+  dtls_int_to_uint8(p, handshake->session_id_length);
+  p += sizeof(uint8);
+  memcpy(p, handshake->session_id, handshake->session_id_length);
+  p += handshake->session_id_length;
 
   if (handshake->cipher != TLS_NULL_WITH_NULL_NULL) {
     /* selected cipher suite */
@@ -2320,6 +2477,59 @@ dtls_send_finished(dtls_context_t *ctx, dtls_peer_t *peer,
 				 buf, p - buf);
 }
 
+/**
+ * Resumes the session the client offered in its ClientHello, if it is
+ * in the cache: sends ServerHello, ChangeCipherSpec and Finished, then
+ * waits for the client's ChangeCipherSpec and Finished. This function
+ * returns \c 1 when the session is resumed, \c 0 when a full handshake
+ * is needed, or a negative value on error.
+ */
+static int
+dtls_resume_session(dtls_context_t *ctx, dtls_peer_t *peer)
+{
+  dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *cached;
+  int res;
+
+  cached = dtls_cache_find_id(ctx, handshake->session_id,
+			      handshake->session_id_length);
+  if (!cached || !known_cipher(ctx, cached->cipher, 0))
+    return 0;
+
+  /* ServerHello creates the server random the keys depend on */
+  handshake->cipher = cached->cipher;
+  handshake->compression = cached->compression;
+
+  res = dtls_send_server_hello(ctx, peer);
+  if (res < 0) {
+    dtls_debug("dtls_resume_session: cannot prepare ServerHello record\n");
+    return res;
+  }
+
+  res = resume_key_block(handshake, peer, cached);
+  if (res < 0)
+    return res;
+
+  res = dtls_send_ccs(ctx, peer);
+  if (res < 0) {
+    dtls_warn("cannot send CCS message\n");
+    return res;
+  }
+
+  dtls_security_params_switch(peer);
+
+  res = dtls_send_finished(ctx, peer, PRF_LABEL(server), PRF_LABEL_SIZE(server));
+  if (res < 0) {
+    dtls_warn("sending server Finished failed\n");
+    return res;
+  }
+
+  dtls_cache_touch(ctx, cached);
+  peer->state = DTLS_STATE_WAIT_CHANGECIPHERSPEC;
+
+  return 1;
+}
+
 static int
 dtls_send_client_hello(dtls_context_t *ctx, dtls_peer_t *peer,
                        uint8 cookie[], size_t cookie_length) {
@@ -2330,6 +2540,7 @@ dtls_send_client_hello(dtls_context_t *ctx, dtls_peer_t *peer,
   int psk;
   int ecdsa;
   dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *cached;
   dtls_tick_t now;
 
   psk = is_psk_supported(ctx);
@@ -2357,14 +2568,28 @@ dtls_send_client_hello(dtls_context_t *ctx, dtls_peer_t *peer,
     dtls_int_to_uint32(handshake->tmp.random.client, now / CLOCK_SECOND);
     dtls_prng(handshake->tmp.random.client + sizeof(uint32),
          DTLS_RANDOM_LENGTH - sizeof(uint32));
+
+    /* Offer to resume the last session with this server, unless this
+     * is a renegotiation. */
+    cached = NULL;
+    if (peer->state != DTLS_STATE_CONNECTED)
+      cached = dtls_cache_find_server(ctx, &peer->session);
+    if (cached) {
+      memcpy(handshake->session_id, cached->id, cached->id_length);
+      handshake->session_id_length = cached->id_length;
+    } else {
+      handshake->session_id_length = 0;
+    }
   }
   /* we must use the same Client Random as for the previous request */
   memcpy(p, handshake->tmp.random.client, DTLS_RANDOM_LENGTH);
   p += DTLS_RANDOM_LENGTH;
 
-  /* session id (length 0) */
-  dtls_int_to_uint8(p, 0);
+  /* session id, also the same as for the previous request */
+  dtls_int_to_uint8(p, handshake->session_id_length);
   p += sizeof(uint8);
+  memcpy(p, handshake->session_id, handshake->session_id_length);
+  p += handshake->session_id_length;
 
   /* cookie */
   dtls_int_to_uint8(p, cookie_length);
@@ -2478,6 +2703,8 @@ check_server_hello(dtls_context_t *ctx,
 		      uint8 *data, size_t data_length)
 {
   dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *cached = NULL;
+  int err;
 
   /* This function is called when we expect a ServerHello (i.e. we
    * have sent a ClientHello).  We might instead receive a HelloVerify
@@ -2514,6 +2741,27 @@ check_server_hello(dtls_context_t *ctx,
   data += DTLS_RANDOM_LENGTH;
   data_length -= DTLS_RANDOM_LENGTH;
 
+  /* The server resumes the session we offered by echoing its id,
+   * otherwise it may give us a new one to offer next time. */
+  if (dtls_uint8_to_int(data) > DTLS_SESSION_ID_LENGTH_MAX ||
+      data_length < dtls_uint8_to_int(data) + sizeof(uint8))
+    goto error;
+
+  if (handshake->session_id_length &&
+      dtls_uint8_to_int(data) == handshake->session_id_length &&
+      memcmp(data + sizeof(uint8), handshake->session_id,
+	     handshake->session_id_length) == 0) {
+    cached = dtls_cache_find_server(ctx, &peer->session);
+    if (!cached) {
+      dtls_alert("cannot resume unknown session\n");
+      return dtls_alert_fatal_create(DTLS_ALERT_HANDSHAKE_FAILURE);
+    }
+  } else {
+    handshake->session_id_length = dtls_uint8_to_int(data);
+    memcpy(handshake->session_id, data + sizeof(uint8),
+	   handshake->session_id_length);
+  }
+
   SKIP_VAR_FIELD(data, data_length, uint8); /* skip session id */
     
   /* Check cipher suite. As we offer all we have, it is sufficient
@@ -2536,7 +2784,17 @@ check_server_hello(dtls_context_t *ctx,
   data += sizeof(uint8);
   data_length -= sizeof(uint8);
 
-  return dtls_check_tls_extension(peer, data, data_length, 0);
+  err = dtls_check_tls_extension(peer, data, data_length, 0);
+  if (err < 0 || !cached)
+    return err;
+
+  /* A resumed session keeps its cipher suite. */
+  if (handshake->cipher != cached->cipher) {
+    dtls_alert("cipher changed while resuming session\n");
+    return dtls_alert_fatal_create(DTLS_ALERT_ILLEGAL_PARAMETER);
+  }
+
+  return resume_key_block(handshake, peer, cached);
 
 error:
   return dtls_alert_fatal_create(DTLS_ALERT_DECODE_ERROR);
@@ -3055,7 +3313,9 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
       dtls_warn("error in check_server_hello err: %i\n", err);
       return err;
     }
-    if (is_tls_ecdhe_ecdsa_with_aes_128_ccm_8(peer->handshake_params->cipher))
+    if (peer->handshake_params->resumed)
+      peer->state = DTLS_STATE_WAIT_CHANGECIPHERSPEC;
+    else if (is_tls_ecdhe_ecdsa_with_aes_128_ccm_8(peer->handshake_params->cipher))
       peer->state = DTLS_STATE_WAIT_SERVERCERTIFICATE;
     else
       peer->state = DTLS_STATE_WAIT_SERVERHELLODONE;
@@ -3155,8 +3415,9 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
       dtls_warn("error in check_finished err: %i\n", err);
       return err;
     }
-    if (role == DTLS_SERVER) {
-      /* send ServerFinished */
+    /* The server answers the client's Finished in a full handshake,
+     * the client answers the server's in an abbreviated one. */
+    if ((role == DTLS_SERVER) != peer->handshake_params->resumed) {
       update_hs_hash(peer, data, data_length);
 
       /* send change cipher spec message and switch to new configuration */
@@ -3168,12 +3429,16 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
 
       dtls_security_params_switch(peer);
 
-      err = dtls_send_finished(ctx, peer, PRF_LABEL(server), PRF_LABEL_SIZE(server));
+      if (role == DTLS_SERVER)
+	err = dtls_send_finished(ctx, peer, PRF_LABEL(server), PRF_LABEL_SIZE(server));
+      else
+	err = dtls_send_finished(ctx, peer, PRF_LABEL(client), PRF_LABEL_SIZE(client));
       if (err < 0) {
-        dtls_warn("sending server Finished failed\n");
+        dtls_warn("sending Finished failed\n");
         return err;
       }
     }
+    dtls_cache_store(ctx, peer);
     dtls_handshake_free(peer->handshake_params);
     peer->handshake_params = NULL;
     dtls_debug("Handshake complete\n");
@@ -3304,6 +3569,26 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
     /* update finish MAC */
     update_hs_hash(peer, data, data_length);
 
+    if (state != DTLS_STATE_CONNECTED) {
+      err = dtls_resume_session(ctx, peer);
+      if (err < 0) {
+        return err;
+      }
+
+      if (err > 0) {
+        dtls_debug("abbreviated handshake, session resumed\n");
+        break;
+      }
+    }
+
+#if DTLS_SESSION_CACHE_MAX > 0
+    /* give the client a new session to resume later */
+    dtls_prng(peer->handshake_params->session_id, DTLS_SESSION_ID_LENGTH_MAX);
+    peer->handshake_params->session_id_length = DTLS_SESSION_ID_LENGTH_MAX;
+#else
+    peer->handshake_params->session_id_length = 0;
+#endif /* DTLS_SESSION_CACHE_MAX */
+
     err = dtls_send_server_hello_msgs(ctx, peer);
     if (err < 0) {
       return err;
@@ -3490,8 +3775,9 @@ handle_ccs(dtls_context_t *ctx, dtls_peer_t *peer,
   if (data_length < 1 || data[0] != 1)
     return dtls_alert_fatal_create(DTLS_ALERT_DECODE_ERROR);
 
-  /* Just change the cipher when we are on the same epoch */
-  if (peer->role == DTLS_SERVER) {
+  /* Just change the cipher when we are on the same epoch. In an
+   * abbreviated handshake, the keys are known since the ServerHello. */
+  if (peer->role == DTLS_SERVER && !handshake->resumed) {
     err = calculate_key_block(ctx, handshake, peer,
 			      &peer->session, peer->role);
     if (err < 0) {
@@ -3532,7 +3818,11 @@ handle_alert(dtls_context_t *ctx, dtls_peer_t *peer,
   if (data[0] == DTLS_ALERT_LEVEL_FATAL || data[1] == DTLS_ALERT_CLOSE_NOTIFY) {
     dtls_alert("%d invalidate peer\n", data[1]);
     
-    list_remove(ctx->peers, peer);
+    dtls_remove_peer(ctx, peer);
+
+    /* a session that failed must not be resumed */
+    if (data[1] != DTLS_ALERT_CLOSE_NOTIFY)
+      dtls_cache_remove(ctx, &peer->session);
 
 #ifdef WITH_CONTIKI
 #ifndef NDEBUG
@@ -3583,6 +3873,8 @@ static int dtls_alert_send_from_err(dtls_context_t *ctx, dtls_peer_t *peer,
       peer = dtls_get_peer(ctx, session);
     }
     if (peer) {
+      if (level == DTLS_ALERT_LEVEL_FATAL)
+	dtls_cache_remove(ctx, &peer->session);
       peer->state = DTLS_STATE_CLOSING;
       return dtls_send_alert(ctx, peer, level, desc);
     }
@@ -3591,6 +3883,7 @@ static int dtls_alert_send_from_err(dtls_context_t *ctx, dtls_peer_t *peer,
       peer = dtls_get_peer(ctx, session);
     }
     if (peer) {
+      dtls_cache_remove(ctx, &peer->session);
       peer->state = DTLS_STATE_CLOSING;
       return dtls_send_alert(ctx, peer, DTLS_ALERT_LEVEL_FATAL, DTLS_ALERT_INTERNAL_ERROR);
     }
@@ -3702,9 +3995,11 @@ dtls_handle_message(dtls_context_t *ctx,
 	/* The new security parameters must be used for all messages
 	 * that are sent after the ChangeCipherSpec message. This
 	 * means that the client's Finished message uses epoch + 1
-	 * while the server is still in the old epoch.
+	 * while the server is still in the old epoch. In an abbreviated
+	 * handshake, the server sends its Finished message first.
 	 */
-	if (role == DTLS_SERVER && state == DTLS_STATE_WAIT_FINISHED) {
+	if (state == DTLS_STATE_WAIT_FINISHED && peer->handshake_params &&
+	    (role == DTLS_SERVER) != peer->handshake_params->resumed) {
 	  expected_epoch++;
 	}
 
@@ -65,6 +65,20 @@ typedef struct dtls_ecdsa_key_t {
 /** Length of the secret that is used for generating Hello Verify cookies. */
 #define DTLS_COOKIE_SECRET_LENGTH 12
 
+#ifndef DTLS_PEER_HASH_SIZE
+/** Number of buckets of the hash table used to look up peers. */
+#define DTLS_PEER_HASH_SIZE 8
+#endif
+
+#ifndef DTLS_SESSION_CACHE_MAX
+/** Number of sessions kept for resumption, 0 disables resumption. */
+#ifdef CONFIG_TINYDTLS_SESSION_CACHE_SIZE
+#define DTLS_SESSION_CACHE_MAX CONFIG_TINYDTLS_SESSION_CACHE_SIZE
+#else
+#define DTLS_SESSION_CACHE_MAX 4
+#endif
+#endif
+
 struct dtls_context_t;
 
 /**
@@ -214,12 +228,34 @@ typedef struct {
 #endif /* DTLS_ECC */
 } dtls_handler_t;
 
+/**
+ * A session established with a full handshake, that can be resumed
+ * with an abbreviated handshake (RFC 5246, section 7.3). Servers look
+ * sessions up by identifier, clients by server address.
+ */
+typedef struct {
+  session_t session;		/**< remote peer address */
+  dtls_peer_type role;		/**< local role in this session */
+  dtls_cipher_t cipher;		/**< negotiated cipher suite */
+  dtls_compression_t compression; /**< negotiated compression method */
+  uint8 id_length;		/**< length of id, 0 for a free entry */
+  uint8 id[DTLS_SESSION_ID_LENGTH_MAX];
+  uint8 master_secret[DTLS_MASTER_SECRET_LENGTH];
+  unsigned int last_used;	/**< LRU stamp, see dtls_context_t */
+} dtls_cached_session_t;
+
 /** Holds global information of the DTLS engine. */
 typedef struct dtls_context_t {
   unsigned char cookie_secret[DTLS_COOKIE_SECRET_LENGTH];
   clock_time_t cookie_secret_age; /**< the time the secret has been generated */
 
   LIST_STRUCT(peers);
+  dtls_peer_t *peer_hash[DTLS_PEER_HASH_SIZE]; /**< peers by session_t */
+
+#if DTLS_SESSION_CACHE_MAX > 0
+  dtls_cached_session_t session_cache[DTLS_SESSION_CACHE_MAX];
+  unsigned int session_cache_clock; /**< last LRU stamp handed out */
+#endif /* DTLS_SESSION_CACHE_MAX */
 
 #ifdef WITH_CONTIKI
   struct etimer retransmit_timer; /**< fires when the next packet must be sent */
@@ -42,6 +42,19 @@
    && uip_ipaddr_cmp(&((A)->addr.ipaddr),&((B)->addr.ipaddr))	\
    && (A)->ifindex == (B)->ifindex)
 
+/* FNV-1a over the IP address, mixed with port and interface */
+static inline unsigned int
+_dtls_address_hash_impl(const session_t *sess) {
+  const uint8_t *p = (const uint8_t *)&sess->addr.ipaddr;
+  unsigned int h = 2166136261u;
+  int i;
+
+  for (i = 0; i < sizeof(sess->addr.ipaddr); i++)
+    h = (h ^ p[i]) * 16777619u;
+
+  return h ^ sess->addr.port ^ (sess->ifindex << 16);
+}
+
 #else /* WITH_CONTIKI */
 
 static inline int 
@@ -67,6 +80,34 @@ _dtls_address_equals_impl(const session_t *a,
  }
  return 0;
 }
+
+static inline unsigned int
+_dtls_address_hash_impl(const session_t *sess) {
+  const uint8_t *p;
+  unsigned int h = 2166136261u;
+  size_t i, len;
+  in_port_t port;
+
+  switch (sess->addr.sa.sa_family) {
+  case AF_INET:
+    p = (const uint8_t *)&sess->addr.sin.sin_addr;
+    len = sizeof(struct in_addr);
+    port = sess->addr.sin.sin_port;
+    break;
+  case AF_INET6:
+    p = (const uint8_t *)&sess->addr.sin6.sin6_addr;
+    len = sizeof(struct in6_addr);
+    port = sess->addr.sin6.sin6_port;
+    break;
+  default:
+    return 0;
+  }
+
+  for (i = 0; i < len; i++)
+    h = (h ^ p[i]) * 16777619u;
+
+  return h ^ port ^ (sess->ifindex << 16);
+}
 #endif /* WITH_CONTIKI */
 
 void
@@ -81,3 +122,9 @@ dtls_session_equals(const session_t *a, const session_t *b) {
   assert(a); assert(b);
   return _dtls_address_equals_impl(a, b);
 }
+
+unsigned int
+dtls_session_hash(const session_t *session) {
+  assert(session);
+  return _dtls_address_hash_impl(session);
+}
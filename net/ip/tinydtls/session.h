@@ -75,4 +75,11 @@ void dtls_session_init(session_t *sess);
  */
 int dtls_session_equals(const session_t *a, const session_t *b);
 
+/**
+ * Computes a hash value over the address, port and interface of @p
+ * session. Sessions that are equal according to dtls_session_equals()
+ * have the same hash value.
+ */
+unsigned int dtls_session_hash(const session_t *session);
+
 #endif /* _DTLS_SESSION_H_ */
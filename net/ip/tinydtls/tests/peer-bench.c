@@ -0,0 +1,264 @@
+/* peer-bench -- many-peers benchmark for tinydtls
+ *
+ * Simulates a DTLS server talking to a large number of clients, all
+ * in-process: records are passed through a packet queue instead of a
+ * socket. As the DTLS context is a singleton on constrained platforms,
+ * client and server ends of each association live in the same context,
+ * each with its own address: the client of association i talks to
+ * port SERVER_PORT + i, the server sees it as port CLIENT_PORT + i.
+ *
+ * Every round, all clients connect (a full handshake on the first
+ * round, an abbreviated one later if the session cache holds the
+ * session), then every client sends records to the server, then all
+ * associations are closed. The benchmark reports handshakes and
+ * records per second.
+ *
+ * With static storage, the library must be built with DTLS_PEER_MAX
+ * of at least twice the number of peers, DTLS_HANDSHAKE_MAX of at
+ * least 2 and DTLS_SESSION_CACHE_MAX of twice the number of peers for
+ * all of them to resume their session.
+ */
+
+#include "tinydtls.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef WITH_CONTIKI
+#include <netinet/in.h>
+#endif /* WITH_CONTIKI */
+
+#include "global.h"
+#include "debug.h"
+#include "dtls.h"
+
+#define SERVER_PORT 20000
+#define CLIENT_PORT 40000
+
+#define DEFAULT_PEERS   200
+#define DEFAULT_ROUNDS  3
+#define DEFAULT_RECORDS 20
+
+#define QUEUE_SIZE 64
+
+#define PSK_IDENTITY "Client_identity"
+#define PSK_KEY      "secretPSK"
+
+#ifdef __GNUC__
+#define UNUSED_PARAM __attribute__((unused))
+#else
+#define UNUSED_PARAM
+#endif /* __GNUC__ */
+
+typedef struct {
+  session_t dst;
+  size_t length;
+  uint8 data[DTLS_MAX_BUF];
+} packet_t;
+
+static packet_t queue[QUEUE_SIZE];
+static int queue_head, queue_count;
+
+static int connected;		/* server ends that completed a handshake */
+static int full_handshakes;	/* server ends that needed the PSK */
+static int records;		/* application records received */
+static int dropped;		/* packets lost to a full queue */
+
+static void
+make_session(session_t *session, unsigned short port) {
+  dtls_session_init(session);
+#ifdef WITH_CONTIKI
+  uip_ip6addr(&session->addr.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  session->addr.port = uip_htons(port);
+#else /* WITH_CONTIKI */
+  session->size = sizeof(session->addr.sin6);
+  session->addr.sin6.sin6_family = AF_INET6;
+  session->addr.sin6.sin6_addr = in6addr_loopback;
+  session->addr.sin6.sin6_port = htons(port);
+#endif /* WITH_CONTIKI */
+}
+
+static unsigned short
+session_port(const session_t *session) {
+#ifdef WITH_CONTIKI
+  return uip_ntohs(session->addr.port);
+#else /* WITH_CONTIKI */
+  return ntohs(session->addr.sin6.sin6_port);
+#endif /* WITH_CONTIKI */
+}
+
+static int
+send_to_peer(struct dtls_context_t *ctx UNUSED_PARAM,
+	     session_t *session, uint8 *data, size_t len) {
+  packet_t *p;
+
+  if (queue_count == QUEUE_SIZE || len > DTLS_MAX_BUF) {
+    dropped++;
+    return len;
+  }
+
+  p = &queue[(queue_head + queue_count++) % QUEUE_SIZE];
+  p->dst = *session;
+  p->length = len;
+  memcpy(p->data, data, len);
+
+  return len;
+}
+
+static int
+read_from_peer(struct dtls_context_t *ctx UNUSED_PARAM,
+	       session_t *session UNUSED_PARAM, uint8 *data UNUSED_PARAM,
+	       size_t len UNUSED_PARAM) {
+  records++;
+  return 0;
+}
+
+static int
+handle_event(struct dtls_context_t *ctx UNUSED_PARAM, session_t *session,
+	     dtls_alert_level_t level, unsigned short code) {
+  if (level == 0 && code == DTLS_EVENT_CONNECTED &&
+      session_port(session) >= CLIENT_PORT)
+    connected++;
+
+  return 0;
+}
+
+static int
+get_psk_info(struct dtls_context_t *ctx UNUSED_PARAM,
+	     const session_t *session,
+	     dtls_credentials_type_t type,
+	     const unsigned char *id UNUSED_PARAM, size_t id_len UNUSED_PARAM,
+	     unsigned char *result, size_t result_length) {
+  switch (type) {
+  case DTLS_PSK_HINT:
+    return 0;
+  case DTLS_PSK_IDENTITY:
+    if (result_length < strlen(PSK_IDENTITY))
+      break;
+    memcpy(result, PSK_IDENTITY, strlen(PSK_IDENTITY));
+    return strlen(PSK_IDENTITY);
+  case DTLS_PSK_KEY:
+    if (result_length < strlen(PSK_KEY))
+      break;
+    if (session_port(session) >= CLIENT_PORT)
+      full_handshakes++;
+    memcpy(result, PSK_KEY, strlen(PSK_KEY));
+    return strlen(PSK_KEY);
+  }
+
+  return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+}
+
+static dtls_handler_t cb = {
+  .write = send_to_peer,
+  .read  = read_from_peer,
+  .event = handle_event,
+  .get_psk_info = get_psk_info,
+};
+
+/** Delivers queued packets, as sent by the other end, until none is left. */
+static void
+run_queue(dtls_context_t *ctx) {
+  packet_t *p;
+  session_t src;
+  unsigned short port;
+
+  while (queue_count) {
+    p = &queue[queue_head];
+    queue_head = (queue_head + 1) % QUEUE_SIZE;
+    queue_count--;
+
+    port = session_port(&p->dst);
+    if (port >= CLIENT_PORT)
+      make_session(&src, port - CLIENT_PORT + SERVER_PORT);
+    else
+      make_session(&src, port - SERVER_PORT + CLIENT_PORT);
+
+    dtls_handle_message(ctx, &src, p->data, p->length);
+  }
+}
+
+static double
+now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int
+main(int argc, char **argv) {
+  dtls_context_t *ctx;
+  session_t session;
+  uint8 msg[32];
+  int peers = DEFAULT_PEERS, rounds = DEFAULT_ROUNDS, count = DEFAULT_RECORDS;
+  int round, i, j, sent;
+  double start, hs_time, data_time;
+
+  if (argc > 1)
+    peers = atoi(argv[1]);
+  if (argc > 2)
+    rounds = atoi(argv[2]);
+  if (argc > 3)
+    count = atoi(argv[3]);
+
+  dtls_init();
+  dtls_set_log_level(DTLS_LOG_CRIT);
+
+  ctx = dtls_new_context(NULL);
+  if (!ctx) {
+    fprintf(stderr, "cannot create context\n");
+    return 1;
+  }
+  dtls_set_handler(ctx, &cb);
+
+  printf("%d peers, %d rounds, %d records, %d hash buckets, "
+	 "%d cached sessions\n", peers, rounds, count,
+	 DTLS_PEER_HASH_SIZE, DTLS_SESSION_CACHE_MAX);
+
+  memset(msg, 'x', sizeof(msg));
+
+  for (round = 0; round < rounds; round++) {
+    connected = full_handshakes = records = sent = 0;
+
+    /* one handshake at a time, so that few handshakes are pending */
+    start = now();
+    for (i = 0; i < peers; i++) {
+      make_session(&session, SERVER_PORT + i);
+      dtls_connect(ctx, &session);
+      run_queue(ctx);
+    }
+    hs_time = now() - start;
+
+    start = now();
+    for (j = 0; j < count; j++) {
+      for (i = 0; i < peers; i++) {
+	make_session(&session, SERVER_PORT + i);
+	if (dtls_write(ctx, &session, msg, sizeof(msg)) > 0)
+	  sent++;
+	run_queue(ctx);
+      }
+    }
+    data_time = now() - start;
+
+    for (i = 0; i < peers; i++) {
+      make_session(&session, SERVER_PORT + i);
+      dtls_close(ctx, &session);
+      run_queue(ctx);
+    }
+
+    printf("round %d: %d/%d connected, %d full handshakes, "
+	   "%.0f handshakes/s\n", round, connected, peers, full_handshakes,
+	   hs_time > 0 ? connected / hs_time : 0);
+    printf("round %d: %d/%d records, %.0f records/s\n",
+	   round, records, sent, data_time > 0 ? records / data_time : 0);
+  }
+
+  if (dropped)
+    printf("%d packets dropped\n", dropped);
+
+  dtls_free_context(ctx);
+
+  return 0;
+}
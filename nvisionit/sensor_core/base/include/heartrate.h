@@ -20,3 +20,10 @@
 #include <stdbool.h>
 
 int measure_heartrate(uint32_t signal);
+
+/* Samples of a continuous ADC stream, the first one taken at time (in ms)
+ * and the next ones every period (in us). Returns the last heart rate
+ * found in the block, or 0.
+ */
+int measure_heartrate_block(const uint16_t *samples, int count, uint32_t time,
+			    uint32_t period);
@@ -19,6 +19,13 @@ typedef enum PulseOximeterState {
 void max30100_pulse_oximeter_init(struct device *i2c_dev);
 void max30100_pulse_oximeter_update(struct device *i2c_dev);
 
+// Steps of max30100_pulse_oximeter_update(), for a caller scheduling them
+// every SAMPLE_TIME, CURRENT_ADJUSTMENT_PERIOD_MS and
+// TEMPERATURE_SAMPLING_PERIOD_MS itself
+void max30100_pulse_oximeter_sample(struct device *i2c_dev);
+void max30100_pulse_oximeter_check_bias(struct device *i2c_dev);
+void max30100_pulse_oximeter_poll_temperature(struct device *i2c_dev);
+
 uint8_t max30100_pulse_oximeter_heartrate;
 uint8_t max30100_pulse_oximeter_spo2;
 int16_t max30100_pulse_oximeter_temperature;
\ No newline at end of file
@@ -68,14 +68,8 @@ static inline int sensor_value_snprintf(char *buf, size_t len, const struct sens
 			val2 = val->val2;
 		}
 
-		/* print value to buffer */
-		if (val1 > 0 || (val1 == 0 && val2 > 0)) {
-			return snprintf(buf, len, "%d.%06d", val1, val2);
-		} else if (val1 == 0 && val2 < 0) {
-			return snprintf(buf, len, "-0.%06d", -val2);
-		} else {
-			return snprintf(buf, len, "%d.%06d", val1, -val2);
-		}
+		/* print value to buffer, both parts having the same sign */
+		return snprintf(buf, len, "%q", val1, val2);
 	case SENSOR_VALUE_TYPE_DOUBLE:
 		return snprintf(buf, len, "%f", val->dval);
 	default:
@@ -19,10 +19,10 @@ uint32_t amp = 400;			// used to hold amplitude of pulse waveform, seeded
 bool firstBeat = true;			// used to seed rate array so we startup with reasonable BPM
 bool secondBeat = false;		// used to seed rate array so we startup with reasonable BPM
 
-int measure_heartrate(uint32_t Signal)
+static int measure_heartrate_at(uint32_t Signal, uint32_t now)
 {
 	int HR = 0;
-	int N = k_uptime_get_32() - lastBeatTime;	// monitor the time since the last beat to avoid noise
+	int N = now - lastBeatTime;	// monitor the time since the last beat to avoid noise
 
 	// find the peak and trough of the pulse wave
 	if(Signal < thresh && N > (IBI/5)*3) {	// avoid dichrotic noise by waiting 3/5 of last IBI
@@ -40,8 +40,8 @@ int measure_heartrate(uint32_t Signal)
 	if (N > 250 && N < 2000) {				// avoid noise. 30 bpm < possible human heart beat < 240
 		if ( (Signal > thresh) && (Pulse == false) && (N > (IBI/5)*3) ){
 			Pulse = true;				// set the Pulse flag when we think there is a pulse
-			IBI = k_uptime_get_32() - lastBeatTime;	// measure time between beats in mS
-			lastBeatTime = k_uptime_get_32();		// keep track of time for next pulse
+			IBI = now - lastBeatTime;		// measure time between beats in mS
+			lastBeatTime = now;				// keep track of time for next pulse
 
 			if(secondBeat) {			// if this is the second beat, if secondBeat == TRUE
 				secondBeat = false;		// clear secondBeat flag
@@ -84,9 +84,31 @@ int measure_heartrate(uint32_t Signal)
 		thresh = 2048;			// set thresh default
 		P = 2048;			// set P default
 		T = 2048;			// set T default
-		lastBeatTime = k_uptime_get_32();	// bring the lastBeatTime up to date
+		lastBeatTime = now;			// bring the lastBeatTime up to date
 		firstBeat = true;		// set these to avoid noise
 		secondBeat = false;		// when we get the heartbeat back
 	}
 	return HR;
 }
+
+int measure_heartrate(uint32_t Signal)
+{
+	return measure_heartrate_at(Signal, k_uptime_get_32());
+}
+
+int measure_heartrate_block(const uint16_t *samples, int count, uint32_t time,
+			    uint32_t period)
+{
+	int HR = 0;
+	int i, ret;
+
+	// each sample is timed by its position in the block, not by when the
+	// block is processed
+	for (i = 0; i < count; i++) {
+		ret = measure_heartrate_at(samples[i], time + i * period / 1000);
+		if (ret) {
+			HR = ret;
+		}
+	}
+	return HR;
+}
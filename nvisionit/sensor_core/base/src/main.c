@@ -35,6 +35,7 @@
 #include <ipm_ids.h>
 #include <bmi160.h>
 #include <heartrate.h>
+#include <drivers/sensor/sensor_sched.h>
 
 #define INTERVAL_HRS 500
 
@@ -58,6 +59,15 @@ struct health_data
 	int16_t accel_z;
 };
 
+static struct health_data data;
+
+static struct sensor_sched sched;
+static struct sensor_sched_entry oximeter_entry;
+static struct sensor_sched_entry bias_entry;
+static struct sensor_sched_entry temperature_entry;
+static struct sensor_sched_entry report_entry;
+
+
 static double sensor_value_normalize(struct sensor_value* val)
 {
 	double value;
@@ -80,10 +90,100 @@ static double sensor_value_normalize(struct sensor_value* val)
 	return value;
 }
 
-void main(void)
+/* The MAX30100 algorithms work on the time of the sample being processed */
+static void set_time(uint64_t timestamp)
+{
+	time = timestamp * MSEC_PER_SEC / sys_clock_hw_cycles_per_sec;
+}
+
+static int oximeter_sample(struct sensor_sched_entry *entry, uint64_t timestamp)
+{
+	set_time(timestamp);
+	max30100_pulse_oximeter_sample(i2c_dev);
+
+	return 0;
+}
+
+static int oximeter_check_bias(struct sensor_sched_entry *entry, uint64_t timestamp)
+{
+	set_time(timestamp);
+	max30100_pulse_oximeter_check_bias(i2c_dev);
+
+	return 0;
+}
+
+static int oximeter_poll_temperature(struct sensor_sched_entry *entry, uint64_t timestamp)
 {
-    int ret;
+	set_time(timestamp);
+	max30100_pulse_oximeter_poll_temperature(i2c_dev);
+
+	return 0;
+}
+
+static int report(struct sensor_sched_entry *entry, uint64_t timestamp)
+{
+	int16_t axis_x = 0;
+	int16_t axis_y = 0;
+	int16_t axis_z = 0;
+	int ret;
+
+	data.heartrate = max30100_pulse_oximeter_heartrate;
+	data.spo2 = max30100_pulse_oximeter_spo2;
+	data.temperature = max30100_pulse_oximeter_temperature;
+
+	get_accel_data(sensor_value_ast);
+
+	axis_x = (int16_t)(sensor_value_normalize(&sensor_value_ast[0]) * 1000.0);
+	axis_y = (int16_t)(sensor_value_normalize(&sensor_value_ast[1]) * 1000.0);
+	axis_z = (int16_t)(sensor_value_normalize(&sensor_value_ast[2]) * 1000.0);
+
+	data.accel_x = (axis_x + data.accel_x) / 2;
+	data.accel_y = (axis_y + data.accel_y) / 2;
+	data.accel_z = (axis_z + data.accel_z) / 2;
+
+	get_gyro_data(sensor_value_ast);
+
+	axis_x = (int16_t)(sensor_value_normalize(&sensor_value_ast[0]) * 1000.0);
+	axis_y = (int16_t)(sensor_value_normalize(&sensor_value_ast[1]) * 1000.0);
+	axis_z = (int16_t)(sensor_value_normalize(&sensor_value_ast[2]) * 1000.0);
+
+	data.gyro_x = (axis_x + data.gyro_x) / 2;
+	data.gyro_y = (axis_y + data.gyro_y) / 2;
+	data.gyro_z = (axis_z + data.gyro_z) / 2;
 
+	sample_update();
+
+	ret = ipm_send(health_ipm, 1, IPM_ID_BMI_ALL, &data, sizeof(data));
+	if (ret)
+	{
+		printk("Failed to send Health message, error (%d)\n", ret);
+	}
+
+	return ret;
+}
+
+static int sched_add(struct sensor_sched_entry *entry, sensor_sched_fetch_t fetch,
+		     struct device *bus, uint32_t period)
+{
+	int ret;
+
+	entry->fetch = fetch;
+	entry->bus = bus;
+	entry->period = period;
+	entry->phase = period;
+
+	ret = sensor_sched_add(&sched, entry);
+	if (ret)
+	{
+		printk("Failed to schedule a %u ms period, error (%d)\n",
+		       period, ret);
+	}
+
+	return ret;
+}
+
+void main(void)
+{
     // Get the devices
     i2c_dev = device_get_binding("I2C_0");
     if (!i2c_dev)
@@ -107,55 +207,25 @@ void main(void)
    
 	printk("Polling the MAX30100\n");
 
-	struct health_data data;
-	int16_t axis_x = 0; 
-	int16_t axis_y = 0;
-	int16_t axis_z = 0;
+	/* All the sensors are sampled from this thread, waking up only for
+	 * the next one due; the MAX30100 steps share the I2C bus and run in
+	 * the same wake up when their deadlines meet
+	 */
+	sensor_sched_init(&sched);
+	if (sched_add(&oximeter_entry, oximeter_sample, i2c_dev, SAMPLE_TIME) ||
+	    sched_add(&bias_entry, oximeter_check_bias, i2c_dev,
+		      CURRENT_ADJUSTMENT_PERIOD_MS) ||
+	    sched_add(&temperature_entry, oximeter_poll_temperature, i2c_dev,
+		      TEMPERATURE_SAMPLING_PERIOD_MS) ||
+	    sched_add(&report_entry, report, NULL, INTERVAL_HRS))
+	{
+		/* a sensor left out would silently never be sampled */
+		printk("Sampling not started\n");
+		return;
+	}
 
-    uint64_t lastSampleTime = 0;
+	sensor_sched_start(&sched);
 	while(1){
-	    time = k_uptime_get();
-	    max30100_pulse_oximeter_update(i2c_dev);
-
-		if((time - lastSampleTime) > 500)
-		{	
-			data.heartrate = max30100_pulse_oximeter_heartrate;
-			data.spo2 = max30100_pulse_oximeter_spo2;
-			data.temperature = max30100_pulse_oximeter_temperature;
-			
-			get_accel_data(sensor_value_ast);	
-
-			axis_x = (int16_t)(sensor_value_normalize(&sensor_value_ast[0]) * 1000.0);
-			axis_y = (int16_t)(sensor_value_normalize(&sensor_value_ast[1]) * 1000.0);
-			axis_z = (int16_t)(sensor_value_normalize(&sensor_value_ast[2]) * 1000.0);
-
-			// printk("Accel: %d %d %d\n", axis_x, axis_y, axis_z);
-
-			data.accel_x = (axis_x + data.accel_x) / 2;
-			data.accel_y = (axis_y + data.accel_y) / 2;
-			data.accel_z = (axis_z + data.accel_z) / 2;
-
-			get_gyro_data(sensor_value_ast);		
-
-			axis_x = (int16_t)(sensor_value_normalize(&sensor_value_ast[0]) * 1000.0);
-			axis_y = (int16_t)(sensor_value_normalize(&sensor_value_ast[1]) * 1000.0);
-			axis_z = (int16_t)(sensor_value_normalize(&sensor_value_ast[2]) * 1000.0);
-
-			// printk("Gyro : %d %d %d\n", axis_x, axis_y, axis_z);
-
-			data.gyro_x = (axis_x + data.gyro_x) / 2;
-			data.gyro_y = (axis_y + data.gyro_y) / 2;
-			data.gyro_z = (axis_z + data.gyro_z) / 2;
-
-		    lastSampleTime = k_uptime_get();
-            sample_update();
-
-			ret = ipm_send(health_ipm, 1, IPM_ID_BMI_ALL, &data, sizeof(data));
-			if (ret)
-			{
-				printk("Failed to send Health message, error (%d)\n", ret);
-			}		
-
-		}
-	}	
+		sensor_sched_wait(&sched, K_FOREVER);
+	}
 }
\ No newline at end of file
@@ -4,24 +4,54 @@
 
 // This file handles the raw data comms from the device.
 #include <max30100.h>
+#include <misc/util.h>
+
+// Cached copy of the configuration registers, from mode to LED configuration,
+// so that updating some of their bits does not read them back first
+static uint8_t config_regs[MAX30100_REG_LED_CONFIGURATION - MAX30100_REG_MODE_CONFIGURATION + 1];
+static struct i2c_reg_shadow config_shadow;
+
+static struct i2c_reg_shadow *max30100_config_shadow(struct device *i2c_dev)
+{
+    if (config_shadow.dev != i2c_dev)
+    {
+        i2c_reg_shadow_init(&config_shadow, i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_MODE_CONFIGURATION,
+                            config_regs, sizeof(config_regs));
+    }
+
+    return &config_shadow;
+}
 
 int max30100_init(struct device *i2c_dev)
 {
+    struct i2c_reg_shadow *shadow = max30100_config_shadow(i2c_dev);
+    uint8_t modeConfig = DEFAULT_MODE;
+    uint8_t spo2Config = MAX30100_SPC_SPO2_HI_RES_EN | (DEFAULT_SAMPLING_RATE << 2) | DEFAULT_PULSE_WIDTH;
+    uint8_t ledConfig = DEFAULT_RED_LED_CURRENT << 4 | DEFAULT_IR_LED_CURRENT;
+    uint8_t whoami = 0;
+
+    // Mode, pulse width, sampling rate, high res mode and LED current, then the
+    // revision, all in a single transfer with repeated starts
+    struct i2c_reg_op ops[] = {
+        { .buf = &modeConfig, .len = 1, .reg = MAX30100_REG_MODE_CONFIGURATION, .flags = I2C_MSG_WRITE },
+        { .buf = &spo2Config, .len = 1, .reg = MAX30100_REG_SPO2_CONFIGURATION, .flags = I2C_MSG_WRITE },
+        { .buf = &ledConfig, .len = 1, .reg = MAX30100_REG_LED_CONFIGURATION, .flags = I2C_MSG_WRITE },
+        { .buf = &whoami, .len = 1, .reg = MAX30100_REG_REVISION_ID, .flags = I2C_MSG_READ },
+    };
+
     printk("MAX30100: Location: 0x%x\n", i2c_dev);
 
-    printk("MAX30100: Setting mode\n");
-    max30100_set_mode(i2c_dev, DEFAULT_MODE);
-    printk("MAX30100: Setting LED pulse width\n");
-    max30100_set_leds_pulse_width(i2c_dev, DEFAULT_PULSE_WIDTH);
-    printk("MAX30100: Setting sampling rate\n");
-    max30100_set_sampling_rate(i2c_dev, DEFAULT_SAMPLING_RATE);
-    printk("MAX30100: Setting LED current\n");
-    max30100_set_leds_current(i2c_dev, DEFAULT_IR_LED_CURRENT, DEFAULT_RED_LED_CURRENT);
-    printk("MAX30100: Setting High res mode\n");
-    max30100_set_highres_mode_enabled(i2c_dev, true);
+    printk("MAX30100: Setting mode, LED pulse width, sampling rate, LED current and high res mode\n");
+    int ret = i2c_reg_transfer(i2c_dev, MAX30100_I2C_ADDRESS, ops, ARRAY_SIZE(ops));
+    if (ret != 0)
+    {
+        printk("MAX30100: Configuration failed\n");
+        return ret;
+    }
 
-    uint8_t whoami = 0;
-    int ret = i2c_reg_read_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_REVISION_ID, &whoami);
+    i2c_reg_shadow_set(shadow, MAX30100_REG_MODE_CONFIGURATION, modeConfig);
+    i2c_reg_shadow_set(shadow, MAX30100_REG_SPO2_CONFIGURATION, spo2Config);
+    i2c_reg_shadow_set(shadow, MAX30100_REG_LED_CONFIGURATION, ledConfig);
 
     printk("MAX30100: Revision: %d\n", whoami);
 
@@ -30,17 +60,19 @@ int max30100_init(struct device *i2c_dev)
 
 void max30100_set_mode(struct device *i2c_dev, uint8_t modeConfig)
 {
-    i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_MODE_CONFIGURATION, modeConfig);
+    i2c_reg_shadow_update(max30100_config_shadow(i2c_dev), MAX30100_REG_MODE_CONFIGURATION, 0xff, modeConfig);
 }
 
 void max30100_start_temperature(struct device *i2c_dev)
 {
-    // Set up the read register
+    // TEMP_EN clears itself at the end of the conversion: it is set on the
+    // device only, the cached value staying valid once the conversion is done
     uint8_t modeConfig;
-    i2c_reg_read_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_MODE_CONFIGURATION, &modeConfig);
-    modeConfig |= MAX30100_MC_TEMP_EN;
-
-    i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_MODE_CONFIGURATION, modeConfig);
+    if (i2c_reg_shadow_read(max30100_config_shadow(i2c_dev), MAX30100_REG_MODE_CONFIGURATION, &modeConfig) == 0)
+    {
+        i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_MODE_CONFIGURATION,
+                           modeConfig | MAX30100_MC_TEMP_EN);
+    }
 }
 
 bool max30100_is_temperature_ready(struct device *i2c_dev)
@@ -65,35 +97,24 @@ float max30100_get_temperature(struct device *i2c_dev)
 
 void max30100_set_leds_pulse_width(struct device *i2c_dev, uint8_t ledPulseWidth)
 {
-    uint8_t previous;
-    i2c_reg_read_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, &previous);
-    i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, (previous & 0xfc) | ledPulseWidth);
+    i2c_reg_shadow_update(max30100_config_shadow(i2c_dev), MAX30100_REG_SPO2_CONFIGURATION, 0x03, ledPulseWidth);
 }
 
 void max30100_set_sampling_rate(struct device *i2c_dev, uint8_t samplingRate)
 {
-    uint8_t previous;
-    i2c_reg_read_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, &previous);
-    i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, (previous & 0xe3) | (samplingRate << 2));
+    i2c_reg_shadow_update(max30100_config_shadow(i2c_dev), MAX30100_REG_SPO2_CONFIGURATION, 0x1c, samplingRate << 2);
 }
 
 void max30100_set_leds_current(struct device *i2c_dev, uint8_t irLedCurrent, uint8_t redLedCurrent)
 {
-    i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_LED_CONFIGURATION, redLedCurrent << 4 | irLedCurrent);
+    i2c_reg_shadow_update(max30100_config_shadow(i2c_dev), MAX30100_REG_LED_CONFIGURATION, 0xff,
+                          redLedCurrent << 4 | irLedCurrent);
 }
 
 void max30100_set_highres_mode_enabled(struct device *i2c_dev, bool enabled)
 {
-    uint8_t previous;
-    i2c_reg_read_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, &previous);
-    if (enabled)
-    {
-        i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, previous | MAX30100_SPC_SPO2_HI_RES_EN);
-    }
-    else
-    {
-        i2c_reg_write_byte(i2c_dev, MAX30100_I2C_ADDRESS, MAX30100_REG_SPO2_CONFIGURATION, previous & ~MAX30100_SPC_SPO2_HI_RES_EN);
-    }
+    i2c_reg_shadow_update(max30100_config_shadow(i2c_dev), MAX30100_REG_SPO2_CONFIGURATION,
+                          MAX30100_SPC_SPO2_HI_RES_EN, enabled ? MAX30100_SPC_SPO2_HI_RES_EN : 0);
 }
 
 void max30100_update(struct device *i2c_dev, uint8_t *buffer)
@@ -59,88 +59,101 @@ void max30100_pulse_oximeter_init(struct device *i2c_dev)
 }
 
 uint8_t buffer[4];
-void max30100_pulse_oximeter_update(struct device *i2c_dev)
+void max30100_pulse_oximeter_sample(struct device *i2c_dev)
 {
-    if ((time - tsLastSample) > SAMPLE_TIME)
-    {
-        //printk("MAX30100: Updating data from FIFO - 0x%x\n", i2c_dev);
-        max30100_update(i2c_dev, buffer);
-        //printk("MAX30100: Received data from FIFO\n");
+    //printk("MAX30100: Updating data from FIFO - 0x%x\n", i2c_dev);
+    max30100_update(i2c_dev, buffer);
+    //printk("MAX30100: Received data from FIFO\n");
 
-        // Warning: the values are always left-aligned
-        uint16_t raw_ir_value = (buffer[0] << 8) | buffer[1];
-        uint16_t raw_red_value = (buffer[2] << 8) | buffer[3];
+    // Warning: the values are always left-aligned
+    uint16_t raw_ir_value = (buffer[0] << 8) | buffer[1];
+    uint16_t raw_red_value = (buffer[2] << 8) | buffer[3];
 
-        //printk("MAX30100: Filtering LED data\n");
-        float led_ir_ac_value = _dc_removal(raw_ir_value, &led_ir_ac_dcw, DC_REMOVER_ALPHA);
-        float led_red_ac_value = _dc_removal(raw_red_value, &led_red_ac_dcw, DC_REMOVER_ALPHA);
+    //printk("MAX30100: Filtering LED data\n");
+    float led_ir_ac_value = _dc_removal(raw_ir_value, &led_ir_ac_dcw, DC_REMOVER_ALPHA);
+    float led_red_ac_value = _dc_removal(raw_red_value, &led_red_ac_dcw, DC_REMOVER_ALPHA);
 
-        //printk("MAX30100: Applying Low Pass filter for the heart beat class\n");
-        float led_ir_heartrate_filtered_sample = _low_pass_filter(-led_ir_ac_value, beat_detection_filter);
+    //printk("MAX30100: Applying Low Pass filter for the heart beat class\n");
+    float led_ir_heartrate_filtered_sample = _low_pass_filter(-led_ir_ac_value, beat_detection_filter);
 
-        //printk("MAX30100: Sending sample to the heartbeat sample function\n");
-        bool beat_detected = max30100_beat_detector_sample(led_ir_heartrate_filtered_sample);
-        float hrs = max30100_beat_detector_get_rate();
+    //printk("MAX30100: Sending sample to the heartbeat sample function\n");
+    bool beat_detected = max30100_beat_detector_sample(led_ir_heartrate_filtered_sample);
+    float hrs = max30100_beat_detector_get_rate();
 
-        if (hrs > 0)
-        {
-            max30100_pulse_oximeter_state = PULSEOXIMETER_STATE_DETECTING;
-            max30100_spo2_calculator_update(led_ir_ac_value, led_red_ac_value, beat_detected);
-
-            if (beat_detected)
-            {
-                max30100_pulse_oximeter_spo2 = max30100_spo2_calculator_get_spo2();
-                max30100_pulse_oximeter_heartrate = (uint8_t)hrs;
-                max30100_pulse_oximeter_temperature = (int16_t)(max30100_get_temperature(i2c_dev) * 100);
-
-           //     printk("MAX30100: Temperature: %d / 100 C\n", max30100_pulse_oximeter_temperature);
-           //     printk("MAX30100: Heartrate: %d bpm\n", max30100_pulse_oximeter_heartrate);
-           //     printk("MAX30100: SpO2: %d %%\n", max30100_pulse_oximeter_spo2);
-            }
-        }
-        else if (max30100_pulse_oximeter_state == PULSEOXIMETER_STATE_DETECTING)
+    if (hrs > 0)
+    {
+        max30100_pulse_oximeter_state = PULSEOXIMETER_STATE_DETECTING;
+        max30100_spo2_calculator_update(led_ir_ac_value, led_red_ac_value, beat_detected);
+
+        if (beat_detected)
         {
-            max30100_pulse_oximeter_state = PULSEOXIMETER_STATE_IDLE;
-            max30100_spo2_calculator_reset();
+            max30100_pulse_oximeter_spo2 = max30100_spo2_calculator_get_spo2();
+            max30100_pulse_oximeter_heartrate = (uint8_t)hrs;
+            max30100_pulse_oximeter_temperature = (int16_t)(max30100_get_temperature(i2c_dev) * 100);
+
+       //     printk("MAX30100: Temperature: %d / 100 C\n", max30100_pulse_oximeter_temperature);
+       //     printk("MAX30100: Heartrate: %d bpm\n", max30100_pulse_oximeter_heartrate);
+       //     printk("MAX30100: SpO2: %d %%\n", max30100_pulse_oximeter_spo2);
         }
+    }
+    else if (max30100_pulse_oximeter_state == PULSEOXIMETER_STATE_DETECTING)
+    {
+        max30100_pulse_oximeter_state = PULSEOXIMETER_STATE_IDLE;
+        max30100_spo2_calculator_reset();
+    }
+}
 
-        tsLastSample = time;
+// Follower that adjusts the red led current in order to have comparable DC baselines between
+// red and IR leds. The numbers are really magic: the less possible to avoid oscillations
+void max30100_pulse_oximeter_check_bias(struct device *i2c_dev)
+{
+    bool changed = false;
+    if (led_ir_ac_dcw - led_red_ac_dcw > 70000 && redLedPower < MAX30100_LED_CURR_50MA)
+    {
+        ++redLedPower;
+        changed = true;
+    }
+    else if (led_red_ac_dcw - led_ir_ac_dcw > 70000 && redLedPower > 0)
+    {
+        --redLedPower;
+        changed = true;
     }
-    // Check current bias
 
-    // Follower that adjusts the red led current in order to have comparable DC baselines between
-    // red and IR leds. The numbers are really magic: the less possible to avoid oscillations
-    if ((time - tsLastBiasCheck) > (CURRENT_ADJUSTMENT_PERIOD_MS))
+    if (changed)
     {
-        bool changed = false;
-        if (led_ir_ac_dcw - led_red_ac_dcw > 70000 && redLedPower < MAX30100_LED_CURR_50MA)
-        {
-            ++redLedPower;
-            changed = true;
-        }
-        else if (led_red_ac_dcw - led_ir_ac_dcw > 70000 && redLedPower > 0)
-        {
-            --redLedPower;
-            changed = true;
-        }
+    //    printk("MAX30100: Adjusting Red LED current to %d\n", redLedPower);
+        max30100_set_leds_current(i2c_dev, IR_LED_CURRENT, redLedPower);
+        tsLastCurrentAdjustment = time;
+    }
+}
 
-        if (changed)
-        {
-        //    printk("MAX30100: Adjusting Red LED current to %d\n", redLedPower);
-            max30100_set_leds_current(i2c_dev, IR_LED_CURRENT, redLedPower);
-            tsLastCurrentAdjustment = time;
-        }
+void max30100_pulse_oximeter_poll_temperature(struct device *i2c_dev)
+{
+    max30100_start_temperature(i2c_dev);
+    while(!max30100_is_temperature_ready(i2c_dev)){
+        max30100_beat_detector_reset();
+    }       
+}
+
+// Runs the steps due at the current time, for callers not scheduling them
+void max30100_pulse_oximeter_update(struct device *i2c_dev)
+{
+    if ((time - tsLastSample) > SAMPLE_TIME)
+    {
+        max30100_pulse_oximeter_sample(i2c_dev);
+        tsLastSample = time;
+    }
 
+    // Check current bias
+    if ((time - tsLastBiasCheck) > (CURRENT_ADJUSTMENT_PERIOD_MS))
+    {
+        max30100_pulse_oximeter_check_bias(i2c_dev);
         tsLastBiasCheck = time;
     }
 
     if ((time - tsLastTemperaturePoll) > (TEMPERATURE_SAMPLING_PERIOD_MS))
     {
-        max30100_start_temperature(i2c_dev);
-        while(!max30100_is_temperature_ready(i2c_dev)){
-            max30100_beat_detector_reset();
-        }       
-
+        max30100_pulse_oximeter_poll_temperature(i2c_dev);
         tsLastTemperaturePoll = time;
     }
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016 Intel Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import argparse
+import re
+import sys
+
+# Event trace decoder.  Turns the "TR <id> <timestamp> [<arg>...]" lines
+# printed by sys_trace_dump() into a timeline.  Any other console output is
+# ignored, so a complete UART or RAM console capture can be fed as is.
+#
+# Timestamps are 32-bit hardware cycle counts: they are unwrapped, and
+# printed relative to the first event, in microseconds when the cycle
+# frequency is known.
+
+trace_re = re.compile(r'TR ([0-9a-fA-F]+) ([0-9a-fA-F]+)((?: [0-9a-fA-F]+)*)\s*$')
+drop_re = re.compile(r'TR-DROP (\d+)')
+
+# event IDs below 0x0100 are reserved for the kernel
+kernel_events = {
+    # logged while the outgoing thread is still the current one
+    0x0001: ("context switch", lambda a: "from thread 0x%08x" % a[0]),
+    0x0002: ("interrupt", lambda a: "irq %d" % a[0]),
+    0x0003: ("sleep exit", lambda a: "slept %d ticks, woken by irq %d" %
+             (a[0], a[1])),
+    0x0010: ("int. locked", lambda a: "new max %d cycles" % a[0]),
+}
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Decode event trace dumps into a timeline.")
+    parser.add_argument("files", nargs="*",
+                        help="console captures (default: standard input)")
+    parser.add_argument("-f", "--freq", type=float, default=0,
+                        help="hardware cycle frequency in Hz")
+    parser.add_argument("-n", "--names", action="append", default=[],
+                        metavar="ID=NAME",
+                        help="name an application event ID (hexadecimal)")
+    parser.add_argument("-s", "--sort", action="store_true",
+                        help="sort events by timestamp")
+    return parser.parse_args()
+
+
+def read_events(files):
+    events = []
+    dropped = 0
+    last = None
+    high = 0
+
+    lines = []
+    if files:
+        for name in files:
+            with open(name) as f:
+                lines.extend(f.readlines())
+    else:
+        lines = sys.stdin.readlines()
+
+    for line in lines:
+        m = drop_re.search(line)
+        if m:
+            dropped += int(m.group(1))
+            continue
+
+        m = trace_re.search(line)
+        if not m:
+            continue
+
+        event_id = int(m.group(1), 16)
+        stamp = int(m.group(2), 16)
+        args = [int(a, 16) for a in m.group(3).split()]
+
+        # unwrap the 32-bit cycle counter
+        if last is not None and stamp < last and last - stamp > 1 << 31:
+            high += 1 << 32
+        last = stamp
+
+        events.append((high + stamp, event_id, args))
+
+    return events, dropped
+
+
+def describe(event_id, args, names):
+    if event_id in names:
+        return names[event_id], " ".join("0x%x" % a for a in args)
+
+    if event_id in kernel_events:
+        name, fmt = kernel_events[event_id]
+        try:
+            return name, fmt(args)
+        except IndexError:
+            pass
+
+    return "event 0x%04x" % event_id, " ".join("0x%x" % a for a in args)
+
+
+def main():
+    args = parse_args()
+
+    names = {}
+    for n in args.names:
+        event_id, name = n.split("=", 1)
+        names[int(event_id, 16)] = name
+
+    events, dropped = read_events(args.files)
+    if not events:
+        sys.stderr.write("no trace events found\n")
+        return 1
+
+    if args.sort:
+        events.sort(key=lambda e: e[0])
+
+    start = events[0][0]
+    prev = start
+
+    for stamp, event_id, event_args in events:
+        name, detail = describe(event_id, event_args, names)
+
+        if args.freq:
+            when = "%12.3f us (+%9.3f)" % ((stamp - start) * 1e6 / args.freq,
+                                           (stamp - prev) * 1e6 / args.freq)
+        else:
+            when = "%12d cyc (+%9d)" % (stamp - start, stamp - prev)
+        prev = stamp
+
+        print("%s  %-16s %s" % (when, name, detail))
+
+    if dropped:
+        print("%d events dropped" % dropped)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
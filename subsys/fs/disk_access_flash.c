@@ -31,10 +31,6 @@ static struct device *flash_dev;
 static uint8_t read_copy_buf[CONFIG_FS_BLOCK_SIZE];
 static uint8_t *fs_buff = read_copy_buf;
 
-/* calculate number of blocks required for a given size */
-#define GET_NUM_BLOCK(total_size, block_size) \
-	((total_size + block_size - 1) / block_size)
-
 #define GET_SIZE_TO_BOUNDARY(start, block_size) \
 	(block_size - (start & (block_size - 1)))
 
@@ -75,28 +71,13 @@ int disk_access_read(uint8_t *buff, uint32_t start_sector,
 		      uint32_t sector_count)
 {
 	off_t fl_addr;
-	uint32_t remaining;
-	uint32_t len;
-	uint32_t num_read;
 
 	fl_addr = lba_to_address(start_sector);
-	remaining = (sector_count * SECTOR_SIZE);
-	len = CONFIG_FS_FLASH_MAX_RW_SIZE;
-
-	num_read = GET_NUM_BLOCK(remaining, CONFIG_FS_FLASH_MAX_RW_SIZE);
 
-	for (uint32_t i = 0; i < num_read; i++) {
-		if (remaining < CONFIG_FS_FLASH_MAX_RW_SIZE) {
-			len = remaining;
-		}
-
-		if (flash_read(flash_dev, fl_addr, buff, len) != 0) {
-			return -EIO;
-		}
-
-		fl_addr += len;
-		buff += len;
-		remaining -= len;
+	/* the flash driver splits long reads itself, if it has to */
+	if (flash_read(flash_dev, fl_addr, buff,
+		       sector_count * SECTOR_SIZE) != 0) {
+		return -EIO;
 	}
 
 	return 0;
@@ -108,7 +89,6 @@ static int read_copy_flash_block(off_t start_addr, uint32_t size,
 				     uint8_t *dest_buff)
 {
 	off_t fl_addr;
-	uint32_t num_read;
 	uint32_t offset = 0;
 
 	/* adjust offset if starting address is not erase-aligned address */
@@ -119,17 +99,10 @@ static int read_copy_flash_block(off_t start_addr, uint32_t size,
 	/* align starting address to an aligned address for flash erase-write */
 	fl_addr = ROUND_DOWN(start_addr, CONFIG_FS_FLASH_ERASE_ALIGNMENT);
 
-	num_read = GET_NUM_BLOCK(CONFIG_FS_BLOCK_SIZE,
-				 CONFIG_FS_FLASH_MAX_RW_SIZE);
-
 	/* read one block from flash */
-	for (uint32_t i = 0; i < num_read; i++) {
-		if (flash_read(flash_dev,
-			fl_addr + (CONFIG_FS_FLASH_MAX_RW_SIZE * i),
-			dest_buff + (CONFIG_FS_FLASH_MAX_RW_SIZE * i),
-			CONFIG_FS_FLASH_MAX_RW_SIZE) != 0) {
-			return -EIO;
-		}
+	if (flash_read(flash_dev, fl_addr, dest_buff,
+		       CONFIG_FS_BLOCK_SIZE) != 0) {
+		return -EIO;
 	}
 
 	/* overwrite with user data */
@@ -138,52 +111,58 @@ static int read_copy_flash_block(off_t start_addr, uint32_t size,
 	return 0;
 }
 
-/* input size is either less or equal to a block size, CONFIG_FS_BLOCK_SIZE. */
-static int update_flash_block(off_t start_addr, uint32_t size,
-				  const void *buff)
+/* Erases and writes whole blocks from an erase-aligned address, size being
+ * a multiple of CONFIG_FS_BLOCK_SIZE.
+ */
+static int write_flash_blocks(off_t fl_addr, uint32_t size, const void *buff)
 {
-	off_t fl_addr;
-	uint8_t *src = (uint8_t *)buff;
-	uint32_t num_write;
-
-	/* if size is a partial block, perform read-copy with user data */
-	if (size < CONFIG_FS_BLOCK_SIZE) {
-		if (read_copy_flash_block(start_addr, size, buff, fs_buff) !=
-		    0) {
+	uint32_t erased;
+
+	/* The range is erased block by block: fl_addr is only aligned on
+	 * CONFIG_FS_FLASH_ERASE_ALIGNMENT, and a single larger erase may be
+	 * done by the driver with a coarser erase unit spilling out of it.
+	 */
+	for (erased = 0; erased < size; erased += CONFIG_FS_BLOCK_SIZE) {
+		/* flash_erase reenables write-protection after each block */
+		flash_write_protection_set(flash_dev, false);
+		if (flash_erase(flash_dev, fl_addr + erased,
+				CONFIG_FS_BLOCK_SIZE) != 0) {
 			return -EIO;
 		}
-
-		/* now use the local buffer as the source */
-		src = (uint8_t *)fs_buff;
 	}
 
-	/* always align starting address for flash write operation */
-	fl_addr = ROUND_DOWN(start_addr, CONFIG_FS_FLASH_ERASE_ALIGNMENT);
-
-	/* disable write-protection first before erase */
+	/* flash_erase reenabled write-protection so disable it again, the
+	 * flash driver splits the write in pages
+	 */
 	flash_write_protection_set(flash_dev, false);
-	if (flash_erase(flash_dev, fl_addr, CONFIG_FS_BLOCK_SIZE) != 0) {
+	if (flash_write(flash_dev, fl_addr, buff, size) != 0) {
 		return -EIO;
 	}
 
-	/* write data to flash */
-	num_write = GET_NUM_BLOCK(CONFIG_FS_BLOCK_SIZE,
-				  CONFIG_FS_FLASH_MAX_RW_SIZE);
+	return 0;
+}
 
-	for (uint32_t i = 0; i < num_write; i++) {
-		/* flash_write reenabled write-protection so disable it again */
-		flash_write_protection_set(flash_dev, false);
+/* input size is either less or equal to a block size, CONFIG_FS_BLOCK_SIZE. */
+static int update_flash_block(off_t start_addr, uint32_t size,
+				  const void *buff)
+{
+	const uint8_t *src = buff;
 
-		if (flash_write(flash_dev, fl_addr, src,
-				CONFIG_FS_FLASH_MAX_RW_SIZE) != 0) {
+	/* if size is a partial block, perform read-copy with user data */
+	if (size < CONFIG_FS_BLOCK_SIZE) {
+		if (read_copy_flash_block(start_addr, size, buff, fs_buff) !=
+		    0) {
 			return -EIO;
 		}
 
-		fl_addr += CONFIG_FS_FLASH_MAX_RW_SIZE;
-		src += CONFIG_FS_FLASH_MAX_RW_SIZE;
+		/* now use the local buffer as the source */
+		src = fs_buff;
 	}
 
-	return 0;
+	/* always align starting address for flash write operation */
+	return write_flash_blocks(ROUND_DOWN(start_addr,
+					     CONFIG_FS_FLASH_ERASE_ALIGNMENT),
+				  CONFIG_FS_BLOCK_SIZE, src);
 }
 
 int disk_access_write(const uint8_t *buff, uint32_t start_sector,
@@ -224,20 +203,18 @@ int disk_access_write(const uint8_t *buff, uint32_t start_sector,
 		buff += size;
 	}
 
-	/* start is an erase-aligned address */
-	while (remaining) {
-		if (remaining < CONFIG_FS_BLOCK_SIZE) {
-			break;
-		}
-
-		if (update_flash_block(fl_addr, CONFIG_FS_BLOCK_SIZE,
-					buff) != 0) {
+	/* start is an erase-aligned address, whole blocks are erased one by
+	 * one then written at once
+	 */
+	size = ROUND_DOWN(remaining, CONFIG_FS_BLOCK_SIZE);
+	if (size) {
+		if (write_flash_blocks(fl_addr, size, buff) != 0) {
 			return -EIO;
 		}
 
-		fl_addr += CONFIG_FS_BLOCK_SIZE;
-		remaining -= CONFIG_FS_BLOCK_SIZE;
-		buff += CONFIG_FS_BLOCK_SIZE;
+		fl_addr += size;
+		remaining -= size;
+		buff += size;
 	}
 
 	/* remaining partial block */
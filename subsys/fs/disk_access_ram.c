@@ -19,6 +19,7 @@
 #include <misc/__assert.h>
 #include <disk_access.h>
 #include <errno.h>
+#include <kernel.h>
 
 #define RAMDISK_SECTOR_SIZE 512
 
@@ -52,8 +53,17 @@ int disk_access_init(void)
 	return 0;
 }
 
+/* Emulated command overhead of a request */
+static inline void request_latency(void)
+{
+#if CONFIG_DISK_ACCESS_RAM_LATENCY_US
+	k_busy_wait(CONFIG_DISK_ACCESS_RAM_LATENCY_US);
+#endif
+}
+
 int disk_access_read(uint8_t *buff, uint32_t sector, uint32_t count)
 {
+	request_latency();
 	memcpy(buff, lba_to_address(sector), count * RAMDISK_SECTOR_SIZE);
 
 	return 0;
@@ -61,6 +71,7 @@ int disk_access_read(uint8_t *buff, uint32_t sector, uint32_t count)
 
 int disk_access_write(const uint8_t *buff, uint32_t sector, uint32_t count)
 {
+	request_latency();
 	memcpy(lba_to_address(sector), buff, count * RAMDISK_SECTOR_SIZE);
 
 	return 0;
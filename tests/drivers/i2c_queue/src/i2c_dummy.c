@@ -0,0 +1,183 @@
+/* i2c_dummy.c - Fake I2C controller and slave for testing the I2C API */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zephyr.h>
+#include <i2c.h>
+#include <errno.h>
+#include <device.h>
+#include <init.h>
+#include <irq_offload.h>
+
+#include "i2c_dummy.h"
+
+/* Plays one message on the bus, as the slave sees it */
+static int i2c_dummy_msg(struct i2c_dummy_driver_data *data,
+			 struct i2c_msg *msg, uint8_t prev_flags,
+			 uint16_t addr, bool last)
+{
+	bool read = (msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_READ;
+	bool addressed = true;
+	uint32_t i;
+
+	if (!data->bus_held) {
+		data->stats.starts++;
+		data->bus_held = true;
+	} else if ((msg->flags & I2C_MSG_RESTART) ||
+		   ((prev_flags ^ msg->flags) & I2C_MSG_RW_MASK)) {
+		data->stats.restarts++;
+	} else {
+		addressed = false;
+	}
+
+	if (addressed && addr != data->slave_addr) {
+		/* Nobody acknowledges the address */
+		data->stats.stops++;
+		data->bus_held = false;
+		return -EIO;
+	}
+
+	for (i = 0; i < msg->len; i++) {
+		if (read) {
+			msg->buf[i] = data->regs[data->reg_ptr];
+		} else if (addressed && i == 0) {
+			/* First byte written selects the register */
+			data->reg_ptr = msg->buf[0] % DUMMY_I2C_NUM_REGS;
+			continue;
+		} else {
+			data->regs[data->reg_ptr] = msg->buf[i];
+		}
+
+		data->reg_ptr = (data->reg_ptr + 1) % DUMMY_I2C_NUM_REGS;
+	}
+
+	if (read) {
+		data->stats.reads++;
+	} else {
+		data->stats.writes++;
+	}
+
+	if (last || (msg->flags & I2C_MSG_STOP)) {
+		data->stats.stops++;
+		data->bus_held = false;
+	}
+
+	return 0;
+}
+
+/* Implemented as a software interrupt so that callbacks are executed
+ * in the expected context. Like the real drivers, the whole queue is
+ * processed without going back to the thread.
+ */
+static void i2c_dummy_isr(void *arg)
+{
+	struct device *d = arg;
+	struct i2c_dummy_driver_data *data = d->driver_data;
+	struct i2c_transaction *trans;
+	unsigned int key;
+	uint8_t flags, i;
+	int status;
+
+	data->stats.interrupts++;
+	data->in_isr = true;
+
+	while (data->head) {
+		trans = data->head;
+		status = 0;
+		flags = 0;
+
+		for (i = 0; i < trans->num_msgs && !status; i++) {
+			status = i2c_dummy_msg(data, &trans->msgs[i], flags,
+					       trans->addr,
+					       i == trans->num_msgs - 1);
+			flags = trans->msgs[i].flags;
+		}
+
+		key = irq_lock();
+		data->head = trans->next;
+		if (!data->head) {
+			data->tail = NULL;
+		}
+		irq_unlock(key);
+
+		trans->next = NULL;
+		trans->callback(d, trans, status);
+	}
+
+	data->in_isr = false;
+}
+
+static int i2c_dummy_configure(struct device *d, uint32_t dev_config)
+{
+	return 0;
+}
+
+static int i2c_dummy_transfer_async(struct device *d,
+				    struct i2c_transaction *trans)
+{
+	struct i2c_dummy_driver_data *data = d->driver_data;
+	struct i2c_transaction *last;
+	unsigned int key;
+	bool idle;
+
+	for (last = trans; ; last = last->next) {
+		if (!last->msgs || !last->num_msgs) {
+			return -ENOTSUP;
+		}
+
+		if (!last->next) {
+			break;
+		}
+	}
+
+	key = irq_lock();
+
+	idle = !data->head && !data->in_isr;
+	if (data->head) {
+		data->tail->next = trans;
+	} else {
+		data->head = trans;
+	}
+	data->tail = last;
+
+	irq_unlock(key);
+
+	if (idle) {
+		irq_offload(i2c_dummy_isr, d);
+	}
+
+	return 0;
+}
+
+static int i2c_dummy_transfer(struct device *d, struct i2c_msg *msgs,
+			      uint8_t num_msgs, uint16_t addr)
+{
+	return _i2c_transfer_sync(d, msgs, num_msgs, addr);
+}
+
+static const struct i2c_driver_api i2c_dummy_api = {
+	.configure = i2c_dummy_configure,
+	.transfer = i2c_dummy_transfer,
+	.transfer_async = i2c_dummy_transfer_async,
+};
+
+int i2c_dummy_init(struct device *d)
+{
+	d->driver_api = &i2c_dummy_api;
+
+	return 0;
+}
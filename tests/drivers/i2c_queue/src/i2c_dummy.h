@@ -0,0 +1,55 @@
+/* i2c_dummy.h - Fake I2C controller and slave */
+
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _I2C_DUMMY_H_
+#define _I2C_DUMMY_H_
+
+#include <zephyr.h>
+#include <device.h>
+#include <i2c.h>
+
+#define DUMMY_I2C_NUM_REGS	64
+
+/* Bus events seen by the slave */
+struct i2c_dummy_stats {
+	uint32_t starts;
+	uint32_t restarts;
+	uint32_t stops;
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t interrupts;
+};
+
+struct i2c_dummy_driver_data {
+	/* Queue of transactions, the head one being in progress */
+	struct i2c_transaction *head;
+	struct i2c_transaction *tail;
+	bool in_isr;
+
+	/* Slave with auto-incremented 8-bit register addresses */
+	uint16_t slave_addr;
+	uint8_t regs[DUMMY_I2C_NUM_REGS];
+	uint8_t reg_ptr;
+	bool bus_held;
+
+	struct i2c_dummy_stats stats;
+};
+
+int i2c_dummy_init(struct device *d);
+
+#endif /* _I2C_DUMMY_H_ */
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Exercises the queued I2C transactions, the batches of register
+ * operations and the register shadow against a simulated slave.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <init.h>
+#include <string.h>
+#include <misc/util.h>
+
+#include <tc_util.h>
+#include "i2c_dummy.h"
+
+#define SLAVE_ADDR	0x57
+#define CHAIN		4
+
+struct i2c_dummy_driver_data i2c_dummy0_driver_data = {
+	.slave_addr = SLAVE_ADDR,
+};
+DEVICE_INIT(i2c_dummy0, "i2c_dummy0", i2c_dummy_init,
+	    &i2c_dummy0_driver_data, NULL,
+	    POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+static struct i2c_dummy_driver_data *slave = &i2c_dummy0_driver_data;
+
+static struct i2c_transaction trans[CHAIN + 1];
+static struct i2c_msg msgs[CHAIN + 1][2];
+static uint8_t bufs[CHAIN + 1][2];
+static int order[CHAIN + 1];
+static int statuses[CHAIN + 1];
+static int done;
+static struct k_sem done_sem;
+
+static void trans_done(struct device *dev, struct i2c_transaction *t,
+		       int status)
+{
+	int i = t - trans;
+
+	order[done] = i;
+	statuses[i] = status;
+	done++;
+
+	/* Queue the extra transaction from the callback of the first */
+	if (i == 0) {
+		i2c_transfer_async(dev, &trans[CHAIN]);
+	}
+
+	if (done == CHAIN + 1) {
+		k_sem_give(&done_sem);
+	}
+}
+
+static int test_reg_batch(struct device *i2c)
+{
+	uint8_t wr1[3] = { 0x11, 0x22, 0x33 };
+	uint8_t wr2[1] = { 0x44 };
+	uint8_t rd1[3], rd2[1];
+	struct i2c_reg_op ops[] = {
+		{ .buf = wr1, .len = sizeof(wr1), .reg = 0x10,
+		  .flags = I2C_MSG_WRITE },
+		{ .buf = wr2, .len = sizeof(wr2), .reg = 0x20,
+		  .flags = I2C_MSG_WRITE },
+		{ .buf = rd1, .len = sizeof(rd1), .reg = 0x10,
+		  .flags = I2C_MSG_READ },
+		{ .buf = rd2, .len = sizeof(rd2), .reg = 0x20,
+		  .flags = I2C_MSG_READ },
+	};
+
+	TC_PRINT("Batch of register operations\n");
+
+	memset(&slave->stats, 0, sizeof(slave->stats));
+
+	if (i2c_reg_transfer(i2c, SLAVE_ADDR, ops, ARRAY_SIZE(ops))) {
+		TC_ERROR("register batch failed\n");
+		return TC_FAIL;
+	}
+
+	if (memcmp(&slave->regs[0x10], wr1, sizeof(wr1)) ||
+	    slave->regs[0x20] != wr2[0] ||
+	    memcmp(rd1, wr1, sizeof(wr1)) || rd2[0] != wr2[0]) {
+		TC_ERROR("registers not written or read back\n");
+		return TC_FAIL;
+	}
+
+	/* One START and one STOP, each later register address and each
+	 * read being preceded by a repeated start
+	 */
+	if (slave->stats.starts != 1 || slave->stats.stops != 1 ||
+	    slave->stats.restarts != 5 || slave->stats.interrupts != 1) {
+		TC_ERROR("unexpected bus conditions: %u starts, %u restarts, "
+			 "%u stops, %u interrupts\n", slave->stats.starts,
+			 slave->stats.restarts, slave->stats.stops,
+			 slave->stats.interrupts);
+		return TC_FAIL;
+	}
+
+	if (i2c_reg_transfer(i2c, SLAVE_ADDR, ops, 0) != -EINVAL ||
+	    i2c_reg_transfer(i2c, SLAVE_ADDR, ops, I2C_REG_OPS_MAX + 1)
+	    != -EINVAL) {
+		TC_ERROR("invalid batch accepted\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int test_chain(struct device *i2c)
+{
+	int i;
+
+	TC_PRINT("Chain of asynchronous transactions\n");
+
+	k_sem_init(&done_sem, 0, 1);
+	done = 0;
+
+	for (i = 0; i <= CHAIN; i++) {
+		bufs[i][0] = 0x30 + i;
+		bufs[i][1] = i;
+
+		msgs[i][0].buf = &bufs[i][0];
+		msgs[i][0].len = 1;
+		msgs[i][0].flags = I2C_MSG_WRITE;
+		msgs[i][1].buf = &bufs[i][1];
+		msgs[i][1].len = 1;
+		msgs[i][1].flags = I2C_MSG_WRITE | I2C_MSG_STOP;
+
+		trans[i].next = i < CHAIN - 1 ? &trans[i + 1] : NULL;
+		trans[i].msgs = msgs[i];
+		trans[i].num_msgs = 2;
+		trans[i].addr = SLAVE_ADDR;
+		trans[i].callback = trans_done;
+		statuses[i] = 1;
+	}
+
+	/* Nobody answers at this address */
+	trans[2].addr = SLAVE_ADDR + 1;
+
+	memset(&slave->stats, 0, sizeof(slave->stats));
+
+	if (i2c_transfer_async(i2c, trans)) {
+		TC_ERROR("cannot queue transactions\n");
+		return TC_FAIL;
+	}
+
+	if (k_sem_take(&done_sem, K_SECONDS(1))) {
+		TC_ERROR("only %d transactions completed\n", done);
+		return TC_FAIL;
+	}
+
+	for (i = 0; i <= CHAIN; i++) {
+		if (order[i] != i) {
+			TC_ERROR("transaction %d completed out of order\n",
+				 order[i]);
+			return TC_FAIL;
+		}
+
+		if (statuses[i] != (i == 2 ? -EIO : 0)) {
+			TC_ERROR("transaction %d completed with %d\n", i,
+				 statuses[i]);
+			return TC_FAIL;
+		}
+
+		if (i != 2 && slave->regs[0x30 + i] != i) {
+			TC_ERROR("transaction %d not written\n", i);
+			return TC_FAIL;
+		}
+	}
+
+	if (slave->stats.interrupts != 1) {
+		TC_ERROR("chain took %u interrupts\n",
+			 slave->stats.interrupts);
+		return TC_FAIL;
+	}
+
+	trans[0].msgs = NULL;
+	if (i2c_transfer_async(i2c, trans) != -ENOTSUP) {
+		TC_ERROR("transaction without message accepted\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int test_shadow(struct device *i2c)
+{
+	struct i2c_reg_shadow shadow;
+	uint8_t values[4];
+	uint8_t value;
+
+	TC_PRINT("Register shadow\n");
+
+	slave->regs[0x07] = 0x80;
+	i2c_reg_shadow_init(&shadow, i2c, SLAVE_ADDR, 0x06, values,
+			    sizeof(values));
+
+	memset(&slave->stats, 0, sizeof(slave->stats));
+
+	/* The first update reads the register */
+	if (i2c_reg_shadow_update(&shadow, 0x07, 0x03, 0x01) ||
+	    slave->regs[0x07] != 0x81 || slave->stats.reads != 1 ||
+	    slave->stats.starts != 2) {
+		TC_ERROR("first update failed\n");
+		return TC_FAIL;
+	}
+
+	/* The next ones only write it, when changed */
+	if (i2c_reg_shadow_update(&shadow, 0x07, 0x1c, 0x04) ||
+	    i2c_reg_shadow_update(&shadow, 0x07, 0x1c, 0x04) ||
+	    slave->regs[0x07] != 0x85 || slave->stats.reads != 1 ||
+	    slave->stats.starts != 3) {
+		TC_ERROR("cached update failed\n");
+		return TC_FAIL;
+	}
+
+	if (i2c_reg_shadow_read(&shadow, 0x07, &value) || value != 0x85 ||
+	    slave->stats.starts != 3) {
+		TC_ERROR("cached read failed\n");
+		return TC_FAIL;
+	}
+
+	/* Values changed by the device are read again once invalidated */
+	slave->regs[0x07] = 0x05;
+	i2c_reg_shadow_invalidate(&shadow, 0x07);
+	if (i2c_reg_shadow_read(&shadow, 0x07, &value) || value != 0x05 ||
+	    slave->stats.reads != 2) {
+		TC_ERROR("invalidated read failed\n");
+		return TC_FAIL;
+	}
+
+	/* Registers out of the range are not cached */
+	if (i2c_reg_shadow_read(&shadow, 0x0a, &value) ||
+	    i2c_reg_shadow_read(&shadow, 0x0a, &value) ||
+	    slave->stats.reads != 4) {
+		TC_ERROR("register out of range cached\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int test_sync(struct device *i2c)
+{
+	uint8_t value;
+
+	TC_PRINT("Synchronous transfers\n");
+
+	if (i2c_reg_write_byte(i2c, SLAVE_ADDR, 0x3f, 0x5a) ||
+	    i2c_reg_update_byte(i2c, SLAVE_ADDR, 0x3f, 0x0f, 0x00) ||
+	    i2c_reg_read_byte(i2c, SLAVE_ADDR, 0x3f, &value) ||
+	    value != 0x50) {
+		TC_ERROR("register access failed\n");
+		return TC_FAIL;
+	}
+
+	if (i2c_reg_read_byte(i2c, SLAVE_ADDR + 1, 0x3f, &value) != -EIO) {
+		TC_ERROR("missing slave not reported\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *i2c;
+	int rv;
+
+	TC_START("Test I2C transaction queue");
+
+	i2c = device_get_binding("i2c_dummy0");
+
+	rv = test_reg_batch(i2c);
+	if (rv == TC_PASS) {
+		rv = test_chain(i2c);
+	}
+	if (rv == TC_PASS) {
+		rv = test_shadow(i2c);
+	}
+	if (rv == TC_PASS) {
+		rv = test_sync(i2c);
+	}
+
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
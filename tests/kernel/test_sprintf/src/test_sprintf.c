@@ -638,6 +638,58 @@ int sprintfIntegerTest(void)
 	return status;
 }
 
+#ifdef CONFIG_MINIMAL_LIBC
+/**
+ *
+ * @brief Test the sprintf() fixed point conversion
+ *
+ * %q is specific to the minimal libc: it takes the integer part and the
+ * millionths of a value, as in the sensor values.
+ *
+ * @return TC_PASS on success, TC_FAIL otherwise
+ */
+
+int sprintfFixedTest(void)
+{
+	int  status = TC_PASS;
+	char buffer[100];
+
+	sprintf(buffer, "%q", 9, 806650);
+	if (strcmp(buffer, "9.806650") != 0) {
+		TC_ERROR("sprintf(%%q).  Expected '9.806650', got '%s'\n", buffer);
+		status = TC_FAIL;
+	}
+
+	sprintf(buffer, "%.2q", 0, -500000);
+	if (strcmp(buffer, "-0.50") != 0) {
+		TC_ERROR("sprintf(%%.2q).  Expected '-0.50', got '%s'\n", buffer);
+		status = TC_FAIL;
+	}
+
+	sprintf(buffer, "%.0q", -3, -999999);
+	if (strcmp(buffer, "-3") != 0) {
+		TC_ERROR("sprintf(%%.0q).  Expected '-3', got '%s'\n", buffer);
+		status = TC_FAIL;
+	}
+
+	sprintf(buffer, "%08.2q", -1, -250000);
+	if (strcmp(buffer, "-0001.25") != 0) {
+		TC_ERROR("sprintf(%%08.2q).  Expected '-0001.25', got '%s'\n",
+				 buffer);
+		status = TC_FAIL;
+	}
+
+	sprintf(buffer, "%-8.1q|", 12, 345678);
+	if (strcmp(buffer, "12.3    |") != 0) {
+		TC_ERROR("sprintf(%%-8.1q).  Expected '12.3    |', got '%s'\n",
+				 buffer);
+		status = TC_FAIL;
+	}
+
+	return status;
+}
+#endif /* CONFIG_MINIMAL_LIBC */
+
 /**
  *
  * @brief Test sprintf with strings
@@ -724,6 +776,13 @@ void main(void)
 		status = TC_FAIL;
 	}
 
+#ifdef CONFIG_MINIMAL_LIBC
+	TC_PRINT("Testing sprintf() with fixed point values ....\n");
+	if (sprintfFixedTest() != TC_PASS) {
+		status = TC_FAIL;
+	}
+#endif
+
 	TC_PRINT("Testing sprintf() with misc options ....\n");
 	if (sprintfMiscTest() != TC_PASS) {
 		status = TC_FAIL;
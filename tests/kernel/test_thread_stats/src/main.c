@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Checks that the execution statistics of a new thread start from zero,
+ * although its structure sits on a stack filled by CONFIG_INIT_STACKS, and
+ * that they account for its run time once it has run.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define STACK_SIZE 512
+
+/* Time the worker spends running */
+#define WORK_US 10000
+
+/* Upper bound of the switches of the main thread so far */
+#define MAIN_SWITCHES_MAX 10
+
+static char __stack stack[STACK_SIZE];
+
+static void worker(void *unused0, void *unused1, void *unused2)
+{
+	ARG_UNUSED(unused0);
+	ARG_UNUSED(unused1);
+	ARG_UNUSED(unused2);
+
+	k_busy_wait(WORK_US);
+}
+
+static int check_main(void)
+{
+	struct k_thread_stats stats;
+
+	k_thread_stats_get(k_current_get(), &stats);
+
+	TC_PRINT("main thread: %u preemptions, %u voluntary switches\n",
+		 stats.preemptions, stats.voluntary_switches);
+
+	if (stats.preemptions + stats.voluntary_switches > MAIN_SWITCHES_MAX) {
+		TC_ERROR("main thread counters not reset\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int check_new(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid;
+
+	/* lower priority than main: ready, but not run until main sleeps */
+	tid = k_thread_spawn(stack, STACK_SIZE, worker, NULL, NULL, NULL,
+			     k_thread_priority_get(k_current_get()) + 1, 0,
+			     K_NO_WAIT);
+
+	k_busy_wait(WORK_US);
+
+	k_thread_stats_get(tid, &stats);
+	if (stats.run_time || stats.ready_time || stats.preemptions ||
+	    stats.voluntary_switches) {
+		TC_ERROR("statistics of a thread not yet run not reset\n");
+		return TC_FAIL;
+	}
+
+	k_sleep(2 * WORK_US / USEC_PER_MSEC);
+
+	/* the worker ran for WORK_US, then terminated */
+	k_thread_stats_get(tid, &stats);
+	if (SYS_CLOCK_HW_CYCLES_TO_NS64(stats.run_time) <
+	    (uint64_t)WORK_US * NSEC_PER_USEC ||
+	    SYS_CLOCK_HW_CYCLES_TO_NS64(stats.run_time) >
+	    (uint64_t)2 * WORK_US * NSEC_PER_USEC) {
+		TC_ERROR("run time of %u us instead of %u us\n",
+			 (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(stats.run_time) /
+				    NSEC_PER_USEC), WORK_US);
+		return TC_FAIL;
+	}
+
+	if (stats.preemptions || stats.voluntary_switches != 1) {
+		TC_ERROR("%u preemptions and %u voluntary switches\n",
+			 stats.preemptions, stats.voluntary_switches);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int rv;
+
+	TC_START("Test thread execution statistics");
+
+	rv = check_main();
+	if (rv == TC_PASS) {
+		rv = check_new();
+	}
+
+	TC_END_RESULT(rv);
+	TC_END_REPORT(rv);
+}
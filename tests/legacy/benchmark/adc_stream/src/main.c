@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the CPU time spent to take 1000 ADC samples at 1 kHz, by a
+ * thread waking up for each sample or as a continuous stream delivered in
+ * blocks.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#include <adc.h>
+
+#define ADC_DRV_NAME CONFIG_ADC_0_NAME
+
+#define SAMPLES 1000
+#define RATE 1000
+#define BLOCK 64
+
+#define STACK_SIZE 512
+#define SAMPLER_PRIORITY -1
+
+/* Cycles of the reference loop, without any sampling */
+#define CALIBRATION_CYCLES (sys_clock_hw_cycles_per_tick * 100)
+
+static char __stack sampler_stack[STACK_SIZE];
+
+static uint16_t samples[SAMPLES];
+static uint16_t blocks[2][BLOCK];
+
+static volatile int taken;
+static volatile int status;
+static uint8_t *last_block;
+
+/* Iterations of the loop also used while sampling */
+static uint32_t calibrate(void)
+{
+	uint32_t start, now, spins = 0;
+
+	start = k_cycle_get_32();
+	do {
+		spins++;
+		now = k_cycle_get_32();
+	} while (now - start < CALIBRATION_CYCLES);
+
+	return spins;
+}
+
+/* Spins until the samples are taken, returns the CPU cycles used by the
+ * sampling, per SAMPLES samples
+ */
+static uint32_t wait_samples(uint32_t ref)
+{
+	uint32_t start, now, cycles, spins = 0;
+	uint64_t free;
+
+	start = k_cycle_get_32();
+	do {
+		spins++;
+		now = k_cycle_get_32();
+	} while (taken < SAMPLES);
+	cycles = now - start;
+
+	free = (uint64_t)spins * CALIBRATION_CYCLES / ref;
+
+	if (free >= cycles) {
+		return 0;
+	}
+
+	return (uint64_t)(cycles - free) * SAMPLES / taken;
+}
+
+static void sampler(void *dev, void *unused1, void *unused2)
+{
+	struct adc_seq_entry entry = {
+		.sampling_delay = 1,
+		.buffer_length = sizeof(uint16_t),
+	};
+	struct adc_seq_table table = {
+		.entries = &entry,
+		.num_entries = 1,
+	};
+
+	ARG_UNUSED(unused1);
+	ARG_UNUSED(unused2);
+
+	while (taken < SAMPLES) {
+		k_sleep(MSEC_PER_SEC / RATE);
+
+		entry.buffer = (uint8_t *)&samples[taken];
+		if (adc_read(dev, &table)) {
+			status = TC_FAIL;
+		}
+		taken++;
+	}
+}
+
+static void block_done(struct device *dev, struct adc_stream *stream,
+		       uint8_t *buffer)
+{
+	/* the buffers are filled in turn */
+	if (buffer == last_block) {
+		status = TC_FAIL;
+	}
+	last_block = buffer;
+
+	taken += stream->buffer_length / sizeof(uint16_t);
+}
+
+static int bench_thread(struct device *adc, uint32_t ref)
+{
+	uint32_t cycles;
+
+	taken = 0;
+	status = TC_PASS;
+
+	k_thread_spawn(sampler_stack, STACK_SIZE, sampler, adc, NULL, NULL,
+		       SAMPLER_PRIORITY, 0, K_NO_WAIT);
+
+	cycles = wait_samples(ref);
+
+	if (status != TC_PASS) {
+		TC_ERROR("sample read failed\n");
+		return TC_FAIL;
+	}
+
+	TC_PRINT("thread per sample: %6u us of CPU per %u samples\n",
+		 (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / 1000),
+		 SAMPLES);
+
+	return TC_PASS;
+}
+
+static int bench_stream(struct device *adc, uint32_t ref)
+{
+	struct adc_stream stream = {
+		.sampling_rate = RATE,
+		.buffer = { (uint8_t *)blocks[0], (uint8_t *)blocks[1] },
+		.buffer_length = sizeof(blocks[0]),
+		.callback = block_done,
+	};
+	uint32_t cycles;
+
+	taken = 0;
+	status = TC_PASS;
+	last_block = NULL;
+
+	if (adc_stream_start(adc, &stream)) {
+		TC_ERROR("cannot start stream\n");
+		return TC_FAIL;
+	}
+
+	cycles = wait_samples(ref);
+
+	adc_stream_stop(adc);
+
+	if (status != TC_PASS || stream.overruns) {
+		TC_ERROR("stream blocks out of order or lost\n");
+		return TC_FAIL;
+	}
+
+	TC_PRINT("stream, %2u samples per block: %6u us of CPU per %u samples\n",
+		 BLOCK, (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / 1000),
+		 SAMPLES);
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *adc;
+	int result;
+	uint32_t ref;
+
+	TC_START("ADC sampling CPU load");
+
+	adc = device_get_binding(ADC_DRV_NAME);
+	if (!adc) {
+		TC_ERROR("cannot get ADC device\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	adc_enable(adc);
+
+	ref = calibrate();
+
+	result = bench_thread(adc, ref);
+	if (result == TC_PASS) {
+		result = bench_stream(adc, ref);
+	}
+
+	adc_disable(adc);
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the cost in cycles per byte of TinyCrypt AES-128 block
+ * encryption, CTR mode and CCM mode, for message sizes ranging from a
+ * single block to a full 1KB record. CCM is run with 13 bytes of associated
+ * data and an 8-byte tag, as used by DTLS.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#include <tinycrypt/aes.h>
+#include <tinycrypt/ctr_mode.h>
+#include <tinycrypt/ccm_mode.h>
+#include <tinycrypt/constants.h>
+
+#define MAX_LEN 1024
+#define TOTAL_BYTES 16384
+#define AD_LEN 13
+#define NONCE_LEN 13
+#define TAG_LEN 8
+
+static const uint8_t key[TC_AES_KEY_SIZE] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint16_t sizes[] = { 16, 64, 256, MAX_LEN };
+
+static uint8_t in[MAX_LEN];
+static uint8_t out[MAX_LEN + TAG_LEN];
+static uint8_t ad[AD_LEN];
+static uint8_t nonce[NONCE_LEN];
+static uint8_t ctr[TC_AES_BLOCK_SIZE];
+
+static struct tc_aes_key_sched_struct sched;
+static struct tc_ccm_mode_struct ccm;
+
+static uint32_t per_byte(uint32_t cycles, uint32_t bytes)
+{
+	return (cycles + bytes / 2) / bytes;
+}
+
+static void bench_block(void)
+{
+	uint32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < TOTAL_BYTES / TC_AES_BLOCK_SIZE; i++) {
+		tc_aes_encrypt(out, in, &sched);
+	}
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("tc_aes_encrypt:        %u cycles/byte\n",
+		 per_byte(cycles, TOTAL_BYTES));
+
+	start = k_cycle_get_32();
+	tc_aes_encrypt_blocks(out, in, MAX_LEN / TC_AES_BLOCK_SIZE, &sched);
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("tc_aes_encrypt_blocks: %u cycles/byte\n",
+		 per_byte(cycles, MAX_LEN));
+}
+
+static void bench_ctr(uint16_t len)
+{
+	uint32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < TOTAL_BYTES / len; i++) {
+		tc_ctr_mode(out, len, in, len, ctr, &sched);
+	}
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("CTR %4u bytes:         %u cycles/byte\n", len,
+		 per_byte(cycles, TOTAL_BYTES));
+}
+
+static void bench_ccm(uint16_t len)
+{
+	uint32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < TOTAL_BYTES / len; i++) {
+		tc_ccm_generation_encryption(out, ad, AD_LEN, in, len, &ccm);
+	}
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("CCM %4u bytes:         %u cycles/byte\n", len,
+		 per_byte(cycles, TOTAL_BYTES));
+}
+
+void main(void)
+{
+	int i;
+
+	TC_START("AES-128 throughput");
+
+	for (i = 0; i < sizeof(in); i++) {
+		in[i] = i;
+	}
+
+	if (tc_aes128_set_encrypt_key(&sched, key) != TC_CRYPTO_SUCCESS ||
+	    tc_ccm_config(&ccm, &sched, nonce, NONCE_LEN,
+			  TAG_LEN) != TC_CRYPTO_SUCCESS) {
+		TC_ERROR("cannot set up the key\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+#ifdef CONFIG_TINYCRYPT_AES_FAST
+	TC_PRINT("table-driven implementation\n");
+#else
+	TC_PRINT("compact implementation\n");
+#endif
+
+	bench_block();
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		bench_ctr(sizes[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		bench_ccm(sizes[i]);
+	}
+
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the time taken by TinyCrypt NIST P-256 operations: key pair
+ * generation, ECDH shared secret computation, ECDSA signature and ECDSA
+ * verification.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#include <tinycrypt/ecc.h>
+#include <tinycrypt/ecc_dh.h>
+#include <tinycrypt/ecc_dsa.h>
+#include <tinycrypt/constants.h>
+
+#define ITERATIONS 4
+
+/* fixed "random" inputs: the operations take the same time for any value */
+static uint32_t random1[NUM_ECC_DIGITS] = {
+	0x8a7f52c1, 0x3bd2c7e4, 0x91ee0d16, 0x5c30a8b7,
+	0xe64d2a9f, 0x0f1b7c53, 0xa2c96e08, 0x7d45b3f2
+};
+
+static uint32_t random2[NUM_ECC_DIGITS] = {
+	0x1c6b9e27, 0xf0a4d358, 0x6e2f81ab, 0xb7d03c94,
+	0x49a5e6d1, 0xd82c1f7a, 0x35f7a0c6, 0x5e91d4b8
+};
+
+static uint32_t hash[NUM_ECC_DIGITS] = {
+	0xba7816bf, 0x8f01cfea, 0x414140de, 0x5dae2223,
+	0xb00361a3, 0x96177a9c, 0xb410ff61, 0xf20015ad
+};
+
+static EccPoint public1, public2;
+static uint32_t private1[NUM_ECC_DIGITS], private2[NUM_ECC_DIGITS];
+static uint32_t secret[NUM_ECC_DIGITS];
+static uint32_t r[NUM_ECC_DIGITS], s[NUM_ECC_DIGITS];
+
+static uint32_t start;
+
+static void report(const char *name)
+{
+	uint64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start);
+
+	TC_PRINT("%s %u.%03u ms\n", name,
+		 (uint32_t)(ns / ITERATIONS / 1000000),
+		 (uint32_t)(ns / ITERATIONS / 1000 % 1000));
+}
+
+void main(void)
+{
+	int result = TC_PASS;
+	int i;
+
+	TC_START("NIST P-256 performance");
+
+	ecc_make_key(&public2, private2, random2);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		ecc_make_key(&public1, private1, random1);
+	}
+	report("key pair generation:");
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		if (!ecdh_shared_secret(secret, &public2, private1)) {
+			result = TC_FAIL;
+		}
+	}
+	report("ECDH shared secret: ");
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		if (!ecdsa_sign(r, s, private1, random2, hash)) {
+			result = TC_FAIL;
+		}
+	}
+	report("ECDSA sign:         ");
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		if (!ecdsa_verify(&public1, hash, r, s)) {
+			result = TC_FAIL;
+		}
+	}
+	report("ECDSA verify:       ");
+
+	TC_END_REPORT(result);
+}
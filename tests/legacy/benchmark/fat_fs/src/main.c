@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the throughput of sequential and random accesses to a file on
+ * the FAT file system, with or without CONFIG_FS_FAT_READ_AHEAD.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <fs.h>
+
+#define TEST_FILE "bench.dat"
+#define FILE_SIZE (32 * 1024)
+
+#define RANDOM_READS 64
+#define RANDOM_SIZE 512
+
+static fs_file_t file;
+static uint8_t buf[4096];
+
+static uint8_t pattern(uint32_t offset)
+{
+	return offset ^ (offset >> 8);
+}
+
+static void report(const char *test, uint32_t bytes, uint32_t cycles)
+{
+	uint64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+	uint32_t centi_mbps;
+
+	/* hundredths of MB/s */
+	centi_mbps = ns ? (uint64_t)bytes * 100 * 1000 / ns : 0;
+
+	TC_PRINT("%-24s %3u.%02u MB/s\n", test, centi_mbps / 100,
+		 centi_mbps % 100);
+}
+
+static int check(uint32_t offset, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		if (buf[i] != pattern(offset + i)) {
+			TC_ERROR("wrong data at offset %u\n", offset + i);
+			return TC_FAIL;
+		}
+	}
+
+	return TC_PASS;
+}
+
+static int bench_write(void)
+{
+	uint32_t start, cycles, offset, i;
+
+	start = k_cycle_get_32();
+	for (offset = 0; offset < FILE_SIZE; offset += sizeof(buf)) {
+		for (i = 0; i < sizeof(buf); i++) {
+			buf[i] = pattern(offset + i);
+		}
+
+		if (fs_write(&file, buf, sizeof(buf)) != sizeof(buf)) {
+			TC_ERROR("cannot write at offset %u\n", offset);
+			return TC_FAIL;
+		}
+	}
+
+	if (fs_sync(&file)) {
+		TC_ERROR("cannot sync file\n");
+		return TC_FAIL;
+	}
+	cycles = k_cycle_get_32() - start;
+
+	report("write 4 KB", FILE_SIZE, cycles);
+
+	return TC_PASS;
+}
+
+/* Reads the whole file in pieces of size bytes, the data is only checked
+ * once timed
+ */
+static int bench_read(const char *test, size_t size)
+{
+	uint32_t start, cycles = 0, offset;
+
+	if (fs_seek(&file, 0, FS_SEEK_SET)) {
+		TC_ERROR("cannot seek\n");
+		return TC_FAIL;
+	}
+
+	for (offset = 0; offset < FILE_SIZE; offset += size) {
+		start = k_cycle_get_32();
+		if (fs_read(&file, buf, size) != size) {
+			TC_ERROR("cannot read at offset %u\n", offset);
+			return TC_FAIL;
+		}
+		cycles += k_cycle_get_32() - start;
+
+		if (check(offset, size) != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	report(test, FILE_SIZE, cycles);
+
+	return TC_PASS;
+}
+
+static int bench_random(void)
+{
+	uint32_t start, cycles = 0, offset, seed = 1;
+	int i;
+
+	for (i = 0; i < RANDOM_READS; i++) {
+		/* same offsets at each run */
+		seed = seed * 1103515245 + 12345;
+		offset = (seed >> 8) % (FILE_SIZE - RANDOM_SIZE);
+
+		start = k_cycle_get_32();
+		if (fs_seek(&file, offset, FS_SEEK_SET) ||
+		    fs_read(&file, buf, RANDOM_SIZE) != RANDOM_SIZE) {
+			TC_ERROR("cannot read at offset %u\n", offset);
+			return TC_FAIL;
+		}
+		cycles += k_cycle_get_32() - start;
+
+		if (check(offset, RANDOM_SIZE) != TC_PASS) {
+			return TC_FAIL;
+		}
+	}
+
+	report("random read 512 bytes", RANDOM_READS * RANDOM_SIZE, cycles);
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+
+	TC_START("FAT file system throughput");
+
+#if CONFIG_FS_FAT_READ_AHEAD
+	TC_PRINT("read-ahead of up to %u sectors\n",
+		 CONFIG_FS_FAT_READ_AHEAD);
+#else
+	TC_PRINT("no read-ahead\n");
+#endif
+
+	fs_unlink(TEST_FILE);
+	if (fs_open(&file, TEST_FILE)) {
+		TC_ERROR("cannot open %s\n", TEST_FILE);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	result = bench_write();
+	if (result == TC_PASS) {
+		result = bench_read("sequential read 4 KB", sizeof(buf));
+	}
+	if (result == TC_PASS) {
+		result = bench_read("sequential read 64 bytes", 64);
+	}
+	if (result == TC_PASS) {
+		result = bench_random();
+	}
+
+	fs_close(&file);
+	fs_unlink(TEST_FILE);
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the rate of characters sent through the IPM console, and the time
+ * the sender spends per line, over a loopback mailbox standing in for the
+ * mailboxes between cores.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <device.h>
+#include <ipm.h>
+#include <console/ipm_console.h>
+
+#define LINES 64
+#define LINE "sensor 12: value 12000 status 0000000c\n"
+#define LINE_LEN (sizeof(LINE) - 1)
+
+/* Loopback mailbox, messages are received as they are sent */
+static ipm_callback_t loop_cb;
+static void *loop_context;
+static int loop_enabled;
+static int loop_messages;
+
+static int loop_send(struct device *d, int wait, uint32_t id,
+		     const void *data, int size)
+{
+	loop_messages++;
+
+	/* The receiver disables the channel until it has room */
+	while (!loop_enabled) {
+		k_yield();
+	}
+
+	loop_cb(loop_context, id, (volatile void *)data);
+
+	return 0;
+}
+
+static void loop_register_callback(struct device *d, ipm_callback_t cb,
+				   void *context)
+{
+	loop_cb = cb;
+	loop_context = context;
+}
+
+static int loop_max_data_size_get(struct device *d)
+{
+	return IPM_CONSOLE_BATCH_SIZE;
+}
+
+static uint32_t loop_max_id_val_get(struct device *d)
+{
+	return 0x7FFFFFFF;
+}
+
+static int loop_set_enabled(struct device *d, int enable)
+{
+	loop_enabled = enable;
+	return 0;
+}
+
+static const struct ipm_driver_api loop_api = {
+	.send = loop_send,
+	.register_callback = loop_register_callback,
+	.max_data_size_get = loop_max_data_size_get,
+	.max_id_val_get = loop_max_id_val_get,
+	.set_enabled = loop_set_enabled
+};
+
+static int loop_init(struct device *d)
+{
+	return 0;
+}
+
+DEVICE_AND_API_INIT(ipm_loop, "ipm_loop", loop_init, NULL, NULL,
+		    PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &loop_api);
+
+/* Receiver, delivering lines without printing them */
+static uint32_t ring_buf_data[256];
+static char __stack thread_stack[IPM_CONSOLE_STACK_SIZE];
+static char line_buf[80];
+
+static struct ipm_console_receiver_config_info receiver_config = {
+	.bind_to = "ipm_loop",
+	.thread_stack = thread_stack,
+	.ring_buf_data = ring_buf_data,
+	.rb_size32 = 256,
+	.line_buf = line_buf,
+	.lb_size = sizeof(line_buf),
+	.flags = 0
+};
+static struct ipm_console_receiver_runtime_data receiver_data;
+DEVICE_INIT(ipm_console_rx, "ipm_console_rx", ipm_console_receiver_init,
+	    &receiver_data, &receiver_config,
+	    APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+/* Sender, taking stdout */
+static struct ipm_console_sender_config_info sender_config = {
+	.bind_to = "ipm_loop",
+	.flags = IPM_CONSOLE_STDOUT
+};
+DEVICE_INIT(ipm_console_tx, "ipm_console_tx", ipm_console_sender_init,
+	    NULL, &sender_config,
+	    APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+static void report(const char *name, uint32_t cycles)
+{
+	uint64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+
+	TC_PRINT("%s %u chars/s, %u ns per line, %u messages per line\n",
+		 name, (uint32_t)(LINES * LINE_LEN * NSEC_PER_SEC / ns),
+		 (uint32_t)(ns / LINES), loop_messages / LINES);
+}
+
+void main(void)
+{
+	struct device *loop = device_get_binding("ipm_loop");
+	uint32_t start;
+	int i, j;
+
+	TC_START("IPM console throughput");
+
+	/* One message per character, as sent by the former console */
+	loop_messages = 0;
+	start = k_cycle_get_32();
+	for (i = 0; i < LINES; i++) {
+		for (j = 0; j < LINE_LEN; j++) {
+			ipm_send(loop, 1, LINE[j], NULL, 0);
+		}
+	}
+	report("per character:", k_cycle_get_32() - start);
+
+	/* Batches of characters through the stdout hook */
+	loop_messages = 0;
+	start = k_cycle_get_32();
+	for (i = 0; i < LINES; i++) {
+		printf(LINE);
+	}
+	report("batched:      ", k_cycle_get_32() - start);
+
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the time needed to share the data of a network buffer with
+ * another consumer, by copying it with net_buf_clone() or by referencing it
+ * with net_buf_slice(), for increasing data sizes.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <net/buf.h>
+
+#define MAX_DATA_SIZE 1024
+#define ITERATIONS 1000
+
+static struct k_fifo bufs_fifo;
+static NET_BUF_POOL(bufs_pool, 2, MAX_DATA_SIZE, &bufs_fifo, NULL, 0);
+
+static struct k_fifo slices_fifo;
+static NET_BUF_POOL(slices_pool, 1, 0, &slices_fifo, NULL, 0);
+
+static uint32_t clone_cost(struct net_buf *buf)
+{
+	uint32_t start = k_cycle_get_32();
+	int i;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		net_buf_unref(net_buf_clone(buf));
+	}
+
+	return (k_cycle_get_32() - start) / ITERATIONS;
+}
+
+static uint32_t slice_cost(struct net_buf *buf)
+{
+	uint32_t start = k_cycle_get_32();
+	int i;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		net_buf_unref(net_buf_slice(&slices_fifo, buf, 0, buf->len));
+	}
+
+	return (k_cycle_get_32() - start) / ITERATIONS;
+}
+
+void main(void)
+{
+	struct net_buf *buf;
+	int size;
+
+	TC_START("Network buffer clone cost");
+
+	net_buf_pool_init(bufs_pool);
+	net_buf_pool_init(slices_pool);
+
+	buf = net_buf_get(&bufs_fifo, 0);
+	memset(net_buf_add(buf, MAX_DATA_SIZE), 0xaa, MAX_DATA_SIZE);
+
+	for (size = 16; size <= MAX_DATA_SIZE; size *= 2) {
+		buf->len = size;
+
+		TC_PRINT("%d bytes: net_buf_clone %u ns, net_buf_slice %u ns\n",
+			 size, SYS_CLOCK_HW_CYCLES_TO_NS(clone_cost(buf)),
+			 SYS_CLOCK_HW_CYCLES_TO_NS(slice_cost(buf)));
+	}
+
+	net_buf_unref(buf);
+
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the latency between signalling one of several event sources and
+ * the thread servicing it running, for a thread waiting with
+ * k_sem_group_take(), a thread waiting with k_poll(), and one thread per
+ * event source.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define STACK_SIZE 512
+
+/* higher priority than the main thread, so waiters run on every signal */
+#define WAITER_PRIORITY -1
+
+#define NUM_SOURCES 8
+#define ITERATIONS 1000
+
+static char __stack waiter_stacks[NUM_SOURCES][STACK_SIZE];
+
+static struct k_sem sems[NUM_SOURCES];
+static struct k_sem *sem_group[NUM_SOURCES + 1];
+
+static struct k_fifo fifo;
+static char __aligned(4) msgq_buf[4 * sizeof(uint32_t)];
+static struct k_msgq msgq;
+static struct k_poll_signal signal;
+
+static void *fifo_item[1];
+
+static volatile uint32_t woken;
+static int handled;
+static int stop;
+
+static void sem_group_waiter(void *p1, void *p2, void *p3)
+{
+	struct k_sem *sem;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (;;) {
+		k_sem_group_take(sem_group, &sem, K_FOREVER);
+		woken = k_cycle_get_32();
+		if (stop) {
+			return;
+		}
+		handled++;
+	}
+}
+
+static void poll_waiter(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event events[NUM_SOURCES];
+	int i;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (i = 0; i < NUM_SOURCES; i++) {
+		k_poll_event_init(&events[i], K_POLL_TYPE_SEM_AVAILABLE,
+				  K_POLL_MODE_NOTIFY_ONLY, &sems[i]);
+	}
+
+	for (;;) {
+		k_poll(events, NUM_SOURCES, K_FOREVER);
+		woken = k_cycle_get_32();
+		if (stop) {
+			return;
+		}
+
+		for (i = 0; i < NUM_SOURCES; i++) {
+			if (events[i].state == K_POLL_STATE_SEM_AVAILABLE) {
+				k_sem_take(events[i].sem, K_NO_WAIT);
+				handled++;
+			}
+			events[i].state = K_POLL_STATE_NOT_READY;
+		}
+	}
+}
+
+static void poll_mixed_waiter(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event events[4];
+	uint32_t msg;
+	int i;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	k_poll_event_init(&events[0], K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &sems[0]);
+	k_poll_event_init(&events[1], K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &fifo);
+	k_poll_event_init(&events[2], K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &msgq);
+	k_poll_event_init(&events[3], K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &signal);
+
+	for (;;) {
+		k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+		woken = k_cycle_get_32();
+		if (stop) {
+			return;
+		}
+
+		if (events[0].state == K_POLL_STATE_SEM_AVAILABLE) {
+			k_sem_take(&sems[0], K_NO_WAIT);
+			handled++;
+		}
+		if (events[1].state == K_POLL_STATE_FIFO_DATA_AVAILABLE) {
+			k_fifo_get(&fifo, K_NO_WAIT);
+			handled++;
+		}
+		if (events[2].state == K_POLL_STATE_MSGQ_DATA_AVAILABLE) {
+			k_msgq_get(&msgq, &msg, K_NO_WAIT);
+			handled++;
+		}
+		if (events[3].state == K_POLL_STATE_SIGNALED) {
+			signal.signaled = 0;
+			handled++;
+		}
+
+		for (i = 0; i < ARRAY_SIZE(events); i++) {
+			events[i].state = K_POLL_STATE_NOT_READY;
+		}
+	}
+}
+
+static void per_source_waiter(void *p1, void *p2, void *p3)
+{
+	struct k_sem *sem = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (;;) {
+		k_sem_take(sem, K_FOREVER);
+		woken = k_cycle_get_32();
+		if (stop) {
+			return;
+		}
+		handled++;
+	}
+}
+
+static void signal_source(int i, int mixed)
+{
+	uint32_t msg = i;
+
+	if (!mixed) {
+		k_sem_give(&sems[i % NUM_SOURCES]);
+		return;
+	}
+
+	switch (i % 4) {
+	case 0:
+		k_sem_give(&sems[0]);
+		break;
+	case 1:
+		k_fifo_put(&fifo, fifo_item);
+		break;
+	case 2:
+		k_msgq_put(&msgq, &msg, K_NO_WAIT);
+		break;
+	default:
+		k_poll_signal(&signal, i);
+		break;
+	}
+}
+
+static void run(const char *name, int num_waiters, k_thread_entry_t entry,
+		int mixed)
+{
+	uint64_t latency = 0;
+	uint32_t start;
+	int i;
+
+	handled = 0;
+	stop = 0;
+
+	for (i = 0; i < num_waiters; i++) {
+		k_thread_spawn(waiter_stacks[i], STACK_SIZE, entry,
+			       &sems[i], NULL, NULL,
+			       WAITER_PRIORITY, 0, K_NO_WAIT);
+	}
+
+	for (i = 0; i < ITERATIONS; i++) {
+		start = k_cycle_get_32();
+		signal_source(i, mixed);
+		latency += woken - start;
+	}
+
+	/* wake up every waiter one last time so that it exits */
+	stop = 1;
+	for (i = 0; i < num_waiters; i++) {
+		k_sem_give(&sems[i]);
+	}
+	for (i = 0; i < NUM_SOURCES; i++) {
+		k_sem_reset(&sems[i]);
+	}
+
+	TC_PRINT("%s: %u ns per event, %d/%d handled, %d stack bytes\n",
+		 name,
+		 SYS_CLOCK_HW_CYCLES_TO_NS((uint32_t)(latency / ITERATIONS)),
+		 handled, ITERATIONS, num_waiters * STACK_SIZE);
+}
+
+void main(void)
+{
+	int i;
+
+	TC_START("Multi-object wait latency");
+
+	for (i = 0; i < NUM_SOURCES; i++) {
+		k_sem_init(&sems[i], 0, 1);
+		sem_group[i] = &sems[i];
+	}
+	sem_group[NUM_SOURCES] = K_END;
+
+	k_fifo_init(&fifo);
+	k_msgq_init(&msgq, msgq_buf, sizeof(uint32_t), 4);
+	k_poll_signal_init(&signal);
+
+	TC_PRINT("%d event sources, %d events\n", NUM_SOURCES, ITERATIONS);
+
+	run("k_sem_group_take", 1, sem_group_waiter, 0);
+	run("k_poll          ", 1, poll_waiter, 0);
+	run("thread/source   ", NUM_SOURCES, per_source_waiter, 0);
+	run("k_poll, mixed   ", 1, poll_mixed_waiter, 1);
+
+	TC_END_REPORT(TC_PASS);
+}
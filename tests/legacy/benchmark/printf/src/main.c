@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the time taken by snprintf() to format numbers and sensor
+ * values, and by printk() to format a number, with or without
+ * CONFIG_MINIMAL_LIBC_FAST_PRINTF.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <stdio.h>
+#include <string.h>
+#include <misc/printk.h>
+
+#define ITERATIONS 1000
+
+/* Character output of printk() */
+extern int (*_char_out)(int);
+extern void __printk_hook_install(int (*fn)(int));
+
+static char buf[32];
+static int result = TC_PASS;
+
+static int discard(int c)
+{
+	return c;
+}
+
+static void report(const char *format, const char *expected, uint32_t cycles)
+{
+	if (expected && strcmp(buf, expected)) {
+		TC_ERROR("%s: \"%s\" instead of \"%s\"\n", format, buf,
+			 expected);
+		result = TC_FAIL;
+		return;
+	}
+
+	cycles /= ITERATIONS;
+	TC_PRINT("%-10s %6u cycles, %6u ns\n", format, cycles,
+		 SYS_CLOCK_HW_CYCLES_TO_NS(cycles));
+}
+
+/* Formats ITERATIONS times into buf */
+#define BENCH_SNPRINTF(expected, format, ...)				\
+	do {								\
+		uint32_t start = k_cycle_get_32();			\
+		int i;							\
+									\
+		for (i = 0; i < ITERATIONS; i++) {			\
+			snprintf(buf, sizeof(buf), format, __VA_ARGS__); \
+		}							\
+		report(format, expected, k_cycle_get_32() - start);	\
+	} while (0)
+
+static void bench_printk(void)
+{
+	int (*char_out)(int) = _char_out;
+	uint32_t start, cycles;
+	int i;
+
+	__printk_hook_install(discard);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		printk("%u", 4000000000u);
+	}
+	cycles = k_cycle_get_32() - start;
+
+	__printk_hook_install(char_out);
+
+	report("printk %u", NULL, cycles);
+}
+
+void main(void)
+{
+	TC_START("printf formatting throughput");
+
+#ifdef CONFIG_MINIMAL_LIBC_FAST_PRINTF
+	TC_PRINT("fast integer conversions\n");
+#else
+	TC_PRINT("default integer conversions\n");
+#endif
+
+	BENCH_SNPRINTF("4000000000", "%u", 4000000000u);
+	BENCH_SNPRINTF("-123456", "%d", -123456);
+	BENCH_SNPRINTF("deadbeef", "%08x", 0xdeadbeef);
+	BENCH_SNPRINTF("9.806650", "%d.%06d", 9, 806650);
+	BENCH_SNPRINTF("9.806650", "%q", 9, 806650);
+	BENCH_SNPRINTF("-0.50", "%.2q", 0, -500000);
+	BENCH_SNPRINTF("9.806650", "%f", 9.80665);
+
+	bench_printk();
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the time a caller of printk() spends printing a line to the UART
+ * console, polled or deferred with CONFIG_UART_CONSOLE_DEFERRED.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/printk.h>
+
+#ifdef CONFIG_UART_CONSOLE_DEFERRED
+#include <console/uart_console.h>
+#endif
+
+/* Lines of about 40 characters, 16 of them fit in the deferred buffer */
+#define LINES 16
+
+void main(void)
+{
+	uint32_t start, cycles;
+	int i;
+
+	TC_START("printk caller latency");
+
+	/* Let the start banner go out first */
+	k_sleep(100);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < LINES; i++) {
+		printk("sensor %d: value %u status %x\n", i, i * 1000, i);
+	}
+	cycles = (k_cycle_get_32() - start) / LINES;
+
+	k_sleep(100);
+
+	TC_PRINT("printk of a 40 character line: %u cycles, %u ns\n",
+		 cycles, SYS_CLOCK_HW_CYCLES_TO_NS(cycles));
+
+#ifdef CONFIG_UART_CONSOLE_DEFERRED
+	TC_PRINT("characters dropped: %u\n", uart_console_dropped());
+#endif
+
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the CPU duty cycle and the timestamp jitter of the sampling of
+ * three simulated sensors, by one thread per sensor or by the sensor
+ * scheduler.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#include <drivers/sensor/sensor_sched.h>
+
+#define DURATION 2000
+
+/* Length of a simulated bus transaction */
+#define TRANSFER_CYCLES (sys_clock_hw_cycles_per_sec / 10000)
+
+#define STACK_SIZE 512
+#define SAMPLER_PRIORITY -1
+
+/* Cycles of the reference loop, without any sampling */
+#define CALIBRATION_CYCLES (sys_clock_hw_cycles_per_tick * 100)
+
+#define MS_TO_CYCLES(ms) \
+	((uint64_t)(ms) * sys_clock_hw_cycles_per_sec / MSEC_PER_SEC)
+#define CYCLES_TO_US(cycles) \
+	((uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / NSEC_PER_USEC))
+
+/* Only compared, never used as a device */
+static struct device bus_a;
+
+static int transfer(struct sensor_sched_entry *entry, uint64_t timestamp);
+
+static struct sensor_sched_entry sensors[] = {
+	{ .bus = &bus_a, .fetch = transfer, .period = 10, .phase = 0 },
+	{ .bus = &bus_a, .fetch = transfer, .period = 20, .phase = 1 },
+	{ .bus = NULL, .fetch = transfer, .period = 50, .phase = 5 },
+};
+
+static const char * const names[] = { "accel", "gyro", "temp" };
+
+static char __stack sampler_stacks[ARRAY_SIZE(sensors)][STACK_SIZE];
+
+static struct sensor_sched sched;
+
+static volatile int running;
+static uint32_t start;
+
+static int transfer(struct sensor_sched_entry *entry, uint64_t timestamp)
+{
+	uint32_t begin = k_cycle_get_32();
+
+	ARG_UNUSED(entry);
+	ARG_UNUSED(timestamp);
+
+	while (k_cycle_get_32() - begin < TRANSFER_CYCLES) {
+	}
+
+	return 0;
+}
+
+/* Iterations of the loop also used while sampling */
+static uint32_t calibrate(void)
+{
+	uint32_t begin, now, spins = 0;
+
+	begin = k_cycle_get_32();
+	do {
+		spins++;
+		now = k_cycle_get_32();
+	} while (now - begin < CALIBRATION_CYCLES);
+
+	return spins;
+}
+
+/* Spins for the duration of the sampling, returns the share of the CPU
+ * used by the sampling, in percents
+ */
+static uint32_t wait_sampling(uint32_t ref)
+{
+	uint32_t now, cycles, spins = 0;
+	uint64_t free;
+
+	do {
+		spins++;
+		now = k_cycle_get_32();
+	} while (now - start < MS_TO_CYCLES(DURATION));
+	cycles = now - start;
+
+	free = (uint64_t)spins * CALIBRATION_CYCLES / ref;
+	if (free >= cycles) {
+		return 0;
+	}
+
+	return (cycles - free) * 100ULL / cycles;
+}
+
+static void report(uint32_t used, uint32_t wakeups)
+{
+	struct sensor_sched_entry *entry;
+	int i;
+
+	TC_PRINT("  CPU used %3u%%, %4u wake ups\n", used, wakeups);
+
+	for (i = 0; i < ARRAY_SIZE(sensors); i++) {
+		entry = &sensors[i];
+
+		TC_PRINT("  %-5s %3u fetches, jitter avg %5u us max %5u us, "
+			 "%u missed\n", names[i], entry->fetches,
+			 entry->fetches ?
+			 CYCLES_TO_US(entry->jitter_sum / entry->fetches) : 0,
+			 CYCLES_TO_US(entry->jitter_max), entry->missed);
+	}
+}
+
+/* Samples one sensor, sleeping for its period after each fetch */
+static void poller(void *p1, void *unused1, void *unused2)
+{
+	struct sensor_sched_entry *entry = p1;
+	uint32_t next = start + MS_TO_CYCLES(entry->phase);
+	uint32_t now, jitter;
+
+	ARG_UNUSED(unused1);
+	ARG_UNUSED(unused2);
+
+	k_sleep(entry->phase);
+
+	while (running) {
+		now = k_cycle_get_32();
+
+		jitter = (int32_t)(now - next) < 0 ? next - now : now - next;
+		entry->jitter_sum += jitter;
+		entry->jitter_max = max(entry->jitter_max, jitter);
+
+		entry->timestamp = now;
+		entry->error = entry->fetch(entry, now);
+		entry->fetches++;
+
+		next += MS_TO_CYCLES(entry->period);
+		k_sleep(entry->period);
+	}
+}
+
+static int bench_threads(uint32_t ref)
+{
+	uint32_t used, wakeups = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sensors); i++) {
+		sensors[i].fetches = 0;
+		sensors[i].missed = 0;
+		sensors[i].jitter_max = 0;
+		sensors[i].jitter_sum = 0;
+	}
+
+	running = 1;
+	start = k_cycle_get_32();
+
+	for (i = 0; i < ARRAY_SIZE(sensors); i++) {
+		k_thread_spawn(sampler_stacks[i], STACK_SIZE, poller,
+			       &sensors[i], NULL, NULL, SAMPLER_PRIORITY, 0,
+			       K_NO_WAIT);
+	}
+
+	used = wait_sampling(ref);
+
+	running = 0;
+	/* let the pollers see the end of the sampling and exit */
+	k_sleep(sensors[ARRAY_SIZE(sensors) - 1].period * 2);
+
+	for (i = 0; i < ARRAY_SIZE(sensors); i++) {
+		wakeups += sensors[i].fetches;
+	}
+
+	TC_PRINT("thread per sensor:\n");
+	report(used, wakeups);
+
+	return TC_PASS;
+}
+
+static void sampler(void *unused0, void *unused1, void *unused2)
+{
+	ARG_UNUSED(unused0);
+	ARG_UNUSED(unused1);
+	ARG_UNUSED(unused2);
+
+	while (running) {
+		sensor_sched_wait(&sched, K_FOREVER);
+	}
+}
+
+static int bench_sched(uint32_t ref)
+{
+	uint32_t used;
+	int i;
+
+	sensor_sched_init(&sched);
+	for (i = 0; i < ARRAY_SIZE(sensors); i++) {
+		if (sensor_sched_add(&sched, &sensors[i])) {
+			TC_ERROR("cannot add sensor %s\n", names[i]);
+			return TC_FAIL;
+		}
+	}
+
+	running = 1;
+	start = k_cycle_get_32();
+	sensor_sched_start(&sched);
+
+	k_thread_spawn(sampler_stacks[0], STACK_SIZE, sampler, NULL, NULL,
+		       NULL, SAMPLER_PRIORITY, 0, K_NO_WAIT);
+
+	used = wait_sampling(ref);
+
+	running = 0;
+	k_sleep(sensors[0].period);
+	sensor_sched_stop(&sched);
+
+	TC_PRINT("sensor scheduler, %u%% of the CPU fetching:\n",
+		 (uint32_t)(sched.busy * 100 / MS_TO_CYCLES(DURATION)));
+	report(used, sched.windows);
+
+	/* the gyroscope deadlines all fall in accelerometer windows */
+	if (sched.windows > sensors[0].fetches + sensors[2].fetches) {
+		TC_ERROR("bus fetches not grouped\n");
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	int result;
+	uint32_t ref;
+
+	TC_START("Sensor sampling duty cycle and jitter");
+
+	ref = calibrate();
+
+	result = bench_threads(ref);
+	if (result == TC_PASS) {
+		result = bench_sched(ref);
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the latency and throughput of UDP datagrams of 64 to 1231 bytes
+ * sent over the 802.15.4 loopback radio, fragmented and compressed by
+ * 6LoWPAN.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+
+#include <net/ip_buf.h>
+#include <net/net_core.h>
+#include <net/net_socket.h>
+
+/* The following uIP includes are for testing purposes only. Never
+ * ever use them in your application.
+ */
+#include "contiki/ipv6/uip-ds6-route.h"  /* to set the route */
+#include "contiki/ipv6/uip-ds6-nbr.h"    /* to set the neighbor cache */
+
+#define ITERATIONS 16
+#define PORT 4242
+
+/* Largest payload of a packet with a 6LoWPAN dispatch in an IP buffer */
+#define MAX_PAYLOAD 1231
+
+static const uint16_t sizes[] = { 64, 128, 256, 512, 1024, MAX_PAYLOAD };
+
+static uint8_t mac[] = { 0x0a, 0xbe, 0xef, 0x2d, 0xbc, 0x15, 0xf0, 0x0d };
+static const uip_lladdr_t dest_mac = { };
+
+static uint8_t payload[MAX_PAYLOAD];
+
+static struct net_context *get_context(const struct in6_addr *remote,
+				       uint16_t remote_port,
+				       const struct in6_addr *local,
+				       uint16_t local_port)
+{
+	struct net_addr remote_addr, local_addr;
+
+	remote_addr.in6_addr = *remote;
+	remote_addr.family = AF_INET6;
+	local_addr.in6_addr = *local;
+	local_addr.family = AF_INET6;
+
+	return net_context_get(IPPROTO_UDP, &remote_addr, remote_port,
+			       &local_addr, local_port);
+}
+
+static int send_recv(struct net_context *tx, struct net_context *rx,
+		     uint16_t len)
+{
+	struct net_buf *buf;
+	int ret = TC_PASS;
+
+	buf = ip_buf_get_tx(tx);
+	if (!buf) {
+		return TC_FAIL;
+	}
+
+	memcpy(net_buf_add(buf, len), payload, len);
+
+	if (net_send(buf) < 0) {
+		ip_buf_unref(buf);
+		return TC_FAIL;
+	}
+
+	buf = net_receive(rx, sys_clock_ticks_per_sec);
+	if (!buf) {
+		TC_ERROR("no datagram of %u bytes received\n", len);
+		return TC_FAIL;
+	}
+
+	if (ip_buf_appdatalen(buf) != len ||
+	    memcmp(ip_buf_appdata(buf), payload, len)) {
+		TC_ERROR("datagram of %u bytes corrupted\n", len);
+		ret = TC_FAIL;
+	}
+
+	ip_buf_unref(buf);
+
+	return ret;
+}
+
+void main(void)
+{
+	const struct in6_addr any = IN6ADDR_ANY_INIT;
+	const struct in6_addr loopback = IN6ADDR_LOOPBACK_INIT;
+	struct net_context *tx, *rx;
+	int result = TC_PASS;
+	uint32_t start;
+	uint64_t ns;
+	int i, s;
+
+	TC_START("6LoWPAN throughput and latency");
+
+	net_init();
+	net_set_mac(mac, sizeof(mac));
+
+	rx = get_context(&any, 0, &loopback, PORT);
+	tx = get_context(&loopback, PORT, &any, 0);
+	if (!rx || !tx) {
+		TC_ERROR("cannot get network contexts\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	uip_ds6_nbr_add((uip_ipaddr_t *)&loopback, &dest_mac, 0,
+			NBR_REACHABLE);
+	uip_ds6_route_add((uip_ipaddr_t *)&loopback, 128,
+			  (uip_ipaddr_t *)&loopback);
+
+	for (i = 0; i < sizeof(payload); i++) {
+		payload[i] = i;
+	}
+
+	/* Let the stack settle before measuring */
+	send_recv(tx, rx, sizes[0]);
+
+	for (s = 0; s < ARRAY_SIZE(sizes) && result == TC_PASS; s++) {
+		start = k_cycle_get_32();
+		for (i = 0; i < ITERATIONS && result == TC_PASS; i++) {
+			result = send_recv(tx, rx, sizes[s]);
+		}
+		ns = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start);
+
+		TC_PRINT("%4u bytes: latency %6u us, throughput %7u bytes/s\n",
+			 sizes[s], (uint32_t)(ns / ITERATIONS / 1000),
+			 (uint32_t)((uint64_t)sizes[s] * ITERATIONS *
+				    NSEC_PER_SEC / ns));
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the throughput of SPI transfers of 4 to 1024 bytes in loopback
+ * mode, synchronous or queued as chains of asynchronous transactions, and
+ * the share of the CPU left to the caller while the asynchronous
+ * transactions are in progress.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <misc/util.h>
+
+#include <spi.h>
+
+#define SPI_DRV_NAME "SPI_0"
+#define SPI_SLAVE 1
+#define SPI_FREQ 4000000
+
+#define ROUNDS 16
+#define CHAIN 4
+#define MAX_LEN 1024
+
+/* Cycles of the reference loop, without any transfer */
+#define CALIBRATION_CYCLES (sys_clock_hw_cycles_per_tick * 10)
+
+static const uint16_t sizes[] = { 4, 16, 64, 256, MAX_LEN };
+
+static uint8_t tx_buf[MAX_LEN];
+static uint8_t rx_buf[CHAIN][MAX_LEN];
+
+static struct spi_transaction trans[CHAIN];
+static volatile int pending;
+static volatile int status;
+
+static struct spi_config spi_conf = {
+	.config = SPI_MODE_LOOP | SPI_WORD(8),
+	.max_sys_freq = SPI_FREQ,
+};
+
+static void trans_done(struct device *dev, struct spi_transaction *t,
+		       int result)
+{
+	if (result) {
+		status = result;
+	}
+
+	pending--;
+}
+
+static uint32_t rate(uint32_t bytes, uint32_t cycles)
+{
+	return (uint64_t)bytes * NSEC_PER_SEC /
+		SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+}
+
+/* Iterations of the loop also used while waiting for transactions */
+static uint32_t calibrate(void)
+{
+	uint32_t start, now, spins = 0;
+
+	start = k_cycle_get_32();
+	do {
+		spins++;
+		now = k_cycle_get_32();
+	} while (now - start < CALIBRATION_CYCLES);
+
+	return spins;
+}
+
+static int bench_sync(struct device *spi, uint16_t len)
+{
+	uint32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ROUNDS; i++) {
+		if (spi_transceive(spi, tx_buf, len, rx_buf[0], len)) {
+			TC_ERROR("transfer of %u bytes failed\n", len);
+			return TC_FAIL;
+		}
+	}
+	cycles = k_cycle_get_32() - start;
+
+	if (memcmp(rx_buf[0], tx_buf, len)) {
+		TC_ERROR("transfer of %u bytes corrupted\n", len);
+		return TC_FAIL;
+	}
+
+	TC_PRINT("%4u bytes: sync  %7u bytes/s\n",
+		 len, rate(len * ROUNDS, cycles));
+
+	return TC_PASS;
+}
+
+static int bench_async(struct device *spi, uint16_t len, uint32_t ref)
+{
+	uint32_t start, now, cycles, spins = 0;
+	int i, round;
+
+	memset(rx_buf, 0, sizeof(rx_buf));
+
+	start = k_cycle_get_32();
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < CHAIN; i++) {
+			trans[i].next = i < CHAIN - 1 ? &trans[i + 1] : NULL;
+			trans[i].tx_buf = tx_buf;
+			trans[i].tx_buf_len = len;
+			trans[i].rx_buf = rx_buf[i];
+			trans[i].rx_buf_len = len;
+			trans[i].callback = trans_done;
+		}
+
+		pending = CHAIN;
+
+		if (spi_transceive_async(spi, trans)) {
+			TC_ERROR("cannot queue transactions\n");
+			return TC_FAIL;
+		}
+
+		do {
+			spins++;
+			now = k_cycle_get_32();
+		} while (pending);
+	}
+	cycles = now - start;
+
+	if (status) {
+		TC_ERROR("transaction of %u bytes failed\n", len);
+		return TC_FAIL;
+	}
+
+	for (i = 0; i < CHAIN; i++) {
+		if (memcmp(rx_buf[i], tx_buf, len)) {
+			TC_ERROR("transaction of %u bytes corrupted\n", len);
+			return TC_FAIL;
+		}
+	}
+
+	TC_PRINT("%4u bytes: async %7u bytes/s, CPU left %3u%%\n",
+		 len, rate(len * CHAIN * ROUNDS, cycles),
+		 (uint32_t)((uint64_t)spins * CALIBRATION_CYCLES * 100 /
+			    ((uint64_t)ref * cycles)));
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *spi;
+	int result = TC_PASS;
+	uint32_t ref;
+	int i;
+
+	TC_START("SPI throughput and CPU load");
+
+	spi = device_get_binding(SPI_DRV_NAME);
+	if (!spi) {
+		TC_ERROR("cannot get SPI device\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	if (spi_configure(spi, &spi_conf) ||
+	    spi_slave_select(spi, SPI_SLAVE)) {
+		TC_ERROR("cannot configure SPI device\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < sizeof(tx_buf); i++) {
+		tx_buf[i] = i;
+	}
+
+	ref = calibrate();
+
+	for (i = 0; i < ARRAY_SIZE(sizes) && result == TC_PASS; i++) {
+		result = bench_sync(spi, sizes[i]);
+		if (result == TC_PASS) {
+			result = bench_async(spi, sizes[i], ref);
+		}
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the throughput of sequential reads of the SPI flash, with
+ * requests of 16 bytes to 4 KB.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#include <flash.h>
+
+#define FLASH_DRV_NAME "W25QXXDV"
+
+#define READ_SIZE (64 * 1024)
+#define MAX_REQUEST 4096
+
+static const uint16_t requests[] = { 16, 64, 256, 1024, MAX_REQUEST };
+
+static uint8_t buf[MAX_REQUEST];
+
+static int bench_read(struct device *flash, uint16_t request)
+{
+	uint32_t start, kbps;
+	uint64_t ns;
+	off_t offset;
+
+	start = k_cycle_get_32();
+	for (offset = 0; offset < READ_SIZE; offset += request) {
+		if (flash_read(flash, offset, buf, request)) {
+			TC_ERROR("read of %u bytes at 0x%x failed\n",
+				 request, (unsigned int)offset);
+			return TC_FAIL;
+		}
+	}
+	ns = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start);
+
+	kbps = (uint64_t)READ_SIZE * NSEC_PER_SEC / 1024 / ns;
+
+	TC_PRINT("%4u bytes per read: %u.%02u MB/s\n", request,
+		 kbps / 1024, kbps % 1024 * 100 / 1024);
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *flash;
+	int result = TC_PASS;
+	int i;
+
+	TC_START("SPI flash sequential read throughput");
+
+	flash = device_get_binding(FLASH_DRV_NAME);
+	if (!flash) {
+		TC_ERROR("cannot get SPI flash device\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(requests) && result == TC_PASS; i++) {
+		result = bench_read(flash, requests[i]);
+	}
+
+	TC_END_REPORT(result);
+}
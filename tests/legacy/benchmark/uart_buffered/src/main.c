@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the throughput of a UART in loopback mode at 9600 to 2000000
+ * baud, polled or buffered, and the share of the CPU left to the caller
+ * while the buffered transfers are in progress.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <misc/util.h>
+
+#include <uart.h>
+#include <drivers/serial/uart_buffered.h>
+#include <uart_ns16550.h>
+
+#define UART_DRV_NAME "UART_1"
+
+#define LEN 1024
+#define TX_RING_SIZE 256
+#define RX_RING_SIZE 2048
+
+/* Longest wait for data, in milliseconds and in cycles */
+#define TIMEOUT 100
+#define TIMEOUT_CYCLES (sys_clock_hw_cycles_per_tick * 10)
+
+/* Cycles of the reference loop, without any transfer */
+#define CALIBRATION_CYCLES (sys_clock_hw_cycles_per_tick * 10)
+
+static const uint32_t rates[] = { 9600, 115200, 460800, 921600, 2000000 };
+
+static uint8_t tx_data[LEN];
+static uint8_t rx_data[LEN];
+
+static uint8_t tx_ring[TX_RING_SIZE];
+static uint8_t rx_ring[RX_RING_SIZE];
+static struct uart_buffered ub;
+
+static uint32_t rate(uint32_t bytes, uint32_t cycles)
+{
+	return (uint64_t)bytes * NSEC_PER_SEC /
+		SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+}
+
+/* Iterations of the loop also used while waiting for transfers */
+static uint32_t calibrate(void)
+{
+	uint32_t start, now, spins = 0;
+
+	start = k_cycle_get_32();
+	do {
+		uart_buffered_read(&ub, rx_data, 1, K_NO_WAIT);
+		spins++;
+		now = k_cycle_get_32();
+	} while (now - start < CALIBRATION_CYCLES);
+
+	return spins;
+}
+
+static int check(const char *mode, int len)
+{
+	if (len != LEN || memcmp(rx_data, tx_data, LEN)) {
+		TC_ERROR("%s transfer corrupted, %d of %d bytes received\n",
+			 mode, len, LEN);
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
+static int bench_poll(struct device *uart)
+{
+	uint32_t start, cycles, wait;
+	unsigned char c = 0;
+	int i;
+
+	uart_irq_rx_disable(uart);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < LEN; i++) {
+		uart_poll_out(uart, tx_data[i]);
+
+		wait = k_cycle_get_32();
+		while (uart_poll_in(uart, &c)) {
+			if (k_cycle_get_32() - wait > TIMEOUT_CYCLES) {
+				break;
+			}
+		}
+		rx_data[i] = c;
+	}
+	cycles = k_cycle_get_32() - start;
+
+	uart_irq_rx_enable(uart);
+
+	if (check("polled", LEN) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	TC_PRINT("  polled   %7u bytes/s\n", rate(LEN, cycles));
+
+	return TC_PASS;
+}
+
+static int bench_blocking(void)
+{
+	uint32_t start, cycles;
+	int received = 0;
+	int n;
+
+	start = k_cycle_get_32();
+
+	/* the RX ring holds the whole transfer, the TX ring a part of it */
+	if (uart_buffered_write(&ub, tx_data, LEN, K_FOREVER) != LEN) {
+		TC_ERROR("blocking write incomplete\n");
+		return TC_FAIL;
+	}
+
+	while (received < LEN) {
+		n = uart_buffered_read(&ub, rx_data + received,
+				       LEN - received, TIMEOUT);
+		if (!n) {
+			break;
+		}
+		received += n;
+	}
+	cycles = k_cycle_get_32() - start;
+
+	if (check("blocking", received) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	TC_PRINT("  blocking %7u bytes/s\n", rate(LEN, cycles));
+
+	return TC_PASS;
+}
+
+static int bench_async(uint32_t ref)
+{
+	uint32_t start, now, cycles, last, spins = 0;
+	int sent = 0, received = 0;
+
+	start = k_cycle_get_32();
+	last = start;
+	do {
+		if (sent < LEN) {
+			sent += uart_buffered_write(&ub, tx_data + sent,
+						    LEN - sent, K_NO_WAIT);
+		}
+		received += uart_buffered_read(&ub, rx_data + received,
+					       LEN - received, K_NO_WAIT);
+		spins++;
+		now = k_cycle_get_32();
+
+		if (received < LEN && sent == LEN) {
+			/* no more data, give up after the timeout */
+			if (now - last > TIMEOUT_CYCLES) {
+				break;
+			}
+		} else {
+			last = now;
+		}
+	} while (received < LEN);
+	cycles = now - start;
+
+	if (check("async", received) != TC_PASS) {
+		return TC_FAIL;
+	}
+
+	TC_PRINT("  async    %7u bytes/s, CPU left %3u%%\n",
+		 rate(LEN, cycles),
+		 (uint32_t)((uint64_t)spins * CALIBRATION_CYCLES * 100 /
+			    ((uint64_t)ref * cycles)));
+
+	return TC_PASS;
+}
+
+void main(void)
+{
+	struct device *uart;
+	int result = TC_PASS;
+	uint32_t ref;
+	int i;
+
+	TC_START("UART throughput and CPU load");
+
+	uart = device_get_binding(UART_DRV_NAME);
+	if (!uart) {
+		TC_ERROR("cannot get UART device\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	if (uart_drv_cmd(uart, CMD_SET_LOOPBACK, 1) ||
+	    uart_buffered_init(&ub, uart, tx_ring, sizeof(tx_ring),
+			       rx_ring, sizeof(rx_ring))) {
+		TC_ERROR("cannot set up UART device\n");
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < sizeof(tx_data); i++) {
+		tx_data[i] = i;
+	}
+
+	ref = calibrate();
+
+	for (i = 0; i < ARRAY_SIZE(rates) && result == TC_PASS; i++) {
+		if (uart_line_ctrl_set(uart, LINE_CTRL_BAUD_RATE, rates[i])) {
+			TC_PRINT("%7u baud: not supported by the UART clock\n",
+				 rates[i]);
+			continue;
+		}
+
+		TC_PRINT("%7u baud:\n", rates[i]);
+
+		result = bench_poll(uart);
+		if (result == TC_PASS) {
+			result = bench_blocking();
+		}
+		if (result == TC_PASS) {
+			result = bench_async(ref);
+		}
+	}
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the submit to run latency of a work item queued behind a backlog
+ * of other work items, and the time needed to drain that backlog.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define STACK_SIZE 1024
+
+/* lower priority than the main thread, so the backlog builds up */
+#define WORK_Q_PRIORITY 5
+
+#define MAX_BACKLOG 64
+#define ITERATIONS 10
+
+/* busy loop iterations done by every backlog work item */
+#define BULK_LOAD 100
+
+static char __stack work_q_stack[STACK_SIZE];
+static struct k_work_q work_q;
+
+static struct k_work bulk_work[MAX_BACKLOG];
+static struct k_work probe_work;
+
+static K_SEM_DEFINE(done_sem, 0, 1);
+
+static int pending;
+static uint32_t probe_submit;
+static uint32_t probe_run;
+static uint32_t drain_end;
+
+static void work_done(void)
+{
+	if (--pending == 0) {
+		drain_end = k_cycle_get_32();
+		k_sem_give(&done_sem);
+	}
+}
+
+static void bulk_handler(struct k_work *work)
+{
+	volatile int i;
+
+	ARG_UNUSED(work);
+
+	for (i = 0; i < BULK_LOAD; i++) {
+	}
+
+	work_done();
+}
+
+static void probe_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	probe_run = k_cycle_get_32();
+
+	work_done();
+}
+
+static void run_backlog(int backlog)
+{
+	uint64_t latency = 0;
+	uint64_t drain = 0;
+	uint32_t start;
+	int i, j;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		pending = backlog + 1;
+
+		start = k_cycle_get_32();
+
+		for (j = 0; j < backlog; j++) {
+			k_work_submit_to_queue(&work_q, &bulk_work[j]);
+		}
+
+		probe_submit = k_cycle_get_32();
+		k_work_submit_to_queue(&work_q, &probe_work);
+
+		k_sem_take(&done_sem, K_FOREVER);
+
+		latency += probe_run - probe_submit;
+		drain += drain_end - start;
+	}
+
+	TC_PRINT("backlog %3d: probe latency %6u ns, drain %8u ns\n",
+		 backlog,
+		 SYS_CLOCK_HW_CYCLES_TO_NS((uint32_t)(latency / ITERATIONS)),
+		 SYS_CLOCK_HW_CYCLES_TO_NS((uint32_t)(drain / ITERATIONS)));
+}
+
+#ifdef CONFIG_WORKQUEUE_STATS
+static void print_stats(void)
+{
+	struct k_work_q_stats stats;
+
+	k_work_q_stats_get(&work_q, &stats);
+
+	TC_PRINT("processed %u items in %u batches, max depth %u\n",
+		 stats.processed, stats.batches, stats.max_depth);
+	TC_PRINT("latency avg %u ns max %u ns, runtime avg %u ns max %u ns\n",
+		 SYS_CLOCK_HW_CYCLES_TO_NS((uint32_t)(stats.total_latency /
+						      stats.processed)),
+		 SYS_CLOCK_HW_CYCLES_TO_NS(stats.max_latency),
+		 SYS_CLOCK_HW_CYCLES_TO_NS((uint32_t)(stats.total_runtime /
+						      stats.processed)),
+		 SYS_CLOCK_HW_CYCLES_TO_NS(stats.max_runtime));
+}
+#endif
+
+void main(void)
+{
+	static const int backlogs[] = { 0, 8, 32, MAX_BACKLOG };
+	int i;
+
+	TC_START("Workqueue latency");
+
+	for (i = 0; i < MAX_BACKLOG; i++) {
+		k_work_init(&bulk_work[i], bulk_handler);
+#ifdef CONFIG_WORKQUEUE_BATCH
+		k_work_lane_set(&bulk_work[i], K_WORK_LANE_LOWEST);
+#endif
+	}
+	k_work_init(&probe_work, probe_handler);
+
+	k_work_q_start(&work_q, work_q_stack, sizeof(work_q_stack),
+		       WORK_Q_PRIORITY);
+
+#ifdef CONFIG_WORKQUEUE_BATCH
+	TC_PRINT("batched workqueue, %d lanes, %d items per batch\n",
+		 CONFIG_WORKQUEUE_NUM_LANES, CONFIG_WORKQUEUE_BATCH_MAX_ITEMS);
+#else
+	TC_PRINT("single FIFO workqueue\n");
+#endif
+
+	for (i = 0; i < ARRAY_SIZE(backlogs); i++) {
+		run_backlog(backlogs[i]);
+	}
+
+#ifdef CONFIG_WORKQUEUE_STATS
+	print_stats();
+#endif
+
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the time taken to find the handler of a CoAP request among 128
+ * resources, searching the resource array or the dispatch tree.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <net/buf.h>
+#include <net/ip_buf.h>
+
+#include <zoap.h>
+
+/* Resources as /<group>/<item>/value */
+#define NUM_GROUPS 8
+#define NUM_ITEMS 16
+#define NUM_RESOURCES (NUM_GROUPS * NUM_ITEMS)
+#define NUM_NODES (1 + NUM_GROUPS + NUM_RESOURCES * 2)
+
+#define ROUNDS 100
+
+#define BUF_SIZE 128
+#define MY_PORT 12345
+
+static struct k_fifo zoap_fifo;
+static NET_BUF_POOL(zoap_pool, 1, BUF_SIZE, &zoap_fifo, NULL,
+		    sizeof(struct ip_buf));
+
+static char names[NUM_ITEMS][4];
+static const char *paths[NUM_RESOURCES][4];
+static struct zoap_resource resources[NUM_RESOURCES + 1];
+static struct zoap_dispatch_node nodes[NUM_NODES];
+static struct zoap_resource *dispatched;
+static uip_ipaddr_t dummy_addr;
+
+static int resource_get(struct zoap_resource *resource,
+			struct zoap_packet *request,
+			const uip_ipaddr_t *addr,
+			uint16_t port)
+{
+	dispatched = resource;
+
+	return 0;
+}
+
+static void resources_init(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		snprintf(names[i], sizeof(names[i]), "%d", i);
+	}
+
+	for (i = 0; i < NUM_RESOURCES; i++) {
+		paths[i][0] = names[i / NUM_ITEMS];
+		paths[i][1] = names[i % NUM_ITEMS];
+		paths[i][2] = "value";
+		paths[i][3] = NULL;
+
+		resources[i].path = paths[i];
+		resources[i].get = resource_get;
+	}
+}
+
+static int build_request(struct zoap_packet *pkt, struct net_buf *buf,
+			 const char **path)
+{
+	int r;
+
+	ip_buf_appdata(buf) = net_buf_tail(buf);
+	ip_buf_appdatalen(buf) = net_buf_tailroom(buf);
+
+	r = zoap_packet_init(pkt, buf);
+	if (r) {
+		return r;
+	}
+
+	zoap_header_set_version(pkt, 1);
+	zoap_header_set_type(pkt, ZOAP_TYPE_CON);
+	zoap_header_set_code(pkt, ZOAP_METHOD_GET);
+	zoap_header_set_id(pkt, zoap_next_id());
+
+	for (; *path; path++) {
+		r = zoap_add_option(pkt, ZOAP_OPTION_URI_PATH,
+				    *path, strlen(*path));
+		if (r) {
+			return r;
+		}
+	}
+
+	return zoap_packet_parse(pkt, buf);
+}
+
+void main(void)
+{
+	struct zoap_dispatch dispatch;
+	struct zoap_packet req;
+	struct net_buf *buf;
+	uint32_t start, linear, tree;
+	int result = TC_FAIL;
+	int round;
+
+	TC_START("CoAP request dispatch");
+
+	net_buf_pool_init(zoap_pool);
+	buf = net_buf_get(&zoap_fifo, 0);
+
+	resources_init();
+
+	if (zoap_dispatch_init(&dispatch, resources, nodes, NUM_NODES)) {
+		TC_ERROR("cannot build the dispatch tree\n");
+		goto done;
+	}
+
+	/* the last resource is the worst case of the linear search */
+	if (build_request(&req, buf, paths[NUM_RESOURCES - 1])) {
+		TC_ERROR("cannot build the request\n");
+		goto done;
+	}
+
+	dispatched = NULL;
+	start = k_cycle_get_32();
+	for (round = 0; round < ROUNDS; round++) {
+		zoap_handle_request(&req, resources, &dummy_addr, MY_PORT);
+	}
+	linear = (k_cycle_get_32() - start) / ROUNDS;
+
+	if (dispatched != &resources[NUM_RESOURCES - 1]) {
+		TC_ERROR("request handled by the wrong resource\n");
+		goto done;
+	}
+
+	dispatched = NULL;
+	start = k_cycle_get_32();
+	for (round = 0; round < ROUNDS; round++) {
+		zoap_dispatch_request(&dispatch, &req, &dummy_addr, MY_PORT);
+	}
+	tree = (k_cycle_get_32() - start) / ROUNDS;
+
+	if (dispatched != &resources[NUM_RESOURCES - 1]) {
+		TC_ERROR("request dispatched to the wrong resource\n");
+		goto done;
+	}
+
+	TC_PRINT("%d resources, per request:\n", NUM_RESOURCES);
+	TC_PRINT("resource array %6u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(linear));
+	TC_PRINT("dispatch tree  %6u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(tree));
+
+	result = TC_PASS;
+
+done:
+	net_buf_unref(buf);
+
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the rate at which CoAP notifications can be prepared for 64
+ * observers, encoding each of them completely or patching a notification
+ * encoded once, and the cost per timer tick of finding the confirmable
+ * notifications due for retransmission.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <misc/byteorder.h>
+
+#include <net/buf.h>
+#include <net/ip_buf.h>
+
+#include <zoap.h>
+
+#define NUM_OBSERVERS 64
+#define PAYLOAD_LEN 64
+#define ROUNDS 20
+#define TICKS 1000
+
+#define BUF_SIZE 128
+
+static struct k_fifo zoap_fifo;
+static NET_BUF_POOL(zoap_pool, 2, BUF_SIZE, &zoap_fifo, NULL,
+		    sizeof(struct ip_buf));
+
+static struct zoap_observer observers[NUM_OBSERVERS];
+static struct zoap_pending pendings[NUM_OBSERVERS];
+static struct zoap_pending *heap[NUM_OBSERVERS];
+static uint8_t payload[PAYLOAD_LEN];
+
+static struct net_buf *get_buf(void)
+{
+	struct net_buf *buf = net_buf_get(&zoap_fifo, 0);
+
+	ip_buf_appdata(buf) = net_buf_tail(buf);
+	ip_buf_appdatalen(buf) = net_buf_tailroom(buf);
+
+	return buf;
+}
+
+/* Token and message ID are set for each observer */
+static void encode_header(struct zoap_packet *pkt, struct net_buf *buf)
+{
+	zoap_packet_init(pkt, buf);
+	zoap_header_set_version(pkt, 1);
+	zoap_header_set_type(pkt, ZOAP_TYPE_NON_CON);
+	zoap_header_set_code(pkt, ZOAP_RESPONSE_CODE_CONTENT);
+}
+
+static void encode_options(struct zoap_packet *pkt, int age)
+{
+	uint8_t *p;
+	uint16_t len;
+
+	zoap_add_option_int(pkt, ZOAP_OPTION_OBSERVE, age);
+	zoap_add_option_int(pkt, ZOAP_OPTION_CONTENT_FORMAT, 0);
+
+	p = zoap_packet_get_payload(pkt, &len);
+	memcpy(p, payload, PAYLOAD_LEN);
+	zoap_packet_set_used(pkt, PAYLOAD_LEN);
+}
+
+static uint32_t rate(uint32_t cycles)
+{
+	uint64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+
+	return (uint64_t)ROUNDS * NUM_OBSERVERS * NSEC_PER_SEC / ns;
+}
+
+static void bench_encode(struct net_buf *buf)
+{
+	struct zoap_packet pkt;
+	uint32_t start;
+	int round, i;
+
+	start = k_cycle_get_32();
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < NUM_OBSERVERS; i++) {
+			encode_header(&pkt, buf);
+			zoap_header_set_id(&pkt, zoap_next_id());
+			zoap_header_set_token(&pkt, observers[i].token,
+					      observers[i].tkl);
+			encode_options(&pkt, round);
+		}
+	}
+
+	TC_PRINT("encoded for each observer: %u notifications/s\n",
+		 rate(k_cycle_get_32() - start));
+}
+
+static void bench_patch(struct net_buf *buf, struct net_buf *obs_buf)
+{
+	struct zoap_packet notification, pkt;
+	uint32_t start;
+	int round, i;
+
+	start = k_cycle_get_32();
+	for (round = 0; round < ROUNDS; round++) {
+		encode_header(&notification, buf);
+		encode_options(&notification, round);
+
+		for (i = 0; i < NUM_OBSERVERS; i++) {
+			zoap_notification_init(&pkt, obs_buf, &notification,
+					       &observers[i], zoap_next_id());
+		}
+	}
+
+	TC_PRINT("encoded once:              %u notifications/s\n",
+		 rate(k_cycle_get_32() - start));
+}
+
+static void bench_ticks(struct net_buf *buf)
+{
+	struct zoap_pending_queue queue;
+	struct zoap_packet pkt;
+	uint32_t start, scan, queued;
+	int i;
+
+	zoap_packet_init(&pkt, buf);
+	zoap_pending_queue_init(&queue, heap, NUM_OBSERVERS);
+
+	/* All notifications sent, none acknowledged yet */
+	for (i = 0; i < NUM_OBSERVERS; i++) {
+		zoap_pending_init(&pendings[i], &pkt);
+		zoap_pending_cycle(&pendings[i]);
+		zoap_pending_queue_add(&queue, &pendings[i], i);
+	}
+
+	start = k_cycle_get_32();
+	for (i = 0; i < TICKS; i++) {
+		zoap_pending_next_to_expire(pendings, NUM_OBSERVERS);
+	}
+	scan = (k_cycle_get_32() - start) / TICKS;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < TICKS; i++) {
+		zoap_pending_queue_expired(&queue, 0);
+	}
+	queued = (k_cycle_get_32() - start) / TICKS;
+
+	TC_PRINT("retransmissions per tick: array scan %u ns, queue %u ns\n",
+		 SYS_CLOCK_HW_CYCLES_TO_NS(scan),
+		 SYS_CLOCK_HW_CYCLES_TO_NS(queued));
+}
+
+void main(void)
+{
+	struct net_buf *buf, *obs_buf;
+	int i;
+
+	TC_START("CoAP notification rate");
+
+	net_buf_pool_init(zoap_pool);
+
+	for (i = 0; i < NUM_OBSERVERS; i++) {
+		sys_put_be32(i, observers[i].token);
+		observers[i].tkl = 4;
+	}
+
+	memset(payload, 'x', sizeof(payload));
+
+	buf = get_buf();
+	obs_buf = get_buf();
+
+	bench_encode(buf);
+	bench_patch(buf, obs_buf);
+	bench_ticks(buf);
+
+	net_buf_unref(buf);
+	net_buf_unref(obs_buf);
+
+	TC_END_REPORT(TC_PASS);
+}
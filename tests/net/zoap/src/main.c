@@ -40,6 +40,12 @@
 #define NUM_OBSERVERS 3
 #define NUM_REPLIES 3
 
+/* Resources of the dispatch test, as /<group>/<item>/value */
+#define NUM_GROUPS 8
+#define NUM_ITEMS 16
+#define NUM_DISPATCH_RESOURCES (NUM_GROUPS * NUM_ITEMS)
+#define NUM_DISPATCH_NODES (1 + NUM_GROUPS + NUM_DISPATCH_RESOURCES * 2)
+
 static struct nano_fifo zoap_fifo;
 static NET_BUF_POOL(zoap_pool, 2, ZOAP_BUF_SIZE,
 		    &zoap_fifo, NULL, sizeof(struct ip_buf));
@@ -934,6 +940,315 @@ done:
 	return result;
 }
 
+static int test_pending_queue(void)
+{
+	static struct zoap_pending queue_pendings[NUM_PENDINGS], extra;
+	struct zoap_pending *heap[NUM_PENDINGS];
+	/* Queued at time 'now' = 1000, they expire at 3000, 1500 and 2500 */
+	static const uint16_t timeouts[NUM_PENDINGS] = { 2000, 500, 1500 };
+	static const int order[NUM_PENDINGS] = { 1, 2, 0 };
+	struct zoap_pending_queue queue;
+	struct zoap_pending *p;
+	int result = TC_FAIL;
+	int i;
+
+	zoap_pending_queue_init(&queue, heap, NUM_PENDINGS);
+
+	for (i = 0; i < NUM_PENDINGS; i++) {
+		queue_pendings[i].timeout = timeouts[i];
+
+		if (zoap_pending_queue_add(&queue, &queue_pendings[i], 1000)) {
+			TC_PRINT("Could not add pending to the queue\n");
+			goto done;
+		}
+	}
+
+	if (!zoap_pending_queue_add(&queue, &extra, 1000)) {
+		TC_PRINT("The queue should be full\n");
+		goto done;
+	}
+
+	if (zoap_pending_queue_expired(&queue, 1499)) {
+		TC_PRINT("Pending expired too early\n");
+		goto done;
+	}
+
+	for (i = 0; i < NUM_PENDINGS; i++) {
+		p = zoap_pending_queue_expired(&queue, 3000);
+		if (p != &queue_pendings[order[i]]) {
+			TC_PRINT("Pendings expired out of order\n");
+			goto done;
+		}
+	}
+
+	if (zoap_pending_queue_next(&queue)) {
+		TC_PRINT("The queue should be empty\n");
+		goto done;
+	}
+
+	/* Times are compared relative to each other, so they can wrap */
+	for (i = 0; i < NUM_PENDINGS; i++) {
+		zoap_pending_queue_add(&queue, &queue_pendings[i], 0xFFFFFF00);
+	}
+
+	zoap_pending_queue_remove(&queue, &queue_pendings[order[0]]);
+
+	p = zoap_pending_queue_next(&queue);
+	if (p != &queue_pendings[order[1]] || p->expiry != 1244) {
+		TC_PRINT("Wrong pending after removal\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static int test_notification(void)
+{
+	const char payload[] = "42 bpm";
+	struct zoap_packet notification, pkt;
+	struct zoap_observer observer = {
+		.token = { 'o', 'b', 's' },
+		.tkl = 3,
+	};
+	struct zoap_option option;
+	struct net_buf *buf, *obs_buf = NULL;
+	const uint8_t *token;
+	uint8_t tkl, *p;
+	uint16_t len;
+	int result = TC_FAIL;
+	int r;
+
+	buf = net_buf_get(&zoap_fifo, 0);
+	if (!buf) {
+		TC_PRINT("Could not get buffer from pool\n");
+		goto done;
+	}
+	ip_buf_appdata(buf) = net_buf_tail(buf);
+	ip_buf_appdatalen(buf) = net_buf_tailroom(buf);
+
+	r = zoap_packet_init(&notification, buf);
+	if (r) {
+		TC_PRINT("Could not initialize packet\n");
+		goto done;
+	}
+
+	/* Encoded once, without token nor message ID */
+	zoap_header_set_version(&notification, 1);
+	zoap_header_set_type(&notification, ZOAP_TYPE_NON_CON);
+	zoap_header_set_code(&notification, ZOAP_RESPONSE_CODE_CONTENT);
+	zoap_add_option_int(&notification, ZOAP_OPTION_OBSERVE, 5);
+	zoap_add_option_int(&notification, ZOAP_OPTION_CONTENT_FORMAT, 0);
+
+	p = zoap_packet_get_payload(&notification, &len);
+	memcpy(p, payload, sizeof(payload));
+	zoap_packet_set_used(&notification, sizeof(payload));
+
+	obs_buf = net_buf_get(&zoap_fifo, 0);
+	if (!obs_buf) {
+		TC_PRINT("Could not get buffer from pool\n");
+		goto done;
+	}
+	ip_buf_appdata(obs_buf) = net_buf_tail(obs_buf);
+	ip_buf_appdatalen(obs_buf) = net_buf_tailroom(obs_buf);
+
+	r = zoap_notification_init(&pkt, obs_buf, &notification,
+				   &observer, 0x1234);
+	if (r) {
+		TC_PRINT("Could not build notification\n");
+		goto done;
+	}
+
+	if (zoap_header_get_type(&pkt) != ZOAP_TYPE_NON_CON ||
+	    zoap_header_get_code(&pkt) != ZOAP_RESPONSE_CODE_CONTENT ||
+	    zoap_header_get_id(&pkt) != 0x1234) {
+		TC_PRINT("Notification header doesn't match\n");
+		goto done;
+	}
+
+	token = zoap_header_get_token(&pkt, &tkl);
+	if (tkl != observer.tkl || memcmp(token, observer.token, tkl)) {
+		TC_PRINT("Notification token doesn't match the observer\n");
+		goto done;
+	}
+
+	r = zoap_find_options(&pkt, ZOAP_OPTION_OBSERVE, &option, 1);
+	if (r != 1 || zoap_option_value_to_int(&option) != 5) {
+		TC_PRINT("Notification Observe option doesn't match\n");
+		goto done;
+	}
+
+	/* Parsing it again must give the same results */
+	r = zoap_packet_parse(&pkt, obs_buf);
+	if (r) {
+		TC_PRINT("Could not parse notification\n");
+		goto done;
+	}
+
+	r = zoap_find_options(&pkt, ZOAP_OPTION_OBSERVE, &option, 1);
+	if (r != 1 || zoap_option_value_to_int(&option) != 5) {
+		TC_PRINT("Notification Observe option doesn't match\n");
+		goto done;
+	}
+
+	p = zoap_packet_get_payload(&pkt, &len);
+	if (!p || memcmp(p, payload, sizeof(payload))) {
+		TC_PRINT("Notification payload doesn't match\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	if (buf) {
+		net_buf_unref(buf);
+	}
+	if (obs_buf) {
+		net_buf_unref(obs_buf);
+	}
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static char dispatch_names[NUM_ITEMS][4];
+static const char *dispatch_paths[NUM_DISPATCH_RESOURCES][4];
+static struct zoap_resource dispatch_resources[NUM_DISPATCH_RESOURCES + 1];
+static struct zoap_dispatch_node dispatch_nodes[NUM_DISPATCH_NODES];
+static struct zoap_resource *dispatched;
+
+static int dispatch_get(struct zoap_resource *resource,
+			struct zoap_packet *request,
+			const uip_ipaddr_t *addr,
+			uint16_t port)
+{
+	dispatched = resource;
+
+	return 0;
+}
+
+static void dispatch_resources_init(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		snprintf(dispatch_names[i], sizeof(dispatch_names[i]), "%d", i);
+	}
+
+	for (i = 0; i < NUM_DISPATCH_RESOURCES; i++) {
+		dispatch_paths[i][0] = dispatch_names[i / NUM_ITEMS];
+		dispatch_paths[i][1] = dispatch_names[i % NUM_ITEMS];
+		dispatch_paths[i][2] = "value";
+		dispatch_paths[i][3] = NULL;
+
+		dispatch_resources[i].path = dispatch_paths[i];
+		dispatch_resources[i].get = dispatch_get;
+	}
+}
+
+static int build_dispatch_request(struct zoap_packet *pkt,
+				  struct net_buf *buf, const char **path)
+{
+	int r;
+
+	ip_buf_appdata(buf) = net_buf_tail(buf);
+	ip_buf_appdatalen(buf) = net_buf_tailroom(buf);
+
+	r = zoap_packet_init(pkt, buf);
+	if (r) {
+		return r;
+	}
+
+	zoap_header_set_version(pkt, 1);
+	zoap_header_set_type(pkt, ZOAP_TYPE_CON);
+	zoap_header_set_code(pkt, ZOAP_METHOD_GET);
+	zoap_header_set_id(pkt, zoap_next_id());
+
+	for (; *path; path++) {
+		r = zoap_add_option(pkt, ZOAP_OPTION_URI_PATH,
+				    *path, strlen(*path));
+		if (r) {
+			return r;
+		}
+	}
+
+	return zoap_packet_parse(pkt, buf);
+}
+
+static int test_dispatch_many_resources(void)
+{
+	const char *missing_path[] = { "0", "16", "value", NULL };
+	struct zoap_dispatch dispatch;
+	struct zoap_packet req;
+	struct net_buf *buf;
+	int result = TC_FAIL;
+	int i, r;
+
+	buf = net_buf_get(&zoap_fifo, 0);
+	if (!buf) {
+		TC_PRINT("Could not get buffer from pool\n");
+		return TC_FAIL;
+	}
+
+	dispatch_resources_init();
+
+	r = zoap_dispatch_init(&dispatch, dispatch_resources,
+			       dispatch_nodes, NUM_DISPATCH_NODES);
+	if (r) {
+		TC_PRINT("Could not build the dispatch tree\n");
+		goto done;
+	}
+
+	for (i = 0; i < NUM_DISPATCH_RESOURCES; i++) {
+		r = build_dispatch_request(&req, buf, dispatch_paths[i]);
+		if (r) {
+			TC_PRINT("Could not build request\n");
+			goto done;
+		}
+
+		dispatched = NULL;
+		r = zoap_dispatch_request(&dispatch, &req, &dummy_addr, MY_PORT);
+		if (r || dispatched != &dispatch_resources[i]) {
+			TC_PRINT("Request dispatched to the wrong resource\n");
+			goto done;
+		}
+
+		dispatched = NULL;
+		r = zoap_handle_request(&req, dispatch_resources,
+					&dummy_addr, MY_PORT);
+		if (r || dispatched != &dispatch_resources[i]) {
+			TC_PRINT("Request handled by the wrong resource\n");
+			goto done;
+		}
+	}
+
+	r = build_dispatch_request(&req, buf, missing_path);
+	if (r) {
+		TC_PRINT("Could not build request\n");
+		goto done;
+	}
+
+	r = zoap_dispatch_request(&dispatch, &req, &dummy_addr, MY_PORT);
+	if (r != -ENOENT) {
+		TC_PRINT("There should be no handler for this resource\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	net_buf_unref(buf);
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 static const struct {
 	const char *name;
 	int (*func)(void);
@@ -947,6 +1262,9 @@ static const struct {
 	{ "Test observer server", test_observer_server, },
 	{ "Test observer client", test_observer_client, },
 	{ "Test block sized transfer", test_block_size, },
+	{ "Test dispatch with many resources", test_dispatch_many_resources, },
+	{ "Test pending retransmission queue", test_pending_queue, },
+	{ "Test notification to an observer", test_notification, },
 };
 
 int main(int argc, char *argv[])
@@ -26,27 +26,86 @@ int k_is_in_isr(void)
 	return 0;
 }
 
+/* A single call can get or put several buffers: the mocks use queues
+ * rather than the ztest single expected value per function.
+ */
+static void *get_data[8];
+static int get_count, get_next;
+static void *put_data[8];
+static int put_count, put_checked;
+
+static void returns_buf(void *data)
+{
+	get_data[get_count++] = data;
+}
+
 void *k_fifo_get(struct k_fifo *fifo, int32_t timeout)
 {
-	return ztest_get_return_value_ptr();
+	assert_true(get_next < get_count, "No buffer to return");
+	return get_data[get_next++];
 }
 
 void k_fifo_put(struct k_fifo *fifo, void *data)
 {
-	ztest_check_expected_value(data);
+	assert_true(put_count < ARRAY_SIZE(put_data), "Too many puts");
+	put_data[put_count++] = data;
 }
 
-#define BUF_COUNT 1
+static void expect_put(void *data)
+{
+	assert_true(put_checked < put_count, "Buffer not put");
+	assert_equal_ptr(put_data[put_checked++], data, "Wrong buffer put");
+}
+
+static void check_fifo_calls(void)
+{
+	assert_equal(put_checked, put_count, "Unexpected buffer put");
+	assert_equal(get_next, get_count, "Buffer not taken");
+	put_count = put_checked = 0;
+	get_count = get_next = 0;
+}
+
+#define BUF_COUNT 3
 #define BUF_SIZE 74
+#define SLICE_COUNT 3
 
 static struct k_fifo bufs_fifo;
 static NET_BUF_POOL(bufs_pool, BUF_COUNT, BUF_SIZE, &bufs_fifo,
 		NULL, sizeof(int));
 
+static struct k_fifo slices_fifo;
+static NET_BUF_POOL(slices_pool, SLICE_COUNT, 0, &slices_fifo,
+		NULL, 0);
+
 static void init_pool(void)
 {
-	ztest_expect_value(k_fifo_put, data, &bufs_pool);
+	int i;
+
+	put_count = put_checked = 0;
+	get_count = get_next = 0;
+
 	net_buf_pool_init(bufs_pool);
+	for (i = 0; i < BUF_COUNT; i++) {
+		expect_put(&bufs_pool[i]);
+	}
+
+	net_buf_pool_init(slices_pool);
+	for (i = 0; i < SLICE_COUNT; i++) {
+		expect_put(&slices_pool[i]);
+	}
+
+	check_fifo_calls();
+}
+
+static struct net_buf *get_buf(int i, const char *data)
+{
+	struct net_buf *buf;
+
+	returns_buf(&bufs_pool[i]);
+	buf = net_buf_get_timeout(&bufs_fifo, 0, K_NO_WAIT);
+	memcpy(net_buf_add(buf, strlen(data)), data, strlen(data));
+
+	return buf;
 }
 
 static void test_get_single_buffer(void)
@@ -55,7 +114,7 @@ static void test_get_single_buffer(void)
 
 	init_pool();
 
-	ztest_returns_value(k_fifo_get, bufs_pool);
+	returns_buf(bufs_pool);
 	buf = net_buf_get_timeout(&bufs_fifo, 0, K_NO_WAIT);
 
 	assert_equal_ptr(buf, &bufs_pool[0], "Returned buffer not from pool");
@@ -63,12 +122,103 @@ static void test_get_single_buffer(void)
 	assert_equal(buf->len, 0, "Invalid length");
 	assert_equal(buf->flags, 0, "Invalid flags");
 	assert_equal_ptr(buf->frags, NULL, "Frags not NULL");
+	assert_equal_ptr(buf->owner, NULL, "Owner not NULL");
+}
+
+static void test_slice(void)
+{
+	struct net_buf *buf, *slice, *slice2;
+
+	init_pool();
+
+	buf = get_buf(0, "0123456789");
+
+	returns_buf(&slices_pool[0]);
+	slice = net_buf_slice(&slices_fifo, buf, 2, 5);
+
+	assert_equal_ptr(slice, &slices_pool[0], "Slice not from pool");
+	assert_equal_ptr(slice->data, buf->data + 2, "Data not shared");
+	assert_equal(slice->len, 5, "Invalid length");
+	assert_equal_ptr(slice->owner, buf, "Invalid owner");
+	assert_equal(buf->ref, 2, "Owner not referenced");
+
+	/* the slice keeps the data alive */
+	net_buf_unref(buf);
+	assert_equal(buf->ref, 1, "Owner released too early");
+
+	/* slices of slices reference the original owner */
+	returns_buf(&slices_pool[1]);
+	slice2 = net_buf_slice(&slices_fifo, slice, 1, 2);
+
+	assert_equal_ptr(slice2->owner, buf, "Invalid owner");
+	assert_equal_ptr(slice2->data, buf->data + 3, "Invalid data");
+	assert_equal(buf->ref, 2, "Owner not referenced");
+
+	net_buf_unref(slice);
+	expect_put(&slices_pool[0]);
+	check_fifo_calls();
+	assert_equal(buf->ref, 1, "Owner not unreferenced");
+
+	net_buf_unref(slice2);
+	expect_put(&slices_pool[1]);
+	expect_put(&bufs_pool[0]);
+	check_fifo_calls();
+}
+
+static void test_frags_slice(void)
+{
+	struct net_buf *head, *frag, *slices;
+
+	init_pool();
+
+	head = get_buf(0, "0123");
+	net_buf_frag_add(head, get_buf(1, "456"));
+	net_buf_frag_add(head, get_buf(2, "789ab"));
+
+	returns_buf(&slices_pool[0]);
+	returns_buf(&slices_pool[1]);
+	returns_buf(&slices_pool[2]);
+	slices = net_buf_frags_slice(&slices_fifo, head, 2, 7);
+
+	assert_not_null(slices, "No slices");
+	assert_equal(net_buf_frags_len(slices), 7, "Invalid length");
+
+	for (frag = slices; frag; frag = frag->frags) {
+		assert_equal(frag->owner->ref, 2, "Owner not referenced");
+	}
+
+	assert_equal(memcmp(slices->data, "23", 2), 0, "Invalid data");
+	assert_equal(memcmp(slices->frags->data, "456", 3), 0, "Invalid data");
+	assert_equal(memcmp(slices->frags->frags->data, "78", 2), 0,
+		     "Invalid data");
+	assert_equal_ptr(slices->frags->frags->frags, NULL, "Too many slices");
+
+	net_buf_unref(slices);
+	expect_put(&slices_pool[0]);
+	expect_put(&slices_pool[1]);
+	expect_put(&slices_pool[2]);
+	check_fifo_calls();
+
+	/* past the end of the chain */
+	returns_buf(&slices_pool[0]);
+	slices = net_buf_frags_slice(&slices_fifo, head, 10, 5);
+	expect_put(&slices_pool[0]);
+	check_fifo_calls();
+	assert_is_null(slices, "Slice past the end of the chain");
+
+	net_buf_unref(head);
+	expect_put(&bufs_pool[0]);
+	expect_put(&bufs_pool[1]);
+	expect_put(&bufs_pool[2]);
+	check_fifo_calls();
 }
 
 void test_main(void)
 {
 	ztest_test_suite(net_buf_test,
-		ztest_unit_test(test_get_single_buffer)
+		ztest_unit_test(test_get_single_buffer),
+		ztest_unit_test(test_slice),
+		ztest_unit_test(test_frags_slice)
 	);
 
 	ztest_run_test_suite(net_buf_test);
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ztest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <contiki/ip/uip-chksum.c>
+
+#define DATA_SIZE 300
+#define MAX_ALIGN 8
+#define NUM_FRAGS 6
+
+static uint8_t buffer[DATA_SIZE + MAX_ALIGN];
+
+/* Byte by byte implementation previously used by the uIP stack */
+static uint16_t ref_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+	uint16_t t;
+	const uint8_t *dataptr;
+	const uint8_t *last_byte;
+
+	dataptr = data;
+	last_byte = data + len - 1;
+
+	while (dataptr < last_byte) {
+		t = (dataptr[0] << 8) + dataptr[1];
+		sum += t;
+		if (sum < t) {
+			sum++;
+		}
+		dataptr += 2;
+	}
+
+	if (dataptr == last_byte) {
+		t = (dataptr[0] << 8) + 0;
+		sum += t;
+		if (sum < t) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+static void fill_random(void)
+{
+	int i;
+
+	for (i = 0; i < sizeof(buffer); i++) {
+		buffer[i] = rand();
+	}
+}
+
+static void test_chksum_add(void)
+{
+	int align, len;
+
+	srand(1);
+	fill_random();
+
+	for (align = 0; align < MAX_ALIGN; align++) {
+		for (len = 0; len <= DATA_SIZE; len++) {
+			uint16_t sum = rand();
+			uint16_t ref = ref_chksum(sum, buffer + align, len);
+
+			assert_equal(uip_chksum_add(sum, buffer + align, len),
+				     ref, "sum differs from reference");
+		}
+	}
+}
+
+static void test_chksum_carry(void)
+{
+	int len;
+
+	/* all ones: every addition carries */
+	memset(buffer, 0xff, sizeof(buffer));
+
+	for (len = 0; len <= DATA_SIZE; len++) {
+		assert_equal(uip_chksum_add(0xffff, buffer + 1, len),
+			     ref_chksum(0xffff, buffer + 1, len),
+			     "sum differs from reference");
+		assert_equal(uip_chksum_add(0, buffer, len),
+			     ref_chksum(0, buffer, len),
+			     "sum differs from reference");
+	}
+
+	memset(buffer, 0, sizeof(buffer));
+
+	assert_equal(uip_chksum_add(0, buffer, DATA_SIZE), 0,
+		     "sum of zeros not zero");
+}
+
+static void test_chksum_frags(void)
+{
+	static struct net_buf frags[NUM_FRAGS];
+	int i, iter;
+
+	srand(2);
+	fill_random();
+
+	for (iter = 0; iter < 1000; iter++) {
+		uint16_t offset = rand() % 8;
+		uint16_t total = 0;
+		uint16_t len;
+		uint8_t *data = buffer;
+
+		/* chop the buffer in fragments of random, often odd, length */
+		for (i = 0; i < NUM_FRAGS; i++) {
+			frags[i].data = data;
+			frags[i].len = rand() % (DATA_SIZE / NUM_FRAGS);
+			frags[i].frags = (i + 1 < NUM_FRAGS) ?
+					 &frags[i + 1] : NULL;
+			data += frags[i].len;
+			total += frags[i].len;
+		}
+
+		if (offset > total) {
+			offset = total;
+		}
+
+		len = rand() % (total - offset + 1);
+
+		assert_equal(uip_chksum_add_frags(0x1234, frags, offset, len),
+			     ref_chksum(0x1234, buffer + offset, len),
+			     "fragment chain sum differs from reference");
+	}
+}
+
+static void test_chksum_update(void)
+{
+	uint16_t chksum, ref, old_val, new_val;
+	uint8_t old_addr[16];
+	int iter, pos;
+
+	srand(3);
+
+	for (iter = 0; iter < 1000; iter++) {
+		fill_random();
+
+		/* checksum field as stored in the packet */
+		chksum = sys_cpu_to_be16(~ref_chksum(0, buffer, DATA_SIZE));
+
+		/* rewrite one 16-bit field */
+		pos = (rand() % (DATA_SIZE / 2)) * 2;
+		memcpy(&old_val, buffer + pos, 2);
+		new_val = rand();
+		memcpy(buffer + pos, &new_val, 2);
+
+		ref = sys_cpu_to_be16(~ref_chksum(0, buffer, DATA_SIZE));
+		chksum = uip_chksum_update16(chksum, old_val, new_val);
+		assert_equal(chksum, ref, "16-bit update differs");
+
+		/* rewrite a 16-byte address */
+		pos = (rand() % ((DATA_SIZE - 16) / 2)) * 2;
+		memcpy(old_addr, buffer + pos, 16);
+		for (int i = 0; i < 16; i++) {
+			buffer[pos + i] = rand();
+		}
+
+		ref = sys_cpu_to_be16(~ref_chksum(0, buffer, DATA_SIZE));
+		chksum = uip_chksum_update(chksum, old_addr, buffer + pos, 16);
+		assert_equal(chksum, ref, "address update differs");
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_chksum_test,
+		ztest_unit_test(test_chksum_add),
+		ztest_unit_test(test_chksum_carry),
+		ztest_unit_test(test_chksum_frags),
+		ztest_unit_test(test_chksum_update)
+	);
+
+	ztest_run_test_suite(net_chksum_test);
+}
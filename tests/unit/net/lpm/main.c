@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ztest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <contiki/ipv6/uip-ds6-lpm.c>
+
+#define MAX_ENTRIES 512
+#define NUM_LOOKUPS 2000
+
+struct route {
+	uint8_t prefix[16];
+	uint8_t len;
+};
+
+static struct route routes[MAX_ENTRIES];
+static int num_routes;
+
+static struct uip_ds6_lpm lpm;
+static struct uip_ds6_lpm_node nodes[2 * MAX_ENTRIES];
+
+static uint8_t addrs[NUM_LOOKUPS][16];
+
+/* Prefix comparison used by the linear route lookup */
+static int prefix_match(const uint8_t *a, const uint8_t *b, uint8_t len)
+{
+	if (memcmp(a, b, len / 8)) {
+		return 0;
+	}
+
+	if (len % 8) {
+		uint8_t mask = 0xff << (8 - len % 8);
+
+		return ((a[len / 8] ^ b[len / 8]) & mask) == 0;
+	}
+
+	return 1;
+}
+
+/* Linear longest prefix match, as previously done by the route table */
+static struct route *ref_lookup(const uint8_t *addr)
+{
+	struct route *found = NULL;
+	uint8_t longest = 0;
+	int i;
+
+	for (i = 0; i < num_routes; i++) {
+		if (routes[i].len >= longest &&
+		    prefix_match(addr, routes[i].prefix, routes[i].len)) {
+			longest = routes[i].len;
+			found = &routes[i];
+			if (longest == 128) {
+				break;
+			}
+		}
+	}
+
+	return found;
+}
+
+static struct route *ref_find(const uint8_t *prefix, uint8_t len)
+{
+	int i;
+
+	for (i = 0; i < num_routes; i++) {
+		if (routes[i].len == len &&
+		    prefix_match(prefix, routes[i].prefix, len)) {
+			return &routes[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void random_addr(uint8_t *addr)
+{
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		addr[i] = rand();
+	}
+}
+
+/* Mostly host routes below a few /64 prefixes, as on a RPL root */
+static void random_prefix(uint8_t *prefix, uint8_t *len)
+{
+	static const uint8_t lens[] = { 0, 16, 48, 56, 64, 64, 72, 127 };
+
+	random_addr(prefix);
+
+	/* share the first 48 bits between prefixes in one of 4 sites */
+	memset(prefix, 0x20, 5);
+	prefix[5] = rand() % 4;
+
+	if (rand() % 4) {
+		*len = 128;
+		/* one of 4 subnets of the site */
+		prefix[6] = 0;
+		prefix[7] = rand() % 4;
+	} else {
+		*len = lens[rand() % sizeof(lens)];
+	}
+}
+
+static void fill(int count)
+{
+	uint8_t prefix[16], len;
+	struct route *r;
+
+	uip_ds6_lpm_init(&lpm, nodes, 2 * count);
+	num_routes = 0;
+
+	while (num_routes < count) {
+		random_prefix(prefix, &len);
+
+		if (ref_find(prefix, len)) {
+			continue;
+		}
+
+		r = &routes[num_routes++];
+		memcpy(r->prefix, prefix, 16);
+		r->len = len;
+
+		assert_equal(uip_ds6_lpm_add(&lpm, prefix, len, r), 0,
+			     "cannot add prefix");
+	}
+}
+
+/* Addresses close to the prefixes in the table, or random */
+static void fill_addrs(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		random_addr(addrs[i]);
+
+		if (num_routes && rand() % 8) {
+			struct route *r = &routes[rand() % num_routes];
+
+			memcpy(addrs[i], r->prefix, r->len / 8);
+			if (rand() % 2) {
+				/* sibling of a host route */
+				addrs[i][15] ^= 1 << (rand() % 8);
+			}
+		}
+	}
+}
+
+static void check_lookups(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		assert_equal_ptr(uip_ds6_lpm_lookup(&lpm, addrs[i]),
+				 ref_lookup(addrs[i]),
+				 "lookup differs from linear match");
+	}
+}
+
+static int count_free(void)
+{
+	struct uip_ds6_lpm_node *node;
+	int count = 0;
+
+	for (node = lpm.free; node; node = node->child[0]) {
+		count++;
+	}
+
+	return count;
+}
+
+static void test_lpm_lookup(void)
+{
+	int i;
+
+	srand(1);
+
+	fill(MAX_ENTRIES);
+	fill_addrs();
+	check_lookups();
+
+	for (i = 0; i < num_routes; i++) {
+		assert_equal_ptr(uip_ds6_lpm_find(&lpm, routes[i].prefix,
+						  routes[i].len),
+				 &routes[i], "prefix not found");
+	}
+}
+
+static void test_lpm_replace(void)
+{
+	uint8_t prefix[16];
+	int entry;
+
+	srand(2);
+
+	fill(16);
+
+	/* bits beyond the prefix length are ignored */
+	memcpy(prefix, routes[0].prefix, 16);
+	prefix[15] ^= 0xff;
+	if (routes[0].len < 128) {
+		assert_equal(uip_ds6_lpm_add(&lpm, prefix, routes[0].len,
+					     &entry), 0, "cannot replace");
+		assert_equal_ptr(uip_ds6_lpm_find(&lpm, routes[0].prefix,
+						  routes[0].len),
+				 &entry, "entry not replaced");
+	}
+
+	assert_equal(uip_ds6_lpm_add(&lpm, prefix, 129, &entry), -EINVAL,
+		     "invalid length accepted");
+}
+
+static void test_lpm_remove(void)
+{
+	int i, count;
+
+	srand(3);
+
+	fill(MAX_ENTRIES);
+	fill_addrs();
+
+	/* remove routes in random order, down to none */
+	while (num_routes > 0) {
+		count = num_routes / 2;
+
+		while (num_routes > count) {
+			i = rand() % num_routes;
+
+			assert_equal_ptr(uip_ds6_lpm_remove(&lpm,
+							    routes[i].prefix,
+							    routes[i].len),
+					 &routes[i], "wrong entry removed");
+			assert_is_null(uip_ds6_lpm_remove(&lpm,
+							  routes[i].prefix,
+							  routes[i].len),
+				       "entry removed twice");
+
+			/* move the last route in place of the removed one */
+			routes[i] = routes[--num_routes];
+			if (i < num_routes) {
+				assert_equal(uip_ds6_lpm_add(&lpm,
+							     routes[i].prefix,
+							     routes[i].len,
+							     &routes[i]), 0,
+					     "cannot update entry");
+			}
+		}
+
+		check_lookups();
+	}
+
+	assert_is_null(lpm.root, "nodes left in empty table");
+	assert_equal(count_free(), 2 * MAX_ENTRIES, "nodes lost");
+}
+
+static void test_lpm_no_nodes(void)
+{
+	uint8_t prefix[16], len;
+	struct route *r;
+	int ret = 0;
+
+	srand(4);
+
+	uip_ds6_lpm_init(&lpm, nodes, 32);
+	num_routes = 0;
+
+	do {
+		random_prefix(prefix, &len);
+		if (ref_find(prefix, len)) {
+			continue;
+		}
+
+		r = &routes[num_routes];
+		memcpy(r->prefix, prefix, 16);
+		r->len = len;
+
+		ret = uip_ds6_lpm_add(&lpm, prefix, len, r);
+		if (!ret) {
+			num_routes++;
+		}
+	} while (ret == 0);
+
+	assert_equal(ret, -ENOMEM, "unexpected error");
+	assert_true(num_routes >= 16, "too few entries for nodes");
+
+	/* a failed addition leaves the table untouched */
+	fill_addrs();
+	check_lookups();
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void test_lpm_lookup_cost(void)
+{
+	static const int sizes[] = { 16, 128, 512 };
+	uint64_t start, linear, tree;
+	volatile void *entry;
+	int i, s;
+
+	srand(5);
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		fill(sizes[s]);
+		fill_addrs();
+
+		start = now_ns();
+		for (i = 0; i < NUM_LOOKUPS; i++) {
+			entry = ref_lookup(addrs[i]);
+		}
+		linear = now_ns() - start;
+
+		start = now_ns();
+		for (i = 0; i < NUM_LOOKUPS; i++) {
+			entry = uip_ds6_lpm_lookup(&lpm, addrs[i]);
+		}
+		tree = now_ns() - start;
+
+		(void)entry;
+
+		PRINT("%3d routes: linear %u ns, tree %u ns per lookup\n",
+		      sizes[s], (unsigned)(linear / NUM_LOOKUPS),
+		      (unsigned)(tree / NUM_LOOKUPS));
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_lpm_test,
+		ztest_unit_test(test_lpm_lookup),
+		ztest_unit_test(test_lpm_replace),
+		ztest_unit_test(test_lpm_remove),
+		ztest_unit_test(test_lpm_no_nodes),
+		ztest_unit_test(test_lpm_lookup_cost)
+	);
+
+	ztest_run_test_suite(net_lpm_test);
+}